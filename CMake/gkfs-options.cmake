@@ -300,6 +300,22 @@ gkfs_define_option(
   DESCRIPTION "Support using the Parallax key-value store in the metadata backend"
 )
 
+## io_uring support
+gkfs_define_option(
+  GKFS_ENABLE_IO_URING
+  HELP_TEXT "Enable io_uring chunk I/O engine"
+  DEFAULT_VALUE OFF
+  DESCRIPTION "Allow the daemon to submit chunk I/O through io_uring (requires liburing)"
+)
+
+## LZ4 chunk compression
+gkfs_define_option(
+  GKFS_ENABLE_LZ4
+  HELP_TEXT "Enable LZ4 chunk compression"
+  DEFAULT_VALUE OFF
+  DESCRIPTION "Allow the daemon to store chunks compressed with LZ4 (requires lz4)"
+)
+
 ## Guided distribution
 gkfs_define_variable(
   GKFS_USE_GUIDED_DISTRIBUTION_PATH
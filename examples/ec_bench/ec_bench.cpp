@@ -0,0 +1,101 @@
+/*
+  Copyright 2018-2024, Barcelona Supercomputing Center (BSC), Spain
+  Copyright 2015-2024, Johannes Gutenberg Universitaet Mainz, Germany
+
+  This software was partially supported by the
+  EC H2020 funded project NEXTGenIO (Project ID: 671951, www.nextgenio.eu).
+
+  This software was partially supported by the
+  ADA-FS project under the SPPEXA project funded by the DFG.
+
+  This file is part of GekkoFS.
+
+  GekkoFS is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  GekkoFS is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with GekkoFS.  If not, see <https://www.gnu.org/licenses/>.
+
+  SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+/* Measures the encode and decode throughput of the Reed-Solomon code used for
+ * erasure-coded chunks.
+ *
+ * Usage: ec_bench [k] [m] [shard size in bytes] [seconds per measurement] */
+
+#include <common/erasure/reed_solomon.hpp>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+/* Runs f until the given time has passed and returns the calls per second */
+template <typename F>
+double
+measure(F f, double seconds) {
+    using clock = chrono::steady_clock;
+    auto start = clock::now();
+    auto elapsed = 0.0;
+    unsigned long calls = 0;
+    do {
+        f();
+        calls++;
+        elapsed = chrono::duration<double>(clock::now() - start).count();
+    } while(elapsed < seconds);
+    return calls / elapsed;
+}
+
+} // namespace
+
+int
+main(int argc, char* argv[]) {
+    unsigned int k = argc > 1 ? stoul(argv[1]) : 4;
+    unsigned int m = argc > 2 ? stoul(argv[2]) : 2;
+    size_t size = argc > 3 ? stoul(argv[3]) : 512 * 1024;
+    double seconds = argc > 4 ? stod(argv[4]) : 1.0;
+
+    gkfs::ec::ReedSolomon rs{k, m};
+    vector<vector<uint8_t>> shards(k + m, vector<uint8_t>(size));
+    mt19937 rng{1};
+    for(unsigned int i = 0; i < k; i++)
+        for(auto& byte : shards[i])
+            byte = static_cast<uint8_t>(rng());
+    vector<uint8_t*> ptrs{};
+    for(auto& shard : shards)
+        ptrs.push_back(shard.data());
+
+    printf("kernel %s, %u+%u, shard size %zu bytes\n", rs.kernel(), k, m,
+           size);
+    // throughput is given in data bytes per second
+    auto data_bytes = static_cast<double>(k) * size;
+    auto encodes = measure(
+            [&] { rs.encode(ptrs.data(), ptrs.data() + k, size); }, seconds);
+    printf("encode:             %8.2f GB/s\n", encodes * data_bytes / 1e9);
+
+    // the worst case loses m data shards
+    for(unsigned int lost = 1; lost <= m && lost <= k; lost++) {
+        vector<bool> present(k + m, true);
+        for(unsigned int i = 0; i < lost; i++)
+            present[i] = false;
+        auto decodes = measure(
+                [&] { rs.reconstruct(ptrs.data(), present, size); }, seconds);
+        printf("decode %3u lost:     %8.2f GB/s\n", lost,
+               decodes * data_bytes / 1e9);
+    }
+    return EXIT_SUCCESS;
+}
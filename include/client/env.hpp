@@ -53,6 +53,24 @@ static constexpr auto HOSTS_FILE = ADD_PREFIX("HOSTS_FILE");
 static constexpr auto FORWARDING_MAP_FILE = ADD_PREFIX("FORWARDING_MAP_FILE");
 #endif
 static constexpr auto NUM_REPL = ADD_PREFIX("NUM_REPL");
+static constexpr auto REPL_FORWARDING = ADD_PREFIX("REPL_FORWARDING");
+static constexpr auto REPL_WRITE_QUORUM = ADD_PREFIX("REPL_WRITE_QUORUM");
+static constexpr auto RPC_TIMEOUT = ADD_PREFIX("RPC_TIMEOUT");
+static constexpr auto METADATA_TIMEOUT = ADD_PREFIX("METADATA_TIMEOUT");
+static constexpr auto READ_TIMEOUT = ADD_PREFIX("READ_TIMEOUT");
+static constexpr auto WRITE_TIMEOUT = ADD_PREFIX("WRITE_TIMEOUT");
+static constexpr auto DIRENTS_TIMEOUT = ADD_PREFIX("DIRENTS_TIMEOUT");
+static constexpr auto RPC_RETRIES = ADD_PREFIX("RPC_RETRIES");
+static constexpr auto WRITE_BUFFER = ADD_PREFIX("WRITE_BUFFER");
+static constexpr auto WRITE_BUFFER_SIZE = ADD_PREFIX("WRITE_BUFFER_SIZE");
+static constexpr auto READ_AHEAD = ADD_PREFIX("READ_AHEAD");
+static constexpr auto READ_AHEAD_MEMORY = ADD_PREFIX("READ_AHEAD_MEMORY");
+static constexpr auto ATTR_CACHE_TTL = ADD_PREFIX("ATTR_CACHE_TTL");
+static constexpr auto ATTR_CACHE_SIZE = ADD_PREFIX("ATTR_CACHE_SIZE");
+static constexpr auto LAZY_SIZE = ADD_PREFIX("LAZY_SIZE");
+static constexpr auto LAZY_SIZE_INTERVAL = ADD_PREFIX("LAZY_SIZE_INTERVAL");
+static constexpr auto READ_HEDGE_PERCENTILE =
+        ADD_PREFIX("READ_HEDGE_PERCENTILE");
 } // namespace gkfs::env
 
 #undef ADD_PREFIX
@@ -0,0 +1,107 @@
+/*
+  Copyright 2018-2024, Barcelona Supercomputing Center (BSC), Spain
+  Copyright 2015-2024, Johannes Gutenberg Universitaet Mainz, Germany
+
+  This software was partially supported by the
+  EC H2020 funded project NEXTGenIO (Project ID: 671951, www.nextgenio.eu).
+
+  This software was partially supported by the
+  ADA-FS project under the SPPEXA project funded by the DFG.
+
+  This file is part of GekkoFS' POSIX interface.
+
+  GekkoFS' POSIX interface is free software: you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation, either version 3 of the License,
+  or (at your option) any later version.
+
+  GekkoFS' POSIX interface is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with GekkoFS' POSIX interface.  If not, see
+  <https://www.gnu.org/licenses/>.
+
+  SPDX-License-Identifier: LGPL-3.0-or-later
+*/
+
+#ifndef GEKKOFS_CLIENT_ERASURE_CODING_HPP
+#define GEKKOFS_CLIENT_ERASURE_CODING_HPP
+
+#include <cstdint>
+#include <set>
+#include <string>
+#include <utility>
+
+#include <sys/types.h>
+
+namespace gkfs::ec {
+
+/**
+ * @brief Checks whether the file system protects data with erasure coding.
+ */
+bool
+enabled();
+
+/**
+ * @brief Returns the path whose chunks are the parity chunks of a file.
+ * @param path
+ */
+std::string
+parity_path(const std::string& path);
+
+/**
+ * @brief Returns the size of the parity of a file of the given size.
+ * @param file_size
+ */
+size_t
+parity_size(size_t file_size);
+
+/**
+ * @brief Recomputes and writes the parity of the stripes touched by a write
+ * after the write's data has been written.
+ * @internal
+ * Chunks of partially written stripes are read back from their daemons.
+ * Concurrent writes to the same stripe by different clients may leave stale
+ * parity.
+ * @endinternal
+ * @param path
+ * @param buf Written data
+ * @param offset Offset of the write
+ * @param count Size of the write
+ * @return error code
+ */
+int
+update_parity(const std::string& path, const char* buf, off64_t offset,
+              size_t count);
+
+/**
+ * @brief Removes the parity beyond the new size of a truncated file and
+ * recomputes the parity of its last stripe.
+ * @param path
+ * @param old_size
+ * @param new_size
+ * @return error code
+ */
+int
+truncate_parity(const std::string& path, size_t old_size, size_t new_size);
+
+/**
+ * @brief Reads data by reconstructing the chunks on failed daemons from the
+ * remaining chunks and parity chunks of their stripes.
+ * @param path
+ * @param buf
+ * @param offset
+ * @param count
+ * @param failed Failed daemons, extended by daemons failing during the read
+ * @return pair<error code, read size>
+ */
+std::pair<int, ssize_t>
+read_degraded(const std::string& path, char* buf, off64_t offset, size_t count,
+              std::set<int8_t>& failed);
+
+} // namespace gkfs::ec
+
+#endif // GEKKOFS_CLIENT_ERASURE_CODING_HPP
@@ -88,6 +88,12 @@ gkfs_truncate(const std::string& path, off_t offset);
 int
 gkfs_truncate(const std::string& path, off_t old_size, off_t new_size);
 
+int
+gkfs_fsync(std::shared_ptr<gkfs::filemap::OpenFile> file);
+
+int
+gkfs_flush(std::shared_ptr<gkfs::filemap::OpenFile> file);
+
 int
 gkfs_dup(int oldfd);
 
@@ -159,4 +165,19 @@ gkfs_rename(const std::string& old_path, const std::string& new_path);
 extern "C" int
 gkfs_getsingleserverdir(const char* path, struct dirent_extended* dirp,
                         unsigned int count, int server);
+
+// File range of list I/O
+struct gkfs_extent {
+    off64_t offset;
+    size_t size;
+};
+
+// List I/O is using extern "C" to demangle it for C usage
+extern "C" ssize_t
+gkfs_pwritelist(int fd, const struct iovec* iov, int iovcnt,
+                const struct gkfs_extent* extents, int extcnt);
+
+extern "C" ssize_t
+gkfs_preadlist(int fd, const struct iovec* iov, int iovcnt,
+               const struct gkfs_extent* extents, int extcnt);
 #endif // GEKKOFS_GKFS_FUNCTIONS_HPP
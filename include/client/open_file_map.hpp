@@ -30,12 +30,20 @@
 #ifndef GEKKOFS_OPEN_FILE_MAP_HPP
 #define GEKKOFS_OPEN_FILE_MAP_HPP
 
+#include <config.hpp>
+#include <common/read_ahead/read_ahead.hpp>
+
 #include <map>
 #include <mutex>
 #include <memory>
 #include <atomic>
 #include <array>
+#include <chrono>
+#include <future>
+#include <list>
 #include <string>
+#include <vector>
+#include <sys/types.h>
 
 namespace gkfs::filemap {
 
@@ -51,11 +59,40 @@ enum class OpenFile_flags {
     wronly,
     rdwr,
     cloexec,
+    sync,
     flag_count // this is purely used as a size variable of this enum class
 };
 
 enum class FileType { regular, directory };
 
+/*
+ * Contiguous writes to a file that were not sent to the daemons yet
+ */
+struct WriteBuffer {
+    std::vector<char> data;
+    off64_t offset{0}; //!< File offset of data
+};
+
+/*
+ * A read-ahead window of a file that is read in the background
+ */
+struct Prefetch {
+    gkfs::read_ahead::MemoryBudget::Reservation reservation;
+    off64_t offset;
+    size_t size;
+    uint64_t generation; //!< Data generation of the file when it was issued
+    std::vector<char> data;
+    // declared after data, so that destruction waits for the read first
+    std::future<ssize_t> result;
+    ssize_t read_size{-1}; //!< Result once it was received, -1 on error
+};
+
+struct ReadAhead {
+    gkfs::read_ahead::AccessPattern pattern{
+            gkfs::config::io::read_ahead_trigger};
+    std::list<Prefetch> prefetches; //!< Ordered by offset
+};
+
 class OpenFile {
 protected:
     FileType type_;
@@ -65,6 +102,13 @@ protected:
     unsigned long pos_;
     std::mutex pos_mutex_;
     std::mutex flag_mutex_;
+    WriteBuffer write_buffer_;
+    std::mutex write_buffer_mutex_;
+    ReadAhead read_ahead_;
+    std::mutex read_ahead_mutex_;
+    // file size reached by writes that was not sent to the daemons, 0 if none
+    std::atomic<off64_t> unsent_size_{0};
+    std::atomic<std::chrono::steady_clock::rep> size_sent_;
 
 public:
     // multiple threads may want to update the file position if fd has been
@@ -96,6 +140,46 @@ public:
 
     FileType
     type() const;
+
+    /**
+     * Returns the write-back buffer of the file. It must only be accessed
+     * while holding write_buffer_mutex().
+     */
+    WriteBuffer&
+    write_buffer();
+
+    std::mutex&
+    write_buffer_mutex();
+
+    /**
+     * Returns the read-ahead state of the file. It must only be accessed
+     * while holding read_ahead_mutex().
+     */
+    ReadAhead&
+    read_ahead();
+
+    std::mutex&
+    read_ahead_mutex();
+
+    /**
+     * Raises the file size reached by writes of this process that was not
+     * sent to the daemons yet.
+     */
+    void
+    raise_unsent_size(off64_t size);
+
+    /**
+     * Returns the unsent file size, 0 if there is none, and resets it.
+     */
+    off64_t
+    take_unsent_size();
+
+    /**
+     * Returns true at most once per interval, whenever the unsent file size
+     * should be sent.
+     */
+    bool
+    size_update_due(std::chrono::milliseconds interval);
 };
 
 
@@ -153,6 +237,12 @@ public:
 
     int
     get_fd_idx();
+
+    /**
+     * Returns all open files, e.g., to flush them on shutdown.
+     */
+    std::vector<std::shared_ptr<OpenFile>>
+    open_files();
 };
 
 } // namespace gkfs::filemap
@@ -31,12 +31,15 @@
 #define GEKKOFS_PRELOAD_CTX_HPP
 
 #include <hermes.hpp>
+#include <array>
 #include <map>
 #include <mercury.h>
 #include <memory>
 #include <vector>
 #include <string>
 #include <config.hpp>
+#include <common/read_ahead/read_ahead.hpp>
+#include <common/attr_cache.hpp>
 
 #include <bitset>
 
@@ -63,6 +66,13 @@ struct FsConfig {
     bool ctime_state;
     bool link_cnt_state;
     bool blocks_state;
+    // files up to this size store their data in the metadentry, 0 if disabled
+    size_t inline_data_size;
+    // chunksize of the file system, a power of 2
+    size_t chunksize;
+    // Reed-Solomon data and parity chunks per stripe, 0 if disabled
+    unsigned int ec_data_shards;
+    unsigned int ec_parity_shards;
 
     uid_t uid;
     gid_t gid;
@@ -72,6 +82,9 @@ struct FsConfig {
 
 enum class RelativizeStatus { internal, external, fd_unknown, fd_not_a_dir };
 
+// RPCs with their own timeout
+enum class RpcOp { metadata, read, write, dirents, count };
+
 /**
  * Singleton class of the client context with all relevant global data
  */
@@ -106,6 +119,31 @@ private:
     std::bitset<MAX_USER_FDS> protected_fds_;
     std::string hostname;
     int replicas_;
+    // daemons of copy 0 write the replicas instead of the client
+    bool replica_forwarding_{false};
+    // copies of each chunk written before a forwarded write returns
+    int write_quorum_{0};
+    // RPCs unanswered after these times fail, 0 waits
+    std::array<unsigned int, static_cast<size_t>(RpcOp::count)>
+            rpc_timeouts_ms_{};
+    // retries of idempotent RPCs that failed
+    unsigned int rpc_retries_{0};
+    // small writes are collected per open file before they are sent
+    bool write_buffer_{false};
+    // size of the write-back buffers, 0 is the chunksize
+    size_t write_buffer_size_{0};
+    // chunks read ahead per window of sequentially read files, 0 disables
+    unsigned int read_ahead_{0};
+    // memory of all read-ahead buffers
+    gkfs::read_ahead::MemoryBudget read_ahead_budget_{};
+    // file sizes reached by writes are sent on close, fsync, stat or after
+    // an interval instead of before every write
+    bool lazy_size_{false};
+    std::chrono::milliseconds lazy_size_interval_{0};
+    // stat results of paths, nullptr if disabled
+    std::unique_ptr<gkfs::metadata::AttributeCache> attr_cache_;
+    // read RPCs slower than this latency percentile are hedged, 0 disables
+    double read_hedge_percentile_{0};
 
 public:
     static PreloadContext*
@@ -223,6 +261,76 @@ public:
 
     int
     get_replicas();
+
+    void
+    set_replica_forwarding(bool forwarding);
+
+    bool
+    get_replica_forwarding();
+
+    void
+    set_write_quorum(int quorum);
+
+    int
+    get_write_quorum();
+
+    void
+    set_rpc_timeout(RpcOp op, unsigned int timeout_ms);
+
+    unsigned int
+    get_rpc_timeout(RpcOp op);
+
+    void
+    set_rpc_retries(unsigned int retries);
+
+    unsigned int
+    get_rpc_retries();
+
+    void
+    set_write_buffer(bool write_buffer);
+
+    void
+    set_write_buffer_size(size_t size);
+
+    /**
+     * Returns the size of the write-back buffers or 0 if write-back buffering
+     * is disabled.
+     */
+    size_t
+    get_write_buffer_size();
+
+    void
+    set_read_ahead(unsigned int chunks);
+
+    unsigned int
+    get_read_ahead();
+
+    gkfs::read_ahead::MemoryBudget&
+    read_ahead_budget();
+
+    void
+    set_lazy_size(bool lazy_size);
+
+    bool
+    get_lazy_size();
+
+    void
+    set_lazy_size_interval(std::chrono::milliseconds interval);
+
+    std::chrono::milliseconds
+    get_lazy_size_interval();
+
+    /**
+     * Returns the attribute cache or nullptr if it is disabled.
+     */
+    gkfs::metadata::AttributeCache*
+    attr_cache();
+
+    void
+    set_read_hedge_percentile(double percentile);
+
+    double
+    get_read_hedge_percentile();
 };
 
 } // namespace preload
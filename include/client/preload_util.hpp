@@ -73,6 +73,9 @@ to_underlying(E e) {
 std::optional<gkfs::metadata::Metadata>
 get_metadata(const std::string& path, bool follow_links = false);
 
+void
+invalidate_metadata(const std::string& path);
+
 int
 metadata_to_stat(const std::string& path, const gkfs::metadata::Metadata& md,
                  struct stat& attr);
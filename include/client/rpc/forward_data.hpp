@@ -33,6 +33,9 @@
 #include <string>
 #include <memory>
 #include <set>
+
+#include <sys/uio.h>
+
 namespace gkfs::rpc {
 
 struct ChunkStat {
@@ -48,15 +51,39 @@ std::pair<int, ssize_t>
 forward_write(const std::string& path, const void* buf, off64_t offset,
               size_t write_size, const int8_t num_copy = 0);
 
+std::pair<int, ssize_t>
+forward_writev(const std::string& path, const struct iovec* iov, int iovcnt,
+               off64_t offset, const int8_t num_copies = 0);
+
 std::pair<int, ssize_t>
 forward_read(const std::string& path, void* buf, off64_t offset,
              size_t read_size, const int8_t num_copies,
              std::set<int8_t>& failed);
 
+std::pair<int, ssize_t>
+forward_readv(const std::string& path, const struct iovec* iov, int iovcnt,
+              off64_t offset, const int8_t num_copies,
+              std::set<int8_t>& failed);
+
 int
 forward_truncate(const std::string& path, size_t current_size, size_t new_size,
                  const int8_t num_copies);
 
+int
+forward_fsync(const std::string& path, size_t file_size,
+              const int8_t num_copies);
+
+std::pair<int, off64_t>
+forward_write_inline(const std::string& path, const void* buf, off64_t offset,
+                     size_t write_size, const bool append_flag);
+
+std::pair<int, ssize_t>
+forward_read_inline(const std::string& path, void* buf, off64_t offset,
+                    size_t read_size);
+
+int
+forward_spill_inline(const std::string& path, const void* buf, size_t size);
+
 std::pair<int, ChunkStat>
 forward_get_chunk_stat();
 
@@ -0,0 +1,283 @@
+/*
+  Copyright 2018-2024, Barcelona Supercomputing Center (BSC), Spain
+  Copyright 2015-2024, Johannes Gutenberg Universitaet Mainz, Germany
+
+  This software was partially supported by the
+  EC H2020 funded project NEXTGenIO (Project ID: 671951, www.nextgenio.eu).
+
+  This software was partially supported by the
+  ADA-FS project under the SPPEXA project funded by the DFG.
+
+  This file is part of GekkoFS' POSIX interface.
+
+  GekkoFS' POSIX interface is free software: you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation, either version 3 of the License,
+  or (at your option) any later version.
+
+  GekkoFS' POSIX interface is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with GekkoFS' POSIX interface.  If not, see
+  <https://www.gnu.org/licenses/>.
+
+  SPDX-License-Identifier: LGPL-3.0-or-later
+*/
+
+#ifndef GEKKOFS_CLIENT_RPC_CALL_HPP
+#define GEKKOFS_CLIENT_RPC_CALL_HPP
+
+#include <client/preload_util.hpp>
+#include <client/logging.hpp>
+
+#include <common/rpc/endpoint_health.hpp>
+
+#include <chrono>
+#include <functional>
+#include <future>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+struct iovec;
+
+namespace gkfs::rpc {
+
+/**
+ * @brief Thrown if an RPC is not answered within its timeout.
+ */
+class timeout_error : public std::runtime_error {
+public:
+    using std::runtime_error::runtime_error;
+};
+
+/**
+ * @brief Returns the health of the daemons as seen by this client.
+ */
+EndpointHealth&
+endpoint_health();
+
+/**
+ * @brief Returns the backoff before a retry of a failed RPC.
+ * @param retry Number of the retry, starting at 0
+ */
+std::chrono::milliseconds
+retry_backoff(unsigned int retry);
+
+/**
+ * @brief Memory exposed for the bulk transfers of RPCs.
+ * @internal
+ * An RPC that timed out can still access its exposed memory until it
+ * completes. RPCs that may time out therefore transfer from and to a private
+ * buffer that is owned by them and released with the last of them, instead of
+ * the application's buffers.
+ * @endinternal
+ */
+struct rpc_memory {
+    std::unique_ptr<char[]> buffer; //!< Private buffer, nullptr if not used
+    hermes::exposed_memory exposed;
+};
+
+/**
+ * @brief Exposes the data of a write. With a timeout for the operation, the
+ * data is copied to a private buffer first so that the application's buffers
+ * can be reused once the write returned, even if an RPC timed out.
+ * @param iov Buffers to write, exposed as a single bulk region in order
+ * @param iovcnt Number of buffers
+ * @param op Operation determining the timeout
+ * @return Exposed memory, to be passed to gkfs::rpc::get_output()
+ * @throws std::exception if the memory cannot be exposed
+ */
+std::shared_ptr<rpc_memory>
+expose_write(const struct iovec* iov, int iovcnt, gkfs::preload::RpcOp op);
+
+/**
+ * @brief Exposes memory for RPCs to write to. With a timeout for the
+ * operation, a private buffer is exposed instead of the application's buffer,
+ * and the caller copies the data of a successful RPC from it.
+ * @param buf Application buffer or nullptr to always use a private buffer
+ * @param size Size of the buffer
+ * @param op Operation determining the timeout
+ * @return Exposed memory, to be passed to gkfs::rpc::get_output()
+ * @throws std::exception if the memory cannot be exposed
+ */
+std::shared_ptr<rpc_memory>
+expose_read(void* buf, size_t size, gkfs::preload::RpcOp op);
+
+/**
+ * @brief A function waiting for an RPC in the background.
+ */
+class background_wait;
+
+/**
+ * @brief Runs a function waiting for an RPC in the background. The waiting
+ * threads are shared by all RPCs of the client.
+ * @param wait Function waiting for an RPC. Its argument is set if it was
+ * queued as all threads were busy, so that the RPC may have completed before
+ * it was waited for
+ * @return The wait, to be passed to gkfs::rpc::abandon_wait()
+ */
+std::shared_ptr<background_wait>
+wait_in_background(std::function<void(bool)> wait);
+
+/**
+ * @brief Marks a wait as no longer awaited by its caller, e.g., as its RPC
+ * timed out. Its thread then no longer counts towards the waiting threads
+ * that are shared by the RPCs still awaited. Has no effect if the wait
+ * already completed.
+ * @param wait Wait returned by gkfs::rpc::wait_in_background()
+ */
+void
+abandon_wait(const std::shared_ptr<background_wait>& wait);
+
+/**
+ * @brief Waits for the output of a posted RPC for at most the timeout of its
+ * operation and records whether the daemon answered.
+ * @internal
+ * Hermes can neither wait for a handle with a timeout nor cancel it. With a
+ * timeout, the handle is therefore waited for in the background, see
+ * gkfs::rpc::wait_in_background(), and an RPC that timed out completes there.
+ * The memory of the RPC is released only then. Its wait is abandoned so that
+ * it does not hold up the waits of other RPCs.
+ * @endinternal
+ * @param handle Handle of the RPC, moved from if a timeout is set
+ * @param host Daemon the RPC was sent to
+ * @param op Operation determining the timeout
+ * @param memory Memory exposed for the RPC, kept until the RPC completed
+ * @return RPC output
+ * @throws gkfs::rpc::timeout_error if the RPC timed out
+ * @throws std::exception if the RPC failed
+ */
+template <typename RpcT>
+typename RpcT::output
+get_output(hermes::rpc_handle<RpcT>& handle, uint64_t host,
+           gkfs::preload::RpcOp op,
+           std::shared_ptr<rpc_memory> memory = nullptr) {
+    const auto timeout = std::chrono::milliseconds(CTX->get_rpc_timeout(op));
+    try {
+        if(timeout.count() == 0) {
+            // TODO(amiranda): hermes will eventually provide a post(endpoint)
+            // returning one result and a broadcast(endpoint_set) returning a
+            // result_set. When that happens we can remove the .at(0) :/
+            auto out = handle.get().at(0);
+            endpoint_health().answered(host);
+            return out;
+        }
+        auto result =
+                std::make_shared<std::promise<typename RpcT::output>>();
+        auto future = result->get_future();
+        auto wait = wait_in_background(
+                [h = std::make_shared<hermes::rpc_handle<RpcT>>(
+                         std::move(handle)),
+                 result, memory](bool) mutable {
+                    try {
+                        result->set_value(h->get().at(0));
+                    } catch(...) {
+                        result->set_exception(std::current_exception());
+                    }
+                    // the RPC no longer accesses its memory
+                    h.reset();
+                    memory.reset();
+                });
+        if(future.wait_for(timeout) == std::future_status::timeout) {
+            abandon_wait(wait);
+            throw timeout_error("RPC to host " + std::to_string(host) +
+                                " timed out after " +
+                                std::to_string(timeout.count()) + " ms");
+        }
+        auto out = future.get();
+        endpoint_health().answered(host);
+        return out;
+    } catch(const std::exception& ex) {
+        endpoint_health().failed(host);
+        throw;
+    }
+}
+
+/**
+ * @brief Sends an RPC to a daemon and waits for its output for at most the
+ * timeout of its operation.
+ * @param op Operation determining the timeout
+ * @param host Daemon to send the RPC to
+ * @param args Input of the RPC
+ * @return RPC output
+ * @throws gkfs::rpc::timeout_error if the RPC timed out
+ * @throws std::exception if the RPC failed
+ */
+template <typename RpcT, typename... Args>
+typename RpcT::output
+call(gkfs::preload::RpcOp op, uint64_t host, const Args&... args) {
+    auto handle =
+            ld_network_service->post<RpcT>(CTX->hosts().at(host), args...);
+    return get_output(handle, host, op);
+}
+
+namespace detail {
+
+template <typename F>
+auto
+with_retries(uint64_t host, F&& attempt) -> decltype(attempt(0u)) {
+    for(unsigned int retry = 0;; retry++) {
+        try {
+            return attempt(retry);
+        } catch(const std::exception& ex) {
+            if(retry >= CTX->get_rpc_retries())
+                throw;
+            auto backoff = retry_backoff(retry);
+            LOG(WARNING, "RPC to host {} failed: '{}'. Retrying in {} ms",
+                host, ex.what(), backoff.count());
+            std::this_thread::sleep_for(backoff);
+        }
+    }
+}
+
+} // namespace detail
+
+/**
+ * @brief Sends an idempotent RPC like gkfs::rpc::call() and sends it again
+ * with exponential backoff if it failed or timed out, up to the configured
+ * number of retries. Errors reported by the daemon are not retried.
+ * @param op Operation determining the timeout
+ * @param host Daemon to send the RPC to
+ * @param args Input of the RPC
+ * @return RPC output
+ * @throws std::exception if the last attempt failed
+ */
+template <typename RpcT, typename... Args>
+typename RpcT::output
+call_with_retries(gkfs::preload::RpcOp op, uint64_t host,
+                  const Args&... args) {
+    return detail::with_retries(
+            host, [&](unsigned int) { return call<RpcT>(op, host, args...); });
+}
+
+/**
+ * @brief Waits for a posted idempotent RPC like gkfs::rpc::get_output() and
+ * sends it again like gkfs::rpc::call_with_retries() if it failed or timed
+ * out.
+ * @param handle Handle of the RPC, moved from if a timeout is set
+ * @param op Operation determining the timeout
+ * @param host Daemon the RPC was sent to
+ * @param args Input of the RPC
+ * @return RPC output
+ * @throws std::exception if the last attempt failed
+ */
+template <typename RpcT, typename... Args>
+typename RpcT::output
+get_output_with_retries(hermes::rpc_handle<RpcT>& handle,
+                        gkfs::preload::RpcOp op, uint64_t host,
+                        const Args&... args) {
+    return detail::with_retries(host, [&](unsigned int retry) {
+        if(retry == 0)
+            return get_output(handle, host, op);
+        return call<RpcT>(op, host, args...);
+    });
+}
+
+} // namespace gkfs::rpc
+
+#endif // GEKKOFS_CLIENT_RPC_CALL_HPP
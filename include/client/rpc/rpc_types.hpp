@@ -37,6 +37,7 @@
 
 // C++ includes
 #include <string>
+#include <vector>
 
 // hermes includes
 #include <hermes.hpp>
@@ -140,16 +141,21 @@ struct fs_config {
         output()
             : m_mountdir(), m_rootdir(), m_atime_state(), m_mtime_state(),
               m_ctime_state(), m_link_cnt_state(), m_blocks_state(), m_uid(),
-              m_gid() {}
+              m_gid(), m_inline_data_size(), m_chunksize(),
+              m_ec_data_shards(), m_ec_parity_shards() {}
 
         output(const std::string& mountdir, const std::string& rootdir,
                bool atime_state, bool mtime_state, bool ctime_state,
                bool link_cnt_state, bool blocks_state, uint32_t uid,
-               uint32_t gid)
+               uint32_t gid, uint64_t inline_data_size, uint64_t chunksize,
+               uint32_t ec_data_shards, uint32_t ec_parity_shards)
             : m_mountdir(mountdir), m_rootdir(rootdir),
               m_atime_state(atime_state), m_mtime_state(mtime_state),
               m_ctime_state(ctime_state), m_link_cnt_state(link_cnt_state),
-              m_blocks_state(blocks_state), m_uid(uid), m_gid(gid) {}
+              m_blocks_state(blocks_state), m_uid(uid), m_gid(gid),
+              m_inline_data_size(inline_data_size), m_chunksize(chunksize),
+              m_ec_data_shards(ec_data_shards),
+              m_ec_parity_shards(ec_parity_shards) {}
 
         output(output&& rhs) = default;
 
@@ -178,6 +184,10 @@ struct fs_config {
             m_blocks_state = out.blocks_state;
             m_uid = out.uid;
             m_gid = out.gid;
+            m_inline_data_size = out.inline_data_size;
+            m_chunksize = out.chunksize;
+            m_ec_data_shards = out.ec_data_shards;
+            m_ec_parity_shards = out.ec_parity_shards;
         }
 
         std::string
@@ -225,6 +235,26 @@ struct fs_config {
             return m_gid;
         }
 
+        uint64_t
+        inline_data_size() const {
+            return m_inline_data_size;
+        }
+
+        uint64_t
+        chunksize() const {
+            return m_chunksize;
+        }
+
+        uint32_t
+        ec_data_shards() const {
+            return m_ec_data_shards;
+        }
+
+        uint32_t
+        ec_parity_shards() const {
+            return m_ec_parity_shards;
+        }
+
     private:
         std::string m_mountdir;
         std::string m_rootdir;
@@ -235,6 +265,10 @@ struct fs_config {
         bool m_blocks_state;
         uint32_t m_uid;
         uint32_t m_gid;
+        uint64_t m_inline_data_size;
+        uint64_t m_chunksize;
+        uint32_t m_ec_data_shards;
+        uint32_t m_ec_parity_shards;
     };
 };
 
@@ -1194,6 +1228,297 @@ struct update_metadentry_size {
     };
 };
 
+//==============================================================================
+// definitions for write_inline
+struct write_inline {
+
+    // forward declarations of public input/output types for this RPC
+    class input;
+
+    class output;
+
+    // traits used so that the engine knows what to do with the RPC
+    using self_type = write_inline;
+    using handle_type = hermes::rpc_handle<self_type>;
+    using input_type = input;
+    using output_type = output;
+    using mercury_input_type = rpc_write_inline_in_t;
+    using mercury_output_type = rpc_update_metadentry_size_out_t;
+
+    // RPC public identifier
+    // (N.B: we reuse the same IDs assigned by Margo so that the daemon
+    // understands Hermes RPCs)
+    constexpr static const uint64_t public_id = 1609891840;
+
+    // RPC internal Mercury identifier
+    constexpr static const hg_id_t mercury_id = public_id;
+
+    // RPC name
+    constexpr static const auto name = gkfs::rpc::tag::write_inline;
+
+    // requires response?
+    constexpr static const auto requires_response = true;
+
+    // Mercury callback to serialize input arguments
+    constexpr static const auto mercury_in_proc_cb =
+            HG_GEN_PROC_NAME(rpc_write_inline_in_t);
+
+    // Mercury callback to serialize output arguments
+    constexpr static const auto mercury_out_proc_cb =
+            HG_GEN_PROC_NAME(rpc_update_metadentry_size_out_t);
+
+    class input {
+
+        template <typename ExecutionContext>
+        friend hg_return_t
+        hermes::detail::post_to_mercury(ExecutionContext*);
+
+    public:
+        input(const std::string& path, int64_t offset, uint64_t count,
+              bool append, const hermes::exposed_memory& buffers)
+            : m_path(path), m_offset(offset), m_count(count),
+              m_append(append), m_buffers(buffers) {}
+
+        input(input&& rhs) = default;
+
+        input(const input& other) = default;
+
+        input&
+        operator=(input&& rhs) = default;
+
+        input&
+        operator=(const input& other) = default;
+
+        std::string
+        path() const {
+            return m_path;
+        }
+
+        int64_t
+        offset() const {
+            return m_offset;
+        }
+
+        uint64_t
+        count() const {
+            return m_count;
+        }
+
+        bool
+        append() const {
+            return m_append;
+        }
+
+        hermes::exposed_memory
+        buffers() const {
+            return m_buffers;
+        }
+
+        explicit input(const rpc_write_inline_in_t& other)
+            : m_path(other.path), m_offset(other.offset), m_count(other.count),
+              m_append(other.append), m_buffers(other.bulk_handle) {}
+
+        explicit operator rpc_write_inline_in_t() {
+            return {m_path.c_str(), m_offset, m_count, m_append,
+                    hg_bulk_t(m_buffers)};
+        }
+
+    private:
+        std::string m_path;
+        int64_t m_offset;
+        uint64_t m_count;
+        bool m_append;
+        hermes::exposed_memory m_buffers;
+    };
+
+    class output {
+
+        template <typename ExecutionContext>
+        friend hg_return_t
+        hermes::detail::post_to_mercury(ExecutionContext*);
+
+    public:
+        output() : m_err(), m_ret_offset() {}
+
+        output(int32_t err, int64_t ret_offset)
+            : m_err(err), m_ret_offset(ret_offset) {}
+
+        output(output&& rhs) = default;
+
+        output(const output& other) = default;
+
+        output&
+        operator=(output&& rhs) = default;
+
+        output&
+        operator=(const output& other) = default;
+
+        explicit output(const rpc_update_metadentry_size_out_t& out) {
+            m_err = out.err;
+            m_ret_offset = out.ret_offset;
+        }
+
+        int32_t
+        err() const {
+            return m_err;
+        }
+
+        int64_t
+        ret_offset() const {
+            return m_ret_offset;
+        }
+
+    private:
+        int32_t m_err;
+        int64_t m_ret_offset;
+    };
+};
+
+//==============================================================================
+// definitions for read_inline
+struct read_inline {
+
+    // forward declarations of public input/output types for this RPC
+    class input;
+
+    class output;
+
+    // traits used so that the engine knows what to do with the RPC
+    using self_type = read_inline;
+    using handle_type = hermes::rpc_handle<self_type>;
+    using input_type = input;
+    using output_type = output;
+    using mercury_input_type = rpc_read_inline_in_t;
+    using mercury_output_type = rpc_data_out_t;
+
+    // RPC public identifier
+    // (N.B: we reuse the same IDs assigned by Margo so that the daemon
+    // understands Hermes RPCs)
+    constexpr static const uint64_t public_id = 1917386752;
+
+    // RPC internal Mercury identifier
+    constexpr static const hg_id_t mercury_id = public_id;
+
+    // RPC name
+    constexpr static const auto name = gkfs::rpc::tag::read_inline;
+
+    // requires response?
+    constexpr static const auto requires_response = true;
+
+    // Mercury callback to serialize input arguments
+    constexpr static const auto mercury_in_proc_cb =
+            HG_GEN_PROC_NAME(rpc_read_inline_in_t);
+
+    // Mercury callback to serialize output arguments
+    constexpr static const auto mercury_out_proc_cb =
+            HG_GEN_PROC_NAME(rpc_data_out_t);
+
+    class input {
+
+        template <typename ExecutionContext>
+        friend hg_return_t
+        hermes::detail::post_to_mercury(ExecutionContext*);
+
+    public:
+        input(const std::string& path, int64_t offset, uint64_t count,
+              bool spill, const hermes::exposed_memory& buffers)
+            : m_path(path), m_offset(offset), m_count(count), m_spill(spill),
+              m_buffers(buffers) {}
+
+        input(input&& rhs) = default;
+
+        input(const input& other) = default;
+
+        input&
+        operator=(input&& rhs) = default;
+
+        input&
+        operator=(const input& other) = default;
+
+        std::string
+        path() const {
+            return m_path;
+        }
+
+        int64_t
+        offset() const {
+            return m_offset;
+        }
+
+        uint64_t
+        count() const {
+            return m_count;
+        }
+
+        bool
+        spill() const {
+            return m_spill;
+        }
+
+        hermes::exposed_memory
+        buffers() const {
+            return m_buffers;
+        }
+
+        explicit input(const rpc_read_inline_in_t& other)
+            : m_path(other.path), m_offset(other.offset), m_count(other.count),
+              m_spill(other.spill), m_buffers(other.bulk_handle) {}
+
+        explicit operator rpc_read_inline_in_t() {
+            return {m_path.c_str(), m_offset, m_count, m_spill,
+                    hg_bulk_t(m_buffers)};
+        }
+
+    private:
+        std::string m_path;
+        int64_t m_offset;
+        uint64_t m_count;
+        bool m_spill;
+        hermes::exposed_memory m_buffers;
+    };
+
+    class output {
+
+        template <typename ExecutionContext>
+        friend hg_return_t
+        hermes::detail::post_to_mercury(ExecutionContext*);
+
+    public:
+        output() : m_err(), m_io_size() {}
+
+        output(int32_t err, size_t io_size) : m_err(err), m_io_size(io_size) {}
+
+        output(output&& rhs) = default;
+
+        output(const output& other) = default;
+
+        output&
+        operator=(output&& rhs) = default;
+
+        output&
+        operator=(const output& other) = default;
+
+        explicit output(const rpc_data_out_t& out) {
+            m_err = out.err;
+            m_io_size = out.io_size;
+        }
+
+        int32_t
+        err() const {
+            return m_err;
+        }
+
+        int64_t
+        io_size() const {
+            return m_io_size;
+        }
+
+    private:
+        int32_t m_err;
+        size_t m_io_size;
+    };
+};
+
 #ifdef HAS_SYMLINKS
 
 //==============================================================================
@@ -1469,13 +1794,16 @@ struct write_data {
 
     public:
         input(const std::string& path, int64_t offset, uint64_t host_id,
-              uint64_t host_size, const std::string& wbitset, uint64_t chunk_n,
-              uint64_t chunk_start, uint64_t chunk_end,
-              uint64_t total_chunk_size, const hermes::exposed_memory& buffers)
+              uint64_t host_size, const std::vector<uint8_t>& chunk_set,
+              uint64_t chunk_n, uint64_t chunk_start, uint64_t chunk_end,
+              uint64_t total_chunk_size, uint32_t replicas,
+              uint32_t write_quorum, const hermes::exposed_memory& buffers)
             : m_path(path), m_offset(offset), m_host_id(host_id),
-              m_host_size(host_size), m_wbitset(wbitset), m_chunk_n(chunk_n),
-              m_chunk_start(chunk_start), m_chunk_end(chunk_end),
-              m_total_chunk_size(total_chunk_size), m_buffers(buffers) {}
+              m_host_size(host_size), m_chunk_set(chunk_set),
+              m_chunk_n(chunk_n), m_chunk_start(chunk_start),
+              m_chunk_end(chunk_end), m_total_chunk_size(total_chunk_size),
+              m_replicas(replicas), m_write_quorum(write_quorum),
+              m_buffers(buffers) {}
 
         input(input&& rhs) = default;
 
@@ -1512,9 +1840,9 @@ struct write_data {
             return m_chunk_n;
         }
 
-        std::string
-        wbitset() const {
-            return m_wbitset;
+        const std::vector<uint8_t>&
+        chunk_set() const {
+            return m_chunk_set;
         }
 
         uint64_t
@@ -1532,6 +1860,16 @@ struct write_data {
             return m_total_chunk_size;
         }
 
+        uint32_t
+        replicas() const {
+            return m_replicas;
+        }
+
+        uint32_t
+        write_quorum() const {
+            return m_write_quorum;
+        }
+
         hermes::exposed_memory
         buffers() const {
             return m_buffers;
@@ -1540,15 +1878,29 @@ struct write_data {
         explicit input(const rpc_write_data_in_t& other)
             : m_path(other.path), m_offset(other.offset),
               m_host_id(other.host_id), m_host_size(other.host_size),
-              m_wbitset(other.wbitset), m_chunk_n(other.chunk_n),
-              m_chunk_start(other.chunk_start), m_chunk_end(other.chunk_end),
+              m_chunk_set(static_cast<const uint8_t*>(other.chunk_set.data),
+                          static_cast<const uint8_t*>(other.chunk_set.data) +
+                                  other.chunk_set.size),
+              m_chunk_n(other.chunk_n), m_chunk_start(other.chunk_start),
+              m_chunk_end(other.chunk_end),
               m_total_chunk_size(other.total_chunk_size),
+              m_replicas(other.replicas), m_write_quorum(other.write_quorum),
               m_buffers(other.bulk_handle) {}
 
         explicit operator rpc_write_data_in_t() {
-            return {m_path.c_str(),      m_offset,          m_host_id,
-                    m_host_size,         m_wbitset.c_str(), m_chunk_n,
-                    m_chunk_start,       m_chunk_end,       m_total_chunk_size,
+            return {m_path.c_str(),
+                    m_offset,
+                    m_host_id,
+                    m_host_size,
+                    rpc_binary_t{m_chunk_set.size(), m_chunk_set.data()},
+                    m_chunk_n,
+                    m_chunk_start,
+                    m_chunk_end,
+                    m_total_chunk_size,
+                    // clients always send all chunks of the request
+                    rpc_binary_t{0, nullptr},
+                    m_replicas,
+                    m_write_quorum,
                     hg_bulk_t(m_buffers)};
         }
 
@@ -1557,11 +1909,13 @@ struct write_data {
         int64_t m_offset;
         uint64_t m_host_id;
         uint64_t m_host_size;
-        std::string m_wbitset;
+        std::vector<uint8_t> m_chunk_set;
         uint64_t m_chunk_n;
         uint64_t m_chunk_start;
         uint64_t m_chunk_end;
         uint64_t m_total_chunk_size;
+        uint32_t m_replicas;
+        uint32_t m_write_quorum;
         hermes::exposed_memory m_buffers;
     };
 
@@ -1654,13 +2008,14 @@ struct read_data {
 
     public:
         input(const std::string& path, int64_t offset, uint64_t host_id,
-              uint64_t host_size, const std::string& wbitset, uint64_t chunk_n,
-              uint64_t chunk_start, uint64_t chunk_end,
+              uint64_t host_size, const std::vector<uint8_t>& chunk_set,
+              uint64_t chunk_n, uint64_t chunk_start, uint64_t chunk_end,
               uint64_t total_chunk_size, const hermes::exposed_memory& buffers)
             : m_path(path), m_offset(offset), m_host_id(host_id),
-              m_host_size(host_size), m_wbitset(wbitset), m_chunk_n(chunk_n),
-              m_chunk_start(chunk_start), m_chunk_end(chunk_end),
-              m_total_chunk_size(total_chunk_size), m_buffers(buffers) {}
+              m_host_size(host_size), m_chunk_set(chunk_set),
+              m_chunk_n(chunk_n), m_chunk_start(chunk_start),
+              m_chunk_end(chunk_end), m_total_chunk_size(total_chunk_size),
+              m_buffers(buffers) {}
 
         input(input&& rhs) = default;
 
@@ -1692,9 +2047,9 @@ struct read_data {
             return m_host_size;
         }
 
-        std::string
-        wbitset() const {
-            return m_wbitset;
+        const std::vector<uint8_t>&
+        chunk_set() const {
+            return m_chunk_set;
         }
 
         uint64_t
@@ -1725,15 +2080,24 @@ struct read_data {
         explicit input(const rpc_read_data_in_t& other)
             : m_path(other.path), m_offset(other.offset),
               m_host_id(other.host_id), m_host_size(other.host_size),
-              m_wbitset(other.wbitset), m_chunk_n(other.chunk_n),
-              m_chunk_start(other.chunk_start), m_chunk_end(other.chunk_end),
+              m_chunk_set(static_cast<const uint8_t*>(other.chunk_set.data),
+                          static_cast<const uint8_t*>(other.chunk_set.data) +
+                                  other.chunk_set.size),
+              m_chunk_n(other.chunk_n), m_chunk_start(other.chunk_start),
+              m_chunk_end(other.chunk_end),
               m_total_chunk_size(other.total_chunk_size),
               m_buffers(other.bulk_handle) {}
 
         explicit operator rpc_read_data_in_t() {
-            return {m_path.c_str(),      m_offset,          m_host_id,
-                    m_host_size,         m_wbitset.c_str(), m_chunk_n,
-                    m_chunk_start,       m_chunk_end,       m_total_chunk_size,
+            return {m_path.c_str(),
+                    m_offset,
+                    m_host_id,
+                    m_host_size,
+                    rpc_binary_t{m_chunk_set.size(), m_chunk_set.data()},
+                    m_chunk_n,
+                    m_chunk_start,
+                    m_chunk_end,
+                    m_total_chunk_size,
                     hg_bulk_t(m_buffers)};
         }
 
@@ -1742,7 +2106,7 @@ struct read_data {
         int64_t m_offset;
         uint64_t m_host_id;
         uint64_t m_host_size;
-        std::string m_wbitset;
+        std::vector<uint8_t> m_chunk_set;
         uint64_t m_chunk_n;
         uint64_t m_chunk_start;
         uint64_t m_chunk_end;
@@ -2294,6 +2658,114 @@ struct chunk_stat {
     };
 };
 
+//==============================================================================
+// definitions for fsync_data
+struct fsync_data {
+
+    // forward declarations of public input/output types for this RPC
+    class input;
+
+    class output;
+
+    // traits used so that the engine knows what to do with the RPC
+    using self_type = fsync_data;
+    using handle_type = hermes::rpc_handle<self_type>;
+    using input_type = input;
+    using output_type = output;
+    using mercury_input_type = rpc_path_only_in_t;
+    using mercury_output_type = rpc_err_out_t;
+
+    // RPC public identifier
+    // (N.B: we reuse the same IDs assigned by Margo so that the daemon
+    // understands Hermes RPCs)
+    constexpr static const uint64_t public_id = 2726035456;
+
+    // RPC internal Mercury identifier
+    constexpr static const hg_id_t mercury_id = public_id;
+
+    // RPC name
+    constexpr static const auto name = gkfs::rpc::tag::fsync_data;
+
+    // requires response?
+    constexpr static const auto requires_response = true;
+
+    // Mercury callback to serialize input arguments
+    constexpr static const auto mercury_in_proc_cb =
+            HG_GEN_PROC_NAME(rpc_path_only_in_t);
+
+    // Mercury callback to serialize output arguments
+    constexpr static const auto mercury_out_proc_cb =
+            HG_GEN_PROC_NAME(rpc_err_out_t);
+
+    class input {
+
+        template <typename ExecutionContext>
+        friend hg_return_t
+        hermes::detail::post_to_mercury(ExecutionContext*);
+
+    public:
+        input(const std::string& path) : m_path(path) {}
+
+        input(input&& rhs) = default;
+
+        input(const input& other) = default;
+
+        input&
+        operator=(input&& rhs) = default;
+
+        input&
+        operator=(const input& other) = default;
+
+        std::string
+        path() const {
+            return m_path;
+        }
+
+        explicit input(const rpc_path_only_in_t& other) : m_path(other.path) {}
+
+        explicit operator rpc_path_only_in_t() {
+            return {m_path.c_str()};
+        }
+
+    private:
+        std::string m_path;
+    };
+
+    class output {
+
+        template <typename ExecutionContext>
+        friend hg_return_t
+        hermes::detail::post_to_mercury(ExecutionContext*);
+
+    public:
+        output() : m_err() {}
+
+        output(int32_t err) : m_err(err) {}
+
+        output(output&& rhs) = default;
+
+        output(const output& other) = default;
+
+        output&
+        operator=(output&& rhs) = default;
+
+        output&
+        operator=(const output& other) = default;
+
+        explicit output(const rpc_err_out_t& out) {
+            m_err = out.err;
+        }
+
+        int32_t
+        err() const {
+            return m_err;
+        }
+
+    private:
+        int32_t m_err;
+    };
+};
+
 } // namespace gkfs::rpc
 
 
@@ -0,0 +1,146 @@
+/*
+  Copyright 2018-2024, Barcelona Supercomputing Center (BSC), Spain
+  Copyright 2015-2024, Johannes Gutenberg Universitaet Mainz, Germany
+
+  This software was partially supported by the
+  EC H2020 funded project NEXTGenIO (Project ID: 671951, www.nextgenio.eu).
+
+  This software was partially supported by the
+  ADA-FS project under the SPPEXA project funded by the DFG.
+
+  This file is part of GekkoFS.
+
+  GekkoFS is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  GekkoFS is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with GekkoFS.  If not, see <https://www.gnu.org/licenses/>.
+
+  SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#ifndef GEKKOFS_COMMON_ATTR_CACHE_HPP
+#define GEKKOFS_COMMON_ATTR_CACHE_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace gkfs::metadata {
+
+struct AttributeCacheStats {
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t evictions;
+    size_t size;
+}; //!< Struct for counters of the attribute cache
+
+/**
+ * @brief Cached result of a stat RPC: the serialized metadata of a path or the
+ * error the daemon returned for it.
+ */
+struct CachedAttributes {
+    int err;
+    std::string attr; //!< Serialized Metadata, empty if err is set
+};
+
+/**
+ * @brief Bounded LRU cache of stat results keyed by path whose entries expire
+ * after a time to live.
+ * @internal
+ * The cache is split into shards, each with its own mutex and LRU list, so
+ * that threads of a client stat'ing different paths rarely contend. Expired
+ * entries are removed when they are looked up or evicted.
+ * @endinternal
+ */
+class AttributeCache {
+public:
+    using clock = std::chrono::steady_clock;
+
+private:
+    struct entry {
+        std::string path;
+        CachedAttributes value;
+        clock::time_point expires;
+    };
+
+    struct shard {
+        std::mutex mtx;
+        std::list<entry> lru; //!< most recently used entry first
+        std::unordered_map<std::string, std::list<entry>::iterator> map;
+    };
+
+    std::vector<std::unique_ptr<shard>> shards_;
+    size_t shard_capacity_; //!< maximum number of entries per shard
+    clock::duration ttl_;
+
+    std::atomic<uint64_t> hits_{0};
+    std::atomic<uint64_t> misses_{0};
+    std::atomic<uint64_t> evictions_{0};
+
+    shard&
+    get_shard(const std::string& path);
+
+public:
+    /**
+     * @brief Creates the cache.
+     * @param capacity Maximum number of entries in total
+     * @param shard_count Number of independently locked shards
+     * @param ttl Time after which an entry expires
+     */
+    AttributeCache(size_t capacity, size_t shard_count, clock::duration ttl);
+
+    /**
+     * @brief Looks up the stat result of a path and marks it as recently
+     * used.
+     * @param path GekkoFS path, e.g., /foo/bar
+     * @param now Current time
+     * @return Cached result or {} on a miss or if it expired
+     */
+    std::optional<CachedAttributes>
+    get(const std::string& path, clock::time_point now = clock::now());
+
+    /**
+     * @brief Inserts or replaces the stat result of a path, evicting the least
+     * recently used entry of the shard if it is full.
+     * @param path GekkoFS path, e.g., /foo/bar
+     * @param value Stat result
+     * @param now Current time
+     */
+    void
+    put(const std::string& path, CachedAttributes value,
+        clock::time_point now = clock::now());
+
+    /**
+     * @brief Removes the stat result of a path, e.g., after it was modified.
+     * @param path GekkoFS path, e.g., /foo/bar
+     */
+    void
+    invalidate(const std::string& path);
+
+    /**
+     * @brief Returns hit, miss, and eviction counters and the current number
+     * of entries.
+     * @return AttributeCacheStats struct
+     */
+    [[nodiscard]] AttributeCacheStats
+    stats() const;
+};
+
+} // namespace gkfs::metadata
+
+#endif // GEKKOFS_COMMON_ATTR_CACHE_HPP
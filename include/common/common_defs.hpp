@@ -29,6 +29,8 @@
 #ifndef GEKKOFS_COMMON_DEFS_HPP
 #define GEKKOFS_COMMON_DEFS_HPP
 
+#include <cerrno>
+
 // These constexpr set the RPC's identity and which handler the receiver end
 // should use
 namespace gkfs::rpc {
@@ -55,8 +57,18 @@ constexpr auto write = "rpc_srv_write_data";
 constexpr auto read = "rpc_srv_read_data";
 constexpr auto truncate = "rpc_srv_trunc_data";
 constexpr auto get_chunk_stat = "rpc_srv_chunk_stat";
+constexpr auto fsync_data = "rpc_srv_fsync_data";
+constexpr auto write_inline = "rpc_srv_write_inline";
+constexpr auto read_inline = "rpc_srv_read_inline";
 } // namespace tag
 
+/*
+ * Error of the inline data RPCs if a file's data is not stored in its
+ * metadentry, and of update_metadentry_size if it is and must be moved to the
+ * file's chunks first.
+ */
+constexpr auto inline_data_err = EXDEV;
+
 namespace protocol {
 constexpr auto ofi_psm2 = "ofi+psm2";
 constexpr auto ofi_sockets = "ofi+sockets";
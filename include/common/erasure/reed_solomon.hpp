@@ -0,0 +1,102 @@
+/*
+  Copyright 2018-2024, Barcelona Supercomputing Center (BSC), Spain
+  Copyright 2015-2024, Johannes Gutenberg Universitaet Mainz, Germany
+
+  This software was partially supported by the
+  EC H2020 funded project NEXTGenIO (Project ID: 671951, www.nextgenio.eu).
+
+  This software was partially supported by the
+  ADA-FS project under the SPPEXA project funded by the DFG.
+
+  This file is part of GekkoFS.
+
+  GekkoFS is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  GekkoFS is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with GekkoFS.  If not, see <https://www.gnu.org/licenses/>.
+
+  SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#ifndef GEKKOFS_COMMON_ERASURE_REED_SOLOMON_HPP
+#define GEKKOFS_COMMON_ERASURE_REED_SOLOMON_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace gkfs::ec {
+
+/**
+ * @brief Systematic Reed-Solomon code over GF(2^8) with k data and m parity
+ * shards of equal size. Any k of the k + m shards restore all others.
+ * @internal
+ * The generator matrix is the identity on top of a Cauchy matrix, whose square
+ * submatrices are all invertible. Shards are multiplied with coefficients by
+ * looking up the products of the low and high nibble of each byte, which maps
+ * to byte shuffles with AVX2, SSSE3, or NEON. The fastest kernel supported by
+ * the CPU is chosen at runtime.
+ * @endinternal
+ */
+class ReedSolomon {
+private:
+    unsigned int k_;
+    unsigned int m_;
+    std::vector<uint8_t> parity_matrix_; //!< m x k coefficients, row-major
+    std::vector<uint8_t> parity_tables_; //!< Nibble products per coefficient
+
+public:
+    /**
+     * @brief Creates a code.
+     * @param data_shards Number of data shards k
+     * @param parity_shards Number of parity shards m
+     * @throws std::invalid_argument if k or m is 0 or k + m exceeds 256
+     */
+    ReedSolomon(unsigned int data_shards, unsigned int parity_shards);
+
+    [[nodiscard]] unsigned int
+    data_shards() const;
+
+    [[nodiscard]] unsigned int
+    parity_shards() const;
+
+    /**
+     * @brief Computes the parity shards of k data shards.
+     * @param data k data shards
+     * @param parity m parity shards, overwritten
+     * @param size Size of each shard in bytes
+     */
+    void
+    encode(const uint8_t* const* data, uint8_t* const* parity,
+           size_t size) const;
+
+    /**
+     * @brief Restores all missing data and parity shards.
+     * @param shards k data shards followed by m parity shards. Missing shards
+     * must point to writable buffers
+     * @param present Which of the k + m shards are present
+     * @param size Size of each shard in bytes
+     * @throws std::invalid_argument if fewer than k shards are present
+     */
+    void
+    reconstruct(uint8_t* const* shards, const std::vector<bool>& present,
+                size_t size) const;
+
+    /**
+     * @brief Returns the name of the kernel used on this CPU, e.g., "avx2".
+     */
+    static const char*
+    kernel();
+};
+
+} // namespace gkfs::ec
+
+#endif // GEKKOFS_COMMON_ERASURE_REED_SOLOMON_HPP
@@ -0,0 +1,152 @@
+/*
+  Copyright 2018-2024, Barcelona Supercomputing Center (BSC), Spain
+  Copyright 2015-2024, Johannes Gutenberg Universitaet Mainz, Germany
+
+  This software was partially supported by the
+  EC H2020 funded project NEXTGenIO (Project ID: 671951, www.nextgenio.eu).
+
+  This software was partially supported by the
+  ADA-FS project under the SPPEXA project funded by the DFG.
+
+  This file is part of GekkoFS.
+
+  GekkoFS is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  GekkoFS is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with GekkoFS.  If not, see <https://www.gnu.org/licenses/>.
+
+  SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#ifndef GEKKOFS_COMMON_READ_AHEAD_HPP
+#define GEKKOFS_COMMON_READ_AHEAD_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace gkfs::read_ahead {
+
+/**
+ * @brief Detects sequential and strided reads of an open file and predicts the
+ * offset of the next read.
+ * @internal
+ * A read continues the pattern if it starts where the previous read ended
+ * (sequential, for any read sizes) or if it is as far from the previous read
+ * as the previous read was from its predecessor (strided, forward only). The
+ * class is not thread-safe.
+ * @endinternal
+ */
+class AccessPattern {
+private:
+    int64_t last_offset_{-1};
+    int64_t last_end_{-1};
+    int64_t stride_{0};
+    unsigned int hits_{0}; //!< Consecutive reads continuing the pattern
+    unsigned int trigger_;
+
+public:
+    /**
+     * @brief Creates a detector.
+     * @param trigger Number of consecutive reads that must continue a pattern
+     * before a next read is predicted
+     */
+    explicit AccessPattern(unsigned int trigger);
+
+    /**
+     * @brief Records a read.
+     * @param offset Offset of the read
+     * @param count Size of the read
+     * @return Predicted offset of the next read or -1 if the reads form no
+     * pattern (yet)
+     */
+    int64_t
+    record(int64_t offset, size_t count);
+
+    /**
+     * @brief Forgets all recorded reads.
+     */
+    void
+    reset();
+};
+
+/**
+ * @brief Bounds the memory that all read-ahead buffers of a process may use.
+ */
+class MemoryBudget {
+private:
+    std::atomic<size_t> used_{0};
+    std::atomic<size_t> limit_;
+
+public:
+    /**
+     * @brief Memory taken from a budget. It is returned to the budget when the
+     * reservation is destroyed.
+     */
+    class Reservation {
+    private:
+        MemoryBudget* budget_{nullptr};
+        size_t size_{0};
+
+    public:
+        Reservation() = default;
+
+        Reservation(MemoryBudget* budget, size_t size);
+
+        Reservation(Reservation&& other) noexcept;
+
+        Reservation&
+        operator=(Reservation&& other) noexcept;
+
+        Reservation(const Reservation&) = delete;
+
+        Reservation&
+        operator=(const Reservation&) = delete;
+
+        ~Reservation();
+
+        /**
+         * @brief Returns false if the budget could not grant the memory.
+         */
+        explicit operator bool() const;
+
+        [[nodiscard]] size_t
+        size() const;
+    };
+
+    /**
+     * @brief Creates a budget.
+     * @param limit Memory in bytes that may be reserved at the same time
+     */
+    explicit MemoryBudget(size_t limit = 0);
+
+    void
+    set_limit(size_t limit);
+
+    /**
+     * @brief Takes memory from the budget.
+     * @param size Memory in bytes
+     * @return Reservation of the memory, which is empty if it would exceed the
+     * limit
+     */
+    Reservation
+    reserve(size_t size);
+
+    /**
+     * @brief Returns the memory in bytes that is currently reserved.
+     */
+    [[nodiscard]] size_t
+    used() const;
+};
+
+} // namespace gkfs::read_ahead
+
+#endif // GEKKOFS_COMMON_READ_AHEAD_HPP
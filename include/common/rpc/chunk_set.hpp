@@ -0,0 +1,109 @@
+/*
+  Copyright 2018-2024, Barcelona Supercomputing Center (BSC), Spain
+  Copyright 2015-2024, Johannes Gutenberg Universitaet Mainz, Germany
+
+  This software was partially supported by the
+  EC H2020 funded project NEXTGenIO (Project ID: 671951, www.nextgenio.eu).
+
+  This software was partially supported by the
+  ADA-FS project under the SPPEXA project funded by the DFG.
+
+  This file is part of GekkoFS.
+
+  GekkoFS is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  GekkoFS is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with GekkoFS.  If not, see <https://www.gnu.org/licenses/>.
+
+  SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#ifndef GEKKOFS_COMMON_RPC_CHUNK_SET_HPP
+#define GEKKOFS_COMMON_RPC_CHUNK_SET_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace gkfs::rpc {
+
+/**
+ * @brief Set of the chunks of an I/O request that a daemon serves, sent with
+ * the request as binary RPC data.
+ * @internal
+ * Chunks are given relative to the first chunk of the request and kept as
+ * sorted runs of consecutive chunks. The encoding is whichever of two formats
+ * is smaller, so its size depends on the number of chunks and runs instead of
+ * being limited to a fixed range:
+ *
+ * - runs: a format byte, the number of runs, and per run the gap to the end of
+ *   the previous run and its length - 1, all as LEB128 varints.
+ * - bitmap: a format byte, the number of bits as varint, and one bit per chunk
+ *   up to the last one.
+ *
+ * Chunks placed by hashing rarely form runs, so a set of one out of many
+ * daemons takes about 2 bytes per chunk as runs and a set of one out of few
+ * daemons takes 1 bit per chunk of the request as bitmap. Contiguous chunks,
+ * e.g., all chunks on a single daemon, take a few bytes.
+ * @endinternal
+ */
+class ChunkSet {
+private:
+    struct run {
+        uint64_t start;
+        uint64_t length;
+    };
+
+    std::vector<run> runs_;
+    uint64_t size_{0};
+
+public:
+    /**
+     * @brief Adds a chunk. Chunks must be added in ascending order. Adding the
+     * last added chunk again has no effect.
+     * @param chunk Chunk id relative to the first chunk of the request
+     * @throws std::invalid_argument if chunk precedes the last added chunk
+     */
+    void
+    add(uint64_t chunk);
+
+    /**
+     * @brief Checks whether a chunk is in the set.
+     * @param chunk Chunk id relative to the first chunk of the request
+     */
+    [[nodiscard]] bool
+    contains(uint64_t chunk) const;
+
+    /**
+     * @brief Returns the number of chunks in the set.
+     */
+    [[nodiscard]] uint64_t
+    size() const;
+
+    /**
+     * @brief Returns the set in its binary RPC encoding.
+     */
+    [[nodiscard]] std::vector<uint8_t>
+    encode() const;
+
+    /**
+     * @brief Reads a set from its binary RPC encoding.
+     * @param data Encoded set
+     * @param size Size of the encoded set in bytes
+     * @throws std::invalid_argument if the encoding is malformed
+     */
+    static ChunkSet
+    decode(const uint8_t* data, size_t size);
+};
+
+} // namespace gkfs::rpc
+
+#endif // GEKKOFS_COMMON_RPC_CHUNK_SET_HPP
@@ -160,6 +160,57 @@ public:
     locate_directory_metadata(const std::string& path) const override;
 };
 
+/**
+ * @brief Places the chunks of erasure-coded files. The k data chunks and m
+ * parity chunks of a stripe are stored on distinct daemons if there are at
+ * least k + m daemons.
+ * @internal
+ * Data chunk c belongs to stripe c / k. The parity chunks of a file are the
+ * chunks of its parity path (gkfs::config::ec::parity_prefix followed by the
+ * file's path), where parity chunk c belongs to stripe c / m. A stripe is
+ * hashed to its first daemon and its data chunks followed by its parity chunks
+ * are placed on the consecutive daemons from there.
+ * @endinternal
+ */
+class StripeDistributor : public Distributor {
+private:
+    host_t localhost_;
+    unsigned int hosts_size_{0};
+    unsigned int data_shards_;
+    unsigned int parity_shards_;
+    std::vector<host_t> all_hosts_;
+    std::hash<std::string> str_hash;
+
+    host_t
+    locate_chunk(const std::string& path, const chunkid_t& chnk_id,
+                 const int num_copy) const;
+
+public:
+    StripeDistributor(host_t localhost, unsigned int hosts_size,
+                      unsigned int data_shards, unsigned int parity_shards);
+
+    host_t
+    localhost() const override;
+
+    unsigned int
+    hosts_size() const override;
+
+    host_t
+    locate_data(const std::string& path, const chunkid_t& chnk_id,
+                const int num_copy) const override;
+
+    host_t
+    locate_data(const std::string& path, const chunkid_t& chnk_id,
+                unsigned int host_size, const int num_copy) override;
+
+    host_t
+    locate_file_metadata(const std::string& path,
+                         const int num_copy) const override;
+
+    std::vector<host_t>
+    locate_directory_metadata(const std::string& path) const override;
+};
+
 /*
  * Class IntervalSet
  * FROM
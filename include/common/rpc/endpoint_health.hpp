@@ -0,0 +1,105 @@
+/*
+  Copyright 2018-2024, Barcelona Supercomputing Center (BSC), Spain
+  Copyright 2015-2024, Johannes Gutenberg Universitaet Mainz, Germany
+
+  This software was partially supported by the
+  EC H2020 funded project NEXTGenIO (Project ID: 671951, www.nextgenio.eu).
+
+  This software was partially supported by the
+  ADA-FS project under the SPPEXA project funded by the DFG.
+
+  This file is part of GekkoFS.
+
+  GekkoFS is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  GekkoFS is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with GekkoFS.  If not, see <https://www.gnu.org/licenses/>.
+
+  SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#ifndef GEKKOFS_COMMON_RPC_ENDPOINT_HEALTH_HPP
+#define GEKKOFS_COMMON_RPC_ENDPOINT_HEALTH_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace gkfs::rpc {
+
+/**
+ * @brief Tracks which endpoints keep failing RPCs so that requests can be
+ * routed to other copies of their data.
+ * @internal
+ * An endpoint failing threshold RPCs in a row, e.g., by timing out, is
+ * suspected for a period. Once the period is over, the endpoint is used again
+ * and a single further failure suspects it anew. Any answered RPC clears it.
+ * @endinternal
+ */
+class EndpointHealth {
+public:
+    using clock = std::chrono::steady_clock;
+
+private:
+    struct endpoint {
+        unsigned int failures{0}; //!< Failed RPCs in a row
+        clock::time_point suspect_until{};
+    };
+
+    mutable std::mutex mutex_;
+    std::unordered_map<uint64_t, endpoint> endpoints_;
+    // number of endpoints in endpoints_ to skip locking if all are healthy
+    std::atomic<size_t> tracked_{0};
+    unsigned int threshold_;
+    std::chrono::milliseconds period_;
+
+public:
+    /**
+     * @brief Creates a tracker.
+     * @param threshold Failed RPCs in a row after which an endpoint is
+     * suspected
+     * @param period Time an endpoint remains suspected
+     * @throws std::invalid_argument if threshold is 0
+     */
+    EndpointHealth(unsigned int threshold, std::chrono::milliseconds period);
+
+    /**
+     * @brief Records a failed RPC, i.e., one that timed out or could not be
+     * delivered.
+     */
+    void
+    failed(uint64_t endpoint, clock::time_point now = clock::now());
+
+    /**
+     * @brief Records an answered RPC.
+     */
+    void
+    answered(uint64_t endpoint);
+
+    /**
+     * @brief Checks whether an endpoint is suspected.
+     */
+    [[nodiscard]] bool
+    suspect(uint64_t endpoint, clock::time_point now = clock::now()) const;
+
+    /**
+     * @brief Returns all suspected endpoints.
+     */
+    [[nodiscard]] std::vector<uint64_t>
+    suspects(clock::time_point now = clock::now()) const;
+};
+
+} // namespace gkfs::rpc
+
+#endif // GEKKOFS_COMMON_RPC_ENDPOINT_HEALTH_HPP
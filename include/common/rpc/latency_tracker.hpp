@@ -0,0 +1,88 @@
+/*
+  Copyright 2018-2024, Barcelona Supercomputing Center (BSC), Spain
+  Copyright 2015-2024, Johannes Gutenberg Universitaet Mainz, Germany
+
+  This software was partially supported by the
+  EC H2020 funded project NEXTGenIO (Project ID: 671951, www.nextgenio.eu).
+
+  This software was partially supported by the
+  ADA-FS project under the SPPEXA project funded by the DFG.
+
+  This file is part of GekkoFS.
+
+  GekkoFS is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  GekkoFS is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with GekkoFS.  If not, see <https://www.gnu.org/licenses/>.
+
+  SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#ifndef GEKKOFS_COMMON_RPC_LATENCY_TRACKER_HPP
+#define GEKKOFS_COMMON_RPC_LATENCY_TRACKER_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace gkfs::rpc {
+
+/**
+ * @brief Tracks a percentile of the most recent latencies of an RPC type, e.g.,
+ * to decide when a request is slow enough to be hedged.
+ * @internal
+ * Latencies are kept in a ring buffer. The percentile is recomputed with
+ * std::nth_element after every capacity / 16 added samples and read without
+ * locking.
+ * @endinternal
+ */
+class LatencyTracker {
+private:
+    std::mutex mutex_;
+    std::vector<uint64_t> samples_; //!< Ring buffer of latencies in us
+    size_t next_{0};
+    size_t count_{0};
+    size_t stale_{0}; //!< Samples added since the percentile was computed
+    double percentile_;
+    size_t min_samples_;
+    std::atomic<uint64_t> value_{0};
+
+public:
+    /**
+     * @brief Creates a tracker.
+     * @param percentile Tracked percentile in (0, 100]
+     * @param capacity Number of most recent samples considered
+     * @param min_samples Number of samples before a percentile is reported
+     * @throws std::invalid_argument if percentile is out of range or capacity
+     * is 0
+     */
+    LatencyTracker(double percentile, size_t capacity, size_t min_samples);
+
+    /**
+     * @brief Adds a latency sample.
+     */
+    void
+    add(std::chrono::microseconds latency);
+
+    /**
+     * @brief Returns the percentile of the recent latencies or 0 if there are
+     * fewer than min_samples samples.
+     */
+    [[nodiscard]] std::chrono::microseconds
+    value() const;
+};
+
+} // namespace gkfs::rpc
+
+#endif // GEKKOFS_COMMON_RPC_LATENCY_TRACKER_HPP
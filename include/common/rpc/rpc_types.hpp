@@ -34,8 +34,48 @@ extern "C" {
 #include <margo.h>
 }
 
+#include <cstdlib>
+
 /* visible API for RPC data types used in RPCS */
 
+// binary data of variable size, e.g., an encoded gkfs::rpc::ChunkSet
+typedef struct {
+    hg_uint64_t size;
+    void* data;
+} rpc_binary_t;
+
+/**
+ * @brief Serializes rpc_binary_t. The decoded data is allocated and freed with
+ * the RPC input.
+ */
+static inline hg_return_t
+hg_proc_rpc_binary_t(hg_proc_t proc, void* arg) {
+    auto* binary = static_cast<rpc_binary_t*>(arg);
+    auto ret = hg_proc_hg_uint64_t(proc, &binary->size);
+    if(ret != HG_SUCCESS)
+        return ret;
+    if(binary->size == 0) {
+        if(hg_proc_get_op(proc) == HG_DECODE)
+            binary->data = nullptr;
+        return HG_SUCCESS;
+    }
+    switch(hg_proc_get_op(proc)) {
+        case HG_DECODE:
+            binary->data = malloc(binary->size);
+            if(binary->data == nullptr)
+                return HG_NOMEM;
+            return hg_proc_raw(proc, binary->data, binary->size);
+        case HG_ENCODE:
+            return hg_proc_raw(proc, binary->data, binary->size);
+        case HG_FREE:
+            free(binary->data);
+            binary->data = nullptr;
+            return HG_SUCCESS;
+        default:
+            return HG_INVALID_ARG;
+    }
+}
+
 // misc generic rpc types
 MERCURY_GEN_PROC(rpc_err_out_t, ((hg_int32_t) (err)))
 
@@ -89,19 +129,34 @@ MERCURY_GEN_PROC(
         rpc_read_data_in_t,
         ((hg_const_string_t) (path))((int64_t) (offset))(
                 (hg_uint64_t) (host_id))((hg_uint64_t) (host_size))(
-                (hg_const_string_t) (wbitset))((hg_uint64_t) (chunk_n))(
+                (rpc_binary_t) (chunk_set))((hg_uint64_t) (chunk_n))(
                 (hg_uint64_t) (chunk_start))((hg_uint64_t) (chunk_end))(
                 (hg_uint64_t) (total_chunk_size))((hg_bulk_t) (bulk_handle)))
 
 MERCURY_GEN_PROC(rpc_data_out_t, ((int32_t) (err))((hg_size_t) (io_size)))
 
+// origin_chunk_set is empty if the bulk holds all chunks from chunk_start to
+// chunk_end, i.e., if the request is sent by a client. replicas is the number
+// of replicas the receiving daemon writes to other daemons
 MERCURY_GEN_PROC(
         rpc_write_data_in_t,
         ((hg_const_string_t) (path))((int64_t) (offset))(
                 (hg_uint64_t) (host_id))((hg_uint64_t) (host_size))(
-                (hg_const_string_t) (wbitset))((hg_uint64_t) (chunk_n))(
+                (rpc_binary_t) (chunk_set))((hg_uint64_t) (chunk_n))(
                 (hg_uint64_t) (chunk_start))((hg_uint64_t) (chunk_end))(
-                (hg_uint64_t) (total_chunk_size))((hg_bulk_t) (bulk_handle)))
+                (hg_uint64_t) (total_chunk_size))(
+                (rpc_binary_t) (origin_chunk_set))((hg_uint32_t) (replicas))(
+                (hg_uint32_t) (write_quorum))((hg_bulk_t) (bulk_handle)))
+
+MERCURY_GEN_PROC(rpc_write_inline_in_t,
+                 ((hg_const_string_t) (path))((hg_int64_t) (offset))(
+                         (hg_uint64_t) (count))((hg_bool_t) (append))(
+                         (hg_bulk_t) (bulk_handle)))
+
+MERCURY_GEN_PROC(rpc_read_inline_in_t,
+                 ((hg_const_string_t) (path))((hg_int64_t) (offset))(
+                         (hg_uint64_t) (count))((hg_bool_t) (spill))(
+                         (hg_bulk_t) (bulk_handle)))
 
 MERCURY_GEN_PROC(rpc_get_dirents_in_t,
                  ((hg_const_string_t) (path))((hg_bulk_t) (bulk_handle)))
@@ -116,7 +171,9 @@ MERCURY_GEN_PROC(
                 (hg_bool_t) (atime_state))((hg_bool_t) (mtime_state))(
                 (hg_bool_t) (ctime_state))((hg_bool_t) (link_cnt_state))(
                 (hg_bool_t) (blocks_state))((hg_uint32_t) (uid))(
-                (hg_uint32_t) (gid)))
+                (hg_uint32_t) (gid))((hg_uint64_t) (inline_data_size))(
+                (hg_uint64_t) (chunksize))((hg_uint32_t) (ec_data_shards))(
+                (hg_uint32_t) (ec_parity_shards)))
 
 
 MERCURY_GEN_PROC(rpc_chunk_stat_in_t, ((hg_int32_t) (dummy)))
@@ -52,18 +52,6 @@ std::string
 get_host_by_name(const std::string& hostname);
 #endif
 
-bool
-get_bitset(const std::vector<uint8_t>& data, const uint16_t position);
-
-void
-set_bitset(std::vector<uint8_t>& data, const uint16_t position);
-
-std::string
-compress_bitset(const std::vector<uint8_t>& bytes);
-
-std::vector<uint8_t>
-decompress_bitset(const std::string& compressedString);
-
 } // namespace gkfs::rpc
 
 #endif // GEKKOFS_COMMON_RPC_UTILS_HPP
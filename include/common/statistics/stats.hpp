@@ -45,6 +45,8 @@
 #include <fstream>
 #include <atomic>
 #include <mutex>
+#include <functional>
+#include <string>
 #include <config.hpp>
 
 
@@ -164,6 +166,10 @@ private:
              std::atomic<unsigned int>>
             chunk_writes; ///< Stores the number of times a chunk/file is write
 
+    std::mutex counters_mutex;
+    std::map<std::string, std::function<unsigned long long()>>
+            counters; ///< Counters owned by other daemon modules, read on dump
+
     /**
      * @brief Called by output to generate CHUNK map
      *
@@ -260,6 +266,18 @@ public:
     void
     add_value_size(enum SizeOp, unsigned long long value);
 
+    /**
+     * @brief Registers a named counter that is owned by another module, e.g.,
+     * a cache in the data backend. The getter is called each time the stats
+     * are dumped, so it must be thread-safe and cheap.
+     *
+     * @param name label used in the output
+     * @param getter returns the current counter value
+     */
+    void
+    register_counter(const std::string& name,
+                     std::function<unsigned long long()> getter);
+
     /**
      * @brief Get the total mean value of the asked stat
      * This can be provided inmediately without cost
@@ -47,6 +47,24 @@ namespace io {
  * If buffer is not zeroed, sparse regions contain invalid data.
  */
 constexpr auto zero_buffer_before_read = false;
+/*
+ * Chunk I/O engine used by the daemon if not set via --io-engine. "tasklet"
+ * runs blocking pread/pwrite in the Argobots I/O pool, "io_uring" (only if
+ * compiled with GKFS_ENABLE_IO_URING) submits all chunk I/O of an RPC as one
+ * batch to an io_uring instance.
+ */
+constexpr auto default_engine = "tasklet";
+// Number of submission queue entries of the io_uring instance
+constexpr auto uring_queue_depth = 256;
+/*
+ * Number of consecutive reads of an open file that must continue a sequential
+ * or strided pattern before the client reads ahead
+ */
+constexpr auto read_ahead_trigger = 2;
+// Read-ahead windows per open file that are prefetched at the same time
+constexpr auto read_ahead_windows = 2;
+// Default memory budget of all read-ahead buffers of a client process in bytes
+constexpr auto read_ahead_memory = 256UL * 1024 * 1024;
 } // namespace io
 
 namespace log {
@@ -84,14 +102,128 @@ constexpr auto implicit_data_removal = true;
 // Check for existence of file metadata before create. This done on RocksDB
 // level
 constexpr auto create_exist_check = true;
+/*
+ * Files up to this size keep their data in their metadentry if not set via
+ * --inline-data-size. Their reads and writes are served by the metadata daemon
+ * in one RPC. 0 disables inline data.
+ */
+constexpr auto inline_data_size = 0;
+// Number of locks serializing updates of inline data and file sizes
+constexpr auto inline_lock_stripes = 64;
+/*
+ * Number of stat results cached by a client if the attribute cache is enabled
+ * via LIBGKFS_ATTR_CACHE_TTL, and its number of independently locked shards
+ */
+constexpr auto attr_cache_size = 16384;
+constexpr auto attr_cache_shards = 16;
+/*
+ * Interval in ms after which a client sends the file size reached by its
+ * writes if sending it is deferred via LIBGKFS_LAZY_SIZE. 0 sends it only on
+ * close, fsync and stat.
+ */
+constexpr auto lazy_size_interval_ms = 1000;
 } // namespace metadata
 namespace data {
 // directory name below rootdir where chunks are placed
 constexpr auto chunk_dir = "chunks";
+/*
+ * Placement of chunks on the node-local file system if not set via
+ * --data-layout. "chunk" stores each chunk in its own file within a directory
+ * per file. "extent" stores all chunks of a file in one sparse file.
+ */
+constexpr auto default_layout = "chunk";
+/*
+ * Number of open chunk file descriptors kept by the data backend to avoid an
+ * open()/close() per chunk operation. 0 disables the cache. Note, that the
+ * daemon's open file limit (ulimit -n) must be large enough.
+ */
+constexpr auto fd_cache_size = 256;
+// Number of independently locked shards of the chunk file descriptor cache
+constexpr auto fd_cache_shards = 16;
+// Max number of chunk directories remembered to skip mkdir() on writes
+constexpr auto known_dirs_max = 65536;
+/*
+ * Max number of files for which the locally stored chunk ids are indexed. The
+ * index answers reads of sparse chunks and truncates without listing or
+ * opening chunk files.
+ */
+constexpr auto presence_files_max = 65536;
+/*
+ * Alignment of offsets, sizes, and buffers for chunk I/O with --direct-io.
+ * Must be a power of 2 and a multiple of the node-local file system's logical
+ * block size. Unaligned requests are staged in aligned buffers.
+ */
+constexpr auto direct_io_alignment = 4096;
+// Number of locks serializing read-modify-write cycles of --direct-io writes
+constexpr auto direct_io_lock_stripes = 64;
+/*
+ * Memory in MiB for caching frequently read chunks in the daemon. 0 disables
+ * the cache. Chunks are admitted once they are read at least
+ * chunk_cache_admit_min times and more often than the chunk they replace.
+ */
+constexpr auto chunk_cache_size = 0;
+// Number of independently locked shards of the chunk data cache
+constexpr auto chunk_cache_shards = 16;
+// Minimum number of recent reads before a chunk is admitted to the cache
+constexpr auto chunk_cache_admit_min = 2;
+// directory name below rootdir where write log segments are placed
+constexpr auto log_dir = "log";
+/*
+ * Size of a write log segment. Segments are moved to the chunk files and
+ * removed by the compactor once they are full or at the latest after the next
+ * compaction interval.
+ */
+constexpr auto log_segment_size = 64 * 1024 * 1024;
+// Writes up to this size are appended to the write log, larger ones are not
+constexpr auto log_max_write_size = 64 * 1024;
+// Interval in which the write log compactor moves segments to chunks
+constexpr auto log_compact_interval_ms = 1000;
+/*
+ * Durability of chunk data if not set via --durability. "none" ignores client
+ * flushes, "flush" syncs a file's chunks on fsync(), and "write-through" also
+ * opens chunk files with O_DSYNC.
+ */
+constexpr auto default_durability = "flush";
+/*
+ * A flush of a file with more local chunk files than this syncs the whole
+ * node-local file system with a single syncfs() instead of one fdatasync() per
+ * chunk file.
+ */
+constexpr auto sync_syncfs_threshold = 64;
+// directory name below rootdir where chunk checksums are placed (--checksums)
+constexpr auto checksum_dir = "checksums";
+/*
+ * Bytes covered by one CRC32C checksum. Must divide the chunksize. Smaller
+ * blocks make partial writes and verified reads cheaper and cost 8 bytes of
+ * metadata per block.
+ */
+constexpr auto checksum_block_size = 4096;
+// Number of locks serializing data and checksum updates of chunks
+constexpr auto checksum_lock_stripes = 64;
+/*
+ * MiB per second the scrubber reads to verify checksums if not set via
+ * --scrub-rate. 0 disables the scrubber.
+ */
+constexpr auto scrub_rate = 0;
+// Pause in seconds between two passes of the scrubber over all chunks
+constexpr auto scrub_interval_s = 3600;
+// Chunk compression if not set via --compression: none or lz4
+constexpr auto default_compression = "none";
+/*
+ * Minimum percent of a chunk's size that LZ4 must save for the chunk to be
+ * stored compressed (--compression lz4). Other chunks are stored raw, which
+ * lets small writes update them in place.
+ */
+constexpr auto compression_min_savings = 10;
+// Number of locks serializing read-modify-write cycles of compressed chunks
+constexpr auto compression_lock_stripes = 64;
 } // namespace data
 
 namespace rpc {
-constexpr auto chunksize = 524288; // in bytes (e.g., 524288 == 512KB)
+// default chunksize in bytes (e.g., 524288 == 512KB), set with --chunksize
+constexpr auto chunksize = 524288;
+// smallest chunksize, keeps chunks aligned for direct I/O and checksum blocks
+constexpr auto min_chunksize = 4096;
 // size of preallocated buffer to hold directory entries in rpc call
 constexpr auto dirents_buff_size = (8 * 1024 * 1024); // 8 mega
 /*
@@ -102,8 +234,68 @@ constexpr auto dirents_buff_size = (8 * 1024 * 1024); // 8 mega
 constexpr auto daemon_io_xstreams = 8;
 // Number of threads used for RPC handlers at the daemon
 constexpr auto daemon_handler_xstreams = 4;
+/*
+ * Number of chunk PULL bulk transfers a write RPC handler keeps in flight. A
+ * chunk is written as soon as its own transfer has finished.
+ */
+constexpr auto daemon_pull_window = 8;
+/*
+ * Number of chunk PUSH bulk transfers a read RPC handler keeps in flight.
+ * Chunks are pushed back in the order their reads complete.
+ */
+constexpr auto daemon_push_window = 8;
+/*
+ * Interval in milliseconds at which a read RPC handler checks for finished
+ * chunk reads while PUSH transfers are in flight, sleeping in between.
+ */
+constexpr auto daemon_push_poll_interval_ms = 0.1;
+/*
+ * Tiers of pre-registered bulk buffers used by the daemon's data handlers in
+ * the form <chunks>:<count>,... Each tier has <count> buffers of <chunks> times
+ * the chunksize. "0" disables the pool.
+ */
+constexpr auto daemon_bulk_pool_tiers = "1:64,4:16";
+// Number of recent read RPC latencies of which the client hedges at a
+// percentile, and the number needed before it starts hedging
+constexpr auto read_latency_samples = 1024;
+constexpr auto read_latency_min_samples = 64;
+/*
+ * Retries of idempotent client RPCs (e.g., stat, read, directory listing)
+ * that failed or timed out, set with LIBGKFS_RPC_RETRIES. The backoff before a
+ * retry starts at rpc_retry_backoff_ms and doubles up to
+ * rpc_retry_backoff_max_ms.
+ */
+constexpr auto rpc_retries = 3;
+constexpr auto rpc_retry_backoff_ms = 10;
+constexpr auto rpc_retry_backoff_max_ms = 1000;
+/*
+ * Daemons failing this many client RPCs in a row are suspected for
+ * suspect_period_ms. Reads use other copies of the chunks of suspected daemons.
+ */
+constexpr auto suspect_failures = 3;
+constexpr auto suspect_period_ms = 10000;
+/*
+ * Number of client threads waiting for RPCs with a timeout and for hedged
+ * reads. RPCs beyond that are waited for once a thread becomes free.
+ */
+constexpr auto max_rpc_waiters = 32u;
+/*
+ * Number of additional client threads waiting for RPCs that timed out or are
+ * no longer needed by their read. These do not count towards max_rpc_waiters.
+ */
+constexpr auto max_abandoned_rpc_waiters = 256u;
 } // namespace rpc
 
+namespace ec {
+/*
+ * Parity chunks of a file are stored as the chunks of this prefix followed by
+ * the file's path. Normalized user paths never begin with "//".
+ */
+constexpr auto parity_prefix = "//parity";
+// Upper bound of data and parity chunks per stripe in GF(2^8)
+constexpr auto max_shards = 256;
+} // namespace ec
+
 namespace rocksdb {
 // Write-ahead logging of rocksdb
 constexpr auto use_write_ahead_log = false;
@@ -0,0 +1,190 @@
+/*
+  Copyright 2018-2024, Barcelona Supercomputing Center (BSC), Spain
+  Copyright 2015-2024, Johannes Gutenberg Universitaet Mainz, Germany
+
+  This software was partially supported by the
+  EC H2020 funded project NEXTGenIO (Project ID: 671951, www.nextgenio.eu).
+
+  This software was partially supported by the
+  ADA-FS project under the SPPEXA project funded by the DFG.
+
+  This file is part of GekkoFS.
+
+  GekkoFS is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  GekkoFS is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with GekkoFS.  If not, see <https://www.gnu.org/licenses/>.
+
+  SPDX-License-Identifier: GPL-3.0-or-later
+*/
+/**
+ * @brief Per-block checksums of the chunks stored on this daemon.
+ */
+
+#ifndef GEKKOFS_DAEMON_CHUNK_CHECKSUM_HPP
+#define GEKKOFS_DAEMON_CHUNK_CHECKSUM_HPP
+
+#include <daemon/backend/data/chunk_storage.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace gkfs::data {
+
+/**
+ * @brief Computes the CRC32C (Castagnoli) checksum of a buffer. Uses the SSE4.2
+ * or ARMv8 CRC instructions if the CPU supports them.
+ * @param crc Checksum of the preceding data, 0 for the first buffer
+ * @param buf Data
+ * @param size Size of the data
+ * @return Checksum of the preceding data and buf
+ */
+uint32_t
+crc32c(uint32_t crc, const char* buf, size_t size);
+
+struct ChecksumEntry {
+    uint32_t crc; //!< CRC32C of the first len bytes of the block
+    uint32_t len; //!< Checksummed bytes, 0 if the block has no checksum
+}; //!< Checksum of a block of a chunk
+
+/**
+ * @brief Stores a CRC32C checksum per block of every chunk in one sidecar file
+ * per GekkoFS file.
+ *
+ * This class is thread-safe for distinct blocks. Callers serialize updates and
+ * verification of the same chunk with mutex().
+ * @internal
+ * The sidecar of /foo/bar is <path>/foo:bar. It is an array of ChecksumEntry
+ * with chunksize / block_size entries per chunk, indexed by chunk id and
+ * block within the chunk, independent of the data layout. Holes
+ * in the sidecar read as entries without a checksum. The sidecar is kept
+ * outside the chunk directory so that its name cannot collide with GekkoFS
+ * files or chunk files.
+ * @endinternal
+ */
+class ChunkChecksums {
+private:
+    std::string path_;         //!< Directory of the sidecar files
+    size_t block_size_;        //!< Checksummed bytes per entry
+    size_t blocks_per_chunk_;  //!< Entries per chunk
+    bool write_through_;       //!< Sidecars are opened with O_DSYNC
+    std::unique_ptr<ChunkFdCache> fd_cache_; //!< Open sidecars or nullptr
+    std::vector<std::mutex> mutexes_;        //!< Striped chunk mutexes
+
+    std::string
+    sidecar_path(const std::string& file_path) const;
+
+    /**
+     * @brief Returns an open handle of a file's sidecar.
+     * @return Handle, or nullptr if create is not set and it does not exist
+     * @throws ChunkStorageException
+     */
+    std::shared_ptr<FileHandle>
+    open_sidecar(const std::string& file_path, bool create);
+
+public:
+    /**
+     * @brief Creates the sidecar directory if needed.
+     * @param path Directory of the sidecar files
+     * @param chunksize Used chunksize in this GekkoFS instance
+     * @param block_size Checksummed bytes per entry, must divide chunksize
+     * @param fd_cache_size Number of open sidecars to keep, 0 disables caching
+     * @param lock_stripes Number of chunk mutexes
+     * @param write_through Open sidecars with O_DSYNC, as the chunk files
+     * @throws ChunkStorageException
+     */
+    ChunkChecksums(const std::string& path, size_t chunksize,
+                   size_t block_size, size_t fd_cache_size,
+                   size_t lock_stripes, bool write_through);
+
+    ~ChunkChecksums();
+
+    [[nodiscard]] size_t
+    block_size() const;
+
+    [[nodiscard]] size_t
+    blocks_per_chunk() const;
+
+    /**
+     * @brief Returns the mutex serializing the data and checksum updates and
+     * verifications of a chunk.
+     */
+    std::mutex&
+    mutex(const std::string& file_path, gkfs::rpc::chnk_id_t chunk_id);
+
+    /**
+     * @brief Stores the checksums of consecutive blocks of a chunk.
+     * @param file_path GekkoFS file path, e.g., /foo/bar
+     * @param chunk_id Number of chunk id
+     * @param first_block First block within the chunk
+     * @param entries Checksums starting with first_block
+     * @throws ChunkStorageException
+     */
+    void
+    put(const std::string& file_path, gkfs::rpc::chnk_id_t chunk_id,
+        uint64_t first_block, const std::vector<ChecksumEntry>& entries);
+
+    /**
+     * @brief Loads the checksums of consecutive blocks of a chunk.
+     * @param file_path GekkoFS file path, e.g., /foo/bar
+     * @param chunk_id Number of chunk id
+     * @param first_block First block within the chunk
+     * @param count Number of blocks
+     * @return count entries, without checksum for unknown blocks
+     * @throws ChunkStorageException
+     */
+    std::vector<ChecksumEntry>
+    get(const std::string& file_path, gkfs::rpc::chnk_id_t chunk_id,
+        uint64_t first_block, size_t count);
+
+    /**
+     * @brief Removes the checksums of all chunks starting with chunk_start.
+     * @throws ChunkStorageException
+     */
+    void
+    trim(const std::string& file_path, gkfs::rpc::chnk_id_t chunk_start);
+
+    /**
+     * @brief Removes the sidecar of a file.
+     * @throws ChunkStorageException
+     */
+    void
+    destroy(const std::string& file_path);
+
+    /**
+     * @brief Flushes the sidecar of a file and the sidecar directory to the
+     * storage device, so that the checksums of synced chunks survive a crash.
+     * @throws ChunkStorageException
+     */
+    void
+    sync(const std::string& file_path);
+
+    /**
+     * @brief Lists all files that have checksums, e.g., for scrubbing.
+     * @return GekkoFS file paths
+     */
+    std::vector<std::string>
+    files() const;
+
+    /**
+     * @brief Returns the number of chunks covered by a file's sidecar.
+     * @return Highest chunk id with checksums + 1, or 0
+     */
+    gkfs::rpc::chnk_id_t
+    chunk_count(const std::string& file_path) const;
+};
+
+} // namespace gkfs::data
+
+#endif // GEKKOFS_DAEMON_CHUNK_CHECKSUM_HPP
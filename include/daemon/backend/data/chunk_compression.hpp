@@ -0,0 +1,95 @@
+/*
+  Copyright 2018-2024, Barcelona Supercomputing Center (BSC), Spain
+  Copyright 2015-2024, Johannes Gutenberg Universitaet Mainz, Germany
+
+  This software was partially supported by the
+  EC H2020 funded project NEXTGenIO (Project ID: 671951, www.nextgenio.eu).
+
+  This software was partially supported by the
+  ADA-FS project under the SPPEXA project funded by the DFG.
+
+  This file is part of GekkoFS.
+
+  GekkoFS is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  GekkoFS is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with GekkoFS.  If not, see <https://www.gnu.org/licenses/>.
+
+  SPDX-License-Identifier: GPL-3.0-or-later
+*/
+/**
+ * @brief Encoding of compressed chunk files.
+ */
+
+#ifndef GEKKOFS_DAEMON_CHUNK_COMPRESSION_HPP
+#define GEKKOFS_DAEMON_CHUNK_COMPRESSION_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace gkfs::data {
+
+/**
+ * @brief Encoding of the payload of a compressed chunk file.
+ */
+enum class ChunkCodec : uint32_t {
+    raw = 0, //!< Payload is the chunk data, written in place
+    lz4 = 1, //!< Payload is an LZ4 block of the chunk data
+};
+
+/**
+ * @brief Header at the beginning of every chunk file if chunks are stored
+ * compressed.
+ */
+struct CompressedChunkHeader {
+    uint32_t magic;       //!< compressed_chunk_magic
+    ChunkCodec codec;     //!< Encoding of the payload
+    uint32_t raw_size;    //!< Chunk size after decoding
+    uint32_t stored_size; //!< Payload bytes following the header
+};
+
+constexpr uint32_t compressed_chunk_magic = 0x315a4b47; // "GKZ1"
+
+/**
+ * @brief Returns whether LZ4 compression was compiled in, i.e., GekkoFS was
+ * built with GKFS_ENABLE_LZ4.
+ */
+bool
+compression_available();
+
+/**
+ * @brief Encodes chunk data as header and payload. The data is compressed if
+ * this saves at least gkfs::config::data::compression_min_savings percent of
+ * its size, otherwise it is stored raw.
+ * @param data Chunk data
+ * @param size Size of the chunk data
+ * @param out Receives header and payload
+ * @return Codec of the payload
+ */
+ChunkCodec
+encode_chunk(const char* data, size_t size, std::vector<char>& out);
+
+/**
+ * @brief Decodes the beginning of an LZ4 payload.
+ * @param payload Payload following the header
+ * @param header Header of the chunk file
+ * @param buf Buffer to decode to
+ * @param size Number of bytes to decode, at most header.raw_size
+ * @return false if the payload is corrupted
+ */
+bool
+decode_chunk(const char* payload, const CompressedChunkHeader& header,
+             char* buf, size_t size);
+
+} // namespace gkfs::data
+
+#endif // GEKKOFS_DAEMON_CHUNK_COMPRESSION_HPP
@@ -0,0 +1,221 @@
+/*
+  Copyright 2018-2024, Barcelona Supercomputing Center (BSC), Spain
+  Copyright 2015-2024, Johannes Gutenberg Universitaet Mainz, Germany
+
+  This software was partially supported by the
+  EC H2020 funded project NEXTGenIO (Project ID: 671951, www.nextgenio.eu).
+
+  This software was partially supported by the
+  ADA-FS project under the SPPEXA project funded by the DFG.
+
+  This file is part of GekkoFS.
+
+  GekkoFS is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  GekkoFS is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with GekkoFS.  If not, see <https://www.gnu.org/licenses/>.
+
+  SPDX-License-Identifier: GPL-3.0-or-later
+*/
+/**
+ * @brief Cache of hot chunk data used by the chunk storage backend.
+ */
+
+#ifndef GEKKOFS_DAEMON_CHUNK_DATA_CACHE_HPP
+#define GEKKOFS_DAEMON_CHUNK_DATA_CACHE_HPP
+
+#include <daemon/backend/data/chunk_storage.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace gkfs::data {
+
+/**
+ * @brief Byte-bounded LRU cache of chunk contents keyed by (file path, chunk
+ * id) with a frequency-based admission policy.
+ * @internal
+ * Admission follows TinyLFU: each shard counts chunk reads in a count-min
+ * sketch of 4-bit counters that are halved periodically, so that the counts
+ * approximate the recent access frequency of each chunk. A chunk is only
+ * admitted once it was read at least gkfs::config::data::chunk_cache_admit_min
+ * times and, if the shard is full, if it is read more often than the least
+ * recently used entry it would replace. Chunks that are read once, e.g., by a
+ * streaming reader, never displace hot chunks.
+ *
+ * Each shard has a version that is increased on every invalidation. A chunk
+ * read on a miss is only inserted if no invalidation happened in its shard
+ * since the miss, so that a concurrent write can never leave stale data in the
+ * cache.
+ *
+ * Every entry holds a buffer of chunksize bytes, which is also what it is
+ * accounted with. Buffers of evicted and invalidated entries are kept in a
+ * small free list and handed out again by acquire(), so that a miss neither
+ * allocates nor zero-fills a new chunk buffer.
+ * @endinternal
+ */
+class ChunkDataCache {
+private:
+    using key_type = std::pair<std::string, gkfs::rpc::chnk_id_t>;
+
+    struct key_hash {
+        size_t
+        operator()(const key_type& key) const noexcept;
+    };
+
+    struct entry {
+        key_type key;
+        std::unique_ptr<char[]> data; //!< buffer of chunksize bytes
+        size_t size;                  //!< chunk content up to its end
+    };
+
+    struct shard {
+        std::mutex mtx;
+        std::list<entry> lru; //!< most recently used entry first
+        std::unordered_map<key_type, std::list<entry>::iterator, key_hash>
+                map;
+        size_t bytes{0};               //!< cached chunk bytes
+        uint64_t version{0};           //!< increased on invalidation
+        std::vector<uint8_t> sketch;   //!< count-min sketch, depth rows
+        size_t sketch_additions{0};    //!< additions since last aging
+    };
+
+    std::vector<std::unique_ptr<shard>> shards_;
+    size_t shard_capacity_;  //!< maximum number of cached bytes per shard
+    size_t max_entry_size_;  //!< chunksize, the largest possible entry
+    size_t sketch_width_;    //!< counters per sketch row, power of 2
+    size_t sketch_window_;   //!< additions after which counters are halved
+
+    std::mutex free_mtx_;
+    std::vector<std::unique_ptr<char[]>> free_; //!< unused chunk buffers
+    std::atomic<uint64_t> hits_{0};
+    std::atomic<uint64_t> misses_{0};
+    std::atomic<uint64_t> admissions_{0};
+    std::atomic<uint64_t> rejections_{0};
+    std::atomic<uint64_t> evictions_{0};
+
+    shard&
+    get_shard(size_t hash);
+
+    /**
+     * @brief Counts an access to a key in the shard's sketch. Shard mutex
+     * must be held.
+     */
+    void
+    record(shard& s, size_t hash);
+
+    /**
+     * @brief Estimates the recent access frequency of a key. Shard mutex must
+     * be held.
+     */
+    uint8_t
+    frequency(const shard& s, size_t hash) const;
+
+    /**
+     * @brief Returns the buffers of removed entries to the free list. Shard
+     * mutex must not be held.
+     */
+    void
+    release(std::list<entry>& entries);
+
+public:
+    /**
+     * @brief Creates the cache.
+     * @param capacity Maximum number of cached bytes in total
+     * @param shard_count Number of independently locked shards
+     * @param chunksize Size of a chunk, i.e., of the largest entry
+     */
+    ChunkDataCache(size_t capacity, size_t shard_count, size_t chunksize);
+
+    /**
+     * @brief Reads from a cached chunk and counts the access. Same semantics
+     * as ChunkStorage::read_chunk().
+     * @param file_path GekkoFS file path, e.g., /foo/bar
+     * @param chunk_id Number of chunk id
+     * @param buf Buffer to read to
+     * @param size Amount of bytes to read
+     * @param offset Offset within the chunk
+     * @param read Set to the amount of bytes read on a hit
+     * @param version Set to the shard version on a miss, to be passed to put()
+     * @return true on a hit
+     */
+    bool
+    get(const std::string& file_path, gkfs::rpc::chnk_id_t chunk_id, char* buf,
+        size_t size, off64_t offset, ssize_t& read, uint64_t& version);
+
+    /**
+     * @brief Decides whether a chunk that missed should be read completely and
+     * inserted into the cache.
+     * @param file_path GekkoFS file path, e.g., /foo/bar
+     * @param chunk_id Number of chunk id
+     * @return true if the chunk is admitted
+     */
+    bool
+    admit(const std::string& file_path, gkfs::rpc::chnk_id_t chunk_id);
+
+    /**
+     * @brief Returns an uninitialized buffer of chunksize bytes to read an
+     * admitted chunk into, reusing a buffer of a removed entry if available.
+     * @return chunk buffer to be passed to put()
+     */
+    std::unique_ptr<char[]>
+    acquire();
+
+    /**
+     * @brief Inserts a chunk, evicting least recently used entries of the
+     * shard if needed. The chunk is dropped and its buffer kept for reuse if
+     * the shard was invalidated since the miss that returned version.
+     * @param file_path GekkoFS file path, e.g., /foo/bar
+     * @param chunk_id Number of chunk id
+     * @param version Shard version returned by get()
+     * @param data Buffer returned by acquire() holding the chunk content
+     * @param size Size of the chunk content
+     */
+    void
+    put(const std::string& file_path, gkfs::rpc::chnk_id_t chunk_id,
+        uint64_t version, std::unique_ptr<char[]>&& data, size_t size);
+
+    /**
+     * @brief Removes a single chunk from the cache.
+     * @param file_path GekkoFS file path, e.g., /foo/bar
+     * @param chunk_id Number of chunk id
+     */
+    void
+    invalidate(const std::string& file_path, gkfs::rpc::chnk_id_t chunk_id);
+
+    /**
+     * @brief Removes all chunks of a file starting with a given chunk id.
+     * @param file_path GekkoFS file path, e.g., /foo/bar
+     * @param chunk_start First chunk id to remove
+     */
+    void
+    invalidate_file(const std::string& file_path,
+                    gkfs::rpc::chnk_id_t chunk_start = 0);
+
+    /**
+     * @brief Returns the cache counters and the current number of cached
+     * bytes.
+     * @return ChunkDataCacheStats struct
+     */
+    [[nodiscard]] ChunkDataCacheStats
+    stats() const;
+};
+
+} // namespace gkfs::data
+
+#endif // GEKKOFS_DAEMON_CHUNK_DATA_CACHE_HPP
@@ -0,0 +1,160 @@
+/*
+  Copyright 2018-2024, Barcelona Supercomputing Center (BSC), Spain
+  Copyright 2015-2024, Johannes Gutenberg Universitaet Mainz, Germany
+
+  This software was partially supported by the
+  EC H2020 funded project NEXTGenIO (Project ID: 671951, www.nextgenio.eu).
+
+  This software was partially supported by the
+  ADA-FS project under the SPPEXA project funded by the DFG.
+
+  This file is part of GekkoFS.
+
+  GekkoFS is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  GekkoFS is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with GekkoFS.  If not, see <https://www.gnu.org/licenses/>.
+
+  SPDX-License-Identifier: GPL-3.0-or-later
+*/
+/**
+ * @brief Cache of open chunk file handles used by the chunk storage backend.
+ */
+
+#ifndef GEKKOFS_DAEMON_CHUNK_FD_CACHE_HPP
+#define GEKKOFS_DAEMON_CHUNK_FD_CACHE_HPP
+
+#include <daemon/backend/data/chunk_storage.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace gkfs::data {
+
+/**
+ * @brief Bounded LRU cache of open chunk file handles keyed by (file path,
+ * chunk id).
+ * @internal
+ * The cache is split into shards, each with its own mutex and LRU list, to
+ * keep lock contention between I/O xstreams low. Handles are shared pointers,
+ * so evicting or invalidating an entry never closes a file descriptor that is
+ * still used by an in-flight tasklet. The descriptor is closed when the last
+ * user drops its reference.
+ *
+ * Each shard has a version that is increased on every invalidation. A handle
+ * opened after a miss is only inserted if no invalidation happened in its
+ * shard since the miss, so that a handle of a removed or trimmed chunk file
+ * never outlives the invalidation in the cache.
+ * @endinternal
+ */
+class ChunkFdCache {
+private:
+    using key_type = std::pair<std::string, gkfs::rpc::chnk_id_t>;
+
+    struct key_hash {
+        size_t
+        operator()(const key_type& key) const noexcept;
+    };
+
+    struct entry {
+        key_type key;
+        std::shared_ptr<FileHandle> fh;
+    };
+
+    struct shard {
+        std::mutex mtx;
+        std::list<entry> lru; //!< most recently used entry first
+        std::unordered_map<key_type, std::list<entry>::iterator, key_hash>
+                map;
+        uint64_t version{0}; //!< increased on invalidation
+    };
+
+    std::vector<std::unique_ptr<shard>> shards_;
+    size_t shard_capacity_; //!< maximum number of entries per shard
+
+    std::atomic<uint64_t> hits_{0};
+    std::atomic<uint64_t> misses_{0};
+    std::atomic<uint64_t> evictions_{0};
+
+    shard&
+    get_shard(const key_type& key);
+
+public:
+    /**
+     * @brief Creates the cache.
+     * @param capacity Maximum number of open handles in total
+     * @param shard_count Number of independently locked shards
+     */
+    ChunkFdCache(size_t capacity, size_t shard_count);
+
+    /**
+     * @brief Looks up an open handle and marks it as recently used.
+     * @param file_path GekkoFS file path, e.g., /foo/bar
+     * @param chunk_id Number of chunk id
+     * @param version Set to the shard version on a miss, to be passed to put()
+     * @return Handle or nullptr on a miss
+     */
+    std::shared_ptr<FileHandle>
+    get(const std::string& file_path, gkfs::rpc::chnk_id_t chunk_id,
+        uint64_t& version);
+
+    /**
+     * @brief Inserts an open handle, evicting the least recently used entry
+     * of the shard if it is full. If another handle for the same key was
+     * inserted concurrently, the existing handle is kept and returned. The
+     * handle is not cached if the shard was invalidated since the miss that
+     * returned version.
+     * @param file_path GekkoFS file path, e.g., /foo/bar
+     * @param chunk_id Number of chunk id
+     * @param version Shard version returned by get()
+     * @param fh Open file handle
+     * @return The handle that is cached for the key
+     */
+    std::shared_ptr<FileHandle>
+    put(const std::string& file_path, gkfs::rpc::chnk_id_t chunk_id,
+        uint64_t version, std::shared_ptr<FileHandle> fh);
+
+    /**
+     * @brief Removes a single chunk handle from the cache.
+     * @param file_path GekkoFS file path, e.g., /foo/bar
+     * @param chunk_id Number of chunk id
+     */
+    void
+    invalidate(const std::string& file_path, gkfs::rpc::chnk_id_t chunk_id);
+
+    /**
+     * @brief Removes all handles of a file starting with a given chunk id.
+     * @param file_path GekkoFS file path, e.g., /foo/bar
+     * @param chunk_start First chunk id to remove
+     */
+    void
+    invalidate_file(const std::string& file_path,
+                    gkfs::rpc::chnk_id_t chunk_start = 0);
+
+    /**
+     * @brief Returns hit, miss, and eviction counters and the current number
+     * of cached handles.
+     * @return ChunkFdCacheStats struct
+     */
+    [[nodiscard]] ChunkFdCacheStats
+    stats() const;
+};
+
+} // namespace gkfs::data
+
+#endif // GEKKOFS_DAEMON_CHUNK_FD_CACHE_HPP
@@ -0,0 +1,203 @@
+/*
+  Copyright 2018-2024, Barcelona Supercomputing Center (BSC), Spain
+  Copyright 2015-2024, Johannes Gutenberg Universitaet Mainz, Germany
+
+  This software was partially supported by the
+  EC H2020 funded project NEXTGenIO (Project ID: 671951, www.nextgenio.eu).
+
+  This software was partially supported by the
+  ADA-FS project under the SPPEXA project funded by the DFG.
+
+  This file is part of GekkoFS.
+
+  GekkoFS is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  GekkoFS is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with GekkoFS.  If not, see <https://www.gnu.org/licenses/>.
+
+  SPDX-License-Identifier: GPL-3.0-or-later
+*/
+/**
+ * @brief Index of the chunks of each file that are stored on this daemon.
+ */
+
+#ifndef GEKKOFS_DAEMON_CHUNK_PRESENCE_HPP
+#define GEKKOFS_DAEMON_CHUNK_PRESENCE_HPP
+
+#include <daemon/backend/data/chunk_storage.hpp>
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace gkfs::data {
+
+/**
+ * @brief Compressed bitmap of chunk ids.
+ * @internal
+ * The bitmap follows the layout of roaring bitmaps: chunk ids are grouped by
+ * their upper bits into containers of 2^16 ids. A container holds a sorted
+ * array of the lower 16 bits while it has at most 4096 entries and a plain
+ * bitmap of 8 KiB otherwise. A sparse file thus needs 2 bytes per chunk and a
+ * dense file at most 1 bit per chunk.
+ * @endinternal
+ */
+class ChunkBitmap {
+private:
+    struct container {
+        std::vector<uint16_t> array; //!< sorted, used if bits is empty
+        std::vector<uint64_t> bits;  //!< 2^16 bits or empty
+        uint32_t cardinality{0};
+    };
+
+    std::map<uint64_t, container> containers_; //!< upper bits -> container
+
+public:
+    /**
+     * @brief Checks whether a chunk id is set.
+     */
+    [[nodiscard]] bool
+    contains(gkfs::rpc::chnk_id_t chunk_id) const;
+
+    /**
+     * @brief Sets a chunk id.
+     */
+    void
+    add(gkfs::rpc::chnk_id_t chunk_id);
+
+    /**
+     * @brief Removes a chunk id if it is set.
+     */
+    void
+    remove(gkfs::rpc::chnk_id_t chunk_id);
+
+    /**
+     * @brief Removes all chunk ids starting with chunk_start.
+     * @param chunk_start First chunk id to remove
+     * @return Removed chunk ids in ascending order
+     */
+    std::vector<gkfs::rpc::chnk_id_t>
+    remove_from(gkfs::rpc::chnk_id_t chunk_start);
+
+    /**
+     * @brief Returns the number of set chunk ids.
+     */
+    [[nodiscard]] size_t
+    size() const;
+};
+
+/**
+ * @brief Keeps a ChunkBitmap of the locally stored chunks for recently used
+ * files so that chunks can be located without accessing the file system.
+ *
+ * This class is thread-safe.
+ * @internal
+ * A file's bitmap is known either because its chunk directory was created by
+ * this daemon or because the directory was scanned once. Until then, no
+ * statement about the file's chunks is made. Bitmaps are built and installed
+ * under the shard's mutex, and chunks are added under the same mutex after
+ * their chunk file was created. Hence, a chunk created concurrently to a scan
+ * is either found by the scan or added after the bitmap was installed.
+ *
+ * The index only reflects the file system, which remains authoritative. It is
+ * therefore kept in memory and rebuilt lazily after a restart. If a shard
+ * exceeds its share of gkfs::config::data::presence_files_max files, the
+ * shard is cleared, similar to the known chunk directories.
+ * @endinternal
+ */
+class ChunkPresenceIndex {
+private:
+    struct shard {
+        std::mutex mtx;
+        std::unordered_map<std::string, ChunkBitmap> files;
+    };
+
+    std::vector<std::unique_ptr<shard>> shards_;
+    size_t shard_files_max_;
+
+    shard&
+    get_shard(const std::string& file_path);
+
+    ChunkBitmap&
+    install(shard& s, const std::string& file_path);
+
+public:
+    /**
+     * @brief Creates the index.
+     * @param files_max Maximum number of files for which bitmaps are kept
+     * @param shard_count Number of independently locked shards
+     */
+    ChunkPresenceIndex(size_t files_max, size_t shard_count);
+
+    /**
+     * @brief Checks whether a chunk is known to not exist locally.
+     * @param file_path GekkoFS file path, e.g., /foo/bar
+     * @param chunk_id Number of chunk id
+     * @return true if the file's bitmap is known and the chunk is not set
+     */
+    bool
+    absent(const std::string& file_path, gkfs::rpc::chnk_id_t chunk_id);
+
+    /**
+     * @brief Records a created chunk if the file's bitmap is known.
+     * @param file_path GekkoFS file path, e.g., /foo/bar
+     * @param chunk_id Number of chunk id
+     */
+    void
+    add(const std::string& file_path, gkfs::rpc::chnk_id_t chunk_id);
+
+    /**
+     * @brief Runs create, which creates a file's chunk space, and starts an
+     * empty bitmap for the file if create returns true, i.e., if the chunk
+     * space did not exist before.
+     * @param file_path GekkoFS file path, e.g., /foo/bar
+     * @param create Function creating the chunk space. May throw
+     */
+    void
+    init(const std::string& file_path, const std::function<bool()>& create);
+
+    /**
+     * @brief Builds a file's bitmap with scan if it is not known yet.
+     * @param file_path GekkoFS file path, e.g., /foo/bar
+     * @param scan Function adding all local chunks of the file. May throw
+     */
+    void
+    load(const std::string& file_path,
+         const std::function<void(ChunkBitmap&)>& scan);
+
+    /**
+     * @brief Removes all chunks of a file starting with chunk_start. The
+     * bitmap is built with scan first if it is not known yet.
+     * @param file_path GekkoFS file path, e.g., /foo/bar
+     * @param chunk_start First chunk id to remove
+     * @param scan Function adding all local chunks of the file. May throw
+     * @return Removed chunk ids that must be deleted by the caller
+     */
+    std::vector<gkfs::rpc::chnk_id_t>
+    trim(const std::string& file_path, gkfs::rpc::chnk_id_t chunk_start,
+         const std::function<void(ChunkBitmap&)>& scan);
+
+    /**
+     * @brief Forgets a file's bitmap, e.g., when the file is removed.
+     * @param file_path GekkoFS file path, e.g., /foo/bar
+     */
+    void
+    erase(const std::string& file_path);
+};
+
+} // namespace gkfs::data
+
+#endif // GEKKOFS_DAEMON_CHUNK_PRESENCE_HPP
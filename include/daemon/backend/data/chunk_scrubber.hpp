@@ -0,0 +1,112 @@
+/*
+  Copyright 2018-2024, Barcelona Supercomputing Center (BSC), Spain
+  Copyright 2015-2024, Johannes Gutenberg Universitaet Mainz, Germany
+
+  This software was partially supported by the
+  EC H2020 funded project NEXTGenIO (Project ID: 671951, www.nextgenio.eu).
+
+  This software was partially supported by the
+  ADA-FS project under the SPPEXA project funded by the DFG.
+
+  This file is part of GekkoFS.
+
+  GekkoFS is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  GekkoFS is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with GekkoFS.  If not, see <https://www.gnu.org/licenses/>.
+
+  SPDX-License-Identifier: GPL-3.0-or-later
+*/
+/**
+ * @brief Background verification of the chunk checksums.
+ */
+
+#ifndef GEKKOFS_DAEMON_CHUNK_SCRUBBER_HPP
+#define GEKKOFS_DAEMON_CHUNK_SCRUBBER_HPP
+
+#include <daemon/backend/data/chunk_storage.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace gkfs::data {
+
+struct ChunkScrubberStats {
+    uint64_t passes; //!< Completed passes over all chunks
+    uint64_t bytes;  //!< Bytes read and verified
+}; //!< Struct for counters of the scrubber
+
+/**
+ * @brief Periodically reads all chunks that have checksums and verifies them,
+ * so that corrupted data is detected before it is read. Mismatches are
+ * counted by the ChunkStorage.
+ * @internal
+ * The scrubber runs in its own thread. Within a pass, it sleeps whenever it
+ * is ahead of the configured rate, so that it competes with client I/O for at
+ * most that bandwidth. Chunks are verified one at a time under their checksum
+ * mutex.
+ * @endinternal
+ */
+class ChunkScrubber {
+private:
+    std::shared_ptr<ChunkStorage> storage_;
+    uint64_t rate_;           //!< Bytes per second
+    unsigned int interval_s_; //!< Pause between passes
+    std::atomic<uint64_t> passes_{0};
+    std::atomic<uint64_t> bytes_{0};
+
+    std::thread scrubber_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool running_{true};
+
+    /**
+     * @brief Sleeps until a point in time or until the scrubber is stopped.
+     * @return false if the scrubber was stopped
+     */
+    bool
+    wait_until(std::chrono::steady_clock::time_point time);
+
+    void
+    scrub_loop();
+
+public:
+    /**
+     * @brief Starts the scrubber.
+     * @param storage ChunkStorage with checksums enabled
+     * @param rate Bytes per second to read, must be larger than 0
+     * @param interval_s Pause in seconds between two passes
+     */
+    ChunkScrubber(std::shared_ptr<ChunkStorage> storage, uint64_t rate,
+                  unsigned int interval_s);
+
+    /**
+     * @brief Stops the scrubber, interrupting a running pass.
+     */
+    ~ChunkScrubber();
+
+    ChunkScrubber(const ChunkScrubber&) = delete;
+
+    ChunkScrubber&
+    operator=(const ChunkScrubber&) = delete;
+
+    [[nodiscard]] ChunkScrubberStats
+    stats() const;
+};
+
+} // namespace gkfs::data
+
+#endif // GEKKOFS_DAEMON_CHUNK_SCRUBBER_HPP
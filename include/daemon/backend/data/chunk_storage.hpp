@@ -35,10 +35,16 @@
 
 #include <common/common_defs.hpp>
 
+#include <atomic>
+#include <cstdint>
 #include <limits>
 #include <string>
 #include <memory>
+#include <mutex>
 #include <system_error>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 /* Forward declarations */
 namespace spdlog {
@@ -47,12 +53,70 @@ class logger;
 
 namespace gkfs::data {
 
+class FileHandle;
+class ChunkFdCache;
+class ChunkDataCache;
+class ChunkPresenceIndex;
+class ChunkBitmap;
+class ChunkChecksums;
+struct CompressedChunkHeader;
+
+constexpr auto layout_chunk = "chunk";
+constexpr auto layout_extent = "extent";
+
+constexpr auto durability_none = "none";
+constexpr auto durability_flush = "flush";
+constexpr auto durability_write_through = "write-through";
+
+constexpr auto compression_none = "none";
+constexpr auto compression_lz4 = "lz4";
+
+/**
+ * @brief Placement of a file's chunks on the node-local file system.
+ */
+enum class ChunkLayout {
+    chunk,  //!< One file per chunk in a directory per GekkoFS file
+    extent, //!< One sparse file per GekkoFS file, chunk at chunk_id * chunksize
+};
+
 struct ChunkStat {
     unsigned long chunk_size;
     unsigned long chunk_total;
     unsigned long chunk_free;
 }; //!< Struct for attaining current usage of storage backend
 
+struct ChunkFdCacheStats {
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t evictions;
+    size_t size;
+}; //!< Struct for counters of the chunk file handle cache
+
+struct ChunkDataCacheStats {
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t admissions;
+    uint64_t rejections;
+    uint64_t evictions;
+    size_t bytes;
+}; //!< Struct for counters of the chunk data cache
+
+struct ChunkSyncStats {
+    uint64_t requests; //!< Calls to sync_chunk_space()
+    uint64_t syncs;    //!< Syncs issued to the local file system
+}; //!< Struct for counters of the group commit of file syncs
+
+struct ChunkChecksumStats {
+    uint64_t verified_blocks; //!< Blocks whose checksum was verified
+    uint64_t mismatches;      //!< Blocks whose checksum did not match
+}; //!< Struct for counters of chunk checksum verification
+
+struct ChunkCompressionStats {
+    uint64_t raw_bytes;    //!< Chunk bytes written to compressed chunk files
+    uint64_t stored_bytes; //!< Bytes written to the local file system for them
+    uint64_t skipped;      //!< Chunks stored raw as compression did not pay off
+}; //!< Struct for counters of compressed chunk storage
+
 /**
  * @brief Generic exception for ChunkStorage
  */
@@ -72,6 +136,39 @@ private:
 
     std::string root_path_; //!< Path to GekkoFS root directory
     size_t chunksize_; //!< File system chunksize. TODO Why does that exist?
+    ChunkLayout layout_; //!< Placement of chunks on the local file system
+    std::unique_ptr<ChunkFdCache> fd_cache_; //!< Open chunk handles or nullptr
+    std::unique_ptr<ChunkDataCache> data_cache_; //!< Hot chunks or nullptr
+    std::unique_ptr<ChunkPresenceIndex>
+            presence_; //!< Locally stored chunks, chunk layout only
+    bool direct_io_; //!< Chunk files are opened with O_DIRECT
+    mutable std::vector<std::mutex>
+            direct_io_mutexes_; //!< Serialize O_DIRECT writes, truncates
+    bool write_through_; //!< Chunk files are opened with O_DSYNC
+    std::unique_ptr<ChunkChecksums> checksums_; //!< Block checksums or nullptr
+    bool verify_reads_; //!< Reads are verified against the checksums
+    mutable std::atomic<uint64_t> verified_blocks_{0};
+    mutable std::atomic<uint64_t> checksum_mismatches_{0};
+    bool compression_; //!< Chunk files are stored with CompressedChunkHeader
+    mutable std::vector<std::mutex>
+            compression_mutexes_; //!< Serialize compressed chunk updates
+    mutable std::atomic<uint64_t> compression_raw_bytes_{0};
+    mutable std::atomic<uint64_t> compression_stored_bytes_{0};
+    mutable std::atomic<uint64_t> compression_skipped_{0};
+    mutable std::mutex known_dirs_mutex_;
+    mutable std::unordered_set<std::string>
+            known_dirs_; //!< Chunk directories known to exist
+
+    struct sync_group {
+        std::mutex mutex;                  //!< Held while a sync runs
+        std::atomic<uint64_t> requested{0}; //!< Last requested sync
+        std::atomic<uint64_t> completed{0}; //!< Last request covered by a sync
+    }; //!< Group commit state of a file
+    mutable std::mutex sync_groups_mutex_;
+    mutable std::unordered_map<std::string, std::shared_ptr<sync_group>>
+            sync_groups_;
+    mutable std::atomic<uint64_t> sync_requests_{0};
+    mutable std::atomic<uint64_t> sync_ops_{0};
 
     /**
      * @brief Converts an internal gkfs path under the root dir to the absolute
@@ -101,6 +198,16 @@ private:
     static inline std::string
     get_chunk_path(const std::string& file_path, gkfs::rpc::chnk_id_t chunk_id);
 
+    /**
+     * @brief Adds the chunk ids of all chunk files in a file's chunk
+     * directory to a bitmap. Used with the chunk layout only.
+     * @param file_path Chunk file path, e.g., /foo/bar
+     * @param bitmap Bitmap to add to
+     * @throws ChunkStorageException if the directory cannot be read
+     */
+    void
+    scan_chunk_space(const std::string& file_path, ChunkBitmap& bitmap) const;
+
     /**
      * @brief Initializes the chunk space for a GekkoFS file, creating its
      * directory on the local file system.
@@ -109,14 +216,246 @@ private:
     void
     init_chunk_space(const std::string& file_path) const;
 
+    /**
+     * @brief Reads a single chunk file bypassing the chunk data cache.
+     * Parameters and semantics are the same as for read_chunk().
+     */
+    ssize_t
+    read_chunk_file(const std::string& file_path, gkfs::rpc::chnk_id_t chunk_id,
+                    char* buf, size_t size, off64_t offset) const;
+
+    /**
+     * @brief Truncates a single chunk file bypassing the chunk data cache.
+     * Parameters and semantics are the same as for truncate_chunk_file().
+     */
+    void
+    truncate_chunk_data(const std::string& file_path,
+                        gkfs::rpc::chnk_id_t chunk_id, off_t length);
+
+    /**
+     * @brief Returns the mutex serializing O_DIRECT writes and truncations of
+     * a chunk. With the extent layout, all chunks of a file share one mutex.
+     * @param file_path Chunk file path, e.g., /foo/bar
+     * @param chunk_id Number of chunk id
+     * @return Mutex of the chunk
+     */
+    std::mutex&
+    direct_io_mutex(const std::string& file_path,
+                    gkfs::rpc::chnk_id_t chunk_id) const;
+
+    /**
+     * @brief Writes to a chunk file opened with O_DIRECT. Unaligned writes are
+     * staged in an aligned buffer with read-modify-write of the first and last
+     * block.
+     * @param fd File descriptor of the chunk file
+     * @param buf Buffer to write to chunk
+     * @param size Amount of bytes to write
+     * @param offset Offset within the file descriptor's file
+     * @return 0 on success or errno
+     */
+    int
+    write_direct(int fd, const char* buf, size_t size, off64_t offset) const;
+
+    /**
+     * @brief Reads from a chunk file opened with O_DIRECT. Unaligned reads are
+     * staged in an aligned buffer.
+     * @param fd File descriptor of the chunk file
+     * @param buf Buffer to read to
+     * @param size Amount of bytes to read
+     * @param offset Offset within the file descriptor's file
+     * @return The amount of bytes read or -errno
+     */
+    ssize_t
+    read_direct(int fd, char* buf, size_t size, off64_t offset) const;
+
+    /**
+     * @brief Reads from a chunk file descriptor until size bytes are read or
+     * end-of-file is reached.
+     * @param fd File descriptor of the chunk file
+     * @param buf Buffer to read to
+     * @param size Amount of bytes to read
+     * @param offset Offset within the file descriptor's file
+     * @return The amount of bytes read or -errno
+     */
+    ssize_t
+    read_fd(int fd, char* buf, size_t size, off64_t offset) const;
+
+    /**
+     * @brief Recomputes the checksums of all blocks overlapping a written
+     * range of a chunk. Blocks that are not fully covered by buf are read from
+     * the chunk file. The caller holds the chunk's checksum mutex.
+     * @param fd File descriptor of the chunk file
+     * @param file_path Chunk file path, e.g., /foo/bar
+     * @param chunk_id Number of chunk id
+     * @param buf Written data or nullptr to read all blocks
+     * @param size Size of the range
+     * @param offset Offset of the range within the chunk
+     * @throws ChunkStorageException
+     */
+    void
+    update_checksums(int fd, const std::string& file_path,
+                     gkfs::rpc::chnk_id_t chunk_id, const char* buf,
+                     size_t size, off64_t offset) const;
+
+    /**
+     * @brief Verifies consecutive blocks of a chunk against their checksums.
+     * The caller holds the chunk's checksum mutex.
+     * @param file_path Chunk file path, e.g., /foo/bar
+     * @param chunk_id Number of chunk id
+     * @param data Chunk data starting at the first block
+     * @param size Size of data, i.e., up to the end of the chunk file
+     * @param first_block First block within the chunk
+     * @param count Number of blocks
+     * @return false if any checksum did not match
+     * @throws ChunkStorageException
+     */
+    bool
+    verify_blocks(const std::string& file_path, gkfs::rpc::chnk_id_t chunk_id,
+                  const char* data, size_t size, uint64_t first_block,
+                  size_t count) const;
+
+    /**
+     * @brief Returns the mutex serializing the updates and reads of a
+     * compressed chunk.
+     * @param file_path Chunk file path, e.g., /foo/bar
+     * @param chunk_id Number of chunk id
+     * @return Mutex of the chunk
+     */
+    std::mutex&
+    compression_mutex(const std::string& file_path,
+                      gkfs::rpc::chnk_id_t chunk_id) const;
+
+    /**
+     * @brief Reads and validates the header of a compressed chunk file.
+     * @param fd File descriptor of the chunk file
+     * @param file_path Chunk file path, e.g., /foo/bar
+     * @param chunk_id Number of chunk id
+     * @param header Receives the header
+     * @return false if the chunk file is empty
+     * @throws ChunkStorageException, EIO if the file has no valid header
+     */
+    bool
+    read_chunk_header(int fd, const std::string& file_path,
+                      gkfs::rpc::chnk_id_t chunk_id,
+                      CompressedChunkHeader& header) const;
+
+    /**
+     * @brief Decodes the beginning of a compressed chunk file.
+     * @param fd File descriptor of the chunk file
+     * @param file_path Chunk file path, e.g., /foo/bar
+     * @param chunk_id Number of chunk id
+     * @param header Header of the chunk file
+     * @param buf Buffer to decode to
+     * @param size Number of bytes to decode, at most header.raw_size
+     * @throws ChunkStorageException, EIO if the payload is corrupted
+     */
+    void
+    load_compressed(int fd, const std::string& file_path,
+                    gkfs::rpc::chnk_id_t chunk_id,
+                    const CompressedChunkHeader& header, char* buf,
+                    size_t size) const;
+
+    /**
+     * @brief Replaces the content of a compressed chunk file with the encoded
+     * chunk data.
+     * @param fd File descriptor of the chunk file
+     * @param file_path Chunk file path, e.g., /foo/bar
+     * @param chunk_id Number of chunk id
+     * @param data Chunk data
+     * @param size Size of the chunk data
+     * @throws ChunkStorageException
+     */
+    void
+    store_compressed(int fd, const std::string& file_path,
+                     gkfs::rpc::chnk_id_t chunk_id, const char* data,
+                     size_t size) const;
+
+    /**
+     * @brief Writes to a compressed chunk file. Raw chunks are written in
+     * place, compressed chunks are decoded, modified, and encoded again.
+     * Parameters are the same as for write_chunk().
+     * @throws ChunkStorageException
+     */
+    void
+    write_compressed(int fd, const std::string& file_path,
+                     gkfs::rpc::chnk_id_t chunk_id, const char* buf,
+                     size_t size, off64_t offset) const;
+
+    /**
+     * @brief Reads from a compressed chunk file, decoding only up to the end
+     * of the requested range. Parameters are the same as for read_chunk().
+     * @return The amount of bytes read
+     * @throws ChunkStorageException
+     */
+    ssize_t
+    read_compressed(int fd, const std::string& file_path,
+                    gkfs::rpc::chnk_id_t chunk_id, char* buf, size_t size,
+                    off64_t offset) const;
+
+    /**
+     * @brief Flushes all chunks of a file and their directory entries to the
+     * local storage device.
+     * @param file_path Chunk file path, e.g., /foo/bar
+     * @throws ChunkStorageException with its error code
+     */
+    void
+    sync_file(const std::string& file_path) const;
+
 public:
     /**
      * @brief Initializes the ChunkStorage object on daemon launch.
      * @param path Root directory where all data is placed on the local FS.
      * @param chunksize Used chunksize in this GekkoFS instance.
-     * @throws ChunkStorageException on launch failure
+     * @param fd_cache_size Maximum number of open chunk files that are kept
+     * in the file handle cache. 0 disables the cache.
+     * @param layout Placement of chunks on the local file system
+     * @param direct_io Bypass the page cache by opening chunks with O_DIRECT
+     * @param data_cache_size Maximum number of bytes of hot chunks that are
+     * kept in memory. 0 disables the cache.
+     * @param write_through Open chunk files with O_DSYNC so that a write is
+     * on the storage device when it returns
+     * @param checksum_path Directory for per-block CRC32C checksums of all
+     * chunks. Empty disables checksums.
+     * @param verify_reads Verify chunk reads against the checksums
+     * @param compression Store chunks LZ4-compressed, requires the chunk
+     * layout without direct I/O and checksums
+     * @throws ChunkStorageException on launch failure, e.g., EINVAL if
+     * direct_io is set but not supported by the local file system or if
+     * compression is not available with the given options
+     */
+    ChunkStorage(std::string& path, size_t chunksize, size_t fd_cache_size = 0,
+                 ChunkLayout layout = ChunkLayout::chunk,
+                 bool direct_io = false, size_t data_cache_size = 0,
+                 bool write_through = false,
+                 const std::string& checksum_path = {},
+                 bool verify_reads = false, bool compression = false);
+
+    ~ChunkStorage();
+
+    /**
+     * @brief Returns an open handle for a chunk file, either from the file
+     * handle cache or by opening the file. If create is set, the chunk space
+     * and the chunk file are created if they do not exist. Used internally and
+     * by I/O engines that submit I/O on the file descriptor themselves.
+     * @param file_path Chunk file path, e.g., /foo/bar
+     * @param chunk_id Number of chunk id
+     * @param create Create chunk file if it does not exist
+     * @return Shared file handle with a valid file descriptor
+     * @throws ChunkStorageException with its error code, e.g., ENOENT
+     */
+    std::shared_ptr<FileHandle>
+    open_chunk(const std::string& file_path, gkfs::rpc::chnk_id_t chunk_id,
+               bool create) const;
+
+    /**
+     * @brief Returns where a chunk starts within the file returned by
+     * open_chunk(), i.e., 0 for the chunk layout and chunk_id * chunksize for
+     * the extent layout.
+     * @param chunk_id Number of chunk id
+     * @return Offset of the chunk in its backing file
      */
-    ChunkStorage(std::string& path, size_t chunksize);
+    [[nodiscard]] off64_t
+    chunk_offset(gkfs::rpc::chnk_id_t chunk_id) const;
 
     /**
      * @brief Removes chunk directory with all its files which is a recursive
@@ -143,15 +482,16 @@ public:
                 const char* buf, size_t size, off64_t offset) const;
 
     /**
-     * @brief Reads a single chunk file and is usually called by an Argobots
-     * tasklet.
+     * @brief Reads a single chunk, either from the chunk data cache or from
+     * its chunk file, and is usually called by an Argobots tasklet.
      * @param file_path Chunk file path, e.g., /foo/bar
      * @param chunk_id Number of chunk id
      * @param buf Buffer to read to from chunk
      * @param size Amount of bytes to read to the chunk file
      * @param offset Offset where to read from the chunk file
-     * @return The amount of bytes read
-     * @throws ChunkStorageException with its error code
+     * @return The amount of bytes read, 0 if the chunk does not exist
+     * @throws ChunkStorageException with its error code, EIO if reads are
+     * verified and the data does not match its checksum
      */
     ssize_t
     read_chunk(const std::string& file_path, gkfs::rpc::chnk_id_t chunk_id,
@@ -178,6 +518,42 @@ public:
     truncate_chunk_file(const std::string& file_path,
                         gkfs::rpc::chnk_id_t chunk_id, off_t length);
 
+    /**
+     * @brief Flushes all locally stored chunks of a file to the storage
+     * device, e.g., for fsync(). Concurrent calls for the same file are
+     * batched into one sync (group commit).
+     * @param file_path Chunk file path, e.g., /foo/bar
+     * @throws ChunkStorageException with its error code
+     */
+    void
+    sync_chunk_space(const std::string& file_path) const;
+
+    /**
+     * @brief Verifies all blocks of a chunk against their checksums, e.g., by
+     * a scrubber. Mismatches are logged and counted.
+     * @param file_path Chunk file path, e.g., /foo/bar
+     * @param chunk_id Number of chunk id
+     * @return The amount of bytes read from the chunk
+     * @throws ChunkStorageException with its error code
+     */
+    size_t
+    scrub_chunk(const std::string& file_path,
+                gkfs::rpc::chnk_id_t chunk_id) const;
+
+    /**
+     * @brief Lists all files that have checksums on this daemon.
+     * @return GekkoFS file paths, empty if checksums are disabled
+     */
+    [[nodiscard]] std::vector<std::string>
+    checksum_files() const;
+
+    /**
+     * @brief Returns the number of chunks of a file that may have checksums.
+     * @return Highest chunk id with checksums + 1, or 0
+     */
+    [[nodiscard]] gkfs::rpc::chnk_id_t
+    checksum_chunk_count(const std::string& file_path) const;
+
     /**
      * @brief Calls statfs on the chunk directory to get statistic on its used
      * storage space.
@@ -186,6 +562,41 @@ public:
      */
     [[nodiscard]] ChunkStat
     chunk_stat() const;
+
+    /**
+     * @brief Returns the counters of the chunk file handle cache.
+     * @return ChunkFdCacheStats struct, all zero if the cache is disabled
+     */
+    [[nodiscard]] ChunkFdCacheStats
+    fd_cache_stats() const;
+
+    /**
+     * @brief Returns the counters of the chunk data cache.
+     * @return ChunkDataCacheStats struct, all zero if the cache is disabled
+     */
+    [[nodiscard]] ChunkDataCacheStats
+    data_cache_stats() const;
+
+    /**
+     * @brief Returns the counters of the group commit of file syncs.
+     * @return ChunkSyncStats struct
+     */
+    [[nodiscard]] ChunkSyncStats
+    sync_stats() const;
+
+    /**
+     * @brief Returns the counters of chunk checksum verification.
+     * @return ChunkChecksumStats struct, all zero if checksums are disabled
+     */
+    [[nodiscard]] ChunkChecksumStats
+    checksum_stats() const;
+
+    /**
+     * @brief Returns the counters of compressed chunk storage.
+     * @return ChunkCompressionStats struct, all zero if compression is disabled
+     */
+    [[nodiscard]] ChunkCompressionStats
+    compression_stats() const;
 };
 
 } // namespace gkfs::data
@@ -0,0 +1,333 @@
+/*
+  Copyright 2018-2024, Barcelona Supercomputing Center (BSC), Spain
+  Copyright 2015-2024, Johannes Gutenberg Universitaet Mainz, Germany
+
+  This software was partially supported by the
+  EC H2020 funded project NEXTGenIO (Project ID: 671951, www.nextgenio.eu).
+
+  This software was partially supported by the
+  ADA-FS project under the SPPEXA project funded by the DFG.
+
+  This file is part of GekkoFS.
+
+  GekkoFS is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  GekkoFS is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with GekkoFS.  If not, see <https://www.gnu.org/licenses/>.
+
+  SPDX-License-Identifier: GPL-3.0-or-later
+*/
+/**
+ * @brief Log-structured write aggregation for small chunk writes.
+ */
+
+#ifndef GEKKOFS_DAEMON_LOG_STORE_HPP
+#define GEKKOFS_DAEMON_LOG_STORE_HPP
+
+#include <daemon/backend/data/chunk_storage.hpp>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace gkfs::data {
+
+struct LogStoreStats {
+    uint64_t appended_bytes;  //!< Bytes written to the log
+    uint64_t compacted_bytes; //!< Bytes moved from the log to chunk files
+    uint64_t live_bytes;      //!< Bytes in the log not yet compacted
+    size_t segments;          //!< Number of segment files
+}; //!< Struct for counters of the write log
+
+/**
+ * @brief Write log that is used in front of the ChunkStorage. Small chunk
+ * writes are appended to large log segments and later rewritten into the
+ * regular chunk files by a background compactor.
+ *
+ * This class is thread-safe.
+ * @internal
+ * Writes up to a configured size are appended to the active segment of a lane.
+ * Each I/O execution stream is mapped to a lane by its thread id, so that
+ * concurrent writers append to different segments sequentially. The space
+ * within a segment is reserved under the lane's lock and written afterwards,
+ * so appends to the same lane also proceed in parallel.
+ *
+ * An extent index maps (file, chunk, chunk offset) to (segment, segment
+ * offset). Extents of a chunk never overlap: a newer write trims or removes
+ * older extents in its range. Reads first read the chunk file and then
+ * overlay all extents of the requested range. Larger writes go directly to the
+ * chunk file and remove overlapping extents from the index.
+ *
+ * The index is split into stripes by file path. A stripe's mutex is held while
+ * chunk data of its files is read, written, moved, or removed, so that the
+ * compactor never overwrites newer data in a chunk file and never moves data
+ * under a concurrent read.
+ *
+ * Once a segment is full, it is sealed. Each compaction round also seals the
+ * active segments. The compactor moves all extents of the chunks referenced by
+ * a sealed segment to their chunk files. On shutdown, all segments are
+ * compacted.
+ *
+ * Segments are replayed after a daemon crash. Each record in a segment starts
+ * with a header naming its file, chunk, and chunk range. Space for a record is
+ * reserved and its header written under the lane's mutex, so that the records
+ * of a segment can be walked in order. A record is committed by writing its
+ * sequence number once its data is written, under the stripe's mutex together
+ * with the index update, so that replaying the committed records in sequence
+ * order rebuilds the index. Direct chunk writes, truncates, and removals
+ * append tombstone records, so that replay does not restore data they replaced.
+ *
+ * The compactor persists a watermark below which all records are compacted or
+ * replaced, i.e., the sequence number before that of the oldest extent in the
+ * index. Replay skips records at or below the watermark, and a segment is
+ * deleted once no extent references it and all its records are at or below
+ * the watermark.
+ * @endinternal
+ */
+class LogStore {
+private:
+    enum class record_type : uint32_t;
+    struct record_header;
+
+    struct segment {
+        uint64_t id;                     //!< Segment file name
+        std::shared_ptr<FileHandle> fh;  //!< Open segment file
+        size_t used{0};                  //!< Reserved bytes
+        std::atomic<uint64_t> live{0};   //!< Bytes referenced by extents
+        std::atomic<uint32_t> pending{0}; //!< Appends not yet indexed
+        std::atomic<bool> sealed{false}; //!< No more appends
+        std::mutex keys_mutex;
+        std::set<std::pair<std::string, gkfs::rpc::chnk_id_t>>
+                keys;        //!< Chunks that had extents in this segment
+        uint64_t max_seq{0}; //!< Newest committed record, under keys_mutex
+    };
+
+    struct extent {
+        uint64_t len;     //!< Length of the extent
+        segment* seg;     //!< Segment holding the data
+        uint64_t seg_off; //!< Offset within the segment
+        uint64_t seq;     //!< Sequence number of the record
+    };
+
+    // chunk offset -> extent
+    using chunk_extents = std::map<uint64_t, extent>;
+    // chunk id -> extents of a file
+    using file_extents = std::map<gkfs::rpc::chnk_id_t, chunk_extents>;
+
+    struct stripe {
+        std::mutex mutex;
+        std::unordered_map<std::string, file_extents> files;
+    };
+
+    struct lane {
+        std::mutex mutex;
+        std::shared_ptr<segment> active;
+    };
+
+    std::shared_ptr<ChunkStorage> storage_; //!< Storage for chunk files
+    std::string log_path_;                  //!< Directory of segment files
+    size_t segment_size_;                   //!< Size of a segment
+    size_t max_write_size_;                 //!< Larger writes bypass the log
+
+    std::vector<std::unique_ptr<stripe>> stripes_;
+    std::vector<std::unique_ptr<lane>> lanes_;
+
+    std::mutex segments_mutex_;
+    std::map<uint64_t, std::shared_ptr<segment>> segments_;
+    uint64_t next_segment_id_{0};
+
+    std::atomic<uint64_t> seq_{0}; //!< Last committed sequence number
+    uint64_t watermark_{0};         //!< Persisted compaction watermark
+
+    std::atomic<uint64_t> appended_bytes_{0};
+    std::atomic<uint64_t> compacted_bytes_{0};
+    std::atomic<uint64_t> live_bytes_{0};
+
+    std::thread compactor_;
+    std::mutex compactor_mutex_;
+    std::condition_variable compactor_cv_;
+    bool running_{true};
+    unsigned int compact_interval_ms_;
+
+    stripe&
+    get_stripe(const std::string& file_path);
+
+    std::shared_ptr<segment>
+    new_segment();
+
+    /**
+     * @brief Reserves space for a record in the lane's active segment and
+     * writes its header and path. The segment has a pending writer afterwards,
+     * which the caller removes once the record is committed.
+     * @return Segment and offset of the record
+     * @throws ChunkStorageException
+     */
+    std::pair<std::shared_ptr<segment>, uint64_t>
+    reserve(const record_header& header, const std::string& file_path);
+
+    /**
+     * @brief Appends a committed tombstone record. The stripe's mutex must be
+     * held by the caller.
+     * @param type record_type::punch for the range [offset, offset + len) of
+     * a chunk, record_type::trim for all chunks starting with chunk_id
+     * @throws ChunkStorageException
+     */
+    void
+    append_tombstone(const std::string& file_path, record_type type,
+                     gkfs::rpc::chnk_id_t chunk_id, uint64_t offset,
+                     uint64_t len);
+
+    /**
+     * @brief Records that a segment holds a committed record.
+     */
+    static void
+    note_seq(segment& seg, uint64_t seq);
+
+    /**
+     * @brief Rebuilds the index from the segments of a previous run.
+     * @throws ChunkStorageException
+     */
+    void
+    recover();
+
+    /**
+     * @brief Persists a new compaction watermark.
+     * @return 0 on success or errno
+     */
+    int
+    persist_watermark(uint64_t watermark);
+
+    /**
+     * @brief Removes the range [off, end) from the extents of a chunk. Extents
+     * partially in the range are trimmed.
+     */
+    void
+    punch(chunk_extents& extents, uint64_t off, uint64_t end);
+
+    /**
+     * @brief Removes all extents of a chunk.
+     */
+    void
+    drop(chunk_extents& extents);
+
+    /**
+     * @brief Moves all extents of a chunk to its chunk file. The stripe's
+     * mutex must be held by the caller.
+     * @throws ChunkStorageException
+     */
+    void
+    compact_chunk(const std::string& file_path, gkfs::rpc::chnk_id_t chunk_id,
+                  chunk_extents& extents);
+
+    /**
+     * @brief Seals the active segments, compacts sealed segments, advances
+     * the watermark and removes segments no longer needed.
+     */
+    void
+    compact();
+
+    void
+    compactor_loop();
+
+public:
+    /**
+     * @brief Sets up the log directory, replays the segments of a previous
+     * run and starts the compactor.
+     * @param storage ChunkStorage holding the chunk files
+     * @param log_path Directory for log segments. It is created if needed
+     * @param segment_size Size of a log segment
+     * @param max_write_size Writes up to this size are appended to the log
+     * @param lanes Number of concurrently appended segments
+     * @param compact_interval_ms Interval in which the compactor runs
+     * @throws ChunkStorageException
+     */
+    LogStore(std::shared_ptr<ChunkStorage> storage, const std::string& log_path,
+             size_t segment_size, size_t max_write_size, unsigned int lanes,
+             unsigned int compact_interval_ms);
+
+    /**
+     * @brief Stops the compactor after moving all data to the chunk files.
+     */
+    ~LogStore();
+
+    LogStore(const LogStore&) = delete;
+
+    LogStore&
+    operator=(const LogStore&) = delete;
+
+    /**
+     * @brief Writes to a chunk, either by appending to the log or directly to
+     * the chunk file. Same semantics as ChunkStorage::write_chunk().
+     * @throws ChunkStorageException with its error code
+     */
+    ssize_t
+    write_chunk(const std::string& file_path, gkfs::rpc::chnk_id_t chunk_id,
+                const char* buf, size_t size, off64_t offset);
+
+    /**
+     * @brief Reads a chunk from its chunk file and the log. Same semantics as
+     * ChunkStorage::read_chunk().
+     * @throws ChunkStorageException with its error code
+     */
+    ssize_t
+    read_chunk(const std::string& file_path, gkfs::rpc::chnk_id_t chunk_id,
+               char* buf, size_t size, off64_t offset);
+
+    /**
+     * @brief Removes all data of a file. Same semantics as
+     * ChunkStorage::destroy_chunk_space().
+     * @throws ChunkStorageException
+     */
+    void
+    destroy_chunk_space(const std::string& file_path);
+
+    /**
+     * @brief Removes all chunks starting with chunk_start. Same semantics as
+     * ChunkStorage::trim_chunk_space().
+     * @throws ChunkStorageException
+     */
+    void
+    trim_chunk_space(const std::string& file_path,
+                     gkfs::rpc::chnk_id_t chunk_start);
+
+    /**
+     * @brief Truncates a single chunk. Same semantics as
+     * ChunkStorage::truncate_chunk_file().
+     * @throws ChunkStorageException
+     */
+    void
+    truncate_chunk_file(const std::string& file_path,
+                        gkfs::rpc::chnk_id_t chunk_id, off_t length);
+
+    /**
+     * @brief Moves all data of a file from the log to its chunk files and
+     * flushes them. Same semantics as ChunkStorage::sync_chunk_space().
+     * @throws ChunkStorageException with its error code
+     */
+    void
+    sync_chunk_space(const std::string& file_path);
+
+    [[nodiscard]] LogStoreStats
+    stats();
+};
+
+} // namespace gkfs::data
+
+#endif // GEKKOFS_DAEMON_LOG_STORE_HPP
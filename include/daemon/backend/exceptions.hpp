@@ -49,6 +49,11 @@ public:
     explicit ExistsException(const std::string& s) : DBException(s){};
 };
 
+class InlineDataException : public DBException {
+public:
+    explicit InlineDataException(const std::string& s) : DBException(s){};
+};
+
 } // namespace gkfs::metadata
 
 #endif // GEKKOFS_DB_EXCEPTIONS_HPP
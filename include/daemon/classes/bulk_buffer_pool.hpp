@@ -0,0 +1,190 @@
+/*
+  Copyright 2018-2024, Barcelona Supercomputing Center (BSC), Spain
+  Copyright 2015-2024, Johannes Gutenberg Universitaet Mainz, Germany
+
+  This software was partially supported by the
+  EC H2020 funded project NEXTGenIO (Project ID: 671951, www.nextgenio.eu).
+
+  This software was partially supported by the
+  ADA-FS project under the SPPEXA project funded by the DFG.
+
+  This file is part of GekkoFS.
+
+  GekkoFS is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  GekkoFS is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with GekkoFS.  If not, see <https://www.gnu.org/licenses/>.
+
+  SPDX-License-Identifier: GPL-3.0-or-later
+*/
+/**
+ * @brief Pool of pre-registered bulk buffers for the daemon's data handlers.
+ */
+
+#ifndef GEKKOFS_DAEMON_BULK_BUFFER_POOL_HPP
+#define GEKKOFS_DAEMON_BULK_BUFFER_POOL_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+extern "C" {
+#include <margo.h>
+}
+
+namespace gkfs::daemon {
+
+/**
+ * @brief Daemon-wide pool of bulk buffers that are allocated and registered
+ * with Margo once at startup. Write and read handlers borrow a buffer for the
+ * duration of an RPC instead of creating (and thereby registering) a new one
+ * per request.
+ *
+ * This class is thread-safe.
+ * @internal
+ * The pool is organized in tiers of buffers with the same size, each a
+ * multiple of the chunk size. A request is served by the smallest tier whose
+ * buffers are large enough and which has a free buffer. If no buffer is
+ * available, the caller falls back to allocating a bulk buffer for the RPC as
+ * before, which is counted as a fallback.
+ * @endinternal
+ */
+class BulkBufferPool : public std::enable_shared_from_this<BulkBufferPool> {
+private:
+    struct region {
+        void* buf;         //!< Page-aligned buffer
+        hg_bulk_t handle;  //!< Bulk handle registered for buf
+    };                     //!< Pre-registered buffer
+    struct tier {
+        size_t size;                 //!< Size of each buffer in bytes
+        std::vector<region> regions; //!< All buffers of this tier
+        std::vector<size_t> free;    //!< Indices of free buffers
+    };                               //!< Buffers of the same size
+
+    margo_instance_id mid_;
+    std::mutex mutex_;
+    std::vector<tier> tiers_; //!< Sorted by ascending buffer size
+    size_t capacity_{0};      //!< Total number of buffers
+    std::atomic<uint64_t> in_use_{0};
+    std::atomic<uint64_t> fallbacks_{0};
+
+    void
+    release(size_t tier_idx, size_t region_idx);
+
+public:
+    /**
+     * @brief A buffer borrowed from the pool for the lifetime of this object.
+     * An empty lease evaluates to false.
+     */
+    class Lease {
+        friend class BulkBufferPool;
+
+    private:
+        std::shared_ptr<BulkBufferPool> pool_{};
+        size_t tier_{0};
+        size_t region_{0};
+        void* buf_{nullptr};
+        hg_bulk_t handle_{HG_BULK_NULL};
+
+    public:
+        Lease() = default;
+
+        Lease(Lease&& rhs) noexcept;
+
+        Lease&
+        operator=(Lease&& rhs) noexcept;
+
+        Lease(const Lease&) = delete;
+
+        Lease&
+        operator=(const Lease&) = delete;
+
+        ~Lease();
+
+        explicit operator bool() const {
+            return pool_ != nullptr;
+        }
+
+        void*
+        buffer() const {
+            return buf_;
+        }
+
+        hg_bulk_t
+        handle() const {
+            return handle_;
+        }
+    };
+
+    /**
+     * @brief Allocates and registers all buffers of the pool.
+     * @param mid Margo instance id of the daemon's RPC server
+     * @param tiers List of pairs of buffer size in bytes and number of buffers
+     * @throws std::runtime_error on allocation or registration failure
+     */
+    BulkBufferPool(margo_instance_id mid,
+                   const std::vector<std::pair<size_t, size_t>>& tiers);
+
+    /**
+     * @brief Deregisters and frees all buffers. All leases must have ended.
+     */
+    ~BulkBufferPool();
+
+    BulkBufferPool(const BulkBufferPool&) = delete;
+
+    BulkBufferPool&
+    operator=(const BulkBufferPool&) = delete;
+
+    /**
+     * @brief Borrows a buffer of at least the given size.
+     * @param size Required buffer size in bytes
+     * @return Lease to the buffer or an empty lease if the pool is exhausted
+     */
+    Lease
+    acquire(size_t size);
+
+    /**
+     * @brief Parses a tier specification of the form
+     * <chunks>:<count>[,<chunks>:<count>...] where each tier has <count>
+     * buffers of <chunks> times the chunk size. "0" disables the pool.
+     * @param spec Tier specification, e.g., "1:64,4:16"
+     * @param chunksize Chunk size in bytes
+     * @return List of pairs of buffer size in bytes and number of buffers
+     * @throws std::invalid_argument on malformed input
+     */
+    static std::vector<std::pair<size_t, size_t>>
+    parse_tiers(const std::string& spec, size_t chunksize);
+
+    /**
+     * @brief Returns all buffers of the pool, e.g., to register them with
+     * other subsystems as well.
+     * @return List of pairs of buffer address and size in bytes
+     */
+    [[nodiscard]] std::vector<std::pair<void*, size_t>>
+    buffers() const;
+
+    [[nodiscard]] uint64_t
+    in_use() const;
+
+    [[nodiscard]] uint64_t
+    capacity() const;
+
+    [[nodiscard]] uint64_t
+    fallbacks() const;
+};
+
+} // namespace gkfs::daemon
+
+#endif // GEKKOFS_DAEMON_BULK_BUFFER_POOL_HPP
@@ -44,6 +44,8 @@ class MetadataDB;
 
 namespace data {
 class ChunkStorage;
+class LogStore;
+class ChunkScrubber;
 }
 
 /* Forward declarations */
@@ -82,6 +84,22 @@ private:
 
     // Storage backend
     std::shared_ptr<gkfs::data::ChunkStorage> storage_;
+    std::shared_ptr<gkfs::data::LogStore> log_store_;
+    bool enable_write_log_ = false;
+    size_t fd_cache_size_ = gkfs::config::data::fd_cache_size;
+    size_t chunk_cache_size_ = gkfs::config::data::chunk_cache_size;
+    std::string data_layout_ = gkfs::config::data::default_layout;
+    bool direct_io_ = false;
+    std::string durability_ = gkfs::config::data::default_durability;
+    std::string compression_ = gkfs::config::data::default_compression;
+    bool checksums_ = false;
+    bool verify_reads_ = false;
+    size_t scrub_rate_ = gkfs::config::data::scrub_rate;
+    std::shared_ptr<gkfs::data::ChunkScrubber> scrubber_;
+    std::string io_engine_ = gkfs::config::io::default_engine;
+    size_t pull_window_ = gkfs::config::rpc::daemon_pull_window;
+    size_t push_window_ = gkfs::config::rpc::daemon_push_window;
+    std::string bulk_pool_tiers_ = gkfs::config::rpc::daemon_bulk_pool_tiers;
 
     // configurable metadata
     bool atime_state_;
@@ -89,6 +107,11 @@ private:
     bool ctime_state_;
     bool link_cnt_state_;
     bool blocks_state_;
+    size_t inline_data_size_ = gkfs::config::metadata::inline_data_size;
+    size_t chunksize_ = gkfs::config::rpc::chunksize;
+    // Reed-Solomon data and parity chunks per stripe, 0 if disabled
+    unsigned int ec_data_shards_ = 0;
+    unsigned int ec_parity_shards_ = 0;
 
     // Statistics
     std::shared_ptr<gkfs::utils::Stats> stats_;
@@ -165,6 +188,102 @@ public:
     void
     storage(const std::shared_ptr<gkfs::data::ChunkStorage>& storage);
 
+    const std::shared_ptr<gkfs::data::LogStore>&
+    log_store() const;
+
+    void
+    log_store(const std::shared_ptr<gkfs::data::LogStore>& log_store);
+
+    bool
+    enable_write_log() const;
+
+    void
+    enable_write_log(bool enable_write_log);
+
+    size_t
+    fd_cache_size() const;
+
+    void
+    fd_cache_size(size_t fd_cache_size);
+
+    size_t
+    chunk_cache_size() const;
+
+    void
+    chunk_cache_size(size_t chunk_cache_size);
+
+    const std::string&
+    data_layout() const;
+
+    void
+    data_layout(const std::string& data_layout);
+
+    bool
+    direct_io() const;
+
+    void
+    direct_io(bool direct_io);
+
+    const std::string&
+    durability() const;
+
+    void
+    durability(const std::string& durability);
+
+    const std::string&
+    compression() const;
+
+    void
+    compression(const std::string& compression);
+
+    bool
+    checksums() const;
+
+    void
+    checksums(bool checksums);
+
+    bool
+    verify_reads() const;
+
+    void
+    verify_reads(bool verify_reads);
+
+    size_t
+    scrub_rate() const;
+
+    void
+    scrub_rate(size_t scrub_rate);
+
+    const std::shared_ptr<gkfs::data::ChunkScrubber>&
+    scrubber() const;
+
+    void
+    scrubber(const std::shared_ptr<gkfs::data::ChunkScrubber>& scrubber);
+
+    const std::string&
+    io_engine() const;
+
+    void
+    io_engine(const std::string& io_engine);
+
+    size_t
+    pull_window() const;
+
+    void
+    pull_window(size_t pull_window);
+
+    size_t
+    push_window() const;
+
+    void
+    push_window(size_t push_window);
+
+    const std::string&
+    bulk_pool_tiers() const;
+
+    void
+    bulk_pool_tiers(const std::string& bulk_pool_tiers);
+
     const std::string&
     rpc_protocol() const;
 
@@ -225,6 +344,30 @@ public:
     void
     parallax_size_md(unsigned int size_md);
 
+    size_t
+    inline_data_size() const;
+
+    void
+    inline_data_size(size_t inline_data_size);
+
+    size_t
+    chunksize() const;
+
+    void
+    chunksize(size_t chunksize);
+
+    unsigned int
+    ec_data_shards() const;
+
+    void
+    ec_data_shards(unsigned int ec_data_shards);
+
+    unsigned int
+    ec_parity_shards() const;
+
+    void
+    ec_parity_shards(unsigned int ec_parity_shards);
+
     const std::shared_ptr<gkfs::utils::Stats>&
     stats() const;
 
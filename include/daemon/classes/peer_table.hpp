@@ -0,0 +1,105 @@
+/*
+  Copyright 2018-2024, Barcelona Supercomputing Center (BSC), Spain
+  Copyright 2015-2024, Johannes Gutenberg Universitaet Mainz, Germany
+
+  This software was partially supported by the
+  EC H2020 funded project NEXTGenIO (Project ID: 671951, www.nextgenio.eu).
+
+  This software was partially supported by the
+  ADA-FS project under the SPPEXA project funded by the DFG.
+
+  This file is part of GekkoFS.
+
+  GekkoFS is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  GekkoFS is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with GekkoFS.  If not, see <https://www.gnu.org/licenses/>.
+
+  SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+/**
+ * @brief Addresses of the other daemons of the file system.
+ */
+
+#ifndef GEKKOFS_DAEMON_PEER_TABLE_HPP
+#define GEKKOFS_DAEMON_PEER_TABLE_HPP
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+extern "C" {
+#include <margo.h>
+}
+
+namespace gkfs::daemon {
+
+/**
+ * @brief Mercury addresses of all daemons of the file system indexed by host
+ * id, used by a daemon to send RPCs to other daemons.
+ *
+ * This class is thread-safe.
+ * @internal
+ * The daemons are read from the hosts file and ordered as clients order them
+ * so that host ids match those in client requests. The hosts file is only read
+ * when the first address is requested, at which point all daemons have
+ * registered themselves, and read again if a request names a different number
+ * of hosts. Addresses are looked up by URI on first use and kept until the
+ * table is destroyed, which must happen before Margo is finalized.
+ * @endinternal
+ */
+class PeerTable {
+private:
+    margo_instance_id mid_;
+    std::string hosts_file_;
+    std::mutex mutex_;
+    std::vector<std::string> uris_; //!< Daemon URIs indexed by host id
+    std::unordered_map<std::string, hg_addr_t> addrs_; //!< Looked up by URI
+
+    /**
+     * @brief Reads all daemon URIs from the hosts file. mutex_ must be held.
+     * @throws std::runtime_error if the file cannot be read or parsed
+     */
+    void
+    load();
+
+public:
+    /**
+     * @brief Creates an empty table. The hosts file is not read yet.
+     * @param mid Margo instance id of the daemon's RPC server
+     * @param hosts_file Path to the shared hosts file
+     */
+    PeerTable(margo_instance_id mid, std::string hosts_file);
+
+    ~PeerTable();
+
+    PeerTable(const PeerTable&) = delete;
+
+    PeerTable&
+    operator=(const PeerTable&) = delete;
+
+    /**
+     * @brief Returns the address of a daemon, looking it up on first use.
+     * @param host_id Host id of the daemon
+     * @param host_size Number of daemons the requesting client knows
+     * @return Mercury address owned by the table
+     * @throws std::runtime_error if the daemon is unknown or the lookup fails
+     */
+    hg_addr_t
+    addr(uint64_t host_id, uint64_t host_size);
+};
+
+} // namespace gkfs::daemon
+
+#endif // GEKKOFS_DAEMON_PEER_TABLE_HPP
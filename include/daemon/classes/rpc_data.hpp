@@ -37,6 +37,13 @@ namespace gkfs {
 namespace rpc {
 class Distributor;
 }
+namespace data {
+class UringEngine;
+}
+namespace daemon {
+class BulkBufferPool;
+class PeerTable;
+}
 
 
 namespace daemon {
@@ -53,9 +60,15 @@ private:
     // Argobots I/O pools and execution streams
     ABT_pool io_pool_;
     std::vector<ABT_xstream> io_streams_;
+    // io_uring chunk I/O engine, nullptr if chunk I/O runs in the I/O pool
+    std::shared_ptr<gkfs::data::UringEngine> uring_engine_;
     std::string self_addr_str_;
     // Distributor
     std::shared_ptr<gkfs::rpc::Distributor> distributor_;
+    // Pre-registered bulk buffers for data handlers, nullptr if disabled
+    std::shared_ptr<BulkBufferPool> bulk_pool_;
+    // Addresses of the other daemons, e.g., to forward replica writes
+    std::shared_ptr<PeerTable> peers_;
 
 public:
     static RPCData*
@@ -89,6 +102,12 @@ public:
     void
     io_streams(const std::vector<ABT_xstream>& io_streams);
 
+    const std::shared_ptr<gkfs::data::UringEngine>&
+    uring_engine() const;
+
+    void
+    uring_engine(const std::shared_ptr<gkfs::data::UringEngine>& uring_engine);
+
     const std::string&
     self_addr_str() const;
 
@@ -100,6 +119,18 @@ public:
 
     void
     distributor(const std::shared_ptr<gkfs::rpc::Distributor>& distributor);
+
+    const std::shared_ptr<BulkBufferPool>&
+    bulk_pool() const;
+
+    void
+    bulk_pool(const std::shared_ptr<BulkBufferPool>& bulk_pool);
+
+    const std::shared_ptr<PeerTable>&
+    peers() const;
+
+    void
+    peers(const std::shared_ptr<PeerTable>& peers);
 };
 
 } // namespace daemon
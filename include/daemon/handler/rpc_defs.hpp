@@ -55,6 +55,10 @@ DECLARE_MARGO_RPC_HANDLER(rpc_srv_get_metadentry_size)
 
 DECLARE_MARGO_RPC_HANDLER(rpc_srv_update_metadentry_size)
 
+DECLARE_MARGO_RPC_HANDLER(rpc_srv_write_inline)
+
+DECLARE_MARGO_RPC_HANDLER(rpc_srv_read_inline)
+
 DECLARE_MARGO_RPC_HANDLER(rpc_srv_get_dirents)
 
 DECLARE_MARGO_RPC_HANDLER(rpc_srv_get_dirents_extended)
@@ -76,4 +80,6 @@ DECLARE_MARGO_RPC_HANDLER(rpc_srv_truncate)
 
 DECLARE_MARGO_RPC_HANDLER(rpc_srv_get_chunk_stat)
 
+DECLARE_MARGO_RPC_HANDLER(rpc_srv_fsync)
+
 #endif // GKFS_DAEMON_RPC_DEFS_HPP
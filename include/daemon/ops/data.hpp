@@ -52,8 +52,15 @@ extern "C" {
 #include <margo.h>
 }
 
+#ifdef GKFS_ENABLE_IO_URING
+#include <daemon/ops/uring_engine.hpp>
+#endif
+
 namespace gkfs::data {
 
+constexpr auto io_engine_tasklet = "tasklet";
+constexpr auto io_engine_uring = "io_uring";
+
 /**
  * @brief Internal Exception for all general chunk operations.
  */
@@ -111,6 +118,12 @@ public:
  * Therefore, a queue per chunk could be beneficial (this has not been tested
  * yet).
  *
+ * If the daemon runs with the io_uring engine, reads and writes do not create
+ * tasklets. Instead, each chunk is queued to the UringEngine which completes
+ * the chunk's eventual. All queued chunks of a read are submitted at once when
+ * waiting for the results, while each chunk of a write is submitted as soon as
+ * its bulk transfer has finished.
+ *
  * Note, at this time, CRTP is only required for `cancel_all_tasks()`.
  *
  * @endinternal
@@ -125,6 +138,7 @@ protected:
     std::vector<ABT_task> abt_tasks_; //!< Tasklets operating on the file
     std::vector<ABT_eventual>
             task_eventuals_; //!< Eventuals for tasklet callbacks
+    bool use_uring_{false}; //!< Chunk I/O is queued to the io_uring engine
 
 public:
     /**
@@ -158,6 +172,17 @@ public:
     void
     cancel_all_tasks() {
         GKFS_DATA->spdlogger()->trace("{}() enter", __func__);
+#ifdef GKFS_ENABLE_IO_URING
+        if(use_uring_) {
+            // io_uring requests cannot be canceled as they reference the
+            // buffers and eventuals. Make sure they are finished first.
+            RPC_DATA->uring_engine()->submit();
+            for(auto& eventual : task_eventuals_) {
+                if(eventual)
+                    ABT_eventual_wait(eventual, nullptr);
+            }
+        }
+#endif
         for(auto& task : abt_tasks_) {
             if(task) {
                 ABT_task_cancel(task);
@@ -349,7 +374,8 @@ public:
 
     /**
      * @brief Waits for all local I/O operations to finish and push buffers back
-     * to the daemon.
+     * to the daemon. Chunks are pushed in completion order with a bounded
+     * number of non-blocking transfers in flight.
      * @param args Bulk_args for push transfer
      * @return Pair for error code for success (0) or failure and read size
      */
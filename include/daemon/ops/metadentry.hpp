@@ -107,6 +107,56 @@ update(const std::string& path, Metadata& md);
 off_t
 update_size(const std::string& path, size_t io_size, off_t offset, bool append);
 
+/**
+ * @brief Decreases a metadentry's size, e.g., on truncate. Inline data is cut
+ * to the new size.
+ * @param path
+ * @param size
+ */
+void
+decrease_size(const std::string& path, size_t size);
+
+/**
+ * @brief Writes to the inline data of a file. Succeeds only if the file's data
+ * is stored inline or the file is empty, and if the write ends within the
+ * inline data size. The file size is updated with the data.
+ * @param path
+ * @param buf Data to write
+ * @param count Size of the data
+ * @param offset Offset of the write, set to the file size if append is set
+ * @param append
+ * @return false if the data must be written to chunks instead
+ * @throws NotFoundException
+ */
+bool
+write_inline(const std::string& path, const char* buf, size_t count,
+             off64_t& offset, bool append);
+
+/**
+ * @brief Reads the inline data of a file.
+ * @param path
+ * @param offset Offset of the read
+ * @param count Size of the read
+ * @param data Receives the data, shorter than count at the end of the file
+ * @return false if the file's data is not stored inline
+ * @throws NotFoundException
+ */
+bool
+read_inline(const std::string& path, off64_t offset, size_t count,
+            std::string& data);
+
+/**
+ * @brief Removes the inline data of a file that was written to the file's
+ * chunks, keeping the file size so that subsequent writes go to chunks. The
+ * data is only removed if it is unchanged since it was read.
+ * @param path
+ * @param data The inline data written to the chunks
+ * @return false if the inline data was modified since it was read
+ * @throws NotFoundException
+ */
+bool
+spill_inline(const std::string& path, const std::string& data);
+
 /**
  * @brief Remove metadentry if exists
  * @param path
@@ -0,0 +1,252 @@
+/*
+  Copyright 2018-2024, Barcelona Supercomputing Center (BSC), Spain
+  Copyright 2015-2024, Johannes Gutenberg Universitaet Mainz, Germany
+
+  This software was partially supported by the
+  EC H2020 funded project NEXTGenIO (Project ID: 671951, www.nextgenio.eu).
+
+  This software was partially supported by the
+  ADA-FS project under the SPPEXA project funded by the DFG.
+
+  This file is part of GekkoFS.
+
+  GekkoFS is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  GekkoFS is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with GekkoFS.  If not, see <https://www.gnu.org/licenses/>.
+
+  SPDX-License-Identifier: GPL-3.0-or-later
+*/
+/**
+ * @brief io_uring based engine to submit chunk I/O of the daemon.
+ */
+
+#ifndef GEKKOFS_DAEMON_URING_ENGINE_HPP
+#define GEKKOFS_DAEMON_URING_ENGINE_HPP
+
+#include <common/common_defs.hpp>
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+extern "C" {
+#include <abt.h>
+#include <liburing.h>
+}
+
+namespace gkfs::data {
+
+class FileHandle;
+
+/**
+ * @brief Exception for setting up or tearing down the io_uring engine.
+ */
+class UringEngineException : public std::runtime_error {
+public:
+    explicit UringEngineException(const std::string& s)
+        : std::runtime_error(s){};
+};
+
+/**
+ * @brief Submits chunk reads and writes to a single io_uring instance instead
+ * of running blocking pread()/pwrite() calls in Argobots tasklets.
+ *
+ * This class is thread-safe.
+ * @internal
+ * Chunk operations queue one submission queue entry (SQE) per chunk which are
+ * handed to the kernel with submit(), for reads once all chunks of an RPC have
+ * been queued and for writes once each chunk's data has arrived. The
+ * completions are reaped by a user-level thread running in a dedicated Argobots
+ * execution stream, which completes the ABT_eventual of each chunk with the
+ * number of transferred bytes or a negative errno, i.e., exactly the value a
+ * chunk tasklet would set. Therefore, ChunkOperation callers are not aware of
+ * the engine that is used.
+ *
+ * Short reads are treated as end-of-file. Short writes and requests
+ * interrupted with EINTR or EAGAIN are queued again for the remaining bytes.
+ * The chunk file handle is held by the request until it completes so that the
+ * file descriptor remains valid even if it is evicted from the file handle
+ * cache in the meantime.
+ *
+ * The buffers of the bulk buffer pool are registered as fixed buffers, so
+ * that the kernel does not map the pages of chunk I/O to and from them on
+ * every request. Chunk I/O on buffers allocated per RPC uses regular requests.
+ * Chunk files are not registered as fixed files. Their descriptors are
+ * closed and their numbers reused on eviction from the file handle cache,
+ * which a fixed file table would have to follow.
+ * @endinternal
+ */
+class UringEngine {
+private:
+    struct request {
+        std::shared_ptr<FileHandle> fh; //!< Chunk file kept open while queued
+        char* buf;                      //!< Buffer for chunk
+        size_t size;                    //!< Size to read or write
+        off64_t off;                    //!< Offset within chunk file
+        size_t done;                    //!< Bytes transferred so far
+        bool write;                     //!< Write or read request
+        ABT_eventual eventual;          //!< Eventual to complete
+    };                                  //!< In-flight chunk request
+
+    struct fixed_buffer {
+        char* base; //!< Start of the buffer
+        size_t size;
+        int index; //!< Index in the registered buffer table
+    };             //!< Buffer registered with io_uring
+
+    struct io_uring ring_ {};
+    std::mutex sq_mutex_; //!< Serializes access to the submission queue
+    std::vector<fixed_buffer> fixed_buffers_; //!< Sorted by base, sq_mutex_
+    //! Queued requests not taken by the kernel yet in queue order, sq_mutex_
+    std::vector<std::pair<struct io_uring_sqe*, request*>> unsubmitted_;
+    ABT_pool pool_{ABT_POOL_NULL};          //!< Pool of reaper xstream
+    ABT_xstream xstream_{ABT_XSTREAM_NULL}; //!< Dedicated reaper xstream
+    ABT_thread reaper_{ABT_THREAD_NULL};    //!< Reaper user-level thread
+    std::atomic<bool> running_{true};
+
+    /**
+     * @brief Places a request into the submission queue. sq_mutex_ must be
+     * held by the caller.
+     * @param req Request to queue
+     * @throws UringEngineException if no SQE is available
+     */
+    void
+    queue(request* req);
+
+    /**
+     * @brief Returns the fixed buffer holding a memory range. sq_mutex_ must
+     * be held by the caller.
+     * @param buf Start of the range
+     * @param size Size of the range
+     * @return Index of the fixed buffer or -1 if it is not registered
+     */
+    int
+    fixed_index(const char* buf, size_t size) const;
+
+    /**
+     * @brief Hands queued requests to the kernel. If submitting fails with
+     * an error other than EINTR, EAGAIN, or EBUSY, all queued requests are
+     * completed with the error. sq_mutex_ must be held by the caller.
+     * @return Result of io_uring_submit()
+     */
+    int
+    submit_queued();
+
+    /**
+     * @brief Opens the chunk file and queues a new request. Errors complete
+     * the eventual right away.
+     */
+    void
+    prepare(const std::string& path, gkfs::rpc::chnk_id_t chunk_id, char* buf,
+            size_t size, off64_t offset, bool write, ABT_eventual eventual);
+
+    /**
+     * @brief Sets the request's eventual with the result and frees it.
+     * @param req Finished request
+     * @param result Transferred bytes or negative errno
+     */
+    static void
+    complete(request* req, ssize_t result);
+
+    /**
+     * @brief Exclusively used by the reaper user-level thread.
+     * @param _arg Pointer to the UringEngine
+     */
+    static void
+    reap_abt(void* _arg);
+
+    /**
+     * @brief Reaps completion queue entries until the engine is shut down.
+     */
+    void
+    reap();
+
+public:
+    /**
+     * @brief Sets up the io_uring instance and starts the reaper.
+     * @param queue_depth Number of submission queue entries
+     * @throws UringEngineException
+     */
+    explicit UringEngine(unsigned int queue_depth);
+
+    /**
+     * @brief Stops the reaper and tears down the io_uring instance. All
+     * requests must have been completed at this point.
+     */
+    ~UringEngine();
+
+    UringEngine(const UringEngine&) = delete;
+
+    UringEngine&
+    operator=(const UringEngine&) = delete;
+
+    /**
+     * @brief Queues a chunk write. The eventual is set to the written bytes
+     * or a negative errno on failure.
+     * @param path Chunk directory path, e.g., /foo/bar
+     * @param chunk_id The affected chunk id
+     * @param buf Buffer to write, must stay valid until completion
+     * @param size Size to write to chunk
+     * @param offset Offset within the chunk file
+     * @param eventual Eventual of type ssize_t to complete
+     */
+    void
+    write_nonblock(const std::string& path, gkfs::rpc::chnk_id_t chunk_id,
+                   const char* buf, size_t size, off64_t offset,
+                   ABT_eventual eventual) noexcept;
+
+    /**
+     * @brief Queues a chunk read. The eventual is set to the read bytes or a
+     * negative errno on failure, e.g., -ENOENT for a sparse chunk.
+     * @param path Chunk directory path, e.g., /foo/bar
+     * @param chunk_id The affected chunk id
+     * @param buf Buffer to read into, must stay valid until completion
+     * @param size Size to read from chunk
+     * @param offset Offset within the chunk file
+     * @param eventual Eventual of type ssize_t to complete
+     */
+    void
+    read_nonblock(const std::string& path, gkfs::rpc::chnk_id_t chunk_id,
+                  char* buf, size_t size, off64_t offset,
+                  ABT_eventual eventual) noexcept;
+
+    /**
+     * @brief Registers buffers as io_uring fixed buffers. Chunk I/O within
+     * these buffers then uses fixed buffer requests.
+     * @param buffers List of pairs of buffer address and size in bytes. The
+     * buffers must stay valid until unregister_buffers() is called
+     * @throws UringEngineException if the kernel rejects the buffers
+     */
+    void
+    register_buffers(const std::vector<std::pair<void*, size_t>>& buffers);
+
+    /**
+     * @brief Unregisters the fixed buffers. No chunk I/O must be in flight.
+     */
+    void
+    unregister_buffers();
+
+    /**
+     * @brief Hands all queued requests to the kernel with a single system
+     * call.
+     */
+    void
+    submit();
+};
+
+} // namespace gkfs::data
+
+#endif // GEKKOFS_DAEMON_URING_ENGINE_HPP
@@ -0,0 +1,272 @@
+/*
+  Copyright 2018-2024, Barcelona Supercomputing Center (BSC), Spain
+  Copyright 2015-2024, Johannes Gutenberg Universitaet Mainz, Germany
+
+  This software was partially supported by the
+  EC H2020 funded project NEXTGenIO (Project ID: 671951, www.nextgenio.eu).
+
+  This software was partially supported by the
+  ADA-FS project under the SPPEXA project funded by the DFG.
+
+  This file is part of GekkoFS' POSIX interface.
+
+  GekkoFS' POSIX interface is free software: you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation, either version 3 of the License,
+  or (at your option) any later version.
+
+  GekkoFS' POSIX interface is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with GekkoFS' POSIX interface.  If not, see
+  <https://www.gnu.org/licenses/>.
+
+  SPDX-License-Identifier: LGPL-3.0-or-later
+*/
+
+#include <client/erasure_coding.hpp>
+#include <client/preload_util.hpp>
+#include <client/logging.hpp>
+#include <client/rpc/forward_data.hpp>
+
+#include <common/erasure/reed_solomon.hpp>
+#include <common/rpc/distributor.hpp>
+
+#include <config.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+using namespace std;
+
+namespace gkfs::ec {
+
+namespace {
+
+/*
+ * The code is created on first use, after the file system configuration has
+ * been fetched from the daemons.
+ */
+const ReedSolomon&
+code() {
+    static const ReedSolomon rs{CTX->fs_conf()->ec_data_shards,
+                                CTX->fs_conf()->ec_parity_shards};
+    return rs;
+}
+
+/**
+ * Reads a contiguous range of a file's data. Sparse regions and regions beyond
+ * the end of the file are not written to buf.
+ * @return error code
+ */
+int
+read_range(const string& path, char* buf, uint64_t offset, size_t size) {
+    if(size == 0)
+        return 0;
+    set<int8_t> failed;
+    return gkfs::rpc::forward_read(path, buf, offset, size, 0, failed).first;
+}
+
+/**
+ * Reads one chunk unless its daemon is known to have failed.
+ * @return true if the chunk was read
+ */
+bool
+read_chunk(const string& path, uint64_t chnk_id, char* buf,
+           set<int8_t>& failed) {
+    auto target = CTX->distributor()->locate_data(path, chnk_id, 0);
+    if(failed.count(static_cast<int8_t>(target)))
+        return false;
+    const auto chunksize = CTX->fs_conf()->chunksize;
+    return gkfs::rpc::forward_read(path, buf, chnk_id * chunksize, chunksize,
+                                   0, failed)
+                   .first == 0;
+}
+
+/**
+ * Encodes consecutive stripes and writes their parity chunks.
+ * @param path
+ * @param data Data of the stripes
+ * @param first_stripe
+ * @param stripes Number of stripes
+ * @return error code
+ */
+int
+write_parity(const string& path, const char* data, uint64_t first_stripe,
+             uint64_t stripes) {
+    const auto& rs = code();
+    const auto k = rs.data_shards();
+    const auto m = rs.parity_shards();
+    const auto chunksize = CTX->fs_conf()->chunksize;
+
+    vector<char> parity(stripes * m * chunksize);
+    vector<const uint8_t*> data_shards(k);
+    vector<uint8_t*> parity_shards(m);
+    for(uint64_t stripe = 0; stripe < stripes; stripe++) {
+        for(unsigned int j = 0; j < k; j++) {
+            data_shards[j] = reinterpret_cast<const uint8_t*>(
+                    data + (stripe * k + j) * chunksize);
+        }
+        for(unsigned int i = 0; i < m; i++) {
+            parity_shards[i] = reinterpret_cast<uint8_t*>(
+                    parity.data() + (stripe * m + i) * chunksize);
+        }
+        rs.encode(data_shards.data(), parity_shards.data(), chunksize);
+    }
+    auto ret = gkfs::rpc::forward_write(parity_path(path), parity.data(),
+                                        first_stripe * m * chunksize,
+                                        parity.size(), 0);
+    if(ret.first) {
+        LOG(ERROR, "{}() Failed to write parity of '{}': '{}'", __func__,
+            path, ret.first);
+    }
+    return ret.first;
+}
+
+} // namespace
+
+bool
+enabled() {
+    return CTX->fs_conf()->ec_data_shards > 0;
+}
+
+string
+parity_path(const string& path) {
+    return gkfs::config::ec::parity_prefix + path;
+}
+
+size_t
+parity_size(size_t file_size) {
+    const auto chunksize = CTX->fs_conf()->chunksize;
+    const size_t stripe_size = code().data_shards() * chunksize;
+    auto stripes = (file_size + stripe_size - 1) / stripe_size;
+    return stripes * code().parity_shards() * chunksize;
+}
+
+int
+update_parity(const string& path, const char* buf, off64_t offset,
+              size_t count) {
+    if(count == 0)
+        return 0;
+    const auto chunksize = CTX->fs_conf()->chunksize;
+    const uint64_t stripe_size = code().data_shards() * chunksize;
+    const uint64_t first = offset / stripe_size;
+    const uint64_t last = (offset + count - 1) / stripe_size;
+    const uint64_t start = first * stripe_size;
+    const uint64_t end = (last + 1) * stripe_size;
+
+    // zeroed, as sparse regions and regions beyond the end of the file are
+    // not read but are zero in the parity
+    vector<char> data(end - start);
+    memcpy(data.data() + (offset - start), buf, count);
+    auto err = read_range(path, data.data(), start, offset - start);
+    if(!err) {
+        err = read_range(path, data.data() + (offset - start) + count,
+                         offset + count, end - offset - count);
+    }
+    if(err) {
+        LOG(ERROR, "{}() Failed to read stripes of '{}': '{}'", __func__, path,
+            err);
+        return err;
+    }
+    return write_parity(path, data.data(), first, last - first + 1);
+}
+
+int
+truncate_parity(const string& path, size_t old_size, size_t new_size) {
+    auto old_parity = parity_size(old_size);
+    auto new_parity = parity_size(new_size);
+    if(new_parity < old_parity) {
+        auto err = gkfs::rpc::forward_truncate(parity_path(path), old_parity,
+                                               new_parity, 0);
+        if(err)
+            return err;
+    }
+    // the parity of the last stripe still covers the truncated data
+    const auto chunksize = CTX->fs_conf()->chunksize;
+    const size_t stripe_size = code().data_shards() * chunksize;
+    if(new_size % stripe_size == 0)
+        return 0;
+    auto stripe = new_size / stripe_size;
+    vector<char> data(stripe_size);
+    auto err = read_range(path, data.data(), stripe * stripe_size,
+                          new_size - stripe * stripe_size);
+    if(err)
+        return err;
+    return write_parity(path, data.data(), stripe, 1);
+}
+
+pair<int, ssize_t>
+read_degraded(const string& path, char* buf, off64_t offset, size_t count,
+              set<int8_t>& failed) {
+    auto md = gkfs::utils::get_metadata(path);
+    if(!md)
+        return make_pair(errno, 0);
+    const uint64_t end = min<uint64_t>(offset + count, md->size());
+    if(static_cast<uint64_t>(offset) >= end)
+        return make_pair(0, 0);
+
+    const auto& rs = code();
+    const auto k = rs.data_shards();
+    const auto m = rs.parity_shards();
+    const auto chunksize = CTX->fs_conf()->chunksize;
+    const uint64_t stripe_size = k * chunksize;
+    const auto ppath = parity_path(path);
+
+    vector<char> shards((k + m) * chunksize);
+    vector<uint8_t*> shard_ptrs(k + m);
+    for(unsigned int i = 0; i < k + m; i++)
+        shard_ptrs[i] = reinterpret_cast<uint8_t*>(&shards[i * chunksize]);
+
+    for(uint64_t stripe = offset / stripe_size; stripe * stripe_size < end;
+        stripe++) {
+        const auto stripe_start = stripe * stripe_size;
+        const auto from = max<uint64_t>(offset, stripe_start);
+        const auto to = min(end, stripe_start + stripe_size);
+        const auto first_j = (from - stripe_start) / chunksize;
+        const auto last_j = (to - 1 - stripe_start) / chunksize;
+        fill(shards.begin(), shards.end(), 0);
+        vector<bool> tried(k + m, false);
+        vector<bool> present(k + m, false);
+        unsigned int n_present = 0;
+        auto read_shard = [&](unsigned int i) {
+            auto& shard_path = i < k ? path : ppath;
+            auto chnk_id = i < k ? stripe * k + i : stripe * m + i - k;
+            tried[i] = true;
+            present[i] = read_chunk(shard_path, chnk_id,
+                                    &shards[i * chunksize], failed);
+            n_present += present[i];
+        };
+        // the requested chunks first, the others only to reconstruct
+        auto complete = true;
+        for(auto j = first_j; j <= last_j; j++) {
+            read_shard(j);
+            complete = complete && present[j];
+        }
+        for(unsigned int i = 0; !complete && i < k + m && n_present < k;
+            i++) {
+            if(!tried[i])
+                read_shard(i);
+        }
+        if(!complete) {
+            if(n_present < k) {
+                LOG(ERROR,
+                    "{}() Stripe {} of '{}' lost more than {} of its chunks",
+                    __func__, stripe, path, m);
+                return make_pair(EIO, 0);
+            }
+            LOG(DEBUG, "{}() Reconstructing stripe {} of '{}'", __func__,
+                stripe, path);
+            rs.reconstruct(shard_ptrs.data(), present, chunksize);
+        }
+        memcpy(buf + (from - offset), &shards[from - stripe_start],
+               to - from);
+    }
+    return make_pair(0, end - offset);
+}
+
+} // namespace gkfs::ec
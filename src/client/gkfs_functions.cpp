@@ -34,9 +34,18 @@
 #include <client/gkfs_functions.hpp>
 #include <client/rpc/forward_metadata.hpp>
 #include <client/rpc/forward_data.hpp>
+#include <client/rpc/rpc_call.hpp>
 #include <client/open_dir.hpp>
+#include <client/erasure_coding.hpp>
 
 #include <common/path_util.hpp>
+#include <common/arithmetic/arithmetic.hpp>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <functional>
+#include <future>
 
 extern "C" {
 #include <dirent.h> // used for file types in the getdents{,64}() functions
@@ -117,6 +126,821 @@ check_parent_dir(const std::string& path) {
 #endif // GKFS_CREATE_CHECK_PARENTS
     return 0;
 }
+
+/**
+ * Moves the data of a file stored inline in its metadentry to the file's
+ * chunks. The inline data is read and written to the chunks before the daemon
+ * removes it from the metadentry, keeping the file size so that subsequent
+ * writes go to chunks. If the inline data was modified in the meantime, the
+ * move is repeated. A failed move leaves the inline data in place.
+ * @param path
+ * @return 0 on success or if the data is not stored inline, error code on
+ * failure
+ */
+int
+spill_inline_data(const std::string& path) {
+    auto inline_size = CTX->fs_conf()->inline_data_size;
+    auto buf = std::make_unique<char[]>(inline_size);
+    while(true) {
+        auto ret = gkfs::rpc::forward_read_inline(path, buf.get(), 0,
+                                                  inline_size);
+        // another process moved the data already
+        if(ret.first == gkfs::rpc::inline_data_err)
+            return 0;
+        if(ret.first || ret.second == 0)
+            return ret.first;
+        auto ret_write =
+                gkfs::rpc::forward_write(path, buf.get(), 0, ret.second, 0);
+        if(ret_write.first) {
+            LOG(ERROR, "Failed to move inline data of '{}' to chunks: '{}'",
+                path, ret_write.first);
+            return ret_write.first;
+        }
+        if(gkfs::ec::enabled()) {
+            auto err = gkfs::ec::update_parity(path, buf.get(), 0, ret.second);
+            if(err)
+                return err;
+        }
+        auto err = gkfs::rpc::forward_spill_inline(path, buf.get(), ret.second);
+        if(err != EAGAIN)
+            return err;
+        LOG(DEBUG, "Inline data of '{}' changed while moving it, retrying",
+            path);
+    }
+}
+
+/**
+ * Returns the data generation of a file. Writes, truncates and removes by this
+ * process increment it, so that read-ahead data of the file read before is
+ * dropped. Files share generations by the hash of their path.
+ * @param path
+ * @return generation counter
+ */
+std::atomic<uint64_t>&
+data_generation(const std::string& path) {
+    static std::array<std::atomic<uint64_t>, 256> generations{};
+    return generations[std::hash<std::string>{}(path) % generations.size()];
+}
+
+/**
+ * Drops the client-side state of a file that this process modified: its
+ * cached stat result and its read-ahead data
+ * @param path
+ */
+void
+file_modified(const std::string& path) {
+    data_generation(path)++;
+    gkfs::utils::invalidate_metadata(path);
+}
+
+/**
+ * Copies data to a sequence of buffers
+ * @param data
+ * @param size
+ * @param iov buffers, filled in order
+ * @param iovcnt
+ */
+void
+scatter(const char* data, size_t size, const struct iovec* iov, int iovcnt) {
+    for(int i = 0; i < iovcnt && size > 0; i++) {
+        auto n = std::min(size, iov[i].iov_len);
+        memcpy(iov[i].iov_base, data, n);
+        data += n;
+        size -= n;
+    }
+}
+
+/**
+ * Returns the data of a sequence of buffers in a contiguous buffer
+ * @param iov
+ * @param iovcnt
+ * @return data of all buffers in order
+ */
+std::vector<char>
+gather(const struct iovec* iov, int iovcnt) {
+    std::vector<char> data;
+    for(int i = 0; i < iovcnt; i++) {
+        auto base = static_cast<const char*>(iov[i].iov_base);
+        data.insert(data.end(), base, base + iov[i].iov_len);
+    }
+    return data;
+}
+
+/**
+ * Returns the total size of a sequence of buffers
+ * @param iov
+ * @param iovcnt
+ * @return size in bytes
+ */
+size_t
+iov_size(const struct iovec* iov, int iovcnt) {
+    size_t size = 0;
+    for(int i = 0; i < iovcnt; i++)
+        size += iov[i].iov_len;
+    return size;
+}
+
+/**
+ * Reads data from the daemons, either inline from the file's metadentry or
+ * from its chunks, to a sequence of buffers. errno may be set
+ * @internal
+ * The chunks are read to all buffers with a single read RPC per daemon.
+ * Inline data and data restored from erasure-coded stripes are read to a
+ * contiguous buffer and copied to the buffers.
+ * @endinternal
+ * @param path
+ * @param iov buffers, filled in order
+ * @param iovcnt
+ * @param offset
+ * @return read size or -1 on error
+ */
+ssize_t
+read_through(const std::string& path, const struct iovec* iov, int iovcnt,
+             off64_t offset) {
+    auto count = iov_size(iov, iovcnt);
+    // Zeroing buffer before read is only relevant for sparse files. Otherwise
+    // sparse regions contain invalid data.
+    if constexpr(gkfs::config::io::zero_buffer_before_read) {
+        for(int i = 0; i < iovcnt; i++)
+            memset(iov[i].iov_base, 0, iov[i].iov_len);
+    }
+    auto inline_read =
+            count > 0 && CTX->get_replicas() == 0 &&
+            static_cast<size_t>(offset) < CTX->fs_conf()->inline_data_size;
+    if(iovcnt > 1 && (inline_read || gkfs::ec::enabled())) {
+        std::vector<char> data(count);
+        struct iovec one {
+            data.data(), count
+        };
+        auto ret = read_through(path, &one, 1, offset);
+        if(ret > 0)
+            scatter(data.data(), ret, iov, iovcnt);
+        return ret;
+    }
+    // Small files are read from their metadentry. The daemon rejects the read
+    // if the file's data is stored in chunks
+    if(inline_read) {
+        auto ret_inline = gkfs::rpc::forward_read_inline(
+                path, iov[0].iov_base, offset, count);
+        if(ret_inline.first == 0)
+            return ret_inline.second;
+        if(ret_inline.first != gkfs::rpc::inline_data_err) {
+            LOG(WARNING, "forward_read_inline() failed with ret '{}'",
+                ret_inline.first);
+            errno = ret_inline.first;
+            return -1;
+        }
+    }
+    std::pair<int, off_t> ret;
+    std::set<int8_t> failed; // set with failed targets.
+    // chunks on suspected daemons are read from their other copies
+    if(CTX->get_replicas() != 0) {
+        for(auto host : gkfs::rpc::endpoint_health().suspects())
+            failed.insert(static_cast<int8_t>(host));
+    }
+    for(unsigned int retry = 0;; retry++) {
+        // chunks on failed daemons are read from their other copies
+        ret = gkfs::rpc::forward_readv(path, iov, iovcnt, offset,
+                                       CTX->get_replicas(), failed);
+        // chunks on failed daemons are restored from their stripes
+        if(ret.first == EIO && !failed.empty() && gkfs::ec::enabled()) {
+            LOG(WARNING, "Reading '{}' from erasure-coded stripes", path);
+            ret = gkfs::ec::read_degraded(
+                    path, static_cast<char*>(iov[0].iov_base), offset, count,
+                    failed);
+        }
+        if(ret.first != EIO || retry >= CTX->get_rpc_retries())
+            break;
+        auto backoff = gkfs::rpc::retry_backoff(retry);
+        LOG(WARNING, "Reading '{}' failed. Retrying in {} ms", path,
+            backoff.count());
+        std::this_thread::sleep_for(backoff);
+        // daemons may have recovered
+        failed.clear();
+    }
+
+    auto err = ret.first;
+    if(err) {
+        LOG(WARNING, "gkfs::rpc::forward_read() failed with ret '{}'", err);
+        errno = err;
+        return -1;
+    }
+    // XXX check that we don't try to read past end of the file
+    return ret.second; // return read size
+}
+
+/**
+ * Reads data from the daemons to a buffer. errno may be set
+ * @param path
+ * @param buf
+ * @param count
+ * @param offset
+ * @return read size or -1 on error
+ */
+ssize_t
+read_through(const std::string& path, char* buf, size_t count,
+             off64_t offset) {
+    struct iovec iov {
+        buf, count
+    };
+    return read_through(path, &iov, 1, offset);
+}
+
+/**
+ * Sends the file size reached by writes of this process whose size update was
+ * deferred to the metadata daemon. errno may be set
+ * @param file
+ * @return 0 on success, -1 on failure
+ */
+int
+send_size(gkfs::filemap::OpenFile& file) {
+    auto size = file.take_unsent_size();
+    if(size == 0)
+        return 0;
+    auto path = file.path();
+    auto ret = gkfs::rpc::forward_update_metadentry_size(path, 0, size, false,
+                                                         CTX->get_replicas());
+    gkfs::utils::invalidate_metadata(path);
+    // the file may have been removed in the meantime
+    if(ret.first && ret.first != ENOENT) {
+        LOG(ERROR, "Failed to update the size of '{}': '{}'", path, ret.first);
+        file.raise_unsent_size(size);
+        errno = ret.first;
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * Writes data from a sequence of buffers to the daemons, either inline into
+ * the file's metadentry or to its chunks, and updates the file size once.
+ * With lazy size updates, the file size of non-append writes is recorded in
+ * the open file instead. errno may be set
+ * @internal
+ * The chunks are written from all buffers with a single write RPC per daemon.
+ * Inline data and parity are written from a contiguous copy of the buffers.
+ * @endinternal
+ * @param file
+ * @param iov buffers, written in order
+ * @param iovcnt
+ * @param offset ignored if is_append is set
+ * @param is_append
+ * @return <written size or -1 on error, offset the data was written at>
+ */
+pair<ssize_t, off64_t>
+write_through(gkfs::filemap::OpenFile& file, const struct iovec* iov,
+              int iovcnt, off64_t offset, bool is_append) {
+    auto path = file.path();
+    auto num_replicas = CTX->get_replicas();
+    auto count = iov_size(iov, iovcnt);
+
+    // Small files store their data in their metadentry. The daemon rejects
+    // the write if the file's data is stored in chunks or if it would grow
+    // beyond the inline data size
+    auto inline_size = CTX->fs_conf()->inline_data_size;
+    auto inline_write = inline_size > 0 && num_replicas == 0 && count > 0 &&
+                        (is_append ? count : offset + count) <= inline_size;
+    if(iovcnt > 1 && (inline_write || gkfs::ec::enabled())) {
+        auto data = gather(iov, iovcnt);
+        struct iovec one {
+            data.data(), count
+        };
+        return write_through(file, &one, 1, offset, is_append);
+    }
+    if(inline_write) {
+        auto ret_inline = gkfs::rpc::forward_write_inline(
+                path, iov[0].iov_base, offset, count, is_append);
+        if(ret_inline.first == 0) {
+            file_modified(path);
+            return make_pair(count, ret_inline.second);
+        }
+        if(ret_inline.first != gkfs::rpc::inline_data_err) {
+            LOG(ERROR, "forward_write_inline() failed with err '{}'",
+                ret_inline.first);
+            errno = ret_inline.first;
+            return make_pair(-1, offset);
+        }
+    }
+
+    // The file size reached by non-append writes is only sent later. As
+    // sending it moves inline data to chunks, this requires no inline data
+    auto lazy_size = CTX->get_lazy_size() && inline_size == 0 && !is_append &&
+                     !file.get_flag(gkfs::filemap::OpenFile_flags::sync);
+    if(!lazy_size) {
+        auto ret_offset = gkfs::rpc::forward_update_metadentry_size(
+                path, count, offset, is_append, num_replicas);
+        if(ret_offset.first == gkfs::rpc::inline_data_err) {
+            // the file outgrows its inline data which is moved to chunks first
+            auto spill_err = spill_inline_data(path);
+            if(spill_err) {
+                errno = spill_err;
+                return make_pair(-1, offset);
+            }
+            ret_offset = gkfs::rpc::forward_update_metadentry_size(
+                    path, count, offset, is_append, num_replicas);
+        }
+        auto err = ret_offset.first;
+        if(err) {
+            LOG(ERROR, "update_metadentry_size() failed with err '{}'", err);
+            errno = err;
+            return make_pair(-1, offset);
+        }
+        if(is_append) {
+            // When append is set the EOF is set to the offset
+            // forward_update_metadentry_size returns. This is because it is
+            // an atomic operation on the server and reserves the space for
+            // this append
+            if(ret_offset.second == -1) {
+                LOG(ERROR,
+                    "update_metadentry_size() received -1 as starting offset. "
+                    "This occurs when the staring offset could not be "
+                    "extracted from RocksDB's merge operations. Inform "
+                    "GekkoFS devs.");
+                errno = EIO;
+                return make_pair(-1, offset);
+            }
+            offset = ret_offset.second;
+        }
+    }
+
+    auto ret_write = gkfs::rpc::forward_writev(path, iov, iovcnt, offset, 0);
+    auto err = ret_write.first;
+    auto write_size = ret_write.second;
+
+    // With replica forwarding, the daemons of copy 0 have written the
+    // replicas. The client only writes them itself if this failed
+    if(num_replicas > 0 && (!CTX->get_replica_forwarding() || err)) {
+        auto ret_write_repl = gkfs::rpc::forward_writev(
+                path, iov, iovcnt, offset, num_replicas);
+
+        if(err and ret_write_repl.first == 0) {
+            // We succesfully write the data to some replica
+            err = ret_write_repl.first;
+            // Write size will be wrong
+            write_size = ret_write_repl.second;
+        }
+    }
+
+    // also after failed writes, which may have written some chunks
+    file_modified(path);
+    if(err) {
+        LOG(WARNING, "gkfs::rpc::forward_write() failed with err '{}'", err);
+        errno = err;
+        return make_pair(-1, offset);
+    }
+    if(gkfs::ec::enabled()) {
+        err = gkfs::ec::update_parity(
+                path, static_cast<const char*>(iov[0].iov_base), offset,
+                write_size);
+        if(err) {
+            errno = err;
+            return make_pair(-1, offset);
+        }
+    }
+    if(lazy_size) {
+        file.raise_unsent_size(offset + write_size);
+        // a failed update is retried with the next one
+        auto interval = CTX->get_lazy_size_interval();
+        if(interval.count() > 0 && file.size_update_due(interval))
+            send_size(file);
+    }
+    if(static_cast<size_t>(write_size) != count) {
+        LOG(WARNING,
+            "gkfs::rpc::forward_write() wrote '{}' bytes instead of '{}'",
+            write_size, count);
+    }
+    return make_pair(write_size, offset);
+}
+
+/**
+ * Writes data from a buffer to the daemons, see above. errno may be set
+ * @param file
+ * @param buf
+ * @param count
+ * @param offset ignored if is_append is set
+ * @param is_append
+ * @return <written size or -1 on error, offset the data was written at>
+ */
+pair<ssize_t, off64_t>
+write_through(gkfs::filemap::OpenFile& file, const char* buf, size_t count,
+              off64_t offset, bool is_append) {
+    struct iovec iov {
+        const_cast<char*>(buf), count
+    };
+    return write_through(file, &iov, 1, offset, is_append);
+}
+
+/**
+ * Writes the content of a file's write-back buffer to the daemons and empties
+ * the buffer. The caller must hold the buffer's mutex. errno may be set
+ * @param file
+ * @return 0 on success, -1 on failure
+ */
+int
+flush_write_buffer(gkfs::filemap::OpenFile& file) {
+    auto& wb = file.write_buffer();
+    if(wb.data.empty())
+        return 0;
+    LOG(DEBUG, "Flushing {} buffered bytes at offset {} of '{}'",
+        wb.data.size(), wb.offset, file.path());
+    auto ret = write_through(file, wb.data.data(), wb.data.size(), wb.offset,
+                             false);
+    // Like the kernel's page cache, failed data is not kept around to avoid
+    // reporting the same error on every subsequent flush
+    wb.data.clear();
+    if(ret.first < 0) {
+        LOG(ERROR, "Failed to flush buffered writes of '{}': '{}'",
+            file.path(), strerror(errno));
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * Adds a write to a file's write-back buffer. A write that does not continue
+ * the buffered data flushes the buffer first. The buffer is flushed whenever
+ * it reaches a multiple of the buffer size so that the resulting write RPCs
+ * are aligned to it. The caller must hold the buffer's mutex. errno may be set
+ * @param file
+ * @param buf
+ * @param count
+ * @param offset
+ * @param size buffer size
+ * @return 0 on success, -1 on failure
+ */
+int
+buffer_write(gkfs::filemap::OpenFile& file, const char* buf, size_t count,
+             off64_t offset, size_t size) {
+    auto& wb = file.write_buffer();
+    if(!wb.data.empty() &&
+       offset != wb.offset + static_cast<off64_t>(wb.data.size())) {
+        if(flush_write_buffer(file))
+            return -1;
+    }
+    if(wb.data.empty()) {
+        wb.offset = offset;
+        wb.data.reserve(size);
+    }
+    while(count > 0) {
+        auto end = wb.offset + wb.data.size();
+        auto limit = (wb.offset / size + 1) * size;
+        auto n = std::min(count, static_cast<size_t>(limit - end));
+        wb.data.insert(wb.data.end(), buf, buf + n);
+        buf += n;
+        offset += n;
+        count -= n;
+        if(end + n == limit) {
+            if(flush_write_buffer(file))
+                return -1;
+            wb.offset = offset;
+        }
+    }
+    return 0;
+}
+
+/**
+ * Reads a read-ahead window of a file in the background. The window is not
+ * read if the read-ahead memory budget is exhausted
+ * @param ra read-ahead state of the file
+ * @param path
+ * @param offset
+ * @param size
+ * @param generation data generation of the file
+ * @return true if the window is read
+ */
+bool
+prefetch(gkfs::filemap::ReadAhead& ra, const std::string& path, off64_t offset,
+         size_t size, uint64_t generation) {
+    auto reservation = CTX->read_ahead_budget().reserve(size);
+    if(!reservation) {
+        LOG(DEBUG, "Read-ahead memory budget exhausted");
+        return false;
+    }
+    ra.prefetches.push_back({std::move(reservation), offset, size, generation,
+                             std::vector<char>(size), {}});
+    auto& p = ra.prefetches.back();
+    LOG(DEBUG, "Reading ahead {} bytes at offset {} of '{}'", size, offset,
+        path);
+    p.result = std::async(std::launch::async,
+                          [path, data = p.data.data(), size, offset]() {
+                              return read_through(path, data, size, offset);
+                          });
+    return true;
+}
+
+/**
+ * Serves a read from a file's read-ahead windows as far as possible and reads
+ * the remainder from the daemons. Then, the read is recorded and windows
+ * following the predicted next read are issued. The caller must hold the
+ * read-ahead mutex. errno may be set
+ * @param file
+ * @param buf
+ * @param count
+ * @param offset
+ * @param window read-ahead window size in bytes
+ * @return read size or -1 on error
+ */
+ssize_t
+read_ahead(gkfs::filemap::OpenFile& file, char* buf, size_t count,
+           off64_t offset, size_t window) {
+    auto& ra = file.read_ahead();
+    auto path = file.path();
+    auto generation = data_generation(path).load();
+    // windows read before a write of this process or behind the read are
+    // useless
+    ra.prefetches.remove_if([&](const gkfs::filemap::Prefetch& p) {
+        return p.generation != generation ||
+               p.offset + static_cast<off64_t>(p.size) <= offset;
+    });
+
+    size_t done = 0;
+    auto eof = false;
+    while(done < count && !eof) {
+        auto pos = offset + static_cast<off64_t>(done);
+        auto it = std::find_if(ra.prefetches.begin(), ra.prefetches.end(),
+                               [pos](const gkfs::filemap::Prefetch& p) {
+                                   return p.offset <= pos &&
+                                          pos < p.offset + static_cast<off64_t>(
+                                                                   p.size);
+                               });
+        if(it == ra.prefetches.end())
+            break;
+        if(it->result.valid())
+            it->read_size = it->result.get();
+        if(it->read_size < 0) {
+            // the remainder is read directly, reporting the error if any
+            ra.prefetches.erase(it);
+            break;
+        }
+        auto available = it->offset + it->read_size - pos;
+        auto n = std::min(count - done,
+                          static_cast<size_t>(std::max<off64_t>(available, 0)));
+        memcpy(buf + done, it->data.data() + (pos - it->offset), n);
+        done += n;
+        // a short window ends at the end of the file
+        eof = static_cast<size_t>(it->read_size) < it->size;
+    }
+    ssize_t ret = done;
+    if(done < count && !eof) {
+        auto rest = read_through(path, buf + done, count - done,
+                                 offset + static_cast<off64_t>(done));
+        if(rest < 0 && done == 0)
+            return -1;
+        if(rest > 0)
+            ret += rest;
+    }
+
+    auto next = ra.pattern.record(offset, count);
+    if(next < 0 || ret == 0)
+        return ret;
+    auto chunksize = CTX->fs_conf()->chunksize;
+    // windows end at chunk boundaries so that their RPCs are chunk-aligned
+    auto window_at = [&](off64_t start) {
+        return gkfs::utils::arithmetic::align_left(start, chunksize) + window -
+               start;
+    };
+    auto covers = [next](const gkfs::filemap::Prefetch& p) {
+        return p.offset <= next &&
+               next < p.offset + static_cast<off64_t>(p.size);
+    };
+    if(std::none_of(ra.prefetches.begin(), ra.prefetches.end(), covers)) {
+        // the windows do not hold the next read, e.g., after a seek
+        ra.prefetches.clear();
+        prefetch(ra, path, next, window_at(next), generation);
+    }
+    // strides larger than a window skip the following windows
+    if(next - offset >= static_cast<off64_t>(window))
+        return ret;
+    while(!ra.prefetches.empty() &&
+          ra.prefetches.size() < gkfs::config::io::read_ahead_windows) {
+        auto& last = ra.prefetches.back();
+        // windows beyond the end of the file are not read
+        if(!last.result.valid() &&
+           static_cast<size_t>(last.read_size) < last.size)
+            break;
+        auto start = last.offset + static_cast<off64_t>(last.size);
+        if(!prefetch(ra, path, start, window_at(start), generation))
+            break;
+    }
+    return ret;
+}
+
+
+/**
+ * Writes data from a sequence of buffers to a contiguous range of a file.
+ * errno may be set
+ * @internal
+ * Small writes go to the file's write-back buffer. Otherwise, all buffers are
+ * written with a single write RPC per daemon and a single size update.
+ * @endinternal
+ * @param file
+ * @param iov buffers, written in order
+ * @param iovcnt
+ * @param offset
+ * @param update_pos pos should only be updated for some write operations (see
+ * man 2 pwrite)
+ * @return written size or -1 on error
+ */
+ssize_t
+write_vector(std::shared_ptr<gkfs::filemap::OpenFile> file,
+             const struct iovec* iov, int iovcnt, off64_t offset,
+             bool update_pos) {
+    if(file->type() != gkfs::filemap::FileType::regular) {
+        assert(file->type() == gkfs::filemap::FileType::directory);
+        LOG(WARNING, "Cannot write to directory");
+        errno = EISDIR;
+        return -1;
+    }
+    auto count = iov_size(iov, iovcnt);
+    if(count == 0)
+        return 0;
+    auto is_append = file->get_flag(gkfs::filemap::OpenFile_flags::append);
+    // Small writes are collected in the file's write-back buffer. Appends
+    // must get their offset from the daemon and synchronous writes must be
+    // durable when they return
+    auto buffer_size = CTX->get_write_buffer_size();
+    if(count < buffer_size && !is_append &&
+       !file->get_flag(gkfs::filemap::OpenFile_flags::sync)) {
+        std::lock_guard<std::mutex> lock(file->write_buffer_mutex());
+        auto pos = offset;
+        for(int i = 0; i < iovcnt; i++) {
+            if(buffer_write(*file, static_cast<const char*>(iov[i].iov_base),
+                            iov[i].iov_len, pos, buffer_size))
+                return -1;
+            pos += iov[i].iov_len;
+        }
+        if(update_pos)
+            file->pos(offset + count);
+        return count;
+    }
+    // buffered writes are sent first to keep the order of writes
+    if(buffer_size > 0) {
+        std::lock_guard<std::mutex> lock(file->write_buffer_mutex());
+        if(flush_write_buffer(*file))
+            return -1;
+    }
+    auto ret = write_through(*file, iov, iovcnt, offset, is_append);
+    if(ret.first < 0)
+        return -1;
+    if(update_pos) {
+        // Update offset in file descriptor in the file map
+        file->pos(ret.second + ret.first);
+    }
+    return ret.first; // return written size
+}
+
+/**
+ * Reads a contiguous range of a file to a sequence of buffers.
+ * errno may be set
+ * @internal
+ * All buffers are read with a single read RPC per daemon. With read-ahead,
+ * the read is served to a contiguous buffer and copied to the buffers.
+ * @endinternal
+ * @param file
+ * @param iov buffers, filled in order
+ * @param iovcnt
+ * @param offset
+ * @return read size or -1 on error
+ */
+ssize_t
+read_vector(std::shared_ptr<gkfs::filemap::OpenFile> file,
+            const struct iovec* iov, int iovcnt, off64_t offset) {
+    if(file->type() != gkfs::filemap::FileType::regular) {
+        assert(file->type() == gkfs::filemap::FileType::directory);
+        LOG(WARNING, "Cannot read from directory");
+        errno = EISDIR;
+        return -1;
+    }
+    auto count = iov_size(iov, iovcnt);
+    if(count == 0)
+        return 0;
+    // buffered writes that the read covers must be visible to it
+    if(CTX->get_write_buffer_size() > 0) {
+        std::lock_guard<std::mutex> lock(file->write_buffer_mutex());
+        auto& wb = file->write_buffer();
+        if(!wb.data.empty() &&
+           offset < wb.offset + static_cast<off64_t>(wb.data.size()) &&
+           offset + static_cast<off64_t>(count) > wb.offset &&
+           flush_write_buffer(*file))
+            return -1;
+    }
+
+    auto window = CTX->get_read_ahead();
+    if(window == 0)
+        return read_through(file->path(), iov, iovcnt, offset);
+    auto window_bytes = window * CTX->fs_conf()->chunksize;
+    std::lock_guard<std::mutex> lock(file->read_ahead_mutex());
+    if(iovcnt == 1)
+        return read_ahead(*file, static_cast<char*>(iov[0].iov_base), count,
+                          offset, window_bytes);
+    std::vector<char> data(count);
+    auto ret = read_ahead(*file, data.data(), count, offset, window_bytes);
+    if(ret > 0)
+        scatter(data.data(), ret, iov, iovcnt);
+    return ret;
+}
+
+/**
+ * Transfers data between a sequence of buffers and a list of file ranges. The
+ * buffers are mapped to the ranges in order. Adjacent ranges are transferred
+ * together as a contiguous range. errno may be set
+ * @param fd
+ * @param iov buffers
+ * @param iovcnt
+ * @param extents file ranges
+ * @param extcnt
+ * @param transfer transfers a contiguous range, returning the transferred size
+ * or -1 on error
+ * @return transferred size or -1 on error
+ */
+ssize_t
+list_io(int fd, const struct iovec* iov, int iovcnt,
+        const struct gkfs_extent* extents, int extcnt,
+        const std::function<ssize_t(std::shared_ptr<gkfs::filemap::OpenFile>,
+                                    const struct iovec*, int, off64_t)>&
+                transfer) {
+    auto file = CTX->file_map()->get(fd);
+    if(!file) {
+        errno = EBADF;
+        return -1;
+    }
+    if(iovcnt < 0 || extcnt < 0) {
+        errno = EINVAL;
+        return -1;
+    }
+    size_t size = 0;
+    for(int i = 0; i < extcnt; i++) {
+        if(extents[i].offset < 0) {
+            errno = EINVAL;
+            return -1;
+        }
+        size += extents[i].size;
+    }
+    if(size != iov_size(iov, iovcnt)) {
+        LOG(ERROR, "List I/O of {} bytes to file ranges of {} bytes",
+            iov_size(iov, iovcnt), size);
+        errno = EINVAL;
+        return -1;
+    }
+
+    ssize_t done = 0;
+    // position in the buffers
+    int seg = 0;
+    size_t seg_offset = 0;
+    std::vector<struct iovec> run_iov;
+    for(int i = 0; i < extcnt;) {
+        // adjacent ranges form a run
+        auto offset = extents[i].offset;
+        size_t run_size = 0;
+        do {
+            run_size += extents[i++].size;
+        } while(i < extcnt &&
+                extents[i].offset == offset + static_cast<off64_t>(run_size));
+        // buffer sections of the run
+        run_iov.clear();
+        for(auto left = run_size; left > 0;) {
+            auto n = std::min(left, iov[seg].iov_len - seg_offset);
+            if(n > 0)
+                run_iov.push_back(
+                        {static_cast<char*>(iov[seg].iov_base) + seg_offset,
+                         n});
+            seg_offset += n;
+            left -= n;
+            if(seg_offset == iov[seg].iov_len) {
+                seg++;
+                seg_offset = 0;
+            }
+        }
+        if(run_size == 0)
+            continue;
+        auto ret = transfer(file, run_iov.data(), run_iov.size(), offset);
+        if(ret < 0)
+            return done > 0 ? done : -1;
+        done += ret;
+        if(static_cast<size_t>(ret) < run_size)
+            break;
+    }
+    return done;
+}
+
+/**
+ * Sends buffered writes and deferred size updates of all open files of a path
+ * in this process, so that the daemons know the file's current size
+ * errno may be set
+ * @param path
+ * @return 0 on success, -1 on failure
+ */
+int
+flush_open_files(const std::string& path) {
+    if(CTX->get_write_buffer_size() == 0 && !CTX->get_lazy_size())
+        return 0;
+    for(const auto& file : CTX->file_map()->open_files()) {
+        if(file->path() == path && gkfs::syscall::gkfs_flush(file))
+            return -1;
+    }
+    return 0;
+}
+
 } // namespace
 
 namespace gkfs::syscall {
@@ -309,6 +1133,8 @@ gkfs_create(const std::string& path, mode_t mode) {
             errno = 0;
         }
     }
+    // a cached ENOENT is outdated
+    file_modified(path);
     if(!success) {
         return -1;
     }
@@ -351,6 +1177,7 @@ gkfs_remove(const std::string& path) {
                 }
             }
             auto err = gkfs::rpc::forward_remove(new_path, CTX->get_replicas());
+            file_modified(new_path);
             if(err) {
                 errno = err;
                 return -1;
@@ -360,7 +1187,15 @@ gkfs_remove(const std::string& path) {
 #endif // HAS_RENAME
 #endif // HAS_SYMLINKS
 
+    // deferred sizes must not grow a file created later with the same path
+    if(CTX->get_lazy_size()) {
+        for(const auto& file : CTX->file_map()->open_files()) {
+            if(file->path() == path)
+                file->take_unsent_size();
+        }
+    }
     auto err = gkfs::rpc::forward_remove(path, CTX->get_replicas());
+    file_modified(path);
     if(err) {
         errno = err;
         return -1;
@@ -453,6 +1288,7 @@ gkfs_rename(const string& old_path, const string& new_path) {
 
             auto err = gkfs::rpc::forward_update_metadentry(
                     new_path, md_old.value(), flags, 0);
+            file_modified(new_path);
 
             if(err) {
                 errno = err;
@@ -460,6 +1296,7 @@ gkfs_rename(const string& old_path, const string& new_path) {
             }
             // Delete old file
             err = gkfs::rpc::forward_remove(old_path, CTX->get_replicas());
+            file_modified(old_path);
             if(err) {
                 errno = err;
                 return -1;
@@ -470,6 +1307,8 @@ gkfs_rename(const string& old_path, const string& new_path) {
     }
 
     auto err = gkfs::rpc::forward_rename(old_path, new_path, md_old.value());
+    file_modified(old_path);
+    file_modified(new_path);
     if(err) {
         errno = err;
         return -1;
@@ -490,6 +1329,8 @@ gkfs_rename(const string& old_path, const string& new_path) {
  */
 int
 gkfs_stat(const string& path, struct stat* buf, bool follow_links) {
+    if(flush_open_files(path))
+        return -1;
     auto md = gkfs::utils::get_metadata(path, follow_links);
     if(!md) {
         return -1;
@@ -529,6 +1370,8 @@ gkfs_stat(const string& path, struct stat* buf, bool follow_links) {
 int
 gkfs_statx(int dirfs, const std::string& path, int flags, unsigned int mask,
            struct statx* buf, bool follow_links) {
+    if(flush_open_files(path))
+        return -1;
     auto md = gkfs::utils::get_metadata(path, follow_links);
 
     if(!md) {
@@ -673,6 +1516,9 @@ gkfs_lseek(unsigned int fd, off_t offset, unsigned int whence) {
 off_t
 gkfs_lseek(shared_ptr<gkfs::filemap::OpenFile> gkfs_fd, off_t offset,
            unsigned int whence) {
+    // the file size known to the daemons must include all writes
+    if(whence == SEEK_END && flush_open_files(gkfs_fd->path()))
+        return -1;
     switch(whence) {
         case SEEK_SET:
             if(offset < 0) {
@@ -686,8 +1532,16 @@ gkfs_lseek(shared_ptr<gkfs::filemap::OpenFile> gkfs_fd, off_t offset,
             break;
         case SEEK_END: {
             // TODO: handle replicas
-            auto ret =
-                    gkfs::rpc::forward_get_metadentry_size(gkfs_fd->path(), 0);
+            std::pair<int, off64_t> ret;
+            if(CTX->attr_cache()) {
+                // the size may be served by the attribute cache
+                auto md = gkfs::utils::get_metadata(gkfs_fd->path());
+                ret = md ? std::make_pair(0, static_cast<off64_t>(md->size()))
+                         : std::make_pair(errno, off64_t{0});
+            } else {
+                ret = gkfs::rpc::forward_get_metadentry_size(gkfs_fd->path(),
+                                                             0);
+            }
             auto err = ret.first;
             if(err) {
                 errno = err;
@@ -747,11 +1601,20 @@ gkfs_truncate(const std::string& path, off_t old_size, off_t new_size) {
 
     auto err = gkfs::rpc::forward_truncate(path, old_size, new_size,
                                            CTX->get_replicas());
+    file_modified(path);
     if(err) {
         LOG(DEBUG, "Failed to truncate data");
         errno = err;
         return -1;
     }
+    if(gkfs::ec::enabled()) {
+        err = gkfs::ec::truncate_parity(path, old_size, new_size);
+        if(err) {
+            LOG(DEBUG, "Failed to truncate parity");
+            errno = err;
+            return -1;
+        }
+    }
     return 0;
 }
 
@@ -777,6 +1640,9 @@ gkfs_truncate(const std::string& path, off_t length) {
         errno = EINVAL;
         return -1;
     }
+    // writes of this process must not extend the file after the truncate
+    if(flush_open_files(path))
+        return -1;
 
     auto md = gkfs::utils::get_metadata(path, true);
     if(!md) {
@@ -825,16 +1691,76 @@ gkfs_truncate(const std::string& path, off_t length) {
             errno = ENOMEM;
             return -1;
         }
-        if(gkfs_write(output_fd, buf.get(), (size_t) n) != n) {
-            errno = EINVAL;
+        // the zeroes may still be in the write-back buffer and the new size
+        // may be deferred (LIBGKFS_LAZY_SIZE). Both are dropped with the file
+        // descriptor and must therefore be flushed first
+        auto err = 0;
+        if(gkfs_write(output_fd, buf.get(), (size_t) n) != n)
+            err = EINVAL;
+        else if(gkfs_flush(CTX->file_map()->get(output_fd)))
+            err = errno;
+        CTX->file_map()->remove(output_fd);
+        if(err) {
+            errno = err;
             return -1;
         }
-        CTX->file_map()->remove(output_fd);
         return 0;
     }
     return gkfs_truncate(path, size, length);
 }
 
+/**
+ * gkfs wrapper for fsync() and fdatasync() system calls
+ * errno may be set
+ * @param file
+ * @return 0 on success, -1 on failure
+ */
+int
+gkfs_fsync(std::shared_ptr<gkfs::filemap::OpenFile> file) {
+    // directories have no data, their metadata is persisted by the KV store
+    if(file->type() != gkfs::filemap::FileType::regular) {
+        return 0;
+    }
+    if(gkfs_flush(file))
+        return -1;
+    auto md = gkfs::utils::get_metadata(file->path());
+    if(!md) {
+        return -1;
+    }
+    auto err = gkfs::rpc::forward_fsync(file->path(), md->size(),
+                                        CTX->get_replicas());
+    if(!err && gkfs::ec::enabled()) {
+        err = gkfs::rpc::forward_fsync(gkfs::ec::parity_path(file->path()),
+                                       gkfs::ec::parity_size(md->size()), 0);
+    }
+    if(err) {
+        LOG(ERROR, "Failed to flush file '{}': '{}'", file->path(),
+            strerror(err));
+        errno = err;
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * Writes the content of a file's write-back buffer to the daemons and sends
+ * the file size reached by its writes if it was deferred
+ * errno may be set
+ * @param file
+ * @return 0 on success, -1 on failure
+ */
+int
+gkfs_flush(std::shared_ptr<gkfs::filemap::OpenFile> file) {
+    if(file->type() != gkfs::filemap::FileType::regular)
+        return 0;
+    if(CTX->get_write_buffer_size() > 0) {
+        std::lock_guard<std::mutex> lock(file->write_buffer_mutex());
+        if(flush_write_buffer(*file))
+            return -1;
+    }
+    return send_size(*file);
+}
+
 /**
  * gkfs wrapper for dup() system calls
  * errno may be set
@@ -872,71 +1798,10 @@ gkfs_dup2(const int oldfd, const int newfd) {
 ssize_t
 gkfs_pwrite(std::shared_ptr<gkfs::filemap::OpenFile> file, const char* buf,
             size_t count, off64_t offset, bool update_pos) {
-    if(file->type() != gkfs::filemap::FileType::regular) {
-        assert(file->type() == gkfs::filemap::FileType::directory);
-        LOG(WARNING, "Cannot write to directory");
-        errno = EISDIR;
-        return -1;
-    }
-    auto path = make_unique<string>(file->path());
-    auto is_append = file->get_flag(gkfs::filemap::OpenFile_flags::append);
-    auto write_size = 0;
-    auto num_replicas = CTX->get_replicas();
-
-    auto ret_offset = gkfs::rpc::forward_update_metadentry_size(
-            *path, count, offset, is_append, num_replicas);
-    auto err = ret_offset.first;
-    if(err) {
-        LOG(ERROR, "update_metadentry_size() failed with err '{}'", err);
-        errno = err;
-        return -1;
-    }
-    if(is_append) {
-        // When append is set the EOF is set to the offset
-        // forward_update_metadentry_size returns. This is because it is an
-        // atomic operation on the server and reserves the space for this append
-        if(ret_offset.second == -1) {
-            LOG(ERROR,
-                "update_metadentry_size() received -1 as starting offset. "
-                "This occurs when the staring offset could not be extracted "
-                "from RocksDB's merge operations. Inform GekkoFS devs.");
-            errno = EIO;
-            return -1;
-        }
-        offset = ret_offset.second;
-    }
-
-    auto ret_write = gkfs::rpc::forward_write(*path, buf, offset, count, 0);
-    err = ret_write.first;
-    write_size = ret_write.second;
-
-    if(num_replicas > 0) {
-        auto ret_write_repl = gkfs::rpc::forward_write(*path, buf, offset,
-                                                       count, num_replicas);
-
-        if(err and ret_write_repl.first == 0) {
-            // We succesfully write the data to some replica
-            err = ret_write_repl.first;
-            // Write size will be wrong
-            write_size = ret_write_repl.second;
-        }
-    }
-
-    if(err) {
-        LOG(WARNING, "gkfs::rpc::forward_write() failed with err '{}'", err);
-        errno = err;
-        return -1;
-    }
-    if(update_pos) {
-        // Update offset in file descriptor in the file map
-        file->pos(offset + write_size);
-    }
-    if(static_cast<size_t>(write_size) != count) {
-        LOG(WARNING,
-            "gkfs::rpc::forward_write() wrote '{}' bytes instead of '{}'",
-            write_size, count);
-    }
-    return write_size; // return written size
+    struct iovec iov {
+        const_cast<char*>(buf), count
+    };
+    return write_vector(file, &iov, 1, offset, update_pos);
 }
 
 /**
@@ -982,33 +1847,8 @@ gkfs_write(int fd, const void* buf, size_t count) {
  */
 ssize_t
 gkfs_pwritev(int fd, const struct iovec* iov, int iovcnt, off_t offset) {
-
     auto file = CTX->file_map()->get(fd);
-    auto pos = offset; // keep track of current position
-    ssize_t written = 0;
-    ssize_t ret;
-    for(int i = 0; i < iovcnt; ++i) {
-        auto count = (iov + i)->iov_len;
-        if(count == 0) {
-            continue;
-        }
-        auto buf = (iov + i)->iov_base;
-        ret = gkfs_pwrite(file, reinterpret_cast<char*>(buf), count, pos);
-        if(ret == -1) {
-            break;
-        }
-        written += ret;
-        pos += ret;
-
-        if(static_cast<size_t>(ret) < count) {
-            break;
-        }
-    }
-
-    if(written == 0) {
-        return -1;
-    }
-    return written;
+    return write_vector(file, iov, iovcnt, offset, false);
 }
 
 /**
@@ -1021,16 +1861,9 @@ gkfs_pwritev(int fd, const struct iovec* iov, int iovcnt, off_t offset) {
  */
 ssize_t
 gkfs_writev(int fd, const struct iovec* iov, int iovcnt) {
-
     auto gkfs_fd = CTX->file_map()->get(fd);
-    auto pos = gkfs_fd->pos(); // retrieve the current offset
-    auto ret = gkfs_pwritev(fd, iov, iovcnt, pos);
-    assert(ret != 0);
-    if(ret < 0) {
-        return -1;
-    }
-    gkfs_fd->pos(pos + ret);
-    return ret;
+    // call pwritev and update pos
+    return write_vector(gkfs_fd, iov, iovcnt, gkfs_fd->pos(), true);
 }
 
 /**
@@ -1044,44 +1877,10 @@ gkfs_writev(int fd, const struct iovec* iov, int iovcnt) {
 ssize_t
 gkfs_pread(std::shared_ptr<gkfs::filemap::OpenFile> file, char* buf,
            size_t count, off64_t offset) {
-    if(file->type() != gkfs::filemap::FileType::regular) {
-        assert(file->type() == gkfs::filemap::FileType::directory);
-        LOG(WARNING, "Cannot read from directory");
-        errno = EISDIR;
-        return -1;
-    }
-
-    // Zeroing buffer before read is only relevant for sparse files. Otherwise
-    // sparse regions contain invalid data.
-    if constexpr(gkfs::config::io::zero_buffer_before_read) {
-        memset(buf, 0, sizeof(char) * count);
-    }
-    std::pair<int, off_t> ret;
-    std::set<int8_t> failed; // set with failed targets.
-    if(CTX->get_replicas() != 0) {
-
-        ret = gkfs::rpc::forward_read(file->path(), buf, offset, count,
-                                      CTX->get_replicas(), failed);
-        while(ret.first == EIO) {
-            ret = gkfs::rpc::forward_read(file->path(), buf, offset, count,
-                                          CTX->get_replicas(), failed);
-            LOG(WARNING, "gkfs::rpc::forward_read() failed with ret '{}'",
-                ret.first);
-        }
-
-    } else {
-        ret = gkfs::rpc::forward_read(file->path(), buf, offset, count, 0,
-                                      failed);
-    }
-
-    auto err = ret.first;
-    if(err) {
-        LOG(WARNING, "gkfs::rpc::forward_read() failed with ret '{}'", err);
-        errno = err;
-        return -1;
-    }
-    // XXX check that we don't try to read past end of the file
-    return ret.second; // return read size
+    struct iovec iov {
+        buf, count
+    };
+    return read_vector(file, &iov, 1, offset);
 }
 
 /**
@@ -1115,33 +1914,8 @@ gkfs_read(int fd, void* buf, size_t count) {
  */
 ssize_t
 gkfs_preadv(int fd, const struct iovec* iov, int iovcnt, off_t offset) {
-
     auto file = CTX->file_map()->get(fd);
-    auto pos = offset; // keep track of current position
-    ssize_t read = 0;
-    ssize_t ret;
-    for(int i = 0; i < iovcnt; ++i) {
-        auto count = (iov + i)->iov_len;
-        if(count == 0) {
-            continue;
-        }
-        auto buf = (iov + i)->iov_base;
-        ret = gkfs_pread(file, reinterpret_cast<char*>(buf), count, pos);
-        if(ret == -1) {
-            break;
-        }
-        read += ret;
-        pos += ret;
-
-        if(static_cast<size_t>(ret) < count) {
-            break;
-        }
-    }
-
-    if(read == 0) {
-        return -1;
-    }
-    return read;
+    return read_vector(file, iov, iovcnt, offset);
 }
 
 /**
@@ -1158,11 +1932,10 @@ gkfs_readv(int fd, const struct iovec* iov, int iovcnt) {
     auto gkfs_fd = CTX->file_map()->get(fd);
     auto pos = gkfs_fd->pos(); // retrieve the current offset
     auto ret = gkfs_preadv(fd, iov, iovcnt, pos);
-    assert(ret != 0);
-    if(ret < 0) {
-        return -1;
+    // Update offset in file descriptor in the file map
+    if(ret > 0) {
+        gkfs_fd->pos(pos + ret);
     }
-    gkfs_fd->pos(pos + ret);
     return ret;
 }
 
@@ -1242,6 +2015,7 @@ gkfs_rmdir(const std::string& path) {
         return -1;
     }
     err = gkfs::rpc::forward_remove(path, CTX->get_replicas());
+    file_modified(path);
     if(err) {
         errno = err;
         return -1;
@@ -1437,6 +2211,7 @@ gkfs_mk_symlink(const std::string& path, const std::string& target_path) {
     }
 
     auto err = gkfs::rpc::forward_mk_symlink(path, target_path);
+    file_modified(path);
     if(err) {
         errno = err;
         return -1;
@@ -1538,3 +2313,26 @@ gkfs_getsingleserverdir(const char* path, struct dirent_extended* dirp,
     }
     return written;
 }
+
+/* List I/O transfers data between memory buffers and a list of non-contiguous
+ * file ranges, e.g., for MPI-IO. Adjacent file ranges are transferred as one
+ * vectored I/O operation
+ */
+extern "C" ssize_t
+gkfs_pwritelist(int fd, const struct iovec* iov, int iovcnt,
+                const struct gkfs_extent* extents, int extcnt) {
+    return list_io(fd, iov, iovcnt, extents, extcnt,
+                   [](auto file, auto run_iov, auto run_iovcnt, auto offset) {
+                       return write_vector(file, run_iov, run_iovcnt, offset,
+                                           false);
+                   });
+}
+
+extern "C" ssize_t
+gkfs_preadlist(int fd, const struct iovec* iov, int iovcnt,
+               const struct gkfs_extent* extents, int extcnt) {
+    return list_io(fd, iov, iovcnt, extents, extcnt,
+                   [](auto file, auto run_iov, auto run_iovcnt, auto offset) {
+                       return read_vector(file, run_iov, run_iovcnt, offset);
+                   });
+}
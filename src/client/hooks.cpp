@@ -92,8 +92,15 @@ hook_close(int fd) {
     LOG(DEBUG, "{}() called with fd: {}", __func__, fd);
 
     if(CTX->file_map()->exist(fd)) {
-        // No call to the daemon is required
+        auto file = CTX->file_map()->get(fd);
         CTX->file_map()->remove(fd);
+        if(gkfs::syscall::gkfs_flush(file)) {
+            return with_errno(-1);
+        }
+        // Data of files opened with O_SYNC or O_DSYNC must be durable on close
+        if(file->get_flag(gkfs::filemap::OpenFile_flags::sync)) {
+            return with_errno(gkfs::syscall::gkfs_fsync(file));
+        }
         return 0;
     }
 
@@ -180,7 +187,12 @@ hook_fstat(unsigned int fd, struct stat* buf) {
     LOG(DEBUG, "{}() called with fd: {}, buf: {}", __func__, fd, fmt::ptr(buf));
 
     if(CTX->file_map()->exist(fd)) {
-        auto path = CTX->file_map()->get(fd)->path();
+        auto file = CTX->file_map()->get(fd);
+        // the size must include buffered writes
+        if(gkfs::syscall::gkfs_flush(file)) {
+            return with_errno(-1);
+        }
+        auto path = file->path();
 #ifdef HAS_RENAME
         // Special case for fstat and rename, fd points to new file...
         // We can change file_map and recall
@@ -536,8 +548,12 @@ hook_ftruncate(unsigned int fd, unsigned long length) {
     LOG(DEBUG, "{}() called with fd: {}, offset: {}", __func__, fd, length);
 
     if(CTX->file_map()->exist(fd)) {
-        auto path = CTX->file_map()->get(fd)->path();
-        return with_errno(gkfs::syscall::gkfs_truncate(path, length));
+        auto file = CTX->file_map()->get(fd);
+        // buffered writes must not be applied after the truncation
+        if(gkfs::syscall::gkfs_flush(file)) {
+            return with_errno(-1);
+        }
+        return with_errno(gkfs::syscall::gkfs_truncate(file->path(), length));
     }
     return syscall_no_intercept_wrapper(SYS_ftruncate, fd, length);
 }
@@ -962,16 +978,15 @@ hook_fstatfs(unsigned int fd, struct statfs* buf) {
     return syscall_no_intercept_wrapper(SYS_fstatfs, fd, buf);
 }
 
-/* The function should broadcast a flush message (pmem_persist i.e.) if the
- * application needs the capabilities*/
+/* Broadcasts a flush to all daemons storing data of the file. Also serves
+ * fdatasync() as file metadata is persisted by the KV store on every update */
 int
 hook_fsync(unsigned int fd) {
 
     LOG(DEBUG, "{}() called with fd: {}", __func__, fd);
 
     if(CTX->file_map()->exist(fd)) {
-        errno = 0;
-        return 0;
+        return with_errno(gkfs::syscall::gkfs_fsync(CTX->file_map()->get(fd)));
     }
 
     return syscall_no_intercept_wrapper(SYS_fsync, fd);
@@ -33,6 +33,8 @@
 #include <client/preload_util.hpp>
 #include <client/logging.hpp>
 
+#include <algorithm>
+
 extern "C" {
 #include <fcntl.h>
 }
@@ -56,8 +58,12 @@ OpenFile::OpenFile(const string& path, const int flags, FileType type)
         flags_[gkfs::utils::to_underlying(OpenFile_flags::wronly)] = true;
     if(flags & O_RDWR)
         flags_[gkfs::utils::to_underlying(OpenFile_flags::rdwr)] = true;
+    // O_SYNC includes the O_DSYNC bit
+    if(flags & O_DSYNC)
+        flags_[gkfs::utils::to_underlying(OpenFile_flags::sync)] = true;
 
     pos_ = 0; // If O_APPEND flag is used, it will be used before each write.
+    size_sent_ = chrono::steady_clock::now().time_since_epoch().count();
 }
 
 OpenFileMap::OpenFileMap() : fd_idx(10000), fd_validation_needed(false) {}
@@ -101,6 +107,50 @@ OpenFile::type() const {
     return type_;
 }
 
+WriteBuffer&
+OpenFile::write_buffer() {
+    return write_buffer_;
+}
+
+std::mutex&
+OpenFile::write_buffer_mutex() {
+    return write_buffer_mutex_;
+}
+
+ReadAhead&
+OpenFile::read_ahead() {
+    return read_ahead_;
+}
+
+std::mutex&
+OpenFile::read_ahead_mutex() {
+    return read_ahead_mutex_;
+}
+
+void
+OpenFile::raise_unsent_size(off64_t size) {
+    auto unsent = unsent_size_.load();
+    while(unsent < size && !unsent_size_.compare_exchange_weak(unsent, size))
+        ;
+}
+
+off64_t
+OpenFile::take_unsent_size() {
+    return unsent_size_.exchange(0);
+}
+
+bool
+OpenFile::size_update_due(chrono::milliseconds interval) {
+    auto now = chrono::steady_clock::now().time_since_epoch().count();
+    auto sent = size_sent_.load();
+    auto period =
+            chrono::duration_cast<chrono::steady_clock::duration>(interval)
+                    .count();
+    // only the thread that moves the timestamp sends the size
+    return now - sent >= period &&
+           size_sent_.compare_exchange_strong(sent, now);
+}
+
 // OpenFileMap starts here
 
 shared_ptr<OpenFile>
@@ -239,4 +289,17 @@ OpenFileMap::get_fd_idx() {
     return fd_idx;
 }
 
+vector<shared_ptr<OpenFile>>
+OpenFileMap::open_files() {
+    lock_guard<recursive_mutex> lock(files_mutex_);
+    vector<shared_ptr<OpenFile>> files;
+    files.reserve(files_.size());
+    for(const auto& [fd, file] : files_) {
+        // dup()ed fds share their file
+        if(find(files.begin(), files.end(), file) == files.end())
+            files.push_back(file);
+    }
+    return files;
+}
+
 } // namespace gkfs::filemap
\ No newline at end of file
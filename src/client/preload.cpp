@@ -33,6 +33,8 @@
 #include <client/rpc/forward_management.hpp>
 #include <client/preload_util.hpp>
 #include <client/intercept.hpp>
+#include <client/gkfs_functions.hpp>
+#include <client/open_file_map.hpp>
 
 #include <common/rpc/distributor.hpp>
 #include <common/common_defs.hpp>
@@ -239,10 +241,28 @@ init_environment() {
                 EXIT_FAILURE,
                 "Unable to fetch file system configurations from daemon process through RPC.");
     }
-    // Initialize random number generator and seed for replica selection
-    // in case of failure, a new replica will be selected
-    if(CTX->get_replicas() > 0) {
-        srand(time(nullptr));
+    if(CTX->fs_conf()->ec_data_shards > 0) {
+#ifdef GKFS_ENABLE_FORWARDING
+        LOG(WARNING, "Erasure coding is not supported with forwarding");
+        CTX->fs_conf()->ec_data_shards = 0;
+        CTX->fs_conf()->ec_parity_shards = 0;
+#else
+        // the chunks of a stripe are placed on distinct daemons
+        auto k = CTX->fs_conf()->ec_data_shards;
+        auto m = CTX->fs_conf()->ec_parity_shards;
+        CTX->distributor(std::make_shared<gkfs::rpc::StripeDistributor>(
+                CTX->local_host_id(), CTX->hosts().size(), k, m));
+        if(CTX->hosts().size() < k + m) {
+            LOG(WARNING,
+                "Erasure coding {}+{} with {} daemons does not survive the loss of {} daemons",
+                k, m, CTX->hosts().size(), m);
+        }
+        if(CTX->get_replicas() > 0) {
+            LOG(WARNING, "Erasure coding replaces replication. Disabling it");
+            CTX->set_replicas(0);
+        }
+        LOG(INFO, "Erasure coding: {}+{}", k, m);
+#endif
     }
 
     LOG(INFO, "Environment initialization successful.");
@@ -303,6 +323,20 @@ init_preload() {
  */
 void
 destroy_preload() {
+    // write buffered data and deferred sizes of files the application did
+    // not close and wait for their read-ahead before the RPC subsystem shuts
+    // down
+    for(const auto& file : CTX->file_map()->open_files()) {
+        if(gkfs::syscall::gkfs_flush(file))
+            LOG(ERROR, "Failed to flush writes of '{}'", file->path());
+        std::lock_guard<std::mutex> lock(file->read_ahead_mutex());
+        file->read_ahead().prefetches.clear();
+    }
+    if(auto* cache = CTX->attr_cache()) {
+        auto stats = cache->stats();
+        LOG(INFO, "Attribute cache: {} hits, {} misses, {} evictions",
+            stats.hits, stats.misses, stats.evictions);
+    }
 #ifdef GKFS_ENABLE_FORWARDING
     destroy_forwarding_mapper();
 #endif
@@ -67,6 +67,72 @@ PreloadContext::PreloadContext()
     hostname = host;
     PreloadContext::set_replicas(
             std::stoi(gkfs::env::get_var(gkfs::env::NUM_REPL, "0")));
+    const auto forwarding = gkfs::env::get_var(gkfs::env::REPL_FORWARDING);
+    PreloadContext::set_replica_forwarding(!forwarding.empty() &&
+                                           forwarding[0] != '0');
+    // 0 or an invalid quorum waits for all copies
+    PreloadContext::set_write_quorum(std::atoi(
+            gkfs::env::get_var(gkfs::env::REPL_WRITE_QUORUM, "0").c_str()));
+    // per-operation timeouts default to LIBGKFS_RPC_TIMEOUT
+    const auto rpc_timeout = gkfs::env::get_var(gkfs::env::RPC_TIMEOUT, "0");
+    const std::pair<RpcOp, const char*> timeout_vars[] = {
+            {RpcOp::metadata, gkfs::env::METADATA_TIMEOUT},
+            {RpcOp::read, gkfs::env::READ_TIMEOUT},
+            {RpcOp::write, gkfs::env::WRITE_TIMEOUT},
+            {RpcOp::dirents, gkfs::env::DIRENTS_TIMEOUT}};
+    for(const auto& [op, var] : timeout_vars) {
+        PreloadContext::set_rpc_timeout(
+                op, std::strtoul(gkfs::env::get_var(var, rpc_timeout).c_str(),
+                                 nullptr, 10));
+    }
+    PreloadContext::set_rpc_retries(std::strtoul(
+            gkfs::env::get_var(gkfs::env::RPC_RETRIES,
+                               std::to_string(gkfs::config::rpc::rpc_retries))
+                    .c_str(),
+            nullptr, 10));
+    PreloadContext::set_read_hedge_percentile(std::atof(
+            gkfs::env::get_var(gkfs::env::READ_HEDGE_PERCENTILE, "0")
+                    .c_str()));
+    const auto write_buffer = gkfs::env::get_var(gkfs::env::WRITE_BUFFER);
+    PreloadContext::set_write_buffer(!write_buffer.empty() &&
+                                     write_buffer[0] != '0');
+    PreloadContext::set_write_buffer_size(std::strtoull(
+            gkfs::env::get_var(gkfs::env::WRITE_BUFFER_SIZE, "0").c_str(),
+            nullptr, 10));
+    PreloadContext::set_read_ahead(std::strtoul(
+            gkfs::env::get_var(gkfs::env::READ_AHEAD, "0").c_str(), nullptr,
+            10));
+    read_ahead_budget_.set_limit(std::strtoull(
+            gkfs::env::get_var(
+                    gkfs::env::READ_AHEAD_MEMORY,
+                    std::to_string(gkfs::config::io::read_ahead_memory))
+                    .c_str(),
+            nullptr, 10));
+    const auto lazy_size = gkfs::env::get_var(gkfs::env::LAZY_SIZE);
+    PreloadContext::set_lazy_size(!lazy_size.empty() && lazy_size[0] != '0');
+    PreloadContext::set_lazy_size_interval(
+            std::chrono::milliseconds(std::strtoul(
+                    gkfs::env::get_var(
+                            gkfs::env::LAZY_SIZE_INTERVAL,
+                            std::to_string(gkfs::config::metadata::
+                                                   lazy_size_interval_ms))
+                            .c_str(),
+                    nullptr, 10)));
+    // stat results are cached for the TTL in ms, 0 disables the cache
+    auto attr_cache_ttl = std::strtoul(
+            gkfs::env::get_var(gkfs::env::ATTR_CACHE_TTL, "0").c_str(),
+            nullptr, 10);
+    if(attr_cache_ttl > 0) {
+        auto attr_cache_size = std::strtoull(
+                gkfs::env::get_var(
+                        gkfs::env::ATTR_CACHE_SIZE,
+                        std::to_string(gkfs::config::metadata::attr_cache_size))
+                        .c_str(),
+                nullptr, 10);
+        attr_cache_ = std::make_unique<gkfs::metadata::AttributeCache>(
+                attr_cache_size, gkfs::config::metadata::attr_cache_shards,
+                std::chrono::milliseconds(attr_cache_ttl));
+    }
 }
 
 void
@@ -464,5 +530,118 @@ PreloadContext::get_replicas() {
     return replicas_;
 }
 
+void
+PreloadContext::set_replica_forwarding(bool forwarding) {
+    replica_forwarding_ = forwarding;
+}
+
+bool
+PreloadContext::get_replica_forwarding() {
+    return replica_forwarding_;
+}
+
+void
+PreloadContext::set_write_quorum(int quorum) {
+    if(quorum <= 0 || quorum > replicas_ + 1)
+        quorum = replicas_ + 1;
+    write_quorum_ = quorum;
+}
+
+int
+PreloadContext::get_write_quorum() {
+    return write_quorum_;
+}
+
+void
+PreloadContext::set_rpc_timeout(RpcOp op, unsigned int timeout_ms) {
+    rpc_timeouts_ms_.at(static_cast<size_t>(op)) = timeout_ms;
+}
+
+unsigned int
+PreloadContext::get_rpc_timeout(RpcOp op) {
+    return rpc_timeouts_ms_.at(static_cast<size_t>(op));
+}
+
+void
+PreloadContext::set_rpc_retries(unsigned int retries) {
+    rpc_retries_ = retries;
+}
+
+unsigned int
+PreloadContext::get_rpc_retries() {
+    return rpc_retries_;
+}
+
+void
+PreloadContext::set_write_buffer(bool write_buffer) {
+    write_buffer_ = write_buffer;
+}
+
+void
+PreloadContext::set_write_buffer_size(size_t size) {
+    write_buffer_size_ = size;
+}
+
+size_t
+PreloadContext::get_write_buffer_size() {
+    if(!write_buffer_)
+        return 0;
+    // the chunksize is only known once the daemon's configuration was read
+    return write_buffer_size_ ? write_buffer_size_ : fs_conf_->chunksize;
+}
+
+void
+PreloadContext::set_read_ahead(unsigned int chunks) {
+    read_ahead_ = chunks;
+}
+
+unsigned int
+PreloadContext::get_read_ahead() {
+    return read_ahead_;
+}
+
+gkfs::read_ahead::MemoryBudget&
+PreloadContext::read_ahead_budget() {
+    return read_ahead_budget_;
+}
+
+void
+PreloadContext::set_lazy_size(bool lazy_size) {
+    lazy_size_ = lazy_size;
+}
+
+bool
+PreloadContext::get_lazy_size() {
+    return lazy_size_;
+}
+
+void
+PreloadContext::set_lazy_size_interval(std::chrono::milliseconds interval) {
+    lazy_size_interval_ = interval;
+}
+
+std::chrono::milliseconds
+PreloadContext::get_lazy_size_interval() {
+    return lazy_size_interval_;
+}
+
+gkfs::metadata::AttributeCache*
+PreloadContext::attr_cache() {
+    return attr_cache_.get();
+}
+
+void
+PreloadContext::set_read_hedge_percentile(double percentile) {
+    // invalid percentiles disable hedging
+    if(!(percentile > 0 && percentile <= 100))
+        percentile = 0;
+    read_hedge_percentile_ = percentile;
+}
+
+double
+PreloadContext::get_read_hedge_percentile() {
+    return read_hedge_percentile_;
+}
+
 } // namespace preload
 } // namespace gkfs
@@ -31,6 +31,7 @@
 #include <client/env.hpp>
 #include <client/logging.hpp>
 #include <client/rpc/forward_metadata.hpp>
+#include <client/rpc/rpc_call.hpp>
 
 #include <common/rpc/distributor.hpp>
 #include <common/rpc/rpc_util.hpp>
@@ -39,7 +40,9 @@
 
 #include <hermes.hpp>
 
+#include <algorithm>
 #include <fstream>
+#include <numeric>
 #include <sstream>
 #include <regex>
 #include <csignal>
@@ -202,38 +205,65 @@ namespace gkfs::utils {
 optional<gkfs::metadata::Metadata>
 get_metadata(const string& path, bool follow_links) {
     std::string attr;
-    auto err = gkfs::rpc::forward_stat(path, attr, 0);
-    // TODO: retry on failure
-
-    if(err) {
-        auto copy = 1;
-        while(copy < CTX->get_replicas() + 1 && err) {
-            LOG(ERROR, "Retrying Stat on replica {} {}", copy, follow_links);
+    auto err = 0;
+    auto* cache = CTX->attr_cache();
+    auto cached = cache ? cache->get(path) : std::nullopt;
+    if(cached) {
+        err = cached->err;
+        attr = std::move(cached->attr);
+    } else {
+        // replicas on suspected daemons are asked last
+        std::vector<int> copies(CTX->get_replicas() + 1);
+        std::iota(copies.begin(), copies.end(), 0);
+        std::stable_partition(copies.begin(), copies.end(), [&path](int copy) {
+            return !gkfs::rpc::endpoint_health().suspect(
+                    CTX->distributor()->locate_file_metadata(path, copy));
+        });
+        for(auto copy : copies) {
+            if(copy != copies.front())
+                LOG(ERROR, "Retrying Stat on replica {} {}", copy,
+                    follow_links);
             err = gkfs::rpc::forward_stat(path, attr, copy);
-            copy++;
-        }
-        if(err) {
-            errno = err;
-            return {};
+            if(!err)
+                break;
         }
+        // only missing paths are cached as errors
+        if(cache && (!err || err == ENOENT))
+            cache->put(path, {err, err ? std::string{} : attr});
+    }
+    if(err) {
+        errno = err;
+        return {};
     }
 #ifdef HAS_SYMLINKS
     if(follow_links) {
         gkfs::metadata::Metadata md{attr};
         while(md.is_link()) {
-            err = gkfs::rpc::forward_stat(md.target_path(), attr, 0);
-            if(err) {
-                errno = err;
+            // link targets are looked up in the attribute cache as well
+            auto target = get_metadata(md.target_path(), false);
+            if(!target)
                 return {};
-            }
-            md = gkfs::metadata::Metadata{attr};
+            md = std::move(target.value());
         }
+        return md;
     }
 #endif
     return gkfs::metadata::Metadata{attr};
 }
 
 
+/**
+ * Removes the cached stat result of a path after it was modified by this
+ * process
+ * @param path
+ */
+void
+invalidate_metadata(const std::string& path) {
+    if(auto* cache = CTX->attr_cache())
+        cache->invalidate(path);
+}
+
+
 /**
  * Converts the Metadata object into a stat struct, which is needed by Linux
  * @param path
@@ -252,7 +282,7 @@ metadata_to_stat(const std::string& path, const gkfs::metadata::Metadata& md,
     attr.st_uid = CTX->fs_conf()->uid;
     attr.st_gid = CTX->fs_conf()->gid;
     attr.st_rdev = 0;
-    attr.st_blksize = gkfs::config::rpc::chunksize;
+    attr.st_blksize = CTX->fs_conf()->chunksize;
     attr.st_blocks = 0;
 
     memset(&attr.st_atim, 0, sizeof(timespec));
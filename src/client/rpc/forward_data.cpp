@@ -30,15 +30,25 @@
 #include <client/preload_util.hpp>
 #include <client/rpc/forward_data.hpp>
 #include <client/rpc/rpc_types.hpp>
+#include <client/rpc/rpc_call.hpp>
 #include <client/logging.hpp>
 
 #include <common/rpc/distributor.hpp>
 #include <common/arithmetic/arithmetic.hpp>
 #include <common/rpc/rpc_util.hpp>
-
+#include <common/rpc/chunk_set.hpp>
+#include <common/rpc/latency_tracker.hpp>
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <numeric>
 #include <unordered_set>
 
 using namespace std;
+using gkfs::preload::RpcOp;
 
 namespace gkfs::rpc {
 
@@ -49,13 +59,9 @@ namespace gkfs::rpc {
 
 /**
  * Send an RPC request to write from a buffer.
- * There is a bitset of 1024 chunks to tell the server
- * which chunks to process. Exceeding this value will work without
- * replication. Another way is to leverage mercury segments.
- * TODO: Decide how to manage a write to a replica that doesn't exist
  * @param path
  * @param buf
- * @param append_flag
+ * @param offset
  * @param write_size
  * @param num_copies number of replicas
  * @return pair<error code, written size>
@@ -63,19 +69,52 @@ namespace gkfs::rpc {
 pair<int, ssize_t>
 forward_write(const string& path, const void* buf, const off64_t offset,
               const size_t write_size, const int8_t num_copies) {
+    struct iovec iov {
+        const_cast<void*>(buf), write_size
+    };
+    return forward_writev(path, &iov, 1, offset, num_copies);
+}
+
+/**
+ * Send an RPC request to write from a sequence of buffers to a contiguous
+ * range of a file.
+ * Each server receives the set of chunks it processes as a
+ * gkfs::rpc::ChunkSet.
+ * With replica forwarding, the daemons of copy 0 write the replicas of their
+ * chunks and num_copies must be 0.
+ * @internal
+ * The buffers are exposed as a single bulk region of several segments. Its
+ * offsets run over the buffers in order, as the offsets of a single buffer
+ * would, so that daemons pull the data of their chunks from it unchanged.
+ * With a write timeout, a private copy of the buffers is exposed instead, see
+ * gkfs::rpc::expose_write().
+ * @endinternal
+ * TODO: Decide how to manage a write to a replica that doesn't exist
+ * @param path
+ * @param iov buffers to write, in file order
+ * @param iovcnt number of buffers
+ * @param offset
+ * @param num_copies number of replicas
+ * @return pair<error code, written size>
+ */
+pair<int, ssize_t>
+forward_writev(const string& path, const struct iovec* iov, const int iovcnt,
+               const off64_t offset, const int8_t num_copies) {
 
     // import pow2-optimized arithmetic functions
     using namespace gkfs::utils::arithmetic;
+    const auto chunksize = CTX->fs_conf()->chunksize;
+
+    size_t write_size = 0;
+    for(int i = 0; i < iovcnt; i++)
+        write_size += iov[i].iov_len;
 
     assert(write_size > 0);
 
     // Calculate chunkid boundaries and numbers so that daemons know in
     // which interval to look for chunks
-    auto chnk_start = block_index(offset, gkfs::config::rpc::chunksize);
-    auto chnk_end = block_index((offset + write_size) - 1,
-                                gkfs::config::rpc::chunksize);
-
-    auto chnk_total = (chnk_end - chnk_start) + 1;
+    auto chnk_start = block_index(offset, chunksize);
+    auto chnk_end = block_index((offset + write_size) - 1, chunksize);
 
     // Collect all chunk ids within count that have the same destination so
     // that those are send in one rpc bulk transfer
@@ -90,18 +129,15 @@ forward_write(const string& path, const void* buf, const off64_t offset,
     std::set<uint64_t> chnk_start_target{};
     std::set<uint64_t> chnk_end_target{};
 
-    std::unordered_map<uint64_t, std::vector<uint8_t>> write_ops_vect;
+    // chunks of each target relative to chnk_start
+    std::unordered_map<uint64_t, gkfs::rpc::ChunkSet> target_chunk_sets;
 
     // If num_copies is 0, we do the normal write operation. Otherwise
     // we process all the replicas.
     for(uint64_t chnk_id = chnk_start; chnk_id <= chnk_end; chnk_id++) {
         for(auto copy = num_copies ? 1 : 0; copy < num_copies + 1; copy++) {
             auto target = CTX->distributor()->locate_data(path, chnk_id, copy);
-
-            if(write_ops_vect.find(target) == write_ops_vect.end())
-                write_ops_vect[target] =
-                        std::vector<uint8_t>(((chnk_total + 7) / 8));
-            gkfs::rpc::set_bitset(write_ops_vect[target], chnk_id - chnk_start);
+            target_chunk_sets[target].add(chnk_id - chnk_start);
 
             if(target_chnks.count(target) == 0) {
                 target_chnks.insert(
@@ -122,25 +158,26 @@ forward_write(const string& path, const void* buf, const off64_t offset,
         }
     }
 
-    // some helper variables for async RPC
-    std::vector<hermes::mutable_buffer> bufseq{
-            hermes::mutable_buffer{const_cast<void*>(buf), write_size},
-    };
-
-    // expose user buffers so that they can serve as RDMA data sources
-    // (these are automatically "unexposed" when the destructor is called)
-    hermes::exposed_memory local_buffers;
+    // expose the data so that it can serve as RDMA data source
+    // (it is automatically "unexposed" once the last RPC completed)
+    std::shared_ptr<gkfs::rpc::rpc_memory> local_buffers;
 
     try {
-        local_buffers = ld_network_service->expose(
-                bufseq, hermes::access_mode::read_only);
-
+        local_buffers = expose_write(iov, iovcnt, RpcOp::write);
     } catch(const std::exception& ex) {
         LOG(ERROR, "Failed to expose buffers for RMA");
         return make_pair(EBUSY, 0);
     }
 
+    // with replica forwarding, the daemons of copy 0 write all replicas
+    uint32_t fwd_replicas = 0;
+    if(num_copies == 0 && CTX->get_replica_forwarding())
+        fwd_replicas = CTX->get_replicas();
+
     std::vector<hermes::rpc_handle<gkfs::rpc::write_data>> handles;
+    // targets of the handles, which lack failed targets with replicas
+    std::vector<uint64_t> handle_targets;
+    auto post_err = 0;
 
     // Issue non-blocking RPC requests and wait for the result later
     //
@@ -150,20 +187,17 @@ forward_write(const string& path, const void* buf, const off64_t offset,
     for(const auto& target : targets) {
 
         // total chunk_size for target
-        auto total_chunk_size =
-                target_chnks[target].size() * gkfs::config::rpc::chunksize;
+        auto total_chunk_size = target_chnks[target].size() * chunksize;
 
         // receiver of first chunk must subtract the offset from first chunk
         if(chnk_start_target.end() != chnk_start_target.find(target)) {
-            total_chunk_size -=
-                    block_overrun(offset, gkfs::config::rpc::chunksize);
+            total_chunk_size -= block_overrun(offset, chunksize);
         }
 
         // receiver of last chunk must subtract
         if(chnk_end_target.end() != chnk_end_target.find(target) &&
-           !is_aligned(offset + write_size, gkfs::config::rpc::chunksize)) {
-            total_chunk_size -= block_underrun(offset + write_size,
-                                               gkfs::config::rpc::chunksize);
+           !is_aligned(offset + write_size, chunksize)) {
+            total_chunk_size -= block_underrun(offset + write_size, chunksize);
         }
 
         auto endp = CTX->hosts().at(target);
@@ -175,25 +209,22 @@ forward_write(const string& path, const void* buf, const off64_t offset,
                     path,
                     // first offset in targets is the chunk with
                     // a potential offset
-                    block_overrun(offset, gkfs::config::rpc::chunksize), target,
+                    block_overrun(offset, chunksize), target,
                     CTX->hosts().size(),
                     // number of chunks handled by that destination
-                    gkfs::rpc::compress_bitset(write_ops_vect[target]),
+                    target_chunk_sets[target].encode(),
                     target_chnks[target].size(),
                     // chunk start id of this write
                     chnk_start,
                     // chunk end id of this write
                     chnk_end,
                     // total size to write
-                    total_chunk_size, local_buffers);
+                    total_chunk_size, fwd_replicas, CTX->get_write_quorum(),
+                    local_buffers->exposed);
 
-            // TODO(amiranda): add a post() with RPC_TIMEOUT to hermes so that
-            // we can retry for RPC_TRIES (see old commits with margo)
-            // TODO(amiranda): hermes will eventually provide a post(endpoint)
-            // returning one result and a broadcast(endpoint_set) returning a
-            // result_set. When that happens we can remove the .at(0) :/
             handles.emplace_back(
                     ld_network_service->post<gkfs::rpc::write_data>(endp, in));
+            handle_targets.push_back(target);
 
             LOG(DEBUG,
                 "host: {}, path: \"{}\", chunk_start: {}, chunk_end: {}, chunks: {}, size: {}, offset: {}",
@@ -204,8 +235,11 @@ forward_write(const string& path, const void* buf, const off64_t offset,
                 "Unable to send non-blocking rpc for "
                 "path \"{}\" [peer: {}]",
                 path, target);
-            if(num_copies == 0)
-                return make_pair(EBUSY, 0);
+            // the RPCs sent so far are still waited for below
+            if(num_copies == 0) {
+                post_err = EBUSY;
+                break;
+            }
         }
     }
 
@@ -213,14 +247,13 @@ forward_write(const string& path, const void* buf, const off64_t offset,
     ssize_t out_size = 0;
     std::size_t idx = 0;
 #ifdef REPLICA_CHECK
-    std::vector<uint8_t> fill(chnk_total);
-    auto write_ops = write_ops_vect.begin();
+    // chunks written by at least one target
+    std::vector<bool> fill((chnk_end - chnk_start) + 1);
 #endif
-    for(const auto& h : handles) {
+    for(auto& h : handles) {
         try {
-            // XXX We might need a timeout here to not wait forever for an
-            // output that never comes?
-            auto out = h.get().at(0);
+            auto out = get_output(h, handle_targets[idx], RpcOp::write,
+                                  local_buffers);
 
             if(out.err() != 0) {
                 LOG(ERROR, "Daemon reported error: {}", out.err());
@@ -228,47 +261,27 @@ forward_write(const string& path, const void* buf, const off64_t offset,
             } else {
                 out_size += static_cast<size_t>(out.io_size());
 #ifdef REPLICA_CHECK
-                if(num_copies) {
-                    if(fill.size() == 0) {
-                        fill = write_ops->second;
-                    } else {
-                        for(size_t i = 0; i < fill.size(); i++) {
-                            fill[i] |= write_ops->second[i];
-                        }
-                    }
-                }
-                write_ops++;
+                for(auto chnk_id : target_chnks[handle_targets[idx]])
+                    fill[chnk_id - chnk_start] = true;
 #endif
             }
         } catch(const std::exception& ex) {
             LOG(ERROR, "Failed to get rpc output for path \"{}\" [peer: {}]",
-                path, targets[idx]);
+                path, handle_targets[idx]);
             err = EIO;
         }
         idx++;
     }
+    if(post_err)
+        return make_pair(post_err, 0);
     // As servers can fail (and we cannot know if the total data is written), we
     // send the updated size but check that at least one copy of all chunks are
     // processed.
     if(num_copies) {
-        // A bit-wise or should show that all the chunks are written (255)
         out_size = write_size;
 #ifdef REPLICA_CHECK
-        for(size_t i = 0; i < fill.size() - 1; i++) {
-            if(fill[i] != 255) {
-                err = EIO;
-                break;
-            }
-        }
-        // Process the leftover bytes
-        for(uint64_t chnk_id = (chnk_start + (fill.size() - 1) * 8);
-            chnk_id <= chnk_end; chnk_id++) {
-            if(!(fill[(chnk_id - chnk_start) / 8] &
-                 (1 << ((chnk_id - chnk_start) % 8)))) {
-                err = EIO;
-                break;
-            }
-        }
+        if(std::find(fill.begin(), fill.end(), false) != fill.end())
+            err = EIO;
 #endif
     }
     /*
@@ -282,6 +295,181 @@ forward_write(const string& path, const void* buf, const off64_t offset,
         return make_pair(0, out_size);
 }
 
+namespace {
+
+using read_handle = hermes::rpc_handle<gkfs::rpc::read_data>;
+
+/*
+ * Recent latencies of read RPCs. Reads hedge RPCs that take longer than the
+ * configured percentile of them.
+ */
+gkfs::rpc::LatencyTracker&
+read_latencies() {
+    static gkfs::rpc::LatencyTracker latencies{
+            CTX->get_read_hedge_percentile(),
+            gkfs::config::rpc::read_latency_samples,
+            gkfs::config::rpc::read_latency_min_samples};
+    return latencies;
+}
+
+struct read_result {
+    size_t rpc;     //!< Index of the RPC within its read
+    bool reachable; //!< False if the daemon did not answer
+    int err;
+    size_t io_size;
+    bool queued{false}; //!< Waited for only after other RPCs
+};
+
+/*
+ * Results of the RPCs of a read, reported by the waiters of the RPCs. Shared
+ * with the waiters as they outlive the read if an RPC times out.
+ */
+struct read_results {
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::deque<read_result> results;
+};
+
+struct read_rpc {
+    size_t group;   //!< Chunk group of the RPC
+    size_t attempt; //!< Attempt of the group the RPC belongs to
+    gkfs::rpc::host_t target;
+    std::vector<uint64_t> chunks;
+    std::chrono::steady_clock::time_point start;
+    bool pending;
+    std::shared_ptr<read_handle> handle;
+    // private buffer of the RPC's chunks, starting at file offset buffer_start
+    std::shared_ptr<gkfs::rpc::rpc_memory> buffer;
+    uint64_t buffer_start;
+    bool succeeded; //!< Read all its chunks
+    std::shared_ptr<gkfs::rpc::background_wait> wait{};
+};
+
+/*
+ * An attempt reads all chunks of its group. Failed RPCs of an attempt are
+ * replaced by RPCs to the next copies of their chunks.
+ */
+struct read_attempt {
+    size_t pending{0}; //!< RPCs not answered yet
+    ssize_t size{0};   //!< Bytes read by the answered RPCs
+    bool failed{false};
+};
+
+/*
+ * Chunks first sent to the same daemon. A group is read once one of its
+ * attempts succeeds. Hedging adds an attempt reading the next copies.
+ */
+struct read_group {
+    std::vector<uint64_t> chunks;
+    std::vector<read_attempt> attempts;
+    bool hedged{false};
+    bool resolved{false};
+};
+
+/*
+ * Copies size bytes between data and a sequence of buffers, starting at
+ * position pos of the buffers. Copies to the buffers if to_iov is set.
+ */
+void
+copy_iov(const struct iovec* iov, int iovcnt, size_t pos, char* data,
+         size_t size, bool to_iov) {
+    for(int i = 0; i < iovcnt && size > 0; i++) {
+        if(pos >= iov[i].iov_len) {
+            pos -= iov[i].iov_len;
+            continue;
+        }
+        auto n = std::min(size, iov[i].iov_len - pos);
+        auto* buf = static_cast<char*>(iov[i].iov_base) + pos;
+        if(to_iov)
+            memcpy(buf, data, n);
+        else
+            memcpy(data, buf, n);
+        data += n;
+        size -= n;
+        pos = 0;
+    }
+}
+
+read_result
+get_read_result(size_t rpc, const read_handle& handle) {
+    try {
+        auto out = handle.get().at(0);
+        return {rpc, true, out.err(), static_cast<size_t>(out.io_size())};
+    } catch(const std::exception& ex) {
+        return {rpc, false, EIO, 0};
+    }
+}
+
+/**
+ * Sends a read RPC for some chunks of a read to a daemon.
+ * @param path
+ * @param offset Offset of the read
+ * @param read_size Size of the read
+ * @param chnk_start First chunk of the read
+ * @param chnk_end Last chunk of the read
+ * @param target Daemon to read from
+ * @param chunks Chunks read from target in ascending order
+ * @param local_buffers Exposed buffer of the read
+ * @return RPC handle
+ * @throws std::exception if the RPC cannot be sent
+ */
+read_handle
+post_read(const string& path, off64_t offset, size_t read_size,
+          uint64_t chnk_start, uint64_t chnk_end, gkfs::rpc::host_t target,
+          const std::vector<uint64_t>& chunks,
+          const hermes::exposed_memory& local_buffers) {
+    // import pow2-optimized arithmetic functions
+    using namespace gkfs::utils::arithmetic;
+    const auto chunksize = CTX->fs_conf()->chunksize;
+
+    gkfs::rpc::ChunkSet chunk_set{};
+    uint64_t total_chunk_size = chunks.size() * chunksize;
+    for(auto chnk_id : chunks)
+        chunk_set.add(chnk_id - chnk_start);
+    // receiver of first chunk must subtract the offset from first chunk
+    if(chunks.front() == chnk_start)
+        total_chunk_size -= block_overrun(offset, chunksize);
+    // receiver of last chunk must subtract
+    if(chunks.back() == chnk_end && !is_aligned(offset + read_size, chunksize))
+        total_chunk_size -= block_underrun(offset + read_size, chunksize);
+
+    LOG(DEBUG, "Sending RPC ...");
+
+    gkfs::rpc::read_data::input in(
+            path,
+            // first offset in targets is the chunk with
+            // a potential offset
+            block_overrun(offset, chunksize), target, CTX->hosts().size(),
+            chunk_set.encode(),
+            // number of chunks handled by that destination
+            chunks.size(),
+            // chunk start id of this read
+            chnk_start,
+            // chunk end id of this read
+            chnk_end,
+            // total size to read
+            total_chunk_size, local_buffers);
+
+    // TODO(amiranda): hermes will eventually provide a post(endpoint)
+    // returning one result and a broadcast(endpoint_set) returning a
+    // result_set. When that happens we can remove the .at(0) :/
+    auto handle = ld_network_service->post<gkfs::rpc::read_data>(
+            CTX->hosts().at(target), in);
+
+    LOG(DEBUG,
+        "host: {}, path: {}, chunk_start: {}, chunk_end: {}, chunks: {}, size: {}, offset: {}",
+        target, path, chnk_start, chnk_end, in.chunk_n(), total_chunk_size,
+        in.offset());
+
+    LOG(TRACE_READS,
+        "read {} host: {}, path: {}, chunk_start: {}, chunk_end: {}",
+        CTX->get_hostname(), target, path, chnk_start, chnk_end);
+
+    return handle;
+}
+
+} // namespace
+
 /**
  * Send an RPC request to read to a buffer.
  * @param path
@@ -289,197 +477,364 @@ forward_write(const string& path, const void* buf, const off64_t offset,
  * @param offset
  * @param read_size
  * @param num_copies number of copies available (0 is no replication)
- * @param failed nodes failed that should not be used
+ * @param failed nodes failed that should not be used, extended by the nodes
+ * failing during the read
  * @return pair<error code, read size>
  */
 pair<int, ssize_t>
 forward_read(const string& path, void* buf, const off64_t offset,
              const size_t read_size, const int8_t num_copies,
              std::set<int8_t>& failed) {
+    struct iovec iov {
+        buf, read_size
+    };
+    return forward_readv(path, &iov, 1, offset, num_copies, failed);
+}
+
+/**
+ * Send an RPC request to read a contiguous range of a file to a sequence of
+ * buffers. The buffers are exposed as a single bulk region of several
+ * segments, see forward_writev().
+ * Chunks are read from their first copy not on a failed daemon. If a daemon
+ * fails, only its chunks are read again from their next copies.
+ * @internal
+ * With a read timeout (LIBGKFS_READ_TIMEOUT) or hedging
+ * (LIBGKFS_READ_HEDGE_PERCENTILE), each RPC is waited for in the background,
+ * see gkfs::rpc::wait_in_background(), so that the read can act on RPCs that
+ * did not answer in time:
+ * - An RPC not answered within the timeout counts as failed daemon.
+ * - An RPC slower than the percentile of recent read RPCs is hedged once by
+ *   reading its chunks from their next copies as well. The first complete
+ *   copy of the chunks is used.
+ * As RPCs may then be abandoned, every RPC reads its chunks to a private
+ * buffer, and only the chunks of the attempt that completes its group are
+ * copied to the read's buffers. The private buffers are initialized from the
+ * read's buffers so that chunk ranges that are not pushed, e.g., holes, are
+ * left unchanged as without a private buffer. An abandoned RPC keeps its
+ * private buffer until it completes.
+ * @endinternal
+ * @param path
+ * @param iov buffers to read to, in file order
+ * @param iovcnt number of buffers
+ * @param offset
+ * @param num_copies number of copies available (0 is no replication)
+ * @param failed nodes failed that should not be used, extended by the nodes
+ * failing during the read
+ * @return pair<error code, read size>
+ */
+pair<int, ssize_t>
+forward_readv(const string& path, const struct iovec* iov, const int iovcnt,
+              const off64_t offset, const int8_t num_copies,
+              std::set<int8_t>& failed) {
 
     // import pow2-optimized arithmetic functions
     using namespace gkfs::utils::arithmetic;
+    using clock = std::chrono::steady_clock;
+    const auto chunksize = CTX->fs_conf()->chunksize;
+
+    // some helper variables for async RPCs
+    std::vector<hermes::mutable_buffer> bufseq{};
+    size_t read_size = 0;
+    for(int i = 0; i < iovcnt; i++) {
+        if(iov[i].iov_len == 0)
+            continue;
+        bufseq.push_back(
+                hermes::mutable_buffer{iov[i].iov_base, iov[i].iov_len});
+        read_size += iov[i].iov_len;
+    }
 
     // Calculate chunkid boundaries and numbers so that daemons know in which
     // interval to look for chunks
-    auto chnk_start = block_index(offset, gkfs::config::rpc::chunksize);
-    auto chnk_end =
-            block_index((offset + read_size - 1), gkfs::config::rpc::chunksize);
-    auto chnk_total = (chnk_end - chnk_start) + 1;
-    // Collect all chunk ids within count that have the same destination so
-    // that those are send in one rpc bulk transfer
-    std::map<uint64_t, std::vector<uint64_t>> target_chnks{};
-
-    // contains the recipient ids, used to access the target_chnks map.
-    // First idx is chunk with potential offset
-    std::vector<uint64_t> targets{};
-    // targets for the first and last chunk as they need special treatment
-    uint64_t chnk_start_target = 0;
-    uint64_t chnk_end_target = 0;
-    std::unordered_map<uint64_t, std::vector<uint8_t>> read_bitset_vect;
-
-    for(uint64_t chnk_id = chnk_start; chnk_id <= chnk_end; chnk_id++) {
-        auto target = CTX->distributor()->locate_data(path, chnk_id, 0);
-        if(num_copies > 0) {
-            // If we have some failures we select another copy (randomly).
-            while(failed.find(target) != failed.end()) {
-                LOG(DEBUG, "Selecting another node, target: {} down", target);
+    auto chnk_start = block_index(offset, chunksize);
+    auto chnk_end = block_index((offset + read_size - 1), chunksize);
+
+    // next copy to read per chunk
+    std::vector<int> next_copy(chnk_end - chnk_start + 1, 0);
+    // Collect the chunks with the same destination so that those are sent
+    // in one rpc bulk transfer. Fails if a chunk has no copy left
+    auto assign = [&](const std::vector<uint64_t>& chunks,
+                      std::map<host_t, std::vector<uint64_t>>& target_chnks) {
+        for(auto chnk_id : chunks) {
+            auto& copy = next_copy[chnk_id - chnk_start];
+            auto target = host_t{0};
+            do {
+                if(copy > num_copies)
+                    return false;
                 target = CTX->distributor()->locate_data(path, chnk_id,
-                                                         rand() % num_copies);
-            }
-        }
-
-        if(read_bitset_vect.find(target) == read_bitset_vect.end())
-            read_bitset_vect[target] =
-                    std::vector<uint8_t>(((chnk_total + 7) / 8));
-        read_bitset_vect[target][(chnk_id - chnk_start) / 8] |=
-                1 << ((chnk_id - chnk_start) % 8); // set
-
-        if(target_chnks.count(target) == 0) {
-            target_chnks.insert(
-                    std::make_pair(target, std::vector<uint64_t>{chnk_id}));
-            targets.push_back(target);
-        } else {
+                                                         copy++);
+            } while(failed.count(static_cast<int8_t>(target)));
             target_chnks[target].push_back(chnk_id);
         }
-
-        // set first and last chnk targets
-        if(chnk_id == chnk_start) {
-            chnk_start_target = target;
-        }
-
-        if(chnk_id == chnk_end) {
-            chnk_end_target = target;
-        }
-    }
-
-    // some helper variables for async RPCs
-    std::vector<hermes::mutable_buffer> bufseq{
-            hermes::mutable_buffer{buf, read_size},
+        return true;
     };
 
+    const auto timeout =
+            std::chrono::milliseconds(CTX->get_rpc_timeout(RpcOp::read));
+    const auto hedging = num_copies > 0 && CTX->get_read_hedge_percentile() > 0;
+    // RPCs are waited for in the background if the read must act before they
+    // answer
+    const auto async = timeout.count() > 0 || hedging;
+
     // expose user buffers so that they can serve as RDMA data targets
-    // (these are automatically "unexposed" when the destructor is called)
+    // (these are automatically "unexposed" when the destructor is called).
+    // RPCs that may be abandoned read to private buffers instead
     hermes::exposed_memory local_buffers;
 
-    try {
-        local_buffers = ld_network_service->expose(
-                bufseq, hermes::access_mode::write_only);
+    if(!async) {
+        try {
+            local_buffers = ld_network_service->expose(
+                    bufseq, hermes::access_mode::write_only);
 
-    } catch(const std::exception& ex) {
-        LOG(ERROR, "Failed to expose buffers for RMA");
-        return make_pair(EBUSY, 0);
+        } catch(const std::exception& ex) {
+            LOG(ERROR, "Failed to expose buffers for RMA");
+            return make_pair(EBUSY, 0);
+        }
     }
-
-    std::vector<hermes::rpc_handle<gkfs::rpc::read_data>> handles;
+    auto results = std::make_shared<read_results>();
+    // RPCs that could not be sent
+    std::deque<read_result> post_failures;
+    std::vector<read_rpc> rpcs;
+    std::vector<read_group> groups;
 
     // Issue non-blocking RPC requests and wait for the result later
-    //
-    // TODO(amiranda): This could be simplified by adding a vector of inputs
-    // to async_engine::broadcast(). This would allow us to avoid manually
-    // looping over handles as we do below
-
-    for(const auto& target : targets) {
-
-        // total chunk_size for target
-        auto total_chunk_size =
-                target_chnks[target].size() * gkfs::config::rpc::chunksize;
-
-        // receiver of first chunk must subtract the offset from first chunk
-        if(target == chnk_start_target) {
-            total_chunk_size -=
-                    block_overrun(offset, gkfs::config::rpc::chunksize);
+    auto post = [&](size_t group, size_t attempt,
+                    std::map<host_t, std::vector<uint64_t>>& target_chnks) {
+        for(auto& [target, chunks] : target_chnks) {
+            auto idx = rpcs.size();
+            rpcs.push_back({group, attempt, target, std::move(chunks),
+                            clock::now(), true, nullptr, nullptr, 0, false});
+            groups[group].attempts[attempt].pending++;
+            auto& rpc = rpcs[idx];
+            try {
+                if(!async) {
+                    rpc.handle = std::make_shared<read_handle>(post_read(
+                            path, offset, read_size, chnk_start, chnk_end,
+                            target, rpc.chunks, local_buffers));
+                } else {
+                    // read the range of the RPC's chunks as a read of its own
+                    rpc.buffer_start = std::max(
+                            static_cast<uint64_t>(offset),
+                            rpc.chunks.front() * chunksize);
+                    auto end = std::min(
+                            static_cast<uint64_t>(offset) + read_size,
+                            (rpc.chunks.back() + 1) * chunksize);
+                    auto size = end - rpc.buffer_start;
+                    rpc.buffer = expose_read(nullptr, size, RpcOp::read);
+                    copy_iov(iov, iovcnt, rpc.buffer_start - offset,
+                             rpc.buffer->buffer.get(), size, false);
+                    rpc.handle = std::make_shared<read_handle>(post_read(
+                            path, rpc.buffer_start, size, rpc.chunks.front(),
+                            rpc.chunks.back(), target, rpc.chunks,
+                            rpc.buffer->exposed));
+                }
+            } catch(const std::exception& ex) {
+                LOG(ERROR,
+                    "Unable to send non-blocking rpc for path \"{}\" "
+                    "[peer: {}]",
+                    path, target);
+                post_failures.push_back({idx, false, EBUSY, 0});
+                continue;
+            }
+            if(!async)
+                continue;
+            // the buffer is owned until the RPC completed
+            rpc.wait = wait_in_background([handle = rpc.handle,
+                                           buffer = rpc.buffer, results,
+                                           idx](bool queued) {
+                auto result = get_read_result(idx, *handle);
+                result.queued = queued;
+                {
+                    std::lock_guard<std::mutex> lock(results->mutex);
+                    results->results.push_back(result);
+                }
+                results->cv.notify_one();
+            });
         }
+    };
 
-        // receiver of last chunk must subtract
-        if(target == chnk_end_target &&
-           !is_aligned(offset + read_size, gkfs::config::rpc::chunksize)) {
-            total_chunk_size -= block_underrun(offset + read_size,
-                                               gkfs::config::rpc::chunksize);
+    // Copies the chunks of an attempt from the private buffers of its RPCs
+    auto copy_out = [&](size_t group, size_t attempt) {
+        for(const auto& rpc : rpcs) {
+            if(rpc.group != group || rpc.attempt != attempt || !rpc.succeeded)
+                continue;
+            for(auto chnk_id : rpc.chunks) {
+                auto start = std::max(static_cast<uint64_t>(offset),
+                                      chnk_id * chunksize);
+                auto end = std::min(static_cast<uint64_t>(offset) + read_size,
+                                    (chnk_id + 1) * chunksize);
+                copy_iov(iov, iovcnt, start - offset,
+                         rpc.buffer->buffer.get() + (start - rpc.buffer_start),
+                         end - start, true);
+            }
         }
+    };
 
-        auto endp = CTX->hosts().at(target);
-
-        try {
-
-            LOG(DEBUG, "Sending RPC ...");
-
-            gkfs::rpc::read_data::input in(
-                    path,
-                    // first offset in targets is the chunk with
-                    // a potential offset
-                    block_overrun(offset, gkfs::config::rpc::chunksize), target,
-                    CTX->hosts().size(),
-                    gkfs::rpc::compress_bitset(read_bitset_vect[target]),
-                    // number of chunks handled by that destination
-                    target_chnks[target].size(),
-                    // chunk start id of this write
-                    chnk_start,
-                    // chunk end id of this write
-                    chnk_end,
-                    // total size to write
-                    total_chunk_size, local_buffers);
-
-            // TODO(amiranda): add a post() with RPC_TIMEOUT to hermes so
-            // that we can retry for RPC_TRIES (see old commits with margo)
-            // TODO(amiranda): hermes will eventually provide a
-            // post(endpoint) returning one result and a
-            // broadcast(endpoint_set) returning a result_set. When that
-            // happens we can remove the .at(0) :/
-            handles.emplace_back(
-                    ld_network_service->post<gkfs::rpc::read_data>(endp, in));
-
-            LOG(DEBUG,
-                "host: {}, path: {}, chunk_start: {}, chunk_end: {}, chunks: {}, size: {}, offset: {}",
-                target, path, chnk_start, chnk_end, in.chunk_n(),
-                total_chunk_size, in.offset());
-
-            LOG(TRACE_READS,
-                "read {} host: {}, path: {}, chunk_start: {}, chunk_end: {}",
-                CTX->get_hostname(), target, path, chnk_start, chnk_end);
-
+    // Reads chunks of an attempt from their next copies
+    auto retry = [&](size_t group, size_t attempt,
+                     const std::vector<uint64_t>& chunks) {
+        std::map<host_t, std::vector<uint64_t>> target_chnks{};
+        if(!assign(chunks, target_chnks)) {
+            groups[group].attempts[attempt].failed = true;
+            return false;
+        }
+        post(group, attempt, target_chnks);
+        return true;
+    };
 
-        } catch(const std::exception& ex) {
-            LOG(ERROR,
-                "Unable to send non-blocking rpc for path \"{}\" "
-                "[peer: {}]",
-                path, target);
-            return make_pair(EBUSY, 0);
+    {
+        std::vector<uint64_t> chunks(chnk_end - chnk_start + 1);
+        std::iota(chunks.begin(), chunks.end(), chnk_start);
+        std::map<host_t, std::vector<uint64_t>> target_chnks{};
+        if(!assign(chunks, target_chnks)) {
+            LOG(ERROR, "No copy of the chunks of \"{}\" is available", path);
+            return make_pair(EIO, 0);
+        }
+        for(auto& [target, chnks] : target_chnks) {
+            groups.push_back({chnks, {read_attempt{}}});
+            std::map<host_t, std::vector<uint64_t>> group_chnks{
+                    {target, std::move(chnks)}};
+            post(groups.size() - 1, 0, group_chnks);
         }
     }
 
     // Wait for RPC responses and then get response and add it to out_size
-    // which is the read size. All potential outputs are served to free
-    // resources regardless of errors, although an errorcode is set.
+    // which is the read size.
     auto err = 0;
     ssize_t out_size = 0;
-    std::size_t idx = 0;
+    auto unresolved = groups.size();
+
+    auto on_result = [&](const read_result& result) {
+        auto& rpc = rpcs[result.rpc];
+        if(!rpc.pending)
+            return;
+        rpc.pending = false;
+        const auto group = rpc.group;
+        const auto attempt = rpc.attempt;
+        if(result.reachable)
+            endpoint_health().answered(rpc.target);
+        else
+            endpoint_health().failed(rpc.target);
+        // the latency of a queued wait includes the time in the queue
+        if(hedging && result.reachable && result.err == 0 && !result.queued) {
+            read_latencies().add(
+                    std::chrono::duration_cast<std::chrono::microseconds>(
+                            clock::now() - rpc.start));
+        }
+        if(groups[group].resolved || groups[group].attempts[attempt].failed)
+            return;
+        auto& att = groups[group].attempts[attempt];
+        att.pending--;
+        if(result.reachable && result.err == 0) {
+            rpc.succeeded = true;
+            att.size += result.io_size;
+            if(att.pending == 0) {
+                groups[group].resolved = true;
+                out_size += att.size;
+                unresolved--;
+                if(async)
+                    copy_out(group, attempt);
+            }
+            return;
+        }
+        if(result.reachable) {
+            LOG(ERROR, "Daemon reported error: {}", result.err);
+        } else {
+            LOG(ERROR, "Failed to get rpc output for path \"{}\" [peer: {}]",
+                path, rpc.target);
+            failed.insert(static_cast<int8_t>(rpc.target));
+        }
+        // read the chunks from their next copies
+        const auto chunks = rpc.chunks;
+        if(retry(group, attempt, chunks))
+            return;
+        const auto& attempts = groups[group].attempts;
+        if(all_of(attempts.begin(), attempts.end(),
+                  [](const read_attempt& a) { return a.failed; }))
+            err = result.err;
+    };
 
-    for(const auto& h : handles) {
-        try {
-            // XXX We might need a timeout here to not wait forever for an
-            // output that never comes?
-            auto out = h.get().at(0);
+    // RPCs whose result is still needed
+    auto awaited = [&](const read_rpc& rpc) {
+        return rpc.pending && !groups[rpc.group].resolved &&
+               !groups[rpc.group].attempts[rpc.attempt].failed;
+    };
 
-            if(out.err() != 0) {
-                LOG(ERROR, "Daemon reported error: {}", out.err());
-                err = out.err();
+    // Fails timed out RPCs and hedges slow RPCs
+    auto on_deadline = [&](clock::time_point now) {
+        auto hedge_after = hedging ? read_latencies().value()
+                                   : std::chrono::microseconds(0);
+        for(size_t idx = 0, n = rpcs.size(); idx < n && !err; idx++) {
+            if(!awaited(rpcs[idx]))
+                continue;
+            if(timeout.count() > 0 && now >= rpcs[idx].start + timeout) {
+                LOG(WARNING, "Read RPC for path \"{}\" timed out [peer: {}]",
+                    path, rpcs[idx].target);
+                abandon_wait(rpcs[idx].wait);
+                on_result({idx, false, EIO, 0});
+                continue;
             }
+            auto group = rpcs[idx].group;
+            if(hedge_after.count() > 0 && !groups[group].hedged &&
+               now >= rpcs[idx].start + hedge_after) {
+                LOG(DEBUG, "Hedging read RPC for path \"{}\" [peer: {}]",
+                    path, rpcs[idx].target);
+                groups[group].hedged = true;
+                groups[group].attempts.emplace_back();
+                retry(group, groups[group].attempts.size() - 1,
+                      groups[group].chunks);
+            }
+        }
+    };
 
-            out_size += static_cast<size_t>(out.io_size());
-
-        } catch(const std::exception& ex) {
-            LOG(ERROR, "Failed to get rpc output for path \"{}\" [peer: {}]",
-                path, targets[idx]);
-            err = EIO;
-            // We should get targets[idx] and remove from the list of peers
-            failed.insert(targets[idx]);
-            // Then repeat the read with another peer (We repear the full
-            // read, this can be optimised but it is a cornercase)
+    while(unresolved > 0 && !err) {
+        if(!post_failures.empty()) {
+            auto result = post_failures.front();
+            post_failures.pop_front();
+            on_result(result);
+            continue;
         }
-        idx++;
+        if(!async) {
+            auto it = find_if(rpcs.begin(), rpcs.end(), awaited);
+            on_result(get_read_result(it - rpcs.begin(), *it->handle));
+            continue;
+        }
+        auto deadline = clock::time_point::max();
+        auto hedge_after = hedging ? read_latencies().value()
+                                   : std::chrono::microseconds(0);
+        for(const auto& rpc : rpcs) {
+            if(!awaited(rpc))
+                continue;
+            if(timeout.count() > 0)
+                deadline = min(deadline, rpc.start + timeout);
+            if(hedge_after.count() > 0 && !groups[rpc.group].hedged)
+                deadline = min(deadline, rpc.start + hedge_after);
+        }
+        std::unique_lock<std::mutex> lock(results->mutex);
+        auto ready = [&results] { return !results->results.empty(); };
+        if(deadline == clock::time_point::max())
+            results->cv.wait(lock, ready);
+        else
+            results->cv.wait_until(lock, deadline, ready);
+        if(results->results.empty()) {
+            lock.unlock();
+            on_deadline(clock::now());
+            continue;
+        }
+        auto result = results->results.front();
+        results->results.pop_front();
+        lock.unlock();
+        on_result(result);
     }
 
+    // All potential outputs are served to free resources regardless of
+    // errors. Waiters own the handles of async RPCs, which may still wait for
+    // RPCs no longer needed
+    for(const auto& rpc : rpcs) {
+        if(rpc.wait)
+            abandon_wait(rpc.wait);
+        else if(rpc.pending && rpc.handle)
+            get_read_result(0, *rpc.handle);
+    }
 
     /*
      * Typically file systems return the size even if only a part of it was
@@ -506,15 +861,14 @@ forward_truncate(const std::string& path, size_t current_size, size_t new_size,
 
     // import pow2-optimized arithmetic functions
     using namespace gkfs::utils::arithmetic;
+    const auto chunksize = CTX->fs_conf()->chunksize;
 
     assert(current_size > new_size);
 
     // Find out which data servers need to delete data chunks in order to
     // contact only them
-    const unsigned int chunk_start =
-            block_index(new_size, gkfs::config::rpc::chunksize);
-    const unsigned int chunk_end = block_index(current_size - new_size - 1,
-                                               gkfs::config::rpc::chunksize);
+    const unsigned int chunk_start = block_index(new_size, chunksize);
+    const unsigned int chunk_end = block_index(current_size - 1, chunksize);
 
     std::unordered_set<unsigned int> hosts;
     for(unsigned int chunk_id = chunk_start; chunk_id <= chunk_end;
@@ -525,6 +879,8 @@ forward_truncate(const std::string& path, size_t current_size, size_t new_size,
     }
 
     std::vector<hermes::rpc_handle<gkfs::rpc::trunc_data>> handles;
+    // daemons of the handles
+    std::vector<uint64_t> handle_hosts;
 
     auto err = 0;
 
@@ -537,14 +893,9 @@ forward_truncate(const std::string& path, size_t current_size, size_t new_size,
 
             gkfs::rpc::trunc_data::input in(path, new_size);
 
-            // TODO(amiranda): add a post() with RPC_TIMEOUT to hermes so
-            // that we can retry for RPC_TRIES (see old commits with margo)
-            // TODO(amiranda): hermes will eventually provide a
-            // post(endpoint) returning one result and a
-            // broadcast(endpoint_set) returning a result_set. When that
-            // happens we can remove the .at(0) :/
             handles.emplace_back(
                     ld_network_service->post<gkfs::rpc::trunc_data>(endp, in));
+            handle_hosts.push_back(host);
 
         } catch(const std::exception& ex) {
             // TODO(amiranda): we should cancel all previously posted
@@ -558,11 +909,9 @@ forward_truncate(const std::string& path, size_t current_size, size_t new_size,
     }
 
     // Wait for RPC responses and then get response
-    for(const auto& h : handles) {
+    for(size_t i = 0; i < handles.size(); i++) {
         try {
-            // XXX We might need a timeout here to not wait forever for an
-            // output that never comes?
-            auto out = h.get().at(0);
+            auto out = get_output(handles[i], handle_hosts[i], RpcOp::write);
 
             if(out.err()) {
                 LOG(ERROR, "received error response: {}", out.err());
@@ -576,6 +925,222 @@ forward_truncate(const std::string& path, size_t current_size, size_t new_size,
     return err ? err : 0;
 }
 
+/**
+ * Send an RPC request to flush a file's chunks to the storage devices of all
+ * daemons that store them
+ * @param path
+ * @param file_size
+ * @param num_copies Number of replicas
+ * @return error code
+ */
+int
+forward_fsync(const std::string& path, size_t file_size,
+              const int8_t num_copies) {
+
+    // import pow2-optimized arithmetic functions
+    using namespace gkfs::utils::arithmetic;
+    const auto chunksize = CTX->fs_conf()->chunksize;
+
+    if(file_size == 0)
+        return 0;
+
+    // Find out which data servers store chunks of this file in order to
+    // contact only them
+    const auto chunk_end = block_index(file_size - 1, chunksize);
+
+    std::unordered_set<unsigned int> hosts;
+    for(uint64_t chunk_id = 0; chunk_id <= chunk_end; ++chunk_id) {
+        // all daemons are contacted already
+        if(hosts.size() == CTX->hosts().size())
+            break;
+        for(auto copy = 0; copy < (num_copies + 1); ++copy) {
+            hosts.insert(CTX->distributor()->locate_data(path, chunk_id, copy));
+        }
+    }
+
+    std::vector<hermes::rpc_handle<gkfs::rpc::fsync_data>> handles;
+    // daemons of the handles
+    std::vector<uint64_t> handle_hosts;
+
+    auto err = 0;
+
+    for(const auto& host : hosts) {
+
+        auto endp = CTX->hosts().at(host);
+
+        try {
+            LOG(DEBUG, "Sending RPC to host: {}", host);
+
+            gkfs::rpc::fsync_data::input in(path);
+
+            handles.emplace_back(
+                    ld_network_service->post<gkfs::rpc::fsync_data>(endp, in));
+            handle_hosts.push_back(host);
+
+        } catch(const std::exception& ex) {
+            LOG(ERROR, "Failed to send request to host: {}", host);
+            err = EIO;
+            break; // We need to gather all responses so we can't return
+                   // here
+        }
+    }
+
+    // Wait for RPC responses and then get response
+    for(size_t i = 0; i < handles.size(); i++) {
+        try {
+            auto out = get_output(handles[i], handle_hosts[i], RpcOp::write);
+
+            if(out.err()) {
+                LOG(ERROR, "received error response: {}", out.err());
+                err = out.err();
+            }
+        } catch(const std::exception& ex) {
+            LOG(ERROR, "while getting rpc output");
+            err = EIO;
+        }
+    }
+    return err;
+}
+
+/**
+ * Send an RPC request to write data inline into the metadentry of a file.
+ * The daemon replies with gkfs::rpc::inline_data_err if the file's data is not
+ * (or could not remain) stored inline. The data must then be written to chunks.
+ * @param path
+ * @param buf
+ * @param offset
+ * @param write_size
+ * @param append_flag
+ * @return pair<error code, offset of the write>
+ */
+pair<int, off64_t>
+forward_write_inline(const string& path, const void* buf, off64_t offset,
+                     size_t write_size, const bool append_flag) {
+
+    assert(write_size > 0);
+    auto host = CTX->distributor()->locate_file_metadata(path, 0);
+
+    std::shared_ptr<gkfs::rpc::rpc_memory> local_buffers;
+    try {
+        struct iovec iov {
+            const_cast<void*>(buf), write_size
+        };
+        local_buffers = expose_write(&iov, 1, RpcOp::write);
+    } catch(const std::exception& ex) {
+        LOG(ERROR, "Failed to expose buffers for RMA");
+        return make_pair(EBUSY, 0);
+    }
+
+    try {
+        LOG(DEBUG, "Sending RPC ...");
+        gkfs::rpc::write_inline::input in(path, offset, write_size,
+                                          bool_to_merc_bool(append_flag),
+                                          local_buffers->exposed);
+        auto handle = ld_network_service->post<gkfs::rpc::write_inline>(
+                CTX->hosts().at(host), in);
+        auto out = get_output(handle, host, RpcOp::write, local_buffers);
+        if(out.err() != 0) {
+            LOG(DEBUG, "Daemon reported error: {}", out.err());
+            return make_pair(out.err(), 0);
+        }
+        return make_pair(0, out.ret_offset());
+    } catch(const std::exception& ex) {
+        LOG(ERROR, "while getting rpc output");
+        return make_pair(EBUSY, 0);
+    }
+}
+
+/**
+ * Send an RPC request to read data stored inline in the metadentry of a file.
+ * The daemon replies with gkfs::rpc::inline_data_err if the file's data is not
+ * stored inline. The data must then be read from chunks.
+ * @param path
+ * @param buf
+ * @param offset
+ * @param read_size
+ * @return pair<error code, read bytes>
+ */
+pair<int, ssize_t>
+forward_read_inline(const string& path, void* buf, off64_t offset,
+                    size_t read_size) {
+
+    assert(read_size > 0);
+    auto host = CTX->distributor()->locate_file_metadata(path, 0);
+
+    std::shared_ptr<gkfs::rpc::rpc_memory> local_buffers;
+    auto attempt = [&](unsigned int) {
+        // an attempt that timed out may still write to its memory
+        local_buffers = expose_read(buf, read_size, RpcOp::read);
+        LOG(DEBUG, "Sending RPC ...");
+        gkfs::rpc::read_inline::input in(path, offset, read_size, false,
+                                         local_buffers->exposed);
+        auto handle = ld_network_service->post<gkfs::rpc::read_inline>(
+                CTX->hosts().at(host), in);
+        return get_output(handle, host, RpcOp::read, local_buffers);
+    };
+
+    try {
+        auto out = detail::with_retries(host, attempt);
+        if(out.err() != 0) {
+            LOG(DEBUG, "Daemon reported error: {}", out.err());
+            return make_pair(out.err(), 0);
+        }
+        if(local_buffers->buffer)
+            memcpy(buf, local_buffers->buffer.get(),
+                   std::min<size_t>(out.io_size(), read_size));
+        return make_pair(0, out.io_size());
+    } catch(const std::exception& ex) {
+        LOG(ERROR, "while getting rpc output");
+        return make_pair(EBUSY, 0);
+    }
+}
+
+/**
+ * Send an RPC request to remove the inline data of a file from its metadentry
+ * after it was written to the file's chunks. The daemon only removes it if it
+ * equals the given data, i.e., if it was not modified since it was read, and
+ * replies with EAGAIN otherwise.
+ * @param path
+ * @param buf inline data written to the chunks
+ * @param size
+ * @return error code
+ */
+int
+forward_spill_inline(const string& path, const void* buf, size_t size) {
+
+    assert(size > 0);
+    auto host = CTX->distributor()->locate_file_metadata(path, 0);
+
+    std::shared_ptr<gkfs::rpc::rpc_memory> local_buffers;
+    try {
+        struct iovec iov {
+            const_cast<void*>(buf), size
+        };
+        local_buffers = expose_write(&iov, 1, RpcOp::write);
+    } catch(const std::exception& ex) {
+        LOG(ERROR, "Failed to expose buffers for RMA");
+        return EBUSY;
+    }
+
+    try {
+        LOG(DEBUG, "Sending RPC ...");
+        // removing the same data again has no effect, so it can be retried
+        auto out = detail::with_retries(host, [&](unsigned int) {
+            gkfs::rpc::read_inline::input in(path, 0, size, true,
+                                             local_buffers->exposed);
+            auto handle = ld_network_service->post<gkfs::rpc::read_inline>(
+                    CTX->hosts().at(host), in);
+            return get_output(handle, host, RpcOp::write, local_buffers);
+        });
+        if(out.err() != 0)
+            LOG(DEBUG, "Daemon reported error: {}", out.err());
+        return out.err();
+    } catch(const std::exception& ex) {
+        LOG(ERROR, "while getting rpc output");
+        return EBUSY;
+    }
+}
+
 /**
  * Send an RPC request to chunk stat all hosts
  * @return pair<error code, rpc::ChunkStat>
@@ -593,12 +1158,6 @@ forward_get_chunk_stat() {
 
             gkfs::rpc::chunk_stat::input in(0);
 
-            // TODO(amiranda): add a post() with RPC_TIMEOUT to hermes so
-            // that we can retry for RPC_TRIES (see old commits with margo)
-            // TODO(amiranda): hermes will eventually provide a
-            // post(endpoint) returning one result and a
-            // broadcast(endpoint_set) returning a result_set. When that
-            // happens we can remove the .at(0) :/
             handles.emplace_back(
                     ld_network_service->post<gkfs::rpc::chunk_stat>(endp, in));
 
@@ -613,7 +1172,7 @@ forward_get_chunk_stat() {
         }
     }
 
-    unsigned long chunk_size = gkfs::config::rpc::chunksize;
+    unsigned long chunk_size = CTX->fs_conf()->chunksize;
     unsigned long chunk_total = 0;
     unsigned long chunk_free = 0;
 
@@ -623,9 +1182,9 @@ forward_get_chunk_stat() {
         gkfs::rpc::chunk_stat::output out{};
 
         try {
-            // XXX We might need a timeout here to not wait forever for an
-            // output that never comes?
-            out = handles[i].get().at(0);
+            // handles are in the order of the hosts
+            out = get_output_with_retries(handles[i], RpcOp::metadata, i,
+                                          gkfs::rpc::chunk_stat::input(0));
 
             if(out.err()) {
                 err = out.err();
@@ -31,6 +31,7 @@
 #include <client/logging.hpp>
 #include <client/preload_util.hpp>
 #include <client/rpc/rpc_types.hpp>
+#include <client/rpc/rpc_call.hpp>
 
 namespace gkfs::rpc {
 
@@ -42,7 +43,7 @@ namespace gkfs::rpc {
 bool
 forward_get_fs_config() {
 
-    auto endp = CTX->hosts().at(CTX->local_host_id());
+    auto host = CTX->local_host_id();
     gkfs::rpc::fs_config::output out;
 
     bool found = false;
@@ -50,19 +51,14 @@ forward_get_fs_config() {
     while(!found && idx <= CTX->hosts().size()) {
         try {
             LOG(DEBUG, "Retrieving file system configurations from daemon");
-            // TODO(amiranda): add a post() with RPC_TIMEOUT to hermes so that
-            // we can retry for RPC_TRIES (see old commits with margo)
-            // TODO(amiranda): hermes will eventually provide a post(endpoint)
-            // returning one result and a broadcast(endpoint_set) returning a
-            // result_set. When that happens we can remove the .at(0) :/
-            out = ld_network_service->post<gkfs::rpc::fs_config>(endp).get().at(
-                    0);
+            out = call<gkfs::rpc::fs_config>(gkfs::preload::RpcOp::metadata,
+                                             host);
             found = true;
         } catch(const std::exception& ex) {
             LOG(ERROR,
                 "Retrieving fs configurations from daemon, possible reattempt at peer: {}",
                 idx);
-            endp = CTX->hosts().at(idx++);
+            host = idx++;
         }
     }
 
@@ -80,6 +76,10 @@ forward_get_fs_config() {
     CTX->fs_conf()->blocks_state = out.blocks_state();
     CTX->fs_conf()->uid = out.uid();
     CTX->fs_conf()->gid = out.gid();
+    CTX->fs_conf()->inline_data_size = out.inline_data_size();
+    CTX->fs_conf()->chunksize = out.chunksize();
+    CTX->fs_conf()->ec_data_shards = out.ec_data_shards();
+    CTX->fs_conf()->ec_parity_shards = out.ec_parity_shards();
 
     LOG(DEBUG, "Got response with mountdir {}", out.mountdir());
 
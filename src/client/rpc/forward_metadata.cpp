@@ -32,13 +32,16 @@
 #include <client/logging.hpp>
 #include <client/preload_util.hpp>
 #include <client/open_dir.hpp>
+#include <client/erasure_coding.hpp>
 #include <client/rpc/rpc_types.hpp>
+#include <client/rpc/rpc_call.hpp>
 
 #include <common/rpc/rpc_util.hpp>
 #include <common/rpc/distributor.hpp>
 #include <common/rpc/rpc_types.hpp>
 
 using namespace std;
+using gkfs::preload::RpcOp;
 
 namespace gkfs::rpc {
 
@@ -57,19 +60,11 @@ namespace gkfs::rpc {
 int
 forward_create(const std::string& path, const mode_t mode, const int copy) {
 
-    auto endp = CTX->hosts().at(
-            CTX->distributor()->locate_file_metadata(path, copy));
+    auto host = CTX->distributor()->locate_file_metadata(path, copy);
 
     try {
         LOG(DEBUG, "Sending RPC ...");
-        // TODO(amiranda): add a post() with RPC_TIMEOUT to hermes so that we
-        // can retry for RPC_TRIES (see old commits with margo)
-        // TODO(amiranda): hermes will eventually provide a post(endpoint)
-        // returning one result and a broadcast(endpoint_set) returning a
-        // result_set. When that happens we can remove the .at(0) :/
-        auto out = ld_network_service->post<gkfs::rpc::create>(endp, path, mode)
-                           .get()
-                           .at(0);
+        auto out = call<gkfs::rpc::create>(RpcOp::metadata, host, path, mode);
         LOG(DEBUG, "Got response success: {}", out.err());
 
         return out.err() ? out.err() : 0;
@@ -89,19 +84,12 @@ forward_create(const std::string& path, const mode_t mode, const int copy) {
 int
 forward_stat(const std::string& path, string& attr, const int copy) {
 
-    auto endp = CTX->hosts().at(
-            CTX->distributor()->locate_file_metadata(path, copy));
+    auto host = CTX->distributor()->locate_file_metadata(path, copy);
 
     try {
         LOG(DEBUG, "Sending RPC ...");
-        // TODO(amiranda): add a post() with RPC_TIMEOUT to hermes so that we
-        // can retry for RPC_TRIES (see old commits with margo)
-        // TODO(amiranda): hermes will eventually provide a post(endpoint)
-        // returning one result and a broadcast(endpoint_set) returning a
-        // result_set. When that happens we can remove the .at(0) :/
-        auto out = ld_network_service->post<gkfs::rpc::stat>(endp, path)
-                           .get()
-                           .at(0);
+        auto out = call_with_retries<gkfs::rpc::stat>(RpcOp::metadata, host,
+                                                      path);
         LOG(DEBUG, "Got response success: {}", out.err());
 
         if(out.err())
@@ -134,8 +122,7 @@ forward_remove(const std::string& path, const int8_t num_copies) {
     uint32_t mode = 0;
 
     for(auto copy = 0; copy < (num_copies + 1); copy++) {
-        auto endp = CTX->hosts().at(
-                CTX->distributor()->locate_file_metadata(path, copy));
+        auto host = CTX->distributor()->locate_file_metadata(path, copy);
 
         /*
          * Send one RPC to metadata destination and remove metadata while
@@ -143,15 +130,8 @@ forward_remove(const std::string& path, const int8_t num_copies) {
          */
         try {
             LOG(DEBUG, "Sending RPC ...");
-            // TODO(amiranda): add a post() with RPC_TIMEOUT to hermes so that
-            // we can retry for RPC_TRIES (see old commits with margo)
-            // TODO(amiranda): hermes will eventually provide a post(endpoint)
-            // returning one result and a broadcast(endpoint_set) returning a
-            // result_set. When that happens we can remove the .at(0) :/
-            auto out = ld_network_service
-                               ->post<gkfs::rpc::remove_metadata>(endp, path)
-                               .get()
-                               .at(0);
+            auto out = call<gkfs::rpc::remove_metadata>(RpcOp::metadata, host,
+                                                        path);
 
             LOG(DEBUG, "Got response success: {}", out.err());
 
@@ -171,9 +151,11 @@ forward_remove(const std::string& path, const int8_t num_copies) {
 
 
     std::vector<hermes::rpc_handle<gkfs::rpc::remove_data>> handles;
+    // daemons of the handles
+    std::vector<uint64_t> handle_hosts;
 
     // Small files
-    if(static_cast<std::size_t>(size / gkfs::config::rpc::chunksize) <
+    if(static_cast<std::size_t>(size / CTX->fs_conf()->chunksize) <
        CTX->hosts().size()) {
         for(auto copymd = 0; copymd < (num_copies + 1); copymd++) {
             const auto metadata_host_id =
@@ -187,9 +169,10 @@ forward_remove(const std::string& path, const int8_t num_copies) {
                 handles.emplace_back(
                         ld_network_service->post<gkfs::rpc::remove_data>(
                                 endp_metadata, in));
+                handle_hosts.push_back(metadata_host_id);
 
                 uint64_t chnk_start = 0;
-                uint64_t chnk_end = size / gkfs::config::rpc::chunksize;
+                uint64_t chnk_end = size / CTX->fs_conf()->chunksize;
 
                 for(uint64_t chnk_id = chnk_start; chnk_id <= chnk_end;
                     chnk_id++) {
@@ -216,6 +199,7 @@ forward_remove(const std::string& path, const int8_t num_copies) {
                                 ld_network_service
                                         ->post<gkfs::rpc::remove_data>(
                                                 endp_chnk, in));
+                        handle_hosts.push_back(chnk_host_id);
                     }
                 }
             } catch(const std::exception& ex) {
@@ -225,22 +209,17 @@ forward_remove(const std::string& path, const int8_t num_copies) {
             }
         }
     } else { // "Big" files
-        for(const auto& endp : CTX->hosts()) {
+        for(uint64_t host = 0; host < CTX->hosts().size(); host++) {
+            const auto& endp = CTX->hosts().at(host);
             try {
                 LOG(DEBUG, "Sending RPC to host: {}", endp.to_string());
 
                 gkfs::rpc::remove_data::input in(path);
 
-                // TODO(amiranda): add a post() with RPC_TIMEOUT to hermes so
-                // that we can retry for RPC_TRIES (see old commits with margo)
-                // TODO(amiranda): hermes will eventually provide a
-                // post(endpoint) returning one result and a
-                // broadcast(endpoint_set) returning a result_set. When that
-                // happens we can remove the .at(0) :/
-
                 handles.emplace_back(
                         ld_network_service->post<gkfs::rpc::remove_data>(endp,
                                                                          in));
+                handle_hosts.push_back(host);
 
             } catch(const std::exception& ex) {
                 // TODO(amiranda): we should cancel all previously posted
@@ -253,13 +232,29 @@ forward_remove(const std::string& path, const int8_t num_copies) {
             }
         }
     }
+    // parity chunks are spread over the daemons like the chunks of big files
+    if(gkfs::ec::enabled()) {
+        gkfs::rpc::remove_data::input in(gkfs::ec::parity_path(path));
+        for(uint64_t host = 0; host < CTX->hosts().size(); host++) {
+            const auto& endp = CTX->hosts().at(host);
+            try {
+                handles.emplace_back(
+                        ld_network_service->post<gkfs::rpc::remove_data>(endp,
+                                                                         in));
+                handle_hosts.push_back(host);
+            } catch(const std::exception& ex) {
+                LOG(ERROR,
+                    "Failed to forward non-blocking rpc request to host: {}",
+                    endp.to_string());
+                return EBUSY;
+            }
+        }
+    }
     // wait for RPC responses
     auto err = 0;
-    for(const auto& h : handles) {
+    for(size_t i = 0; i < handles.size(); i++) {
         try {
-            // XXX We might need a timeout here to not wait forever for an
-            // output that never comes?
-            auto out = h.get().at(0);
+            auto out = get_output(handles[i], handle_hosts[i], RpcOp::write);
 
             if(out.err() != 0) {
                 LOG(ERROR, "received error response: {}", out.err());
@@ -284,20 +279,12 @@ forward_remove(const std::string& path, const int8_t num_copies) {
 int
 forward_decr_size(const std::string& path, size_t length, const int copy) {
 
-    auto endp = CTX->hosts().at(
-            CTX->distributor()->locate_file_metadata(path, copy));
+    auto host = CTX->distributor()->locate_file_metadata(path, copy);
 
     try {
         LOG(DEBUG, "Sending RPC ...");
-        // TODO(amiranda): add a post() with RPC_TIMEOUT to hermes so that we
-        // can retry for RPC_TRIES (see old commits with margo)
-        // TODO(amiranda): hermes will eventually provide a post(endpoint)
-        // returning one result and a broadcast(endpoint_set) returning a
-        // result_set. When that happens we can remove the .at(0) :/
-        auto out = ld_network_service
-                           ->post<gkfs::rpc::decr_size>(endp, path, length)
-                           .get()
-                           .at(0);
+        auto out = call<gkfs::rpc::decr_size>(RpcOp::metadata, host, path,
+                                              length);
 
         LOG(DEBUG, "Got response success: {}", out.err());
 
@@ -324,36 +311,26 @@ forward_update_metadentry(const string& path,
                           const gkfs::metadata::MetadentryUpdateFlags& md_flags,
                           const int copy) {
 
-    auto endp = CTX->hosts().at(
-            CTX->distributor()->locate_file_metadata(path, copy));
+    auto host = CTX->distributor()->locate_file_metadata(path, copy);
 
     try {
         LOG(DEBUG, "Sending RPC ...");
-        // TODO(amiranda): add a post() with RPC_TIMEOUT to hermes so that we
-        // can retry for RPC_TRIES (see old commits with margo)
-        // TODO(amiranda): hermes will eventually provide a post(endpoint)
-        // returning one result and a broadcast(endpoint_set) returning a
-        // result_set. When that happens we can remove the .at(0) :/
-        auto out = ld_network_service
-                           ->post<gkfs::rpc::update_metadentry>(
-                                   endp, path,
-                                   (md_flags.link_count ? md.link_count() : 0),
-                                   /* mode */ 0,
-                                   /* uid */ 0,
-                                   /* gid */ 0, (md_flags.size ? md.size() : 0),
-                                   (md_flags.blocks ? md.blocks() : 0),
-                                   (md_flags.atime ? md.atime() : 0),
-                                   (md_flags.mtime ? md.mtime() : 0),
-                                   (md_flags.ctime ? md.ctime() : 0),
-                                   bool_to_merc_bool(md_flags.link_count),
-                                   /* mode_flag */ false,
-                                   bool_to_merc_bool(md_flags.size),
-                                   bool_to_merc_bool(md_flags.blocks),
-                                   bool_to_merc_bool(md_flags.atime),
-                                   bool_to_merc_bool(md_flags.mtime),
-                                   bool_to_merc_bool(md_flags.ctime))
-                           .get()
-                           .at(0);
+        auto out = call<gkfs::rpc::update_metadentry>(
+                RpcOp::metadata, host, path,
+                (md_flags.link_count ? md.link_count() : 0),
+                /* mode */ 0,
+                /* uid */ 0,
+                /* gid */ 0, (md_flags.size ? md.size() : 0),
+                (md_flags.blocks ? md.blocks() : 0),
+                (md_flags.atime ? md.atime() : 0),
+                (md_flags.mtime ? md.mtime() : 0),
+                (md_flags.ctime ? md.ctime() : 0),
+                bool_to_merc_bool(md_flags.link_count),
+                /* mode_flag */ false, bool_to_merc_bool(md_flags.size),
+                bool_to_merc_bool(md_flags.blocks),
+                bool_to_merc_bool(md_flags.atime),
+                bool_to_merc_bool(md_flags.mtime),
+                bool_to_merc_bool(md_flags.ctime));
 
         LOG(DEBUG, "Got response success: {}", out.err());
 
@@ -382,32 +359,20 @@ int
 forward_rename(const string& oldpath, const string& newpath,
                const gkfs::metadata::Metadata& md) {
 
-    auto endp = CTX->hosts().at(
-            CTX->distributor()->locate_file_metadata(oldpath, 0));
+    auto host = CTX->distributor()->locate_file_metadata(oldpath, 0);
 
     try {
         LOG(DEBUG, "Sending RPC ...");
-        // TODO(amiranda): add a post() with RPC_TIMEOUT to hermes so that we
-        // can retry for RPC_TRIES (see old commits with margo)
-        // TODO(amiranda): hermes will eventually provide a post(endpoint)
-        // returning one result and a broadcast(endpoint_set) returning a
-        // result_set. When that happens we can remove the .at(0) :/
-        auto out = ld_network_service
-                           ->post<gkfs::rpc::update_metadentry>(
-                                   endp, oldpath, (md.link_count()),
-                                   /* mode */ 0,
-                                   /* uid */ 0,
-                                   /* gid */ 0, md.size(),
-                                   /*  blockcnt  */ -1, (md.atime()),
-                                   (md.mtime()), (md.ctime()),
-                                   bool_to_merc_bool(md.link_count()),
-                                   /* mode_flag */ false,
-                                   bool_to_merc_bool(md.size()), 1,
-                                   bool_to_merc_bool(md.atime()),
-                                   bool_to_merc_bool(md.mtime()),
-                                   bool_to_merc_bool(md.ctime()))
-                           .get()
-                           .at(0);
+        auto out = call<gkfs::rpc::update_metadentry>(
+                RpcOp::metadata, host, oldpath, (md.link_count()),
+                /* mode */ 0,
+                /* uid */ 0,
+                /* gid */ 0, md.size(),
+                /*  blockcnt  */ -1, (md.atime()), (md.mtime()), (md.ctime()),
+                bool_to_merc_bool(md.link_count()),
+                /* mode_flag */ false, bool_to_merc_bool(md.size()), 1,
+                bool_to_merc_bool(md.atime()), bool_to_merc_bool(md.mtime()),
+                bool_to_merc_bool(md.ctime()));
 
         LOG(DEBUG, "Got response success: {}", out.err());
 
@@ -424,26 +389,12 @@ forward_rename(const string& oldpath, const string& newpath,
     /*
      * Now create the new file
      */
-    // TODO(amiranda): add a post() with RPC_TIMEOUT to hermes so that we
-    // can retry for RPC_TRIES (see old commits with margo)
-    // TODO(amiranda): hermes will eventually provide a post(endpoint)
-    // returning one result and a broadcast(endpoint_set) returning a
-    // result_set. When that happens we can remove the .at(0) :/
-    auto endp2 = CTX->hosts().at(
-            CTX->distributor()->locate_file_metadata(newpath, 0));
+    auto host2 = CTX->distributor()->locate_file_metadata(newpath, 0);
 
     try {
         LOG(DEBUG, "Sending RPC ...");
-        // TODO(amiranda): add a post() with RPC_TIMEOUT to hermes so that we
-        // can retry for RPC_TRIES (see old commits with margo)
-        // TODO(amiranda): hermes will eventually provide a post(endpoint)
-        // returning one result and a broadcast(endpoint_set) returning a
-        // result_set. When that happens we can remove the .at(0) :/
-
-        auto out = ld_network_service
-                           ->post<gkfs::rpc::create>(endp2, newpath, md2.mode())
-                           .get()
-                           .at(0);
+        auto out = call<gkfs::rpc::create>(RpcOp::metadata, host2, newpath,
+                                           md2.mode());
         LOG(DEBUG, "Got response success: {}", out.err());
 
     } catch(const std::exception& ex) {
@@ -454,17 +405,9 @@ forward_rename(const string& oldpath, const string& newpath,
 
     try {
         LOG(DEBUG, "Sending RPC ...");
-        // TODO(amiranda): add a post() with RPC_TIMEOUT to hermes so that we
-        // can retry for RPC_TRIES (see old commits with margo)
-        // TODO(amiranda): hermes will eventually provide a post(endpoint)
-        // returning one result and a broadcast(endpoint_set) returning a
-        // result_set. When that happens we can remove the .at(0) :/
         // Update new file with target link = oldpath
-        auto out =
-                ld_network_service
-                        ->post<gkfs::rpc::mk_symlink>(endp2, newpath, oldpath)
-                        .get()
-                        .at(0);
+        auto out = call<gkfs::rpc::mk_symlink>(RpcOp::metadata, host2, newpath,
+                                               oldpath);
 
         LOG(DEBUG, "Got response success: {}", out.err());
 
@@ -478,15 +421,8 @@ forward_rename(const string& oldpath, const string& newpath,
     // Update the renamed path to solve the issue with fstat with fd)
     try {
         LOG(DEBUG, "Sending RPC ...");
-        // TODO(amiranda): add a post() with RPC_TIMEOUT to hermes so that we
-        // can retry for RPC_TRIES (see old commits with margo)
-        // TODO(amiranda): hermes will eventually provide a post(endpoint)
-        // returning one result and a broadcast(endpoint_set) returning a
-        // result_set. When that happens we can remove the .at(0) :/
-        auto out = ld_network_service
-                           ->post<gkfs::rpc::mk_symlink>(endp, oldpath, newpath)
-                           .get()
-                           .at(0);
+        auto out = call<gkfs::rpc::mk_symlink>(RpcOp::metadata, host, oldpath,
+                                               newpath);
 
         LOG(DEBUG, "Got response success: {}", out.err());
 
@@ -517,21 +453,18 @@ forward_update_metadentry_size(const string& path, const size_t size,
                                const int num_copies) {
 
     std::vector<hermes::rpc_handle<gkfs::rpc::update_metadentry_size>> handles;
+    // daemons of the handles
+    std::vector<uint64_t> handle_hosts;
 
     for(auto copy = 0; copy < num_copies + 1; copy++) {
-        auto endp = CTX->hosts().at(
-                CTX->distributor()->locate_file_metadata(path, copy));
+        auto host = CTX->distributor()->locate_file_metadata(path, copy);
         try {
             LOG(DEBUG, "Sending RPC ...");
-            // TODO(amiranda): add a post() with RPC_TIMEOUT to hermes so that
-            // we can retry for RPC_TRIES (see old commits with margo)
-            // TODO(amiranda): hermes will eventually provide a post(endpoint)
-            // returning one result and a broadcast(endpoint_set) returning a
-            // result_set. When that happens we can remove the .at(0) :/
             handles.emplace_back(
                     ld_network_service->post<gkfs::rpc::update_metadentry_size>(
-                            endp, path, size, offset,
+                            CTX->hosts().at(host), path, size, offset,
                             bool_to_merc_bool(append_flag)));
+            handle_hosts.push_back(host);
         } catch(const std::exception& ex) {
             LOG(ERROR, "while getting rpc output");
             return make_pair(EBUSY, 0);
@@ -541,14 +474,14 @@ forward_update_metadentry_size(const string& path, const size_t size,
     ssize_t out_size = 0;
     auto idx = 0;
     bool valid = false;
-    for(const auto& h : handles) {
+    for(auto& h : handles) {
         try {
-            // XXX We might need a timeout here to not wait forever for an
-            // output that never comes?
-            auto out = h.get().at(0);
+            auto out = get_output(h, handle_hosts[idx], RpcOp::metadata);
 
             if(out.err() != 0) {
                 LOG(ERROR, "Daemon {} reported error: {}", idx, out.err());
+                if(!valid)
+                    err = out.err();
             } else {
                 valid = true;
                 out_size = out.ret_size();
@@ -580,20 +513,12 @@ forward_update_metadentry_size(const string& path, const size_t size,
 pair<int, off64_t>
 forward_get_metadentry_size(const std::string& path, const int copy) {
 
-    auto endp = CTX->hosts().at(
-            CTX->distributor()->locate_file_metadata(path, copy));
+    auto host = CTX->distributor()->locate_file_metadata(path, copy);
 
     try {
         LOG(DEBUG, "Sending RPC ...");
-        // TODO(amiranda): add a post() with RPC_TIMEOUT to hermes so that we
-        // can retry for RPC_TRIES (see old commits with margo)
-        // TODO(amiranda): hermes will eventually provide a post(endpoint)
-        // returning one result and a broadcast(endpoint_set) returning a
-        // result_set. When that happens we can remove the .at(0) :/
-        auto out = ld_network_service
-                           ->post<gkfs::rpc::get_metadentry_size>(endp, path)
-                           .get()
-                           .at(0);
+        auto out = call_with_retries<gkfs::rpc::get_metadentry_size>(
+                RpcOp::metadata, host, path);
 
         LOG(DEBUG, "Got response success: {}", out.err());
 
@@ -619,30 +544,22 @@ forward_get_dirents(const string& path) {
 
     auto const targets = CTX->distributor()->locate_directory_metadata(path);
 
-    /* preallocate receiving buffer. The actual size is not known yet.
-     *
-     * On C++14 make_unique function also zeroes the newly allocated buffer.
-     * It turns out that this operation is increadibly slow for such a big
-     * buffer. Moreover we don't need a zeroed buffer here.
+    /* preallocate receiving buffers. The actual size is not known yet.
+     * Each server gets its own buffer, which is owned by its RPCs until they
+     * completed.
      */
-    auto large_buffer = std::unique_ptr<char[]>(
-            new char[gkfs::config::rpc::dirents_buff_size]);
-
     // XXX there is a rounding error here depending on the number of targets...
     const std::size_t per_host_buff_size =
             gkfs::config::rpc::dirents_buff_size / targets.size();
 
     // expose local buffers for RMA from servers
-    std::vector<hermes::exposed_memory> exposed_buffers;
+    std::vector<std::shared_ptr<gkfs::rpc::rpc_memory>> exposed_buffers;
     exposed_buffers.reserve(targets.size());
 
     for(std::size_t i = 0; i < targets.size(); ++i) {
         try {
-            exposed_buffers.emplace_back(ld_network_service->expose(
-                    std::vector<hermes::mutable_buffer>{hermes::mutable_buffer{
-                            large_buffer.get() + (i * per_host_buff_size),
-                            per_host_buff_size}},
-                    hermes::access_mode::write_only));
+            exposed_buffers.emplace_back(expose_read(
+                    nullptr, per_host_buff_size, RpcOp::dirents));
         } catch(const std::exception& ex) {
             LOG(ERROR, "{}() Failed to expose buffers for RMA. err '{}'",
                 __func__, ex.what());
@@ -659,7 +576,7 @@ forward_get_dirents(const string& path) {
         // Setup rpc input parameters for each host
         auto endp = CTX->hosts().at(targets[i]);
 
-        gkfs::rpc::get_dirents::input in(path, exposed_buffers[i]);
+        gkfs::rpc::get_dirents::input in(path, exposed_buffers[i]->exposed);
 
         try {
             LOG(DEBUG, "{}() Sending RPC to host: '{}'", __func__, targets[i]);
@@ -686,9 +603,20 @@ forward_get_dirents(const string& path) {
         gkfs::rpc::get_dirents::output out;
 
         try {
-            // XXX We might need a timeout here to not wait forever for an
-            // output that never comes?
-            out = handles[i].get().at(0);
+            out = detail::with_retries(targets[i], [&](unsigned int retry) {
+                if(retry == 0)
+                    return get_output(handles[i], targets[i], RpcOp::dirents,
+                                      exposed_buffers[i]);
+                // an RPC that timed out may still write to its buffer
+                exposed_buffers[i] = expose_read(nullptr, per_host_buff_size,
+                                                 RpcOp::dirents);
+                auto handle = ld_network_service->post<gkfs::rpc::get_dirents>(
+                        CTX->hosts().at(targets[i]),
+                        gkfs::rpc::get_dirents::input(
+                                path, exposed_buffers[i]->exposed));
+                return get_output(handle, targets[i], RpcOp::dirents,
+                                  exposed_buffers[i]);
+            });
             // skip processing dirent data if there was an error during send
             // In this case all responses are gathered but their contents
             // skipped
@@ -712,11 +640,8 @@ forward_get_dirents(const string& path) {
             continue;
         }
 
-        // each server wrote information to its pre-defined region in
-        // large_buffer, recover it by computing the base_address for each
-        // particular server and adding the appropriate offsets
-        assert(exposed_buffers[i].count() == 1);
-        void* base_ptr = exposed_buffers[i].begin()->data();
+        // each server wrote information to its own buffer
+        void* base_ptr = exposed_buffers[i]->buffer.get();
 
         bool* bool_ptr = reinterpret_cast<bool*>(base_ptr);
         char* names_ptr = reinterpret_cast<char*>(base_ptr) +
@@ -766,27 +691,19 @@ forward_get_dirents_single(const string& path, int server) {
     auto const targets = CTX->distributor()->locate_directory_metadata(path);
 
     /* preallocate receiving buffer. The actual size is not known yet.
-     *
-     * On C++14 make_unique function also zeroes the newly allocated buffer.
-     * It turns out that this operation is increadibly slow for such a big
-     * buffer. Moreover we don't need a zeroed buffer here.
+     * The buffer is owned by the RPCs until they completed.
      */
-    auto large_buffer = std::unique_ptr<char[]>(
-            new char[gkfs::config::rpc::dirents_buff_size]);
-
     // We use the full size per server...
     const std::size_t per_host_buff_size = gkfs::config::rpc::dirents_buff_size;
     vector<tuple<const std::string, bool, size_t, time_t>> output;
 
     // expose local buffers for RMA from servers
-    std::vector<hermes::exposed_memory> exposed_buffers;
+    std::vector<std::shared_ptr<gkfs::rpc::rpc_memory>> exposed_buffers;
     exposed_buffers.reserve(1);
     std::size_t i = server;
     try {
-        exposed_buffers.emplace_back(ld_network_service->expose(
-                std::vector<hermes::mutable_buffer>{hermes::mutable_buffer{
-                        large_buffer.get(), per_host_buff_size}},
-                hermes::access_mode::write_only));
+        exposed_buffers.emplace_back(
+                expose_read(nullptr, per_host_buff_size, RpcOp::dirents));
     } catch(const std::exception& ex) {
         LOG(ERROR, "{}() Failed to expose buffers for RMA. err '{}'", __func__,
             ex.what());
@@ -799,7 +716,8 @@ forward_get_dirents_single(const string& path, int server) {
 
     auto endp = CTX->hosts().at(targets[i]);
 
-    gkfs::rpc::get_dirents_extended::input in(path, exposed_buffers[0]);
+    gkfs::rpc::get_dirents_extended::input in(path,
+                                              exposed_buffers[0]->exposed);
 
     try {
         LOG(DEBUG, "{}() Sending RPC to host: '{}'", __func__, targets[i]);
@@ -822,9 +740,20 @@ forward_get_dirents_single(const string& path, int server) {
     gkfs::rpc::get_dirents_extended::output out;
 
     try {
-        // XXX We might need a timeout here to not wait forever for an
-        // output that never comes?
-        out = handles[0].get().at(0);
+        out = detail::with_retries(targets[i], [&](unsigned int retry) {
+            if(retry == 0)
+                return get_output(handles[0], targets[i], RpcOp::dirents,
+                                  exposed_buffers[0]);
+            // an RPC that timed out may still write to its buffer
+            exposed_buffers[0] = expose_read(nullptr, per_host_buff_size,
+                                             RpcOp::dirents);
+            auto handle =
+                    ld_network_service->post<gkfs::rpc::get_dirents_extended>(
+                            endp, gkfs::rpc::get_dirents_extended::input(
+                                          path, exposed_buffers[0]->exposed));
+            return get_output(handle, targets[i], RpcOp::dirents,
+                              exposed_buffers[0]);
+        });
         // skip processing dirent data if there was an error during send
         // In this case all responses are gathered but their contents skipped
 
@@ -845,7 +774,7 @@ forward_get_dirents_single(const string& path, int server) {
 
     // The parenthesis is extremely important if not the cast will add as a
     // size_t or a time_t and not as a char
-    auto out_buff_ptr = static_cast<char*>(exposed_buffers[0].begin()->data());
+    auto out_buff_ptr = exposed_buffers[0]->buffer.get();
     auto bool_ptr = reinterpret_cast<bool*>(out_buff_ptr);
     auto size_ptr = reinterpret_cast<size_t*>(
             (out_buff_ptr) + (out.dirents_size() * sizeof(bool)));
@@ -887,21 +816,12 @@ forward_get_dirents_single(const string& path, int server) {
 int
 forward_mk_symlink(const std::string& path, const std::string& target_path) {
 
-    auto endp =
-            CTX->hosts().at(CTX->distributor()->locate_file_metadata(path, 0));
+    auto host = CTX->distributor()->locate_file_metadata(path, 0);
 
     try {
         LOG(DEBUG, "Sending RPC ...");
-        // TODO(amiranda): add a post() with RPC_TIMEOUT to hermes so that we
-        // can retry for RPC_TRIES (see old commits with margo)
-        // TODO(amiranda): hermes will eventually provide a post(endpoint)
-        // returning one result and a broadcast(endpoint_set) returning a
-        // result_set. When that happens we can remove the .at(0) :/
-        auto out =
-                ld_network_service
-                        ->post<gkfs::rpc::mk_symlink>(endp, path, target_path)
-                        .get()
-                        .at(0);
+        auto out = call<gkfs::rpc::mk_symlink>(RpcOp::metadata, host, path,
+                                               target_path);
 
         LOG(DEBUG, "Got response success: {}", out.err());
 
@@ -0,0 +1,236 @@
+/*
+  Copyright 2018-2024, Barcelona Supercomputing Center (BSC), Spain
+  Copyright 2015-2024, Johannes Gutenberg Universitaet Mainz, Germany
+
+  This software was partially supported by the
+  EC H2020 funded project NEXTGenIO (Project ID: 671951, www.nextgenio.eu).
+
+  This software was partially supported by the
+  ADA-FS project under the SPPEXA project funded by the DFG.
+
+  This file is part of GekkoFS' POSIX interface.
+
+  GekkoFS' POSIX interface is free software: you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation, either version 3 of the License,
+  or (at your option) any later version.
+
+  GekkoFS' POSIX interface is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with GekkoFS' POSIX interface.  If not, see
+  <https://www.gnu.org/licenses/>.
+
+  SPDX-License-Identifier: LGPL-3.0-or-later
+*/
+
+#include <client/rpc/rpc_call.hpp>
+
+#include <config.hpp>
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <mutex>
+
+#include <sys/uio.h>
+
+namespace gkfs::rpc {
+
+// opaque to the callers of wait_in_background()
+class background_wait {
+public:
+    std::function<void(bool)> wait_;
+    bool queued_{false};
+    bool running_{false};
+    bool abandoned_{false};
+};
+
+namespace {
+
+/*
+ * Threads waiting for RPCs in the background. Hermes can only wait for an RPC
+ * by blocking a thread, so every RPC waited for at the same time needs its own
+ * thread. Threads are started on demand up to max_rpc_waiters and then reused
+ * for further RPCs, which wait in order while all threads are busy.
+ *
+ * Threads waiting for abandoned RPCs, e.g., RPCs to a hung daemon that timed
+ * out, do not count towards max_rpc_waiters, so that they cannot hold up the
+ * RPCs still waited for. Up to max_abandoned_rpc_waiters additional threads
+ * are started for them, which end once their RPC completed.
+ */
+class rpc_waiters {
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<std::shared_ptr<background_wait>> waits_;
+    unsigned int threads_{0};
+    unsigned int idle_{0};
+    unsigned int abandoned_{0}; //!< Threads waiting for abandoned RPCs
+
+    unsigned int
+    max_threads() const {
+        return gkfs::config::rpc::max_rpc_waiters +
+               std::min(abandoned_,
+                        gkfs::config::rpc::max_abandoned_rpc_waiters);
+    }
+
+    // mutex_ must be held
+    bool
+    start_thread() {
+        if(idle_ >= waits_.size())
+            return true;
+        if(threads_ >= max_threads())
+            return false;
+        std::thread([this] { run(); }).detach();
+        threads_++;
+        cv_.notify_one();
+        return true;
+    }
+
+    void
+    run() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        for(;;) {
+            idle_++;
+            cv_.wait(lock, [this] { return !waits_.empty(); });
+            idle_--;
+            auto w = std::move(waits_.front());
+            waits_.pop_front();
+            w->running_ = true;
+            if(w->abandoned_) {
+                abandoned_++;
+                start_thread();
+            }
+            auto wait = std::move(w->wait_);
+            auto queued = w->queued_;
+            lock.unlock();
+            wait(queued);
+            // release what the RPC owned before waiting for the next one
+            wait = nullptr;
+            lock.lock();
+            w->running_ = false;
+            if(w->abandoned_)
+                abandoned_--;
+            // threads started for abandoned RPCs end with them
+            if(threads_ > max_threads()) {
+                threads_--;
+                return;
+            }
+        }
+    }
+
+public:
+    std::shared_ptr<background_wait>
+    add(std::function<void(bool)> wait) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto w = std::make_shared<background_wait>();
+        w->wait_ = std::move(wait);
+        waits_.push_back(w);
+        w->queued_ = !start_thread();
+        cv_.notify_one();
+        return w;
+    }
+
+    void
+    abandon(const std::shared_ptr<background_wait>& w) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if(w->abandoned_)
+            return;
+        w->abandoned_ = true;
+        if(w->running_) {
+            abandoned_++;
+            start_thread();
+        }
+    }
+};
+
+// never destroyed as its threads may still wait when the process exits
+rpc_waiters&
+waiters() {
+    static auto* waiters = new rpc_waiters();
+    return *waiters;
+}
+
+} // namespace
+
+
+EndpointHealth&
+endpoint_health() {
+    static EndpointHealth health{
+            gkfs::config::rpc::suspect_failures,
+            std::chrono::milliseconds(gkfs::config::rpc::suspect_period_ms)};
+    return health;
+}
+
+std::chrono::milliseconds
+retry_backoff(unsigned int retry) {
+    const auto max_ms = gkfs::config::rpc::rpc_retry_backoff_max_ms;
+    // doubling stops at the maximum
+    auto ms = gkfs::config::rpc::rpc_retry_backoff_ms;
+    for(unsigned int i = 0; i < retry && ms < max_ms; i++)
+        ms *= 2;
+    return std::chrono::milliseconds(std::min(ms, max_ms));
+}
+
+std::shared_ptr<rpc_memory>
+expose_write(const struct iovec* iov, int iovcnt, gkfs::preload::RpcOp op) {
+    auto memory = std::make_shared<rpc_memory>();
+    std::vector<hermes::mutable_buffer> bufseq{};
+    if(CTX->get_rpc_timeout(op) == 0) {
+        // every RPC is waited for before the write returns
+        for(int i = 0; i < iovcnt; i++) {
+            if(iov[i].iov_len == 0)
+                continue;
+            bufseq.push_back(
+                    hermes::mutable_buffer{iov[i].iov_base, iov[i].iov_len});
+        }
+    } else {
+        size_t size = 0;
+        for(int i = 0; i < iovcnt; i++)
+            size += iov[i].iov_len;
+        // not zeroed as the data is copied to it right away
+        memory->buffer = std::unique_ptr<char[]>(new char[size]);
+        size_t pos = 0;
+        for(int i = 0; i < iovcnt; i++) {
+            if(iov[i].iov_len == 0)
+                continue;
+            std::memcpy(memory->buffer.get() + pos, iov[i].iov_base,
+                        iov[i].iov_len);
+            pos += iov[i].iov_len;
+        }
+        bufseq.push_back(hermes::mutable_buffer{memory->buffer.get(), size});
+    }
+    memory->exposed = ld_network_service->expose(
+            bufseq, hermes::access_mode::read_only);
+    return memory;
+}
+
+std::shared_ptr<rpc_memory>
+expose_read(void* buf, size_t size, gkfs::preload::RpcOp op) {
+    auto memory = std::make_shared<rpc_memory>();
+    if(!buf || CTX->get_rpc_timeout(op) > 0) {
+        memory->buffer = std::unique_ptr<char[]>(new char[size]);
+        buf = memory->buffer.get();
+    }
+    memory->exposed = ld_network_service->expose(
+            std::vector<hermes::mutable_buffer>{
+                    hermes::mutable_buffer{buf, size}},
+            hermes::access_mode::write_only);
+    return memory;
+}
+
+std::shared_ptr<background_wait>
+wait_in_background(std::function<void(bool)> wait) {
+    return waiters().add(std::move(wait));
+}
+
+void
+abandon_wait(const std::shared_ptr<background_wait>& wait) {
+    waiters().abandon(wait);
+}
+
+} // namespace gkfs::rpc
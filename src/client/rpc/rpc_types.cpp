@@ -43,6 +43,8 @@ hermes::detail::register_user_request_types() {
     (void) registered_requests().add<gkfs::rpc::update_metadentry>();
     (void) registered_requests().add<gkfs::rpc::get_metadentry_size>();
     (void) registered_requests().add<gkfs::rpc::update_metadentry_size>();
+    (void) registered_requests().add<gkfs::rpc::write_inline>();
+    (void) registered_requests().add<gkfs::rpc::read_inline>();
 
 #ifdef HAS_SYMLINKS
     (void) registered_requests().add<gkfs::rpc::mk_symlink>();
@@ -53,5 +55,6 @@ hermes::detail::register_user_request_types() {
     (void) registered_requests().add<gkfs::rpc::trunc_data>();
     (void) registered_requests().add<gkfs::rpc::get_dirents>();
     (void) registered_requests().add<gkfs::rpc::chunk_stat>();
+    (void) registered_requests().add<gkfs::rpc::fsync_data>();
     (void) registered_requests().add<gkfs::rpc::get_dirents_extended>();
 }
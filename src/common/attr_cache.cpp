@@ -0,0 +1,121 @@
+/*
+  Copyright 2018-2024, Barcelona Supercomputing Center (BSC), Spain
+  Copyright 2015-2024, Johannes Gutenberg Universitaet Mainz, Germany
+
+  This software was partially supported by the
+  EC H2020 funded project NEXTGenIO (Project ID: 671951, www.nextgenio.eu).
+
+  This software was partially supported by the
+  ADA-FS project under the SPPEXA project funded by the DFG.
+
+  This file is part of GekkoFS.
+
+  GekkoFS is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  GekkoFS is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with GekkoFS.  If not, see <https://www.gnu.org/licenses/>.
+
+  SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include <common/attr_cache.hpp>
+
+#include <functional>
+
+using namespace std;
+
+namespace gkfs::metadata {
+
+AttributeCache::shard&
+AttributeCache::get_shard(const string& path) {
+    return *shards_[hash<string>{}(path) % shards_.size()];
+}
+
+AttributeCache::AttributeCache(size_t capacity, size_t shard_count,
+                               clock::duration ttl)
+    : ttl_(ttl) {
+    if(shard_count == 0)
+        shard_count = 1;
+    // do not create more shards than entries
+    if(capacity < shard_count)
+        shard_count = capacity > 0 ? capacity : 1;
+    shard_capacity_ = capacity / shard_count;
+    shards_.reserve(shard_count);
+    for(size_t i = 0; i < shard_count; i++)
+        shards_.emplace_back(make_unique<shard>());
+}
+
+optional<CachedAttributes>
+AttributeCache::get(const string& path, clock::time_point now) {
+    auto& s = get_shard(path);
+    lock_guard<mutex> lock(s.mtx);
+    auto it = s.map.find(path);
+    if(it == s.map.end()) {
+        misses_++;
+        return {};
+    }
+    if(it->second->expires <= now) {
+        s.lru.erase(it->second);
+        s.map.erase(it);
+        misses_++;
+        return {};
+    }
+    hits_++;
+    // move entry to the front of the LRU list
+    s.lru.splice(s.lru.begin(), s.lru, it->second);
+    return it->second->value;
+}
+
+void
+AttributeCache::put(const string& path, CachedAttributes value,
+                    clock::time_point now) {
+    if(shard_capacity_ == 0)
+        return;
+    auto& s = get_shard(path);
+    lock_guard<mutex> lock(s.mtx);
+    auto it = s.map.find(path);
+    if(it != s.map.end()) {
+        it->second->value = std::move(value);
+        it->second->expires = now + ttl_;
+        s.lru.splice(s.lru.begin(), s.lru, it->second);
+        return;
+    }
+    if(s.map.size() >= shard_capacity_) {
+        s.map.erase(s.lru.back().path);
+        s.lru.pop_back();
+        evictions_++;
+    }
+    s.lru.push_front({path, std::move(value), now + ttl_});
+    s.map.emplace(path, s.lru.begin());
+}
+
+void
+AttributeCache::invalidate(const string& path) {
+    auto& s = get_shard(path);
+    lock_guard<mutex> lock(s.mtx);
+    auto it = s.map.find(path);
+    if(it == s.map.end())
+        return;
+    s.lru.erase(it->second);
+    s.map.erase(it);
+}
+
+AttributeCacheStats
+AttributeCache::stats() const {
+    size_t size = 0;
+    for(const auto& s : shards_) {
+        lock_guard<mutex> lock(s->mtx);
+        size += s->map.size();
+    }
+    return {hits_.load(), misses_.load(), evictions_.load(), size};
+}
+
+} // namespace gkfs::metadata
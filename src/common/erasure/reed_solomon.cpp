@@ -0,0 +1,359 @@
+/*
+  Copyright 2018-2024, Barcelona Supercomputing Center (BSC), Spain
+  Copyright 2015-2024, Johannes Gutenberg Universitaet Mainz, Germany
+
+  This software was partially supported by the
+  EC H2020 funded project NEXTGenIO (Project ID: 671951, www.nextgenio.eu).
+
+  This software was partially supported by the
+  ADA-FS project under the SPPEXA project funded by the DFG.
+
+  This file is part of GekkoFS.
+
+  GekkoFS is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  GekkoFS is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with GekkoFS.  If not, see <https://www.gnu.org/licenses/>.
+
+  SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include <common/erasure/reed_solomon.hpp>
+
+#include <algorithm>
+#include <array>
+#include <stdexcept>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+using namespace std;
+
+namespace gkfs::ec {
+
+namespace {
+
+// x^8 + x^4 + x^3 + x^2 + 1
+constexpr unsigned int gf_poly = 0x11d;
+// bytes of the low and high nibble product tables of a coefficient
+constexpr size_t table_size = 32;
+// shards are encoded in slices that keep all shards in the cache
+constexpr size_t slice_size = 16 * 1024;
+
+struct gf_tables {
+    array<uint8_t, 512> exp;
+    array<uint8_t, 256> log;
+};
+
+constexpr gf_tables
+make_gf_tables() {
+    gf_tables t{};
+    unsigned int x = 1;
+    for(unsigned int i = 0; i < 255; i++) {
+        t.exp[i] = static_cast<uint8_t>(x);
+        t.exp[i + 255] = static_cast<uint8_t>(x);
+        t.log[x] = static_cast<uint8_t>(i);
+        x <<= 1;
+        if(x & 0x100)
+            x ^= gf_poly;
+    }
+    return t;
+}
+
+constexpr auto gf = make_gf_tables();
+
+uint8_t
+gf_mul(uint8_t a, uint8_t b) {
+    if(a == 0 || b == 0)
+        return 0;
+    return gf.exp[gf.log[a] + gf.log[b]];
+}
+
+uint8_t
+gf_inv(uint8_t a) {
+    return gf.exp[255 - gf.log[a]];
+}
+
+/*
+ * Writes the products of c with all low nibbles followed by those with all
+ * high nibbles, so that c * x == lo[x & 0x0f] ^ hi[x >> 4].
+ */
+void
+make_nibble_tables(uint8_t c, uint8_t* tables) {
+    for(unsigned int x = 0; x < 16; x++) {
+        tables[x] = gf_mul(c, static_cast<uint8_t>(x));
+        tables[16 + x] = gf_mul(c, static_cast<uint8_t>(x << 4));
+    }
+}
+
+/*
+ * Kernels multiplying src with a coefficient given by its nibble tables and
+ * writing the product to dst, or adding it to dst if add is set.
+ */
+using mul_kernel = void (*)(const uint8_t* tables, const uint8_t* src,
+                            uint8_t* dst, size_t size, bool add);
+
+void
+mul_scalar(const uint8_t* tables, const uint8_t* src, uint8_t* dst,
+           size_t size, bool add) {
+    const auto* lo = tables;
+    const auto* hi = tables + 16;
+    if(add) {
+        for(size_t i = 0; i < size; i++)
+            dst[i] ^= lo[src[i] & 0x0f] ^ hi[src[i] >> 4];
+    } else {
+        for(size_t i = 0; i < size; i++)
+            dst[i] = lo[src[i] & 0x0f] ^ hi[src[i] >> 4];
+    }
+}
+
+#if defined(__x86_64__)
+__attribute__((target("ssse3"))) void
+mul_ssse3(const uint8_t* tables, const uint8_t* src, uint8_t* dst, size_t size,
+          bool add) {
+    const auto lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(tables));
+    const auto hi =
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(tables + 16));
+    const auto mask = _mm_set1_epi8(0x0f);
+    size_t i = 0;
+    for(; i + 16 <= size; i += 16) {
+        auto v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        auto v_hi = _mm_and_si128(_mm_srli_epi64(v, 4), mask);
+        auto p = _mm_xor_si128(_mm_shuffle_epi8(lo, _mm_and_si128(v, mask)),
+                               _mm_shuffle_epi8(hi, v_hi));
+        if(add) {
+            p = _mm_xor_si128(
+                    p, _mm_loadu_si128(reinterpret_cast<__m128i*>(dst + i)));
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), p);
+    }
+    mul_scalar(tables, src + i, dst + i, size - i, add);
+}
+
+__attribute__((target("avx2"))) void
+mul_avx2(const uint8_t* tables, const uint8_t* src, uint8_t* dst, size_t size,
+         bool add) {
+    const auto lo = _mm256_broadcastsi128_si256(
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(tables)));
+    const auto hi = _mm256_broadcastsi128_si256(
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(tables + 16)));
+    const auto mask = _mm256_set1_epi8(0x0f);
+    size_t i = 0;
+    for(; i + 32 <= size; i += 32) {
+        auto v = _mm256_loadu_si256(
+                reinterpret_cast<const __m256i*>(src + i));
+        auto v_hi = _mm256_and_si256(_mm256_srli_epi64(v, 4), mask);
+        auto p = _mm256_xor_si256(
+                _mm256_shuffle_epi8(lo, _mm256_and_si256(v, mask)),
+                _mm256_shuffle_epi8(hi, v_hi));
+        if(add) {
+            p = _mm256_xor_si256(
+                    p, _mm256_loadu_si256(reinterpret_cast<__m256i*>(dst + i)));
+        }
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), p);
+    }
+    mul_scalar(tables, src + i, dst + i, size - i, add);
+}
+#elif defined(__aarch64__)
+void
+mul_neon(const uint8_t* tables, const uint8_t* src, uint8_t* dst, size_t size,
+         bool add) {
+    const auto lo = vld1q_u8(tables);
+    const auto hi = vld1q_u8(tables + 16);
+    const auto mask = vdupq_n_u8(0x0f);
+    size_t i = 0;
+    for(; i + 16 <= size; i += 16) {
+        auto v = vld1q_u8(src + i);
+        auto p = veorq_u8(vqtbl1q_u8(lo, vandq_u8(v, mask)),
+                          vqtbl1q_u8(hi, vshrq_n_u8(v, 4)));
+        if(add)
+            p = veorq_u8(p, vld1q_u8(dst + i));
+        vst1q_u8(dst + i, p);
+    }
+    mul_scalar(tables, src + i, dst + i, size - i, add);
+}
+#endif
+
+struct kernel_info {
+    mul_kernel mul;
+    const char* name;
+};
+
+kernel_info
+select_kernel() {
+#if defined(__x86_64__)
+    if(__builtin_cpu_supports("avx2"))
+        return {mul_avx2, "avx2"};
+    if(__builtin_cpu_supports("ssse3"))
+        return {mul_ssse3, "ssse3"};
+#elif defined(__aarch64__)
+    return {mul_neon, "neon"};
+#endif
+    return {mul_scalar, "scalar"};
+}
+
+const kernel_info&
+active_kernel() {
+    static const kernel_info kernel = select_kernel();
+    return kernel;
+}
+
+/*
+ * Inverts the n x n matrix a with Gauss-Jordan elimination.
+ */
+vector<uint8_t>
+invert(vector<uint8_t> a, unsigned int n) {
+    vector<uint8_t> inv(n * n, 0);
+    for(unsigned int i = 0; i < n; i++)
+        inv[i * n + i] = 1;
+    for(unsigned int col = 0; col < n; col++) {
+        auto pivot = col;
+        while(pivot < n && a[pivot * n + col] == 0)
+            pivot++;
+        if(pivot == n)
+            throw runtime_error("Reed-Solomon matrix is singular");
+        if(pivot != col) {
+            for(unsigned int j = 0; j < n; j++) {
+                swap(a[pivot * n + j], a[col * n + j]);
+                swap(inv[pivot * n + j], inv[col * n + j]);
+            }
+        }
+        auto scale = gf_inv(a[col * n + col]);
+        for(unsigned int j = 0; j < n; j++) {
+            a[col * n + j] = gf_mul(a[col * n + j], scale);
+            inv[col * n + j] = gf_mul(inv[col * n + j], scale);
+        }
+        for(unsigned int row = 0; row < n; row++) {
+            auto factor = a[row * n + col];
+            if(row == col || factor == 0)
+                continue;
+            for(unsigned int j = 0; j < n; j++) {
+                a[row * n + j] ^= gf_mul(factor, a[col * n + j]);
+                inv[row * n + j] ^= gf_mul(factor, inv[col * n + j]);
+            }
+        }
+    }
+    return inv;
+}
+
+} // namespace
+
+ReedSolomon::ReedSolomon(unsigned int data_shards, unsigned int parity_shards)
+    : k_(data_shards), m_(parity_shards) {
+    if(k_ == 0 || m_ == 0 || k_ + m_ > 256)
+        throw invalid_argument(
+                "Reed-Solomon needs k, m > 0 and k + m <= 256 shards");
+    // Cauchy matrix 1 / (x_i + y_j) with distinct x_i = k + i and y_j = j
+    parity_matrix_.resize(m_ * k_);
+    parity_tables_.resize(m_ * k_ * table_size);
+    for(unsigned int i = 0; i < m_; i++) {
+        for(unsigned int j = 0; j < k_; j++) {
+            auto c = gf_inv(static_cast<uint8_t>((k_ + i) ^ j));
+            parity_matrix_[i * k_ + j] = c;
+            make_nibble_tables(c, &parity_tables_[(i * k_ + j) * table_size]);
+        }
+    }
+}
+
+unsigned int
+ReedSolomon::data_shards() const {
+    return k_;
+}
+
+unsigned int
+ReedSolomon::parity_shards() const {
+    return m_;
+}
+
+void
+ReedSolomon::encode(const uint8_t* const* data, uint8_t* const* parity,
+                    size_t size) const {
+    const auto mul = active_kernel().mul;
+    for(size_t off = 0; off < size; off += slice_size) {
+        auto len = min(slice_size, size - off);
+        for(unsigned int i = 0; i < m_; i++) {
+            for(unsigned int j = 0; j < k_; j++) {
+                mul(&parity_tables_[(i * k_ + j) * table_size], data[j] + off,
+                    parity[i] + off, len, j > 0);
+            }
+        }
+    }
+}
+
+void
+ReedSolomon::reconstruct(uint8_t* const* shards, const vector<bool>& present,
+                         size_t size) const {
+    if(present.size() != k_ + m_)
+        throw invalid_argument("Reed-Solomon shard count mismatch");
+    // the first k present shards, preferring data shards
+    vector<unsigned int> rows{};
+    for(unsigned int r = 0; r < k_ + m_ && rows.size() < k_; r++) {
+        if(present[r])
+            rows.push_back(r);
+    }
+    if(rows.size() < k_)
+        throw invalid_argument("Fewer Reed-Solomon shards present than needed");
+    // nibble tables of the rows restoring the missing data shards
+    vector<unsigned int> missing{};
+    vector<uint8_t> tables{};
+    if(rows.back() >= k_) {
+        // Invert the generator rows of the present shards. Its rows then
+        // combine the present shards to the data shards
+        vector<uint8_t> a(k_ * k_, 0);
+        for(unsigned int r = 0; r < k_; r++) {
+            if(rows[r] < k_)
+                a[r * k_ + rows[r]] = 1;
+            else
+                copy_n(&parity_matrix_[(rows[r] - k_) * k_], k_, &a[r * k_]);
+        }
+        auto inv = invert(std::move(a), k_);
+        for(unsigned int d = 0; d < k_; d++) {
+            if(present[d])
+                continue;
+            missing.push_back(d);
+            tables.resize(tables.size() + k_ * table_size);
+            for(unsigned int j = 0; j < k_; j++) {
+                make_nibble_tables(
+                        inv[d * k_ + j],
+                        &tables[tables.size() - (k_ - j) * table_size]);
+            }
+        }
+    }
+    const auto mul = active_kernel().mul;
+    for(size_t off = 0; off < size; off += slice_size) {
+        auto len = min(slice_size, size - off);
+        for(size_t d = 0; d < missing.size(); d++) {
+            for(unsigned int j = 0; j < k_; j++) {
+                mul(&tables[(d * k_ + j) * table_size], shards[rows[j]] + off,
+                    shards[missing[d]] + off, len, j > 0);
+            }
+        }
+        // parity is computed from the restored data
+        for(unsigned int i = 0; i < m_; i++) {
+            if(present[k_ + i])
+                continue;
+            for(unsigned int j = 0; j < k_; j++) {
+                mul(&parity_tables_[(i * k_ + j) * table_size],
+                    shards[j] + off, shards[k_ + i] + off, len, j > 0);
+            }
+        }
+    }
+}
+
+const char*
+ReedSolomon::kernel() {
+    return active_kernel().name;
+}
+
+} // namespace gkfs::ec
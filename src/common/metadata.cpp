@@ -176,6 +176,10 @@ Metadata::Metadata(const std::string& binary_str) {
 
     // we consumed all the binary string
     assert(*ptr == '\0');
+    // inline data follows the terminator
+    auto parsed = static_cast<size_t>(ptr - binary_str.data());
+    if(parsed < binary_str.size())
+        inline_data_.assign(ptr + 1, binary_str.size() - parsed - 1);
 }
 
 std::string
@@ -214,6 +218,11 @@ Metadata::serialize() const {
     s += rename_path_;
 #endif // HAS_RENAME
 #endif // HAS_SYMLINKS
+    // binary, must be last. RPCs sending the string stop at the terminator
+    if(!inline_data_.empty()) {
+        s += '\0';
+        s += inline_data_;
+    }
 
     return s;
 }
@@ -302,6 +311,16 @@ Metadata::blocks(blkcnt_t blocks) {
     Metadata::blocks_ = blocks;
 }
 
+const std::string&
+Metadata::inline_data() const {
+    return inline_data_;
+}
+
+void
+Metadata::inline_data(const std::string& inline_data) {
+    Metadata::inline_data_ = inline_data;
+}
+
 #ifdef HAS_SYMLINKS
 
 std::string
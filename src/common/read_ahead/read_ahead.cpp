@@ -0,0 +1,115 @@
+/*
+  Copyright 2018-2024, Barcelona Supercomputing Center (BSC), Spain
+  Copyright 2015-2024, Johannes Gutenberg Universitaet Mainz, Germany
+
+  This software was partially supported by the
+  EC H2020 funded project NEXTGenIO (Project ID: 671951, www.nextgenio.eu).
+
+  This software was partially supported by the
+  ADA-FS project under the SPPEXA project funded by the DFG.
+
+  This file is part of GekkoFS.
+
+  GekkoFS is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  GekkoFS is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with GekkoFS.  If not, see <https://www.gnu.org/licenses/>.
+
+  SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include <common/read_ahead/read_ahead.hpp>
+
+#include <utility>
+
+using namespace std;
+
+namespace gkfs::read_ahead {
+
+AccessPattern::AccessPattern(unsigned int trigger) : trigger_(trigger) {}
+
+int64_t
+AccessPattern::record(int64_t offset, size_t count) {
+    auto stride = offset - last_offset_;
+    auto sequential = last_end_ >= 0 && offset == last_end_;
+    auto strided = last_offset_ >= 0 && stride > 0 && stride == stride_;
+    hits_ = (sequential || strided) ? hits_ + 1 : 0;
+    stride_ = last_offset_ >= 0 ? stride : 0;
+    last_offset_ = offset;
+    last_end_ = offset + static_cast<int64_t>(count);
+    if(hits_ == 0 || hits_ < trigger_)
+        return -1;
+    return sequential ? last_end_ : offset + stride;
+}
+
+void
+AccessPattern::reset() {
+    last_offset_ = -1;
+    last_end_ = -1;
+    stride_ = 0;
+    hits_ = 0;
+}
+
+MemoryBudget::Reservation::Reservation(MemoryBudget* budget, size_t size)
+    : budget_(budget), size_(size) {}
+
+MemoryBudget::Reservation::Reservation(Reservation&& other) noexcept
+    : budget_(exchange(other.budget_, nullptr)),
+      size_(exchange(other.size_, 0)) {}
+
+MemoryBudget::Reservation&
+MemoryBudget::Reservation::operator=(Reservation&& other) noexcept {
+    if(this != &other) {
+        if(budget_)
+            budget_->used_ -= size_;
+        budget_ = exchange(other.budget_, nullptr);
+        size_ = exchange(other.size_, 0);
+    }
+    return *this;
+}
+
+MemoryBudget::Reservation::~Reservation() {
+    if(budget_)
+        budget_->used_ -= size_;
+}
+
+MemoryBudget::Reservation::operator bool() const {
+    return budget_ != nullptr;
+}
+
+size_t
+MemoryBudget::Reservation::size() const {
+    return size_;
+}
+
+MemoryBudget::MemoryBudget(size_t limit) : limit_(limit) {}
+
+void
+MemoryBudget::set_limit(size_t limit) {
+    limit_ = limit;
+}
+
+MemoryBudget::Reservation
+MemoryBudget::reserve(size_t size) {
+    auto used = used_.load();
+    do {
+        if(size > limit_.load() || used > limit_.load() - size)
+            return {};
+    } while(!used_.compare_exchange_weak(used, used + size));
+    return {this, size};
+}
+
+size_t
+MemoryBudget::used() const {
+    return used_;
+}
+
+} // namespace gkfs::read_ahead
@@ -0,0 +1,203 @@
+/*
+  Copyright 2018-2024, Barcelona Supercomputing Center (BSC), Spain
+  Copyright 2015-2024, Johannes Gutenberg Universitaet Mainz, Germany
+
+  This software was partially supported by the
+  EC H2020 funded project NEXTGenIO (Project ID: 671951, www.nextgenio.eu).
+
+  This software was partially supported by the
+  ADA-FS project under the SPPEXA project funded by the DFG.
+
+  This file is part of GekkoFS.
+
+  GekkoFS is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  GekkoFS is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with GekkoFS.  If not, see <https://www.gnu.org/licenses/>.
+
+  SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include <common/rpc/chunk_set.hpp>
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+using namespace std;
+
+namespace gkfs::rpc {
+
+namespace {
+
+constexpr uint8_t format_runs = 0;
+constexpr uint8_t format_bitmap = 1;
+
+size_t
+varint_size(uint64_t value) {
+    size_t size = 1;
+    while(value >= 0x80) {
+        value >>= 7;
+        size++;
+    }
+    return size;
+}
+
+void
+put_varint(vector<uint8_t>& out, uint64_t value) {
+    while(value >= 0x80) {
+        out.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+uint64_t
+get_varint(const uint8_t*& pos, const uint8_t* end) {
+    uint64_t value = 0;
+    for(unsigned shift = 0; shift < 64; shift += 7) {
+        if(pos == end)
+            throw invalid_argument("Chunk set ends within a number");
+        auto byte = *pos++;
+        value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+        if(!(byte & 0x80))
+            return value;
+    }
+    throw invalid_argument("Chunk set number exceeds 64 bits");
+}
+
+} // namespace
+
+void
+ChunkSet::add(uint64_t chunk) {
+    if(!runs_.empty()) {
+        auto& last = runs_.back();
+        auto end = last.start + last.length;
+        if(chunk + 1 == end)
+            return;
+        if(chunk == end) {
+            last.length++;
+            size_++;
+            return;
+        }
+        if(chunk < end)
+            throw invalid_argument("Chunks must be added in ascending order");
+    }
+    runs_.push_back({chunk, 1});
+    size_++;
+}
+
+bool
+ChunkSet::contains(uint64_t chunk) const {
+    // first run starting after chunk
+    auto it = upper_bound(
+            runs_.begin(), runs_.end(), chunk,
+            [](uint64_t c, const run& r) { return c < r.start; });
+    if(it == runs_.begin())
+        return false;
+    --it;
+    return chunk - it->start < it->length;
+}
+
+uint64_t
+ChunkSet::size() const {
+    return size_;
+}
+
+vector<uint8_t>
+ChunkSet::encode() const {
+    size_t runs_size = 1 + varint_size(runs_.size());
+    uint64_t prev_end = 0;
+    for(const auto& r : runs_) {
+        runs_size +=
+                varint_size(r.start - prev_end) + varint_size(r.length - 1);
+        prev_end = r.start + r.length;
+    }
+    // prev_end is the number of bits of the bitmap
+    auto bitmap_size = 1 + varint_size(prev_end) + (prev_end + 7) / 8;
+
+    vector<uint8_t> out;
+    if(runs_size <= bitmap_size) {
+        out.reserve(runs_size);
+        out.push_back(format_runs);
+        put_varint(out, runs_.size());
+        prev_end = 0;
+        for(const auto& r : runs_) {
+            put_varint(out, r.start - prev_end);
+            put_varint(out, r.length - 1);
+            prev_end = r.start + r.length;
+        }
+        return out;
+    }
+    out.reserve(bitmap_size);
+    out.push_back(format_bitmap);
+    put_varint(out, prev_end);
+    auto bits_pos = out.size();
+    out.resize(bitmap_size, 0);
+    auto* bits = out.data() + bits_pos;
+    for(const auto& r : runs_) {
+        for(auto chunk = r.start; chunk < r.start + r.length; chunk++)
+            bits[chunk / 8] |= static_cast<uint8_t>(1u << (chunk % 8));
+    }
+    return out;
+}
+
+ChunkSet
+ChunkSet::decode(const uint8_t* data, size_t size) {
+    if(size == 0)
+        throw invalid_argument("Chunk set is empty");
+    const auto* pos = data + 1;
+    const auto* end = data + size;
+    ChunkSet set{};
+    if(data[0] == format_runs) {
+        auto run_count = get_varint(pos, end);
+        // every run takes at least 2 bytes
+        if(run_count > static_cast<uint64_t>(end - pos) / 2)
+            throw invalid_argument("Chunk set has too many runs");
+        set.runs_.reserve(run_count);
+        uint64_t prev_end = 0;
+        for(uint64_t i = 0; i < run_count; i++) {
+            auto gap = get_varint(pos, end);
+            auto length_1 = get_varint(pos, end);
+            if((i > 0 && gap == 0) ||
+               gap > numeric_limits<uint64_t>::max() - prev_end ||
+               length_1 >= numeric_limits<uint64_t>::max() - prev_end - gap)
+                throw invalid_argument("Chunk set has invalid runs");
+            auto start = prev_end + gap;
+            set.runs_.push_back({start, length_1 + 1});
+            set.size_ += length_1 + 1;
+            prev_end = start + length_1 + 1;
+        }
+    } else if(data[0] == format_bitmap) {
+        auto bit_count = get_varint(pos, end);
+        if(bit_count / 8 + (bit_count % 8 != 0) !=
+           static_cast<uint64_t>(end - pos))
+            throw invalid_argument("Chunk set bitmap has a wrong size");
+        for(uint64_t byte = 0; byte < static_cast<uint64_t>(end - pos);
+            byte++) {
+            // skip bytes of chunks served by other daemons
+            if(pos[byte] == 0)
+                continue;
+            for(unsigned bit = 0; bit < 8; bit++) {
+                if(pos[byte] & (1u << bit) && byte * 8 + bit < bit_count)
+                    set.add(byte * 8 + bit);
+            }
+        }
+        return set;
+    } else {
+        throw invalid_argument("Chunk set has an unknown format");
+    }
+    if(pos != end)
+        throw invalid_argument("Chunk set has trailing bytes");
+    return set;
+}
+
+} // namespace gkfs::rpc
@@ -154,6 +154,69 @@ ForwarderDistributor::locate_directory_metadata(const std::string& path) const {
     return all_hosts_;
 }
 
+StripeDistributor::StripeDistributor(host_t localhost,
+                                     unsigned int hosts_size,
+                                     unsigned int data_shards,
+                                     unsigned int parity_shards)
+    : localhost_(localhost), hosts_size_(hosts_size), data_shards_(data_shards),
+      parity_shards_(parity_shards), all_hosts_(hosts_size) {
+    ::iota(all_hosts_.begin(), all_hosts_.end(), 0);
+}
+
+host_t
+StripeDistributor::localhost() const {
+    return localhost_;
+}
+
+unsigned int
+StripeDistributor::hosts_size() const {
+    return hosts_size_;
+}
+
+host_t
+StripeDistributor::locate_chunk(const string& path, const chunkid_t& chnk_id,
+                                const int num_copy) const {
+    const string prefix = gkfs::config::ec::parity_prefix;
+    if(path.compare(0, prefix.size(), prefix) == 0) {
+        auto stripe = chnk_id / parity_shards_;
+        return (str_hash(path.substr(prefix.size()) + ::to_string(stripe)) +
+                data_shards_ + chnk_id % parity_shards_ + num_copy) %
+               hosts_size_;
+    }
+    auto stripe = chnk_id / data_shards_;
+    return (str_hash(path + ::to_string(stripe)) + chnk_id % data_shards_ +
+            num_copy) %
+           hosts_size_;
+}
+
+host_t
+StripeDistributor::locate_data(const string& path, const chunkid_t& chnk_id,
+                               const int num_copy) const {
+    return locate_chunk(path, chnk_id, num_copy);
+}
+
+host_t
+StripeDistributor::locate_data(const string& path, const chunkid_t& chnk_id,
+                               unsigned int hosts_size, const int num_copy) {
+    if(hosts_size_ != hosts_size) {
+        hosts_size_ = hosts_size;
+        all_hosts_ = std::vector<unsigned int>(hosts_size);
+        ::iota(all_hosts_.begin(), all_hosts_.end(), 0);
+    }
+    return locate_chunk(path, chnk_id, num_copy);
+}
+
+host_t
+StripeDistributor::locate_file_metadata(const string& path,
+                                        const int num_copy) const {
+    return (str_hash(path) + num_copy) % hosts_size_;
+}
+
+::vector<host_t>
+StripeDistributor::locate_directory_metadata(const string& path) const {
+    return all_hosts_;
+}
+
 void
 IntervalSet::Add(chunkid_t smaller, chunkid_t bigger) {
     const auto next = _intervals.upper_bound(smaller);
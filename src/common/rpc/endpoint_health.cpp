@@ -0,0 +1,89 @@
+/*
+  Copyright 2018-2024, Barcelona Supercomputing Center (BSC), Spain
+  Copyright 2015-2024, Johannes Gutenberg Universitaet Mainz, Germany
+
+  This software was partially supported by the
+  EC H2020 funded project NEXTGenIO (Project ID: 671951, www.nextgenio.eu).
+
+  This software was partially supported by the
+  ADA-FS project under the SPPEXA project funded by the DFG.
+
+  This file is part of GekkoFS.
+
+  GekkoFS is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  GekkoFS is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with GekkoFS.  If not, see <https://www.gnu.org/licenses/>.
+
+  SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include <common/rpc/endpoint_health.hpp>
+
+#include <stdexcept>
+
+using namespace std;
+
+namespace gkfs::rpc {
+
+EndpointHealth::EndpointHealth(unsigned int threshold,
+                               chrono::milliseconds period)
+    : threshold_(threshold), period_(period) {
+    if(threshold == 0)
+        throw invalid_argument("Endpoint failure threshold must not be 0");
+}
+
+void
+EndpointHealth::failed(uint64_t endpoint, clock::time_point now) {
+    lock_guard<mutex> lock(mutex_);
+    auto [it, inserted] = endpoints_.try_emplace(endpoint);
+    if(inserted)
+        tracked_++;
+    auto& ep = it->second;
+    ep.failures++;
+    if(ep.failures >= threshold_ && now >= ep.suspect_until)
+        ep.suspect_until = now + period_;
+}
+
+void
+EndpointHealth::answered(uint64_t endpoint) {
+    // common case: no endpoint failed
+    if(tracked_.load(memory_order_relaxed) == 0)
+        return;
+    lock_guard<mutex> lock(mutex_);
+    if(endpoints_.erase(endpoint))
+        tracked_--;
+}
+
+bool
+EndpointHealth::suspect(uint64_t endpoint, clock::time_point now) const {
+    if(tracked_.load(memory_order_relaxed) == 0)
+        return false;
+    lock_guard<mutex> lock(mutex_);
+    auto it = endpoints_.find(endpoint);
+    return it != endpoints_.end() && it->second.failures >= threshold_ &&
+           now < it->second.suspect_until;
+}
+
+vector<uint64_t>
+EndpointHealth::suspects(clock::time_point now) const {
+    vector<uint64_t> out;
+    if(tracked_.load(memory_order_relaxed) == 0)
+        return out;
+    lock_guard<mutex> lock(mutex_);
+    for(const auto& [endpoint, ep] : endpoints_) {
+        if(ep.failures >= threshold_ && now < ep.suspect_until)
+            out.push_back(endpoint);
+    }
+    return out;
+}
+
+} // namespace gkfs::rpc
@@ -0,0 +1,73 @@
+/*
+  Copyright 2018-2024, Barcelona Supercomputing Center (BSC), Spain
+  Copyright 2015-2024, Johannes Gutenberg Universitaet Mainz, Germany
+
+  This software was partially supported by the
+  EC H2020 funded project NEXTGenIO (Project ID: 671951, www.nextgenio.eu).
+
+  This software was partially supported by the
+  ADA-FS project under the SPPEXA project funded by the DFG.
+
+  This file is part of GekkoFS.
+
+  GekkoFS is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  GekkoFS is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with GekkoFS.  If not, see <https://www.gnu.org/licenses/>.
+
+  SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include <common/rpc/latency_tracker.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+using namespace std;
+
+namespace gkfs::rpc {
+
+LatencyTracker::LatencyTracker(double percentile, size_t capacity,
+                               size_t min_samples)
+    : samples_(capacity), percentile_(percentile),
+      min_samples_(max<size_t>(min_samples, 1)) {
+    if(!(percentile > 0 && percentile <= 100) || capacity == 0)
+        throw invalid_argument("Invalid latency percentile or capacity");
+}
+
+void
+LatencyTracker::add(chrono::microseconds latency) {
+    lock_guard<mutex> lock(mutex_);
+    samples_[next_] = static_cast<uint64_t>(max<int64_t>(latency.count(), 0));
+    next_ = (next_ + 1) % samples_.size();
+    count_ = min(count_ + 1, samples_.size());
+    stale_++;
+    if(count_ < min_samples_ ||
+       (value_.load(memory_order_relaxed) != 0 &&
+        stale_ < max<size_t>(samples_.size() / 16, 1)))
+        return;
+    // nearest rank
+    auto rank = static_cast<size_t>(ceil(percentile_ / 100 * count_));
+    auto idx = min(max<size_t>(rank, 1), count_) - 1;
+    vector<uint64_t> sorted(samples_.begin(), samples_.begin() + count_);
+    nth_element(sorted.begin(), sorted.begin() + idx, sorted.end());
+    // 0 means no value yet
+    value_.store(max<uint64_t>(sorted[idx], 1), memory_order_relaxed);
+    stale_ = 0;
+}
+
+chrono::microseconds
+LatencyTracker::value() const {
+    return chrono::microseconds(value_.load(memory_order_relaxed));
+}
+
+} // namespace gkfs::rpc
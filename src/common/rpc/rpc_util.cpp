@@ -105,111 +105,4 @@ get_host_by_name(const string& hostname) {
 }
 #endif
 
-/**
- * @brief Get the bit from a bit vector
- *
- * @param data
- * @param position
- * @return the bit
- */
-bool
-get_bitset(const std::vector<uint8_t>& data, const uint16_t position) {
-    return (data[(position) / 8] & 1 << ((position) % 8));
-}
-
-/**
- * @brief Get the bit from a bit vector
- *
- * @param data
- * @param position
- */
-void
-set_bitset(std::vector<uint8_t>& data, const uint16_t position) {
-    data[(position) / 8] |= 1 << ((position) % 8); // set
-}
-
-std::string
-base64_encode(const std::vector<uint8_t>& data) {
-    static const std::string base64_chars =
-            "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
-
-    std::ostringstream encoded;
-    uint32_t buffer = 0;
-    int padding = 0;
-
-    for(uint8_t byte : data) {
-        buffer = (buffer << 8) | byte;
-        padding += 8;
-        while(padding >= 6) {
-            padding -= 6;
-            encoded << base64_chars[(buffer >> padding) & 0x3F];
-        }
-    }
-
-    if(padding > 0) {
-        buffer <<= 6 - padding;
-        encoded << base64_chars[buffer & 0x3F];
-    }
-
-    while(encoded.str().length() % 4 != 0) {
-        encoded << '=';
-    }
-
-    return encoded.str();
-}
-
-std::vector<uint8_t>
-base64_decode(const std::string& encoded) {
-    static const std::string base64_chars =
-            "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
-
-    std::vector<uint8_t> data;
-    uint32_t buffer = 0;
-    int padding = 0;
-    size_t count = 0;
-
-    for(char c : encoded) {
-        if(c == '=')
-            break;
-
-        std::size_t value = base64_chars.find(c);
-        if(value == std::string::npos)
-            continue;
-
-        buffer = (buffer << 6) | value;
-        padding += 6;
-
-        if(padding >= 8) {
-            padding -= 8;
-            data.push_back(static_cast<uint8_t>((buffer >> padding) & 0xFF));
-            count++;
-        }
-    }
-
-    // Handle padding characters
-    if(padding > 0 && padding < 6 && (buffer & ((1 << padding) - 1)) == 0) {
-        // Remove the padding bits
-        buffer >>= padding;
-        padding = 0;
-        data.push_back(static_cast<uint8_t>((buffer >> 8) & 0xFF));
-        count++;
-    }
-
-    if(count == 0 || padding % 8 != 0)
-        return {};
-
-    return data;
-}
-
-std::string
-compress_bitset(const std::vector<uint8_t>& bytes) {
-    return base64_encode(bytes);
-}
-
-std::vector<uint8_t>
-decompress_bitset(const std::string& compressedString) {
-    return base64_decode(compressedString);
-}
-
-
 } // namespace gkfs::rpc
\ No newline at end of file
@@ -211,6 +211,13 @@ Stats::add_value_size(enum SizeOp iop, unsigned long long value) {
         add_value_iops(IopsOp::iops_write);
 }
 
+void
+Stats::register_counter(const std::string& name,
+                        std::function<unsigned long long()> getter) {
+    const std::lock_guard<std::mutex> lock(counters_mutex);
+    counters[name] = std::move(getter);
+}
+
 /**
  * @brief Get the total mean value of the asked stat
  * This can be provided inmediately without cost
@@ -318,6 +325,12 @@ Stats::dump(std::ofstream& of) {
         }
         of << std::endl;
     }
+    {
+        const std::lock_guard<std::mutex> lock(counters_mutex);
+        for(const auto& [name, getter] : counters) {
+            of << "Stats " << name << " \t\t" << getter() << std::endl;
+        }
+    }
     of << std::endl;
 }
 void
@@ -0,0 +1,396 @@
+/*
+  Copyright 2018-2024, Barcelona Supercomputing Center (BSC), Spain
+  Copyright 2015-2024, Johannes Gutenberg Universitaet Mainz, Germany
+
+  This software was partially supported by the
+  EC H2020 funded project NEXTGenIO (Project ID: 671951, www.nextgenio.eu).
+
+  This software was partially supported by the
+  ADA-FS project under the SPPEXA project funded by the DFG.
+
+  This file is part of GekkoFS.
+
+  GekkoFS is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  GekkoFS is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with GekkoFS.  If not, see <https://www.gnu.org/licenses/>.
+
+  SPDX-License-Identifier: GPL-3.0-or-later
+*/
+/**
+ * @brief Per-block checksums of the chunks stored on this daemon.
+ */
+
+#include <daemon/backend/data/data_module.hpp>
+#include <daemon/backend/data/chunk_checksum.hpp>
+#include <daemon/backend/data/chunk_fd_cache.hpp>
+#include <daemon/backend/data/file_handle.hpp>
+#include <config.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <functional>
+
+#include <spdlog/spdlog.h>
+
+#if defined(__x86_64__)
+#include <nmmintrin.h>
+#elif defined(__aarch64__) && defined(__ARM_FEATURE_CRC32)
+#include <arm_acle.h>
+#endif
+
+extern "C" {
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+}
+
+namespace fs = std::filesystem;
+using namespace std;
+
+namespace gkfs::data {
+
+namespace {
+
+// reflected CRC32C polynomial
+constexpr uint32_t crc32c_poly = 0x82F63B78;
+
+constexpr array<uint32_t, 256>
+make_crc32c_table() {
+    array<uint32_t, 256> table{};
+    for(uint32_t i = 0; i < 256; i++) {
+        uint32_t crc = i;
+        for(int bit = 0; bit < 8; bit++)
+            crc = (crc >> 1) ^ (crc & 1 ? crc32c_poly : 0);
+        table[i] = crc;
+    }
+    return table;
+}
+
+constexpr auto crc32c_table = make_crc32c_table();
+
+uint32_t
+crc32c_sw(uint32_t crc, const unsigned char* p, size_t size) {
+    while(size--)
+        crc = crc32c_table[(crc ^ *p++) & 0xFF] ^ (crc >> 8);
+    return crc;
+}
+
+#if defined(__x86_64__)
+__attribute__((target("sse4.2"))) uint32_t
+crc32c_hw(uint32_t crc, const unsigned char* p, size_t size) {
+    uint64_t crc64 = crc;
+    for(; size >= sizeof(uint64_t); size -= sizeof(uint64_t)) {
+        uint64_t word;
+        memcpy(&word, p, sizeof(word));
+        crc64 = _mm_crc32_u64(crc64, word);
+        p += sizeof(uint64_t);
+    }
+    crc = static_cast<uint32_t>(crc64);
+    while(size--)
+        crc = _mm_crc32_u8(crc, *p++);
+    return crc;
+}
+
+bool
+crc32c_hw_supported() {
+    return __builtin_cpu_supports("sse4.2");
+}
+#elif defined(__aarch64__) && defined(__ARM_FEATURE_CRC32)
+uint32_t
+crc32c_hw(uint32_t crc, const unsigned char* p, size_t size) {
+    for(; size >= sizeof(uint64_t); size -= sizeof(uint64_t)) {
+        uint64_t word;
+        memcpy(&word, p, sizeof(word));
+        crc = __crc32cd(crc, word);
+        p += sizeof(uint64_t);
+    }
+    while(size--)
+        crc = __crc32cb(crc, *p++);
+    return crc;
+}
+
+bool
+crc32c_hw_supported() {
+    return true;
+}
+#else
+uint32_t
+crc32c_hw(uint32_t crc, const unsigned char* p, size_t size) {
+    return crc32c_sw(crc, p, size);
+}
+
+bool
+crc32c_hw_supported() {
+    return false;
+}
+#endif
+
+/**
+ * @brief Returns the sidecar file name of a GekkoFS file, following the
+ * naming of chunk directories.
+ */
+string
+sidecar_name(const string& file_path) {
+    auto name = file_path.substr(1);
+    ::replace(name.begin(), name.end(), '/', ':');
+    return name;
+}
+
+} // namespace
+
+uint32_t
+crc32c(uint32_t crc, const char* buf, size_t size) {
+    static const auto impl = crc32c_hw_supported() ? crc32c_hw : crc32c_sw;
+    return ~impl(~crc, reinterpret_cast<const unsigned char*>(buf), size);
+}
+
+// private functions
+
+string
+ChunkChecksums::sidecar_path(const string& file_path) const {
+    return fmt::format("{}/{}", path_, sidecar_name(file_path));
+}
+
+shared_ptr<FileHandle>
+ChunkChecksums::open_sidecar(const string& file_path, bool create) {
+    uint64_t version = 0;
+    if(fd_cache_) {
+        auto fh = fd_cache_->get(file_path, 0, version);
+        if(fh)
+            return fh;
+    }
+    auto path = sidecar_path(file_path);
+    auto flags = O_RDWR | (create ? O_CREAT : 0);
+    // checksums must be as durable as the chunk data they cover
+    if(write_through_)
+        flags |= O_DSYNC;
+    auto fd = open(path.c_str(), flags, 0640);
+    if(fd == -1) {
+        if(errno == ENOENT && !create)
+            return nullptr;
+        auto err = errno;
+        auto err_str = fmt::format(
+                "{}() Failed to open checksum file. Path: '{}', Error: '{}'",
+                __func__, path, ::strerror(err));
+        throw ChunkStorageException(err, err_str);
+    }
+    auto fh = make_shared<FileHandle>(fd, path);
+    if(!fd_cache_)
+        return fh;
+    return fd_cache_->put(file_path, 0, version, std::move(fh));
+}
+
+// public functions
+
+ChunkChecksums::ChunkChecksums(const string& path, size_t chunksize,
+                               size_t block_size, size_t fd_cache_size,
+                               size_t lock_stripes, bool write_through)
+    : path_(path), block_size_(block_size),
+      blocks_per_chunk_(chunksize / block_size), write_through_(write_through),
+      mutexes_(max<size_t>(lock_stripes, 1)) {
+    assert(block_size_ > 0 && chunksize % block_size_ == 0);
+    try {
+        fs::create_directories(path_);
+    } catch(const fs::filesystem_error& e) {
+        auto err_str = fmt::format(
+                "{}() Failed to create checksum directory. Path: '{}', Error: '{}'",
+                __func__, path_, e.what());
+        throw ChunkStorageException(e.code().value(), err_str);
+    }
+    if(fd_cache_size > 0)
+        fd_cache_ = make_unique<ChunkFdCache>(
+                fd_cache_size, gkfs::config::data::fd_cache_shards);
+    GKFS_DATA_MOD->log()->debug(
+            "{}() Chunk checksums initialized with path: '{}' block size: '{}' hardware CRC32C: '{}'",
+            __func__, path_, block_size_, crc32c_hw_supported());
+}
+
+ChunkChecksums::~ChunkChecksums() = default;
+
+size_t
+ChunkChecksums::block_size() const {
+    return block_size_;
+}
+
+size_t
+ChunkChecksums::blocks_per_chunk() const {
+    return blocks_per_chunk_;
+}
+
+mutex&
+ChunkChecksums::mutex(const string& file_path, gkfs::rpc::chnk_id_t chunk_id) {
+    auto h = hash<string>{}(file_path);
+    h ^= hash<gkfs::rpc::chnk_id_t>{}(chunk_id) + 0x9e3779b9 + (h << 6) +
+         (h >> 2);
+    return mutexes_[h % mutexes_.size()];
+}
+
+void
+ChunkChecksums::put(const string& file_path, gkfs::rpc::chnk_id_t chunk_id,
+                    uint64_t first_block,
+                    const vector<ChecksumEntry>& entries) {
+    if(entries.empty())
+        return;
+    assert(first_block + entries.size() <= blocks_per_chunk_);
+    auto fh = open_sidecar(file_path, true);
+    auto size = entries.size() * sizeof(ChecksumEntry);
+    auto offset = (chunk_id * blocks_per_chunk_ + first_block) *
+                  sizeof(ChecksumEntry);
+    const auto* buf = reinterpret_cast<const char*>(entries.data());
+    size_t wrote_total = 0;
+    while(wrote_total != size) {
+        auto wrote = pwrite64(fh->native(), buf + wrote_total,
+                              size - wrote_total, offset + wrote_total);
+        if(wrote < 0) {
+            if(errno == EINTR || errno == EAGAIN || errno == EWOULDBLOCK)
+                continue;
+            auto err = errno;
+            auto err_str = fmt::format(
+                    "{}() Failed to write checksums. File: '{}', chunk: '{}', Error: '{}'",
+                    __func__, file_path, chunk_id, ::strerror(err));
+            throw ChunkStorageException(err, err_str);
+        }
+        wrote_total += wrote;
+    }
+}
+
+vector<ChecksumEntry>
+ChunkChecksums::get(const string& file_path, gkfs::rpc::chnk_id_t chunk_id,
+                    uint64_t first_block, size_t count) {
+    vector<ChecksumEntry> entries(count, ChecksumEntry{0, 0});
+    auto fh = open_sidecar(file_path, false);
+    if(!fh)
+        return entries;
+    auto size = count * sizeof(ChecksumEntry);
+    auto offset = (chunk_id * blocks_per_chunk_ + first_block) *
+                  sizeof(ChecksumEntry);
+    auto* buf = reinterpret_cast<char*>(entries.data());
+    size_t read_total = 0;
+    while(read_total != size) {
+        auto read = pread64(fh->native(), buf + read_total, size - read_total,
+                            offset + read_total);
+        // entries beyond the end of the sidecar have no checksum
+        if(read == 0)
+            break;
+        if(read < 0) {
+            if(errno == EINTR || errno == EAGAIN || errno == EWOULDBLOCK)
+                continue;
+            auto err = errno;
+            auto err_str = fmt::format(
+                    "{}() Failed to read checksums. File: '{}', chunk: '{}', Error: '{}'",
+                    __func__, file_path, chunk_id, ::strerror(err));
+            throw ChunkStorageException(err, err_str);
+        }
+        read_total += read;
+    }
+    return entries;
+}
+
+void
+ChunkChecksums::trim(const string& file_path,
+                     gkfs::rpc::chnk_id_t chunk_start) {
+    auto path = sidecar_path(file_path);
+    auto new_size = chunk_start * blocks_per_chunk_ * sizeof(ChecksumEntry);
+    struct stat st {};
+    if(stat(path.c_str(), &st) == -1) {
+        if(errno == ENOENT)
+            return;
+    } else if(static_cast<uint64_t>(st.st_size) <= new_size) {
+        return;
+    } else if(truncate(path.c_str(), new_size) == 0) {
+        return;
+    }
+    auto err = errno;
+    auto err_str = fmt::format(
+            "{}() Failed to trim checksum file. Path: '{}', Error: '{}'",
+            __func__, path, ::strerror(err));
+    throw ChunkStorageException(err, err_str);
+}
+
+void
+ChunkChecksums::sync(const string& file_path) {
+    auto throw_err = [&](int err, const string& path) {
+        auto err_str = fmt::format(
+                "{}() Failed to sync checksum file. Path: '{}', Error: '{}'",
+                __func__, path, ::strerror(err));
+        throw ChunkStorageException(err, err_str);
+    };
+    auto fh = open_sidecar(file_path, false);
+    // no checksums of this file were ever written to this daemon
+    if(!fh)
+        return;
+    if(fdatasync(fh->native()) == -1)
+        throw_err(errno, sidecar_path(file_path));
+    // the sidecar's directory entry
+    auto fd = open(path_.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if(fd == -1)
+        throw_err(errno, path_);
+    auto err = fsync(fd) == -1 ? errno : 0;
+    close(fd);
+    if(err != 0)
+        throw_err(err, path_);
+}
+
+void
+ChunkChecksums::destroy(const string& file_path) {
+    auto path = sidecar_path(file_path);
+    auto failed = unlink(path.c_str()) == -1 && errno != ENOENT;
+    auto err = errno;
+    // must follow the unlink, see ChunkFdCache
+    if(fd_cache_)
+        fd_cache_->invalidate_file(file_path);
+    if(failed) {
+        auto err_str = fmt::format(
+                "{}() Failed to remove checksum file. Path: '{}', Error: '{}'",
+                __func__, path, ::strerror(err));
+        throw ChunkStorageException(err, err_str);
+    }
+}
+
+/**
+ * @internal
+ * Sidecar names are mapped back to GekkoFS paths by replacing ':' with '/'.
+ * This is ambiguous for GekkoFS paths that contain ':', whose chunks are then
+ * not found and skipped.
+ * @endinternal
+ */
+vector<string>
+ChunkChecksums::files() const {
+    vector<string> files;
+    std::error_code ec;
+    for(fs::directory_iterator it(path_, ec), end; !ec && it != end;
+        it.increment(ec)) {
+        auto name = it->path().filename().string();
+        ::replace(name.begin(), name.end(), ':', '/');
+        files.emplace_back("/" + name);
+    }
+    if(ec)
+        GKFS_DATA_MOD->log()->warn(
+                "{}() Failed to list checksum directory '{}'. Error: '{}'",
+                __func__, path_, ec.message());
+    return files;
+}
+
+gkfs::rpc::chnk_id_t
+ChunkChecksums::chunk_count(const string& file_path) const {
+    struct stat st {};
+    if(stat(sidecar_path(file_path).c_str(), &st) == -1)
+        return 0;
+    auto chunk_bytes = blocks_per_chunk_ * sizeof(ChecksumEntry);
+    return (st.st_size + chunk_bytes - 1) / chunk_bytes;
+}
+
+} // namespace gkfs::data
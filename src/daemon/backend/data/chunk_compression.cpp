@@ -0,0 +1,105 @@
+/*
+  Copyright 2018-2024, Barcelona Supercomputing Center (BSC), Spain
+  Copyright 2015-2024, Johannes Gutenberg Universitaet Mainz, Germany
+
+  This software was partially supported by the
+  EC H2020 funded project NEXTGenIO (Project ID: 671951, www.nextgenio.eu).
+
+  This software was partially supported by the
+  ADA-FS project under the SPPEXA project funded by the DFG.
+
+  This file is part of GekkoFS.
+
+  GekkoFS is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  GekkoFS is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with GekkoFS.  If not, see <https://www.gnu.org/licenses/>.
+
+  SPDX-License-Identifier: GPL-3.0-or-later
+*/
+/**
+ * @brief Encoding of compressed chunk files.
+ */
+
+#include <daemon/backend/data/chunk_compression.hpp>
+#include <config.hpp>
+
+#include <cassert>
+#include <cstring>
+
+#ifdef GKFS_ENABLE_LZ4
+#include <lz4.h>
+#endif
+
+namespace gkfs::data {
+
+bool
+compression_available() {
+#ifdef GKFS_ENABLE_LZ4
+    return true;
+#else
+    return false;
+#endif
+}
+
+ChunkCodec
+encode_chunk(const char* data, size_t size, std::vector<char>& out) {
+    constexpr auto header_size = sizeof(CompressedChunkHeader);
+    CompressedChunkHeader header{compressed_chunk_magic, ChunkCodec::raw,
+                                 static_cast<uint32_t>(size),
+                                 static_cast<uint32_t>(size)};
+#ifdef GKFS_ENABLE_LZ4
+    // anything larger than this is stored raw
+    auto limit = size - size * gkfs::config::data::compression_min_savings /
+                                100;
+    out.resize(header_size + LZ4_compressBound(static_cast<int>(size)));
+    auto stored = size > 0 ? LZ4_compress_default(data,
+                                                  out.data() + header_size,
+                                                  static_cast<int>(size),
+                                                  static_cast<int>(limit))
+                           : 0;
+    // 0 if the data did not fit into limit
+    if(stored > 0) {
+        header.codec = ChunkCodec::lz4;
+        header.stored_size = static_cast<uint32_t>(stored);
+        out.resize(header_size + stored);
+        memcpy(out.data(), &header, header_size);
+        return header.codec;
+    }
+#endif
+    out.resize(header_size + size);
+    memcpy(out.data(), &header, header_size);
+    memcpy(out.data() + header_size, data, size);
+    return header.codec;
+}
+
+bool
+decode_chunk(const char* payload, const CompressedChunkHeader& header,
+             char* buf, size_t size) {
+    assert(size <= header.raw_size);
+    if(header.codec == ChunkCodec::raw) {
+        memcpy(buf, payload, size);
+        return true;
+    }
+#ifdef GKFS_ENABLE_LZ4
+    if(header.codec != ChunkCodec::lz4)
+        return false;
+    // stops decoding once size bytes are produced
+    auto decoded = LZ4_decompress_safe_partial(
+            payload, buf, static_cast<int>(header.stored_size),
+            static_cast<int>(size), static_cast<int>(size));
+    return decoded == static_cast<int>(size);
+#else
+    return false;
+#endif
+}
+
+} // namespace gkfs::data
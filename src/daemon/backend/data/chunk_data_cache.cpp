@@ -0,0 +1,292 @@
+/*
+  Copyright 2018-2024, Barcelona Supercomputing Center (BSC), Spain
+  Copyright 2015-2024, Johannes Gutenberg Universitaet Mainz, Germany
+
+  This software was partially supported by the
+  EC H2020 funded project NEXTGenIO (Project ID: 671951, www.nextgenio.eu).
+
+  This software was partially supported by the
+  ADA-FS project under the SPPEXA project funded by the DFG.
+
+  This file is part of GekkoFS.
+
+  GekkoFS is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  GekkoFS is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with GekkoFS.  If not, see <https://www.gnu.org/licenses/>.
+
+  SPDX-License-Identifier: GPL-3.0-or-later
+*/
+/**
+ * @brief Definitions of the cache of hot chunk data.
+ */
+
+#include <daemon/backend/data/chunk_data_cache.hpp>
+#include <config.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <functional>
+
+using namespace std;
+
+namespace gkfs::data {
+
+namespace {
+
+constexpr size_t sketch_depth = 4;
+constexpr uint8_t sketch_max = 15; // 4-bit counters
+
+/**
+ * @brief Derives the counter index of a key in one sketch row.
+ */
+size_t
+sketch_index(size_t hash, size_t row, size_t width) {
+    // splitmix64 finalizer with a distinct seed per row
+    uint64_t x = hash + (row + 1) * 0x9e3779b97f4a7c15ull;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+    x ^= x >> 31;
+    return row * width + (x & (width - 1));
+}
+
+} // namespace
+
+size_t
+ChunkDataCache::key_hash::operator()(const key_type& key) const noexcept {
+    auto h = hash<string>{}(key.first);
+    // boost::hash_combine
+    return h ^ (hash<gkfs::rpc::chnk_id_t>{}(key.second) + 0x9e3779b9 +
+                (h << 6) + (h >> 2));
+}
+
+ChunkDataCache::shard&
+ChunkDataCache::get_shard(size_t hash) {
+    return *shards_[hash % shards_.size()];
+}
+
+void
+ChunkDataCache::record(shard& s, size_t hash) {
+    for(size_t row = 0; row < sketch_depth; row++) {
+        auto& counter = s.sketch[sketch_index(hash, row, sketch_width_)];
+        if(counter < sketch_max)
+            counter++;
+    }
+    // age all counters so that formerly hot chunks can cool down
+    if(++s.sketch_additions >= sketch_window_) {
+        for(auto& counter : s.sketch)
+            counter >>= 1;
+        s.sketch_additions /= 2;
+    }
+}
+
+uint8_t
+ChunkDataCache::frequency(const shard& s, size_t hash) const {
+    uint8_t freq = sketch_max;
+    for(size_t row = 0; row < sketch_depth; row++)
+        freq = min(freq, s.sketch[sketch_index(hash, row, sketch_width_)]);
+    return freq;
+}
+
+ChunkDataCache::ChunkDataCache(size_t capacity, size_t shard_count,
+                               size_t chunksize)
+    : max_entry_size_(chunksize) {
+    if(shard_count == 0)
+        shard_count = 1;
+    // each shard must be able to hold at least one chunk
+    if(capacity / shard_count < chunksize)
+        shard_count = max<size_t>(capacity / chunksize, 1);
+    shard_capacity_ = capacity / shard_count;
+    // sample about ten times the number of cached chunks before aging
+    sketch_window_ = max<size_t>(10 * (shard_capacity_ / chunksize), 1024);
+    sketch_width_ = 1;
+    while(sketch_width_ < sketch_window_)
+        sketch_width_ <<= 1;
+    shards_.reserve(shard_count);
+    for(size_t i = 0; i < shard_count; i++) {
+        shards_.emplace_back(make_unique<shard>());
+        shards_.back()->sketch.resize(sketch_depth * sketch_width_);
+    }
+}
+
+bool
+ChunkDataCache::get(const string& file_path, gkfs::rpc::chnk_id_t chunk_id,
+                    char* buf, size_t size, off64_t offset, ssize_t& read,
+                    uint64_t& version) {
+    key_type key{file_path, chunk_id};
+    auto h = key_hash{}(key);
+    auto& s = get_shard(h);
+    lock_guard<mutex> lock(s.mtx);
+    record(s, h);
+    auto it = s.map.find(key);
+    if(it == s.map.end()) {
+        misses_++;
+        version = s.version;
+        return false;
+    }
+    hits_++;
+    // move entry to the front of the LRU list
+    s.lru.splice(s.lru.begin(), s.lru, it->second);
+    const auto& e = *it->second;
+    read = 0;
+    if(static_cast<size_t>(offset) < e.size) {
+        read = static_cast<ssize_t>(min(size, e.size - offset));
+        memcpy(buf, e.data.get() + offset, read);
+    }
+    return true;
+}
+
+bool
+ChunkDataCache::admit(const string& file_path, gkfs::rpc::chnk_id_t chunk_id) {
+    auto h = key_hash{}(key_type{file_path, chunk_id});
+    auto& s = get_shard(h);
+    lock_guard<mutex> lock(s.mtx);
+    auto freq = frequency(s, h);
+    bool admitted = freq >= gkfs::config::data::chunk_cache_admit_min;
+    if(admitted && s.bytes + max_entry_size_ > shard_capacity_ &&
+       !s.lru.empty()) {
+        // the chunk must be hotter than the one it would replace
+        auto victim = key_hash{}(s.lru.back().key);
+        admitted = freq > frequency(s, victim);
+    }
+    if(!admitted)
+        rejections_++;
+    return admitted;
+}
+
+/**
+ * @internal
+ * At most one buffer per shard is kept, which covers the steady state in
+ * which every insertion evicts one entry. Buffers beyond that, e.g., of a
+ * removed file, are freed.
+ * @endinternal
+ */
+void
+ChunkDataCache::release(list<entry>& entries) {
+    if(entries.empty())
+        return;
+    lock_guard<mutex> lock(free_mtx_);
+    for(auto& e : entries) {
+        if(free_.size() >= shards_.size())
+            break;
+        free_.emplace_back(std::move(e.data));
+    }
+}
+
+unique_ptr<char[]>
+ChunkDataCache::acquire() {
+    {
+        lock_guard<mutex> lock(free_mtx_);
+        if(!free_.empty()) {
+            auto data = std::move(free_.back());
+            free_.pop_back();
+            return data;
+        }
+    }
+    // default-initialized, i.e., not zero-filled
+    return unique_ptr<char[]>(new char[max_entry_size_]);
+}
+
+void
+ChunkDataCache::put(const string& file_path, gkfs::rpc::chnk_id_t chunk_id,
+                    uint64_t version, unique_ptr<char[]>&& data, size_t size) {
+    key_type key{file_path, chunk_id};
+    auto& s = get_shard(key_hash{}(key));
+    // buffers of evicted or dropped chunks are released outside the lock
+    list<entry> evicted{};
+    {
+        lock_guard<mutex> lock(s.mtx);
+        auto it = s.map.find(key);
+        if(s.version != version || it != s.map.end() ||
+           max_entry_size_ > shard_capacity_) {
+            // another tasklet may have inserted the same chunk in the meantime
+            if(it != s.map.end())
+                s.lru.splice(s.lru.begin(), s.lru, it->second);
+            evicted.push_back({std::move(key), std::move(data), size});
+        } else {
+            while(!s.lru.empty() &&
+                  s.bytes + max_entry_size_ > shard_capacity_) {
+                s.bytes -= max_entry_size_;
+                s.map.erase(s.lru.back().key);
+                evicted.splice(evicted.begin(), s.lru, prev(s.lru.end()));
+                evictions_++;
+            }
+            s.bytes += max_entry_size_;
+            s.lru.push_front({std::move(key), std::move(data), size});
+            s.map.emplace(s.lru.front().key, s.lru.begin());
+            admissions_++;
+        }
+    }
+    release(evicted);
+}
+
+void
+ChunkDataCache::invalidate(const string& file_path,
+                           gkfs::rpc::chnk_id_t chunk_id) {
+    key_type key{file_path, chunk_id};
+    auto& s = get_shard(key_hash{}(key));
+    list<entry> removed{};
+    {
+        lock_guard<mutex> lock(s.mtx);
+        s.version++;
+        auto it = s.map.find(key);
+        if(it == s.map.end())
+            return;
+        s.bytes -= max_entry_size_;
+        removed.splice(removed.begin(), s.lru, it->second);
+        s.map.erase(it);
+    }
+    release(removed);
+}
+
+/**
+ * @internal
+ * Chunks of one file are spread over all shards. Removing a file therefore
+ * walks every shard, which is bound by the number of cached chunks.
+ * @endinternal
+ */
+void
+ChunkDataCache::invalidate_file(const string& file_path,
+                                gkfs::rpc::chnk_id_t chunk_start) {
+    for(auto& s : shards_) {
+        list<entry> removed{};
+        {
+            lock_guard<mutex> lock(s->mtx);
+            s->version++;
+            for(auto it = s->lru.begin(); it != s->lru.end();) {
+                if(it->key.second >= chunk_start &&
+                   it->key.first == file_path) {
+                    s->bytes -= max_entry_size_;
+                    s->map.erase(it->key);
+                    auto next = std::next(it);
+                    removed.splice(removed.begin(), s->lru, it);
+                    it = next;
+                } else {
+                    ++it;
+                }
+            }
+        }
+        release(removed);
+    }
+}
+
+ChunkDataCacheStats
+ChunkDataCache::stats() const {
+    size_t bytes = 0;
+    for(const auto& s : shards_) {
+        lock_guard<mutex> lock(s->mtx);
+        bytes += s->bytes;
+    }
+    return {hits_.load(),       misses_.load(),    admissions_.load(),
+            rejections_.load(), evictions_.load(), bytes};
+}
+
+} // namespace gkfs::data
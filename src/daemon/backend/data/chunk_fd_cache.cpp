@@ -0,0 +1,163 @@
+/*
+  Copyright 2018-2024, Barcelona Supercomputing Center (BSC), Spain
+  Copyright 2015-2024, Johannes Gutenberg Universitaet Mainz, Germany
+
+  This software was partially supported by the
+  EC H2020 funded project NEXTGenIO (Project ID: 671951, www.nextgenio.eu).
+
+  This software was partially supported by the
+  ADA-FS project under the SPPEXA project funded by the DFG.
+
+  This file is part of GekkoFS.
+
+  GekkoFS is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  GekkoFS is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with GekkoFS.  If not, see <https://www.gnu.org/licenses/>.
+
+  SPDX-License-Identifier: GPL-3.0-or-later
+*/
+/**
+ * @brief Definitions of the cache of open chunk file handles.
+ */
+
+#include <daemon/backend/data/chunk_fd_cache.hpp>
+#include <daemon/backend/data/file_handle.hpp>
+
+#include <functional>
+
+using namespace std;
+
+namespace gkfs::data {
+
+size_t
+ChunkFdCache::key_hash::operator()(const key_type& key) const noexcept {
+    auto h = hash<string>{}(key.first);
+    // boost::hash_combine
+    return h ^ (hash<gkfs::rpc::chnk_id_t>{}(key.second) + 0x9e3779b9 +
+                (h << 6) + (h >> 2));
+}
+
+ChunkFdCache::shard&
+ChunkFdCache::get_shard(const key_type& key) {
+    return *shards_[key_hash{}(key) % shards_.size()];
+}
+
+ChunkFdCache::ChunkFdCache(size_t capacity, size_t shard_count) {
+    if(shard_count == 0)
+        shard_count = 1;
+    // do not create more shards than entries
+    if(capacity < shard_count)
+        shard_count = capacity > 0 ? capacity : 1;
+    shard_capacity_ = capacity / shard_count;
+    shards_.reserve(shard_count);
+    for(size_t i = 0; i < shard_count; i++)
+        shards_.emplace_back(make_unique<shard>());
+}
+
+shared_ptr<FileHandle>
+ChunkFdCache::get(const string& file_path, gkfs::rpc::chnk_id_t chunk_id,
+                  uint64_t& version) {
+    key_type key{file_path, chunk_id};
+    auto& s = get_shard(key);
+    lock_guard<mutex> lock(s.mtx);
+    auto it = s.map.find(key);
+    if(it == s.map.end()) {
+        misses_++;
+        version = s.version;
+        return nullptr;
+    }
+    hits_++;
+    // move entry to the front of the LRU list
+    s.lru.splice(s.lru.begin(), s.lru, it->second);
+    return it->second->fh;
+}
+
+shared_ptr<FileHandle>
+ChunkFdCache::put(const string& file_path, gkfs::rpc::chnk_id_t chunk_id,
+                  uint64_t version, shared_ptr<FileHandle> fh) {
+    if(shard_capacity_ == 0)
+        return fh;
+    key_type key{file_path, chunk_id};
+    auto& s = get_shard(key);
+    // evicted handles are released outside the lock as they may close the fd
+    shared_ptr<FileHandle> evicted{};
+    lock_guard<mutex> lock(s.mtx);
+    // the file was removed or trimmed while the handle was opened
+    if(s.version != version)
+        return fh;
+    auto it = s.map.find(key);
+    if(it != s.map.end()) {
+        // another tasklet opened the same chunk in the meantime
+        s.lru.splice(s.lru.begin(), s.lru, it->second);
+        return it->second->fh;
+    }
+    if(s.map.size() >= shard_capacity_) {
+        auto& victim = s.lru.back();
+        s.map.erase(victim.key);
+        evicted = std::move(victim.fh);
+        s.lru.pop_back();
+        evictions_++;
+    }
+    s.lru.push_front({std::move(key), fh});
+    s.map.emplace(s.lru.front().key, s.lru.begin());
+    return fh;
+}
+
+void
+ChunkFdCache::invalidate(const string& file_path,
+                         gkfs::rpc::chnk_id_t chunk_id) {
+    key_type key{file_path, chunk_id};
+    auto& s = get_shard(key);
+    lock_guard<mutex> lock(s.mtx);
+    s.version++;
+    auto it = s.map.find(key);
+    if(it == s.map.end())
+        return;
+    s.lru.erase(it->second);
+    s.map.erase(it);
+}
+
+/**
+ * @internal
+ * Chunks of one file are spread over all shards. Removing a file therefore
+ * walks every shard, which is bound by the cache capacity and much cheaper
+ * than the file system operations that trigger it.
+ * @endinternal
+ */
+void
+ChunkFdCache::invalidate_file(const string& file_path,
+                              gkfs::rpc::chnk_id_t chunk_start) {
+    for(auto& s : shards_) {
+        lock_guard<mutex> lock(s->mtx);
+        s->version++;
+        for(auto it = s->lru.begin(); it != s->lru.end();) {
+            if(it->key.second >= chunk_start && it->key.first == file_path) {
+                s->map.erase(it->key);
+                it = s->lru.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+}
+
+ChunkFdCacheStats
+ChunkFdCache::stats() const {
+    size_t size = 0;
+    for(const auto& s : shards_) {
+        lock_guard<mutex> lock(s->mtx);
+        size += s->map.size();
+    }
+    return {hits_.load(), misses_.load(), evictions_.load(), size};
+}
+
+} // namespace gkfs::data
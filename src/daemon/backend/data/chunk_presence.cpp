@@ -0,0 +1,260 @@
+/*
+  Copyright 2018-2024, Barcelona Supercomputing Center (BSC), Spain
+  Copyright 2015-2024, Johannes Gutenberg Universitaet Mainz, Germany
+
+  This software was partially supported by the
+  EC H2020 funded project NEXTGenIO (Project ID: 671951, www.nextgenio.eu).
+
+  This software was partially supported by the
+  ADA-FS project under the SPPEXA project funded by the DFG.
+
+  This file is part of GekkoFS.
+
+  GekkoFS is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  GekkoFS is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with GekkoFS.  If not, see <https://www.gnu.org/licenses/>.
+
+  SPDX-License-Identifier: GPL-3.0-or-later
+*/
+/**
+ * @brief Definitions of the index of locally stored chunks.
+ */
+
+#include <daemon/backend/data/chunk_presence.hpp>
+#include <config.hpp>
+
+#include <algorithm>
+
+using namespace std;
+
+namespace gkfs::data {
+
+namespace {
+
+constexpr size_t container_bits = 16;
+constexpr size_t container_words = (1u << container_bits) / 64;
+// above this size, a bitmap is smaller than a sorted array
+constexpr size_t array_max = 4096;
+
+} // namespace
+
+// ChunkBitmap
+
+bool
+ChunkBitmap::contains(gkfs::rpc::chnk_id_t chunk_id) const {
+    auto it = containers_.find(chunk_id >> container_bits);
+    if(it == containers_.end())
+        return false;
+    auto low = static_cast<uint16_t>(chunk_id);
+    const auto& c = it->second;
+    if(!c.bits.empty())
+        return (c.bits[low / 64] >> (low % 64)) & 1u;
+    return binary_search(c.array.begin(), c.array.end(), low);
+}
+
+void
+ChunkBitmap::add(gkfs::rpc::chnk_id_t chunk_id) {
+    auto& c = containers_[chunk_id >> container_bits];
+    auto low = static_cast<uint16_t>(chunk_id);
+    if(!c.bits.empty()) {
+        auto& word = c.bits[low / 64];
+        auto mask = uint64_t{1} << (low % 64);
+        if(!(word & mask)) {
+            word |= mask;
+            c.cardinality++;
+        }
+        return;
+    }
+    auto pos = lower_bound(c.array.begin(), c.array.end(), low);
+    if(pos != c.array.end() && *pos == low)
+        return;
+    c.array.insert(pos, low);
+    c.cardinality++;
+    if(c.array.size() > array_max) {
+        // convert to a bitmap container
+        c.bits.assign(container_words, 0);
+        for(auto v : c.array)
+            c.bits[v / 64] |= uint64_t{1} << (v % 64);
+        c.array.clear();
+        c.array.shrink_to_fit();
+    }
+}
+
+void
+ChunkBitmap::remove(gkfs::rpc::chnk_id_t chunk_id) {
+    auto it = containers_.find(chunk_id >> container_bits);
+    if(it == containers_.end())
+        return;
+    auto low = static_cast<uint16_t>(chunk_id);
+    auto& c = it->second;
+    if(!c.bits.empty()) {
+        auto& word = c.bits[low / 64];
+        auto mask = uint64_t{1} << (low % 64);
+        if(!(word & mask))
+            return;
+        word &= ~mask;
+        c.cardinality--;
+        if(c.cardinality <= array_max) {
+            // convert back to an array container
+            for(size_t w = 0; w < container_words; w++) {
+                for(auto bits = c.bits[w]; bits != 0; bits &= bits - 1)
+                    c.array.push_back(static_cast<uint16_t>(
+                            w * 64 + __builtin_ctzll(bits)));
+            }
+            c.bits.clear();
+            c.bits.shrink_to_fit();
+        }
+    } else {
+        auto pos = lower_bound(c.array.begin(), c.array.end(), low);
+        if(pos == c.array.end() || *pos != low)
+            return;
+        c.array.erase(pos);
+        c.cardinality--;
+    }
+    if(c.cardinality == 0)
+        containers_.erase(it);
+}
+
+vector<gkfs::rpc::chnk_id_t>
+ChunkBitmap::remove_from(gkfs::rpc::chnk_id_t chunk_start) {
+    vector<gkfs::rpc::chnk_id_t> removed;
+    auto it = containers_.lower_bound(chunk_start >> container_bits);
+    while(it != containers_.end()) {
+        auto base = it->first << container_bits;
+        const auto& c = it->second;
+        // ids below chunk_start can only be in the first container
+        size_t first = chunk_start > base ? chunk_start - base : 0;
+        auto count = removed.size();
+        if(!c.bits.empty()) {
+            for(size_t w = first / 64; w < container_words; w++) {
+                auto bits = c.bits[w];
+                if(w == first / 64)
+                    bits &= ~uint64_t{0} << (first % 64);
+                for(; bits != 0; bits &= bits - 1)
+                    removed.push_back(base + w * 64 + __builtin_ctzll(bits));
+            }
+        } else {
+            for(auto v : c.array) {
+                if(v >= first)
+                    removed.push_back(base + v);
+            }
+        }
+        if(first == 0) {
+            it = containers_.erase(it);
+        } else {
+            ++it;
+            // partially trimmed container
+            for(auto i = count; i < removed.size(); i++)
+                remove(removed[i]);
+        }
+    }
+    return removed;
+}
+
+size_t
+ChunkBitmap::size() const {
+    size_t size = 0;
+    for(const auto& [key, c] : containers_)
+        size += c.cardinality;
+    return size;
+}
+
+// ChunkPresenceIndex
+
+ChunkPresenceIndex::shard&
+ChunkPresenceIndex::get_shard(const string& file_path) {
+    return *shards_[hash<string>{}(file_path) % shards_.size()];
+}
+
+ChunkBitmap&
+ChunkPresenceIndex::install(shard& s, const string& file_path) {
+    if(s.files.size() >= shard_files_max_)
+        s.files.clear();
+    auto& bitmap = s.files[file_path];
+    bitmap = ChunkBitmap{};
+    return bitmap;
+}
+
+ChunkPresenceIndex::ChunkPresenceIndex(size_t files_max, size_t shard_count) {
+    if(shard_count == 0)
+        shard_count = 1;
+    shard_files_max_ = max<size_t>(files_max / shard_count, 1);
+    shards_.reserve(shard_count);
+    for(size_t i = 0; i < shard_count; i++)
+        shards_.emplace_back(make_unique<shard>());
+}
+
+bool
+ChunkPresenceIndex::absent(const string& file_path,
+                           gkfs::rpc::chnk_id_t chunk_id) {
+    auto& s = get_shard(file_path);
+    lock_guard<mutex> lock(s.mtx);
+    auto it = s.files.find(file_path);
+    return it != s.files.end() && !it->second.contains(chunk_id);
+}
+
+void
+ChunkPresenceIndex::add(const string& file_path,
+                        gkfs::rpc::chnk_id_t chunk_id) {
+    auto& s = get_shard(file_path);
+    lock_guard<mutex> lock(s.mtx);
+    auto it = s.files.find(file_path);
+    if(it != s.files.end())
+        it->second.add(chunk_id);
+}
+
+void
+ChunkPresenceIndex::init(const string& file_path,
+                         const function<bool()>& create) {
+    auto& s = get_shard(file_path);
+    lock_guard<mutex> lock(s.mtx);
+    if(create())
+        install(s, file_path);
+}
+
+void
+ChunkPresenceIndex::load(const string& file_path,
+                         const function<void(ChunkBitmap&)>& scan) {
+    auto& s = get_shard(file_path);
+    lock_guard<mutex> lock(s.mtx);
+    if(s.files.count(file_path) != 0)
+        return;
+    ChunkBitmap bitmap{};
+    scan(bitmap);
+    install(s, file_path) = std::move(bitmap);
+}
+
+vector<gkfs::rpc::chnk_id_t>
+ChunkPresenceIndex::trim(const string& file_path,
+                         gkfs::rpc::chnk_id_t chunk_start,
+                         const function<void(ChunkBitmap&)>& scan) {
+    auto& s = get_shard(file_path);
+    lock_guard<mutex> lock(s.mtx);
+    auto it = s.files.find(file_path);
+    if(it == s.files.end()) {
+        ChunkBitmap bitmap{};
+        scan(bitmap);
+        auto& installed = install(s, file_path);
+        installed = std::move(bitmap);
+        return installed.remove_from(chunk_start);
+    }
+    return it->second.remove_from(chunk_start);
+}
+
+void
+ChunkPresenceIndex::erase(const string& file_path) {
+    auto& s = get_shard(file_path);
+    lock_guard<mutex> lock(s.mtx);
+    s.files.erase(file_path);
+}
+
+} // namespace gkfs::data
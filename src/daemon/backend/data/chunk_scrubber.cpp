@@ -0,0 +1,115 @@
+/*
+  Copyright 2018-2024, Barcelona Supercomputing Center (BSC), Spain
+  Copyright 2015-2024, Johannes Gutenberg Universitaet Mainz, Germany
+
+  This software was partially supported by the
+  EC H2020 funded project NEXTGenIO (Project ID: 671951, www.nextgenio.eu).
+
+  This software was partially supported by the
+  ADA-FS project under the SPPEXA project funded by the DFG.
+
+  This file is part of GekkoFS.
+
+  GekkoFS is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  GekkoFS is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with GekkoFS.  If not, see <https://www.gnu.org/licenses/>.
+
+  SPDX-License-Identifier: GPL-3.0-or-later
+*/
+/**
+ * @brief Background verification of the chunk checksums.
+ */
+
+#include <daemon/backend/data/data_module.hpp>
+#include <daemon/backend/data/chunk_scrubber.hpp>
+
+#include <cassert>
+
+#include <spdlog/spdlog.h>
+
+using namespace std;
+
+namespace gkfs::data {
+
+// private functions
+
+bool
+ChunkScrubber::wait_until(chrono::steady_clock::time_point time) {
+    unique_lock<mutex> lock(mutex_);
+    cv_.wait_until(lock, time, [this] { return !running_; });
+    return running_;
+}
+
+void
+ChunkScrubber::scrub_loop() {
+    while(true) {
+        auto start = chrono::steady_clock::now();
+        uint64_t pass_bytes = 0;
+        for(const auto& file : storage_->checksum_files()) {
+            auto chunks = storage_->checksum_chunk_count(file);
+            for(gkfs::rpc::chnk_id_t chunk_id = 0; chunk_id < chunks;
+                chunk_id++) {
+                try {
+                    auto read = storage_->scrub_chunk(file, chunk_id);
+                    pass_bytes += read;
+                    bytes_ += read;
+                } catch(const ChunkStorageException& e) {
+                    GKFS_DATA_MOD->log()->error("{}() {}", __func__, e.what());
+                }
+                // sleep while the pass is ahead of the rate
+                using clock = chrono::steady_clock;
+                chrono::duration<double> elapsed(
+                        static_cast<double>(pass_bytes) / rate_);
+                auto due = start +
+                           chrono::duration_cast<clock::duration>(elapsed);
+                if(!wait_until(due))
+                    return;
+            }
+        }
+        passes_++;
+        GKFS_DATA_MOD->log()->debug(
+                "{}() Scrubbed '{}' bytes. Checksum mismatches so far: '{}'",
+                __func__, pass_bytes, storage_->checksum_stats().mismatches);
+        if(!wait_until(chrono::steady_clock::now() +
+                       chrono::seconds(interval_s_)))
+            return;
+    }
+}
+
+// public functions
+
+ChunkScrubber::ChunkScrubber(shared_ptr<ChunkStorage> storage, uint64_t rate,
+                             unsigned int interval_s)
+    : storage_(std::move(storage)), rate_(rate), interval_s_(interval_s) {
+    assert(storage_ && rate_ > 0);
+    scrubber_ = thread(&ChunkScrubber::scrub_loop, this);
+    GKFS_DATA_MOD->log()->debug(
+            "{}() Scrubber started with rate: '{}' bytes/s interval: '{}' s",
+            __func__, rate_, interval_s_);
+}
+
+ChunkScrubber::~ChunkScrubber() {
+    {
+        lock_guard<mutex> lock(mutex_);
+        running_ = false;
+    }
+    cv_.notify_all();
+    if(scrubber_.joinable())
+        scrubber_.join();
+}
+
+ChunkScrubberStats
+ChunkScrubber::stats() const {
+    return {passes_.load(), bytes_.load()};
+}
+
+} // namespace gkfs::data
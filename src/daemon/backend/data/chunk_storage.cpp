@@ -33,9 +33,19 @@
 #include <daemon/backend/data/data_module.hpp>
 #include <daemon/backend/data/chunk_storage.hpp>
 #include <daemon/backend/data/file_handle.hpp>
+#include <daemon/backend/data/chunk_fd_cache.hpp>
+#include <daemon/backend/data/chunk_data_cache.hpp>
+#include <daemon/backend/data/chunk_presence.hpp>
+#include <daemon/backend/data/chunk_checksum.hpp>
+#include <daemon/backend/data/chunk_compression.hpp>
 #include <common/path_util.hpp>
+#include <common/arithmetic/arithmetic.hpp>
+#include <config.hpp>
 
+#include <algorithm>
 #include <cerrno>
+#include <cstring>
+#include <functional>
 
 #include <filesystem>
 #include <spdlog/spdlog.h>
@@ -44,6 +54,7 @@ extern "C" {
 #include <sys/statfs.h>
 #include <sys/stat.h>
 #include <fcntl.h>
+#include <unistd.h>
 }
 
 namespace fs = std::filesystem;
@@ -51,6 +62,98 @@ using namespace std;
 
 namespace gkfs::data {
 
+namespace {
+
+/**
+ * @brief Writes a buffer to a file descriptor, retrying interrupted and short
+ * writes.
+ * @return 0 on success or errno
+ */
+int
+write_fd(int fd, const char* buf, size_t size, off64_t offset) {
+    size_t wrote_total = 0;
+    while(wrote_total != size) {
+        auto wrote = pwrite64(fd, buf + wrote_total, size - wrote_total,
+                              offset + wrote_total);
+        if(wrote < 0) {
+            if(errno == EINTR || errno == EAGAIN || errno == EWOULDBLOCK)
+                continue;
+            return errno;
+        }
+        wrote_total += wrote;
+    }
+    return 0;
+}
+
+/**
+ * @brief Returns an aligned staging buffer of at least size bytes for O_DIRECT
+ * I/O. The buffer is owned by the calling thread and reused by all of its
+ * chunk operations, which never yield while using it.
+ * @throws std::bad_alloc
+ */
+char*
+staging_buffer(size_t size) {
+    thread_local unique_ptr<char, decltype(&free)> buf{nullptr, &free};
+    thread_local size_t buf_size = 0;
+    if(buf_size < size) {
+        // aligned_alloc() requires a multiple of the alignment
+        buf.reset(static_cast<char*>(
+                aligned_alloc(gkfs::config::data::direct_io_alignment, size)));
+        buf_size = buf ? size : 0;
+        if(!buf)
+            throw bad_alloc();
+    }
+    return buf.get();
+}
+
+/**
+ * @brief pread() for O_DIRECT file descriptors. A short read is end-of-file,
+ * reading on from the unaligned position would fail with EINVAL.
+ * @return The amount of bytes read or -errno
+ */
+ssize_t
+pread_direct(int fd, char* buf, size_t size, off64_t offset) {
+    ssize_t read;
+    do {
+        read = pread64(fd, buf, size, offset);
+    } while(read < 0 && (errno == EINTR || errno == EAGAIN));
+    return read < 0 ? -errno : read;
+}
+
+/**
+ * @brief Opens a file or directory and flushes it to the storage device.
+ * @param path Absolute path
+ * @param data_only Use fdatasync() instead of fsync()
+ * @return 0 on success or errno, e.g., ENOENT if the path does not exist
+ */
+int
+sync_path(const string& path, bool data_only) {
+    auto fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if(fd == -1)
+        return errno;
+    auto ret = data_only ? fdatasync(fd) : fsync(fd);
+    auto err = ret == -1 ? errno : 0;
+    close(fd);
+    return err;
+}
+
+/**
+ * @brief Flushes the whole file system containing path to the storage device.
+ * @param path Absolute path of a directory
+ * @return 0 on success or errno
+ */
+int
+sync_file_system(const string& path) {
+    auto fd = open(path.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if(fd == -1)
+        return errno;
+    auto err = syncfs(fd) == -1 ? errno : 0;
+    close(fd);
+    return err;
+}
+
+} // namespace
+
 // private functions
 
 string
@@ -84,22 +187,598 @@ ChunkStorage::get_chunk_path(const string& file_path,
     return fmt::format("{}/{}", get_chunks_dir(file_path), chunk_id);
 }
 
+/**
+ * @internal
+ * Adds the ids of all chunk files in a file's chunk directory. A missing
+ * directory means that the file has no local chunks.
+ * @endinternal
+ */
+void
+ChunkStorage::scan_chunk_space(const string& file_path,
+                               ChunkBitmap& bitmap) const {
+    auto chunk_dir = absolute(get_chunks_dir(file_path));
+    std::error_code ec;
+    fs::directory_iterator chunk_file(chunk_dir, ec);
+    if(ec) {
+        // no chunk of this file was ever written to this daemon
+        if(ec.value() == ENOENT)
+            return;
+        auto err_str = fmt::format(
+                "{}() Failed to open chunk directory. File: '{}', Error: '{}'",
+                __func__, chunk_dir, ec.message());
+        throw ChunkStorageException(ec.value(), err_str);
+    }
+    for(const fs::directory_iterator end; chunk_file != end;
+        chunk_file.increment(ec)) {
+        auto name = chunk_file->path().filename().string();
+        char* name_end = nullptr;
+        auto chunk_id = strtoull(name.c_str(), &name_end, 10);
+        if(!name.empty() && *name_end == '\0')
+            bitmap.add(chunk_id);
+    }
+    if(ec) {
+        auto err_str = fmt::format(
+                "{}() Failed to read chunk directory. File: '{}', Error: '{}'",
+                __func__, chunk_dir, ec.message());
+        throw ChunkStorageException(ec.value(), err_str);
+    }
+}
+
+/**
+ * @internal
+ * Chunk directories that were created once are remembered so that subsequent
+ * writes to the same file do not issue a mkdir() system call. The set is
+ * cleared when it reaches gkfs::config::data::known_dirs_max entries.
+ * @endinternal
+ */
 void
 ChunkStorage::init_chunk_space(const string& file_path) const {
+    {
+        lock_guard<mutex> lock(known_dirs_mutex_);
+        if(known_dirs_.count(file_path) != 0)
+            return;
+    }
     auto chunk_dir = absolute(get_chunks_dir(file_path));
-    auto err = mkdir(chunk_dir.c_str(), 0750);
-    if(err == -1 && errno != EEXIST) {
+    // a newly created chunk directory has no chunks
+    presence_->init(file_path, [&] {
+        auto err = mkdir(chunk_dir.c_str(), 0750);
+        if(err == -1 && errno != EEXIST) {
+            auto err_str = fmt::format(
+                    "{}() Failed to create chunk directory. File: '{}', Error: '{}'",
+                    __func__, file_path, errno);
+            throw ChunkStorageException(errno, err_str);
+        }
+        return err == 0;
+    });
+    lock_guard<mutex> lock(known_dirs_mutex_);
+    if(known_dirs_.size() >= gkfs::config::data::known_dirs_max)
+        known_dirs_.clear();
+    known_dirs_.emplace(file_path);
+}
+
+/**
+ * @internal
+ * Cached handles are opened read-write so that they can serve both reads and
+ * writes. If the chunk directory vanished since it was remembered, e.g., due
+ * to a concurrent remove, it is created again and the open is retried once.
+ *
+ * With the extent layout, all chunks share the backing file
+ * /tmp/rootdir/<pid>/data/chunks/foo:bar and therefore a single cache entry.
+ * @endinternal
+ */
+shared_ptr<FileHandle>
+ChunkStorage::open_chunk(const string& file_path, gkfs::rpc::chnk_id_t chunk_id,
+                         bool create) const {
+    if(layout_ == ChunkLayout::extent)
+        chunk_id = 0;
+    uint64_t version = 0;
+    if(fd_cache_) {
+        auto fh = fd_cache_->get(file_path, chunk_id, version);
+        if(fh)
+            return fh;
+    }
+    // O_DIRECT writes may need to read the blocks they partially overwrite
+    // checksums of partially written blocks are computed from the chunk file
+    // compressed chunks are read, modified, and written back as a whole
+    int flags = fd_cache_ || direct_io_ || checksums_ || compression_
+                        ? O_RDWR
+                        : (create ? O_WRONLY : O_RDONLY);
+    if(direct_io_)
+        flags |= O_DIRECT;
+    if(write_through_)
+        flags |= O_DSYNC;
+    if(create) {
+        flags |= O_CREAT;
+        // may throw ChunkStorageException on failure
+        if(layout_ == ChunkLayout::chunk)
+            init_chunk_space(file_path);
+    }
+    auto chunk_path = layout_ == ChunkLayout::chunk
+                              ? absolute(get_chunk_path(file_path, chunk_id))
+                              : absolute(get_chunks_dir(file_path));
+    auto fd = open(chunk_path.c_str(), flags, 0640);
+    if(fd == -1 && create && errno == ENOENT &&
+       layout_ == ChunkLayout::chunk) {
+        {
+            lock_guard<mutex> lock(known_dirs_mutex_);
+            known_dirs_.erase(file_path);
+        }
+        init_chunk_space(file_path);
+        fd = open(chunk_path.c_str(), flags, 0640);
+    }
+    if(fd == -1) {
+        auto err = errno;
         auto err_str = fmt::format(
-                "{}() Failed to create chunk directory. File: '{}', Error: '{}'",
-                __func__, file_path, errno);
-        throw ChunkStorageException(errno, err_str);
+                "{}() Failed to open chunk file. File: '{}', Error: '{}'",
+                __func__, chunk_path, ::strerror(err));
+        throw ChunkStorageException(err, err_str);
     }
+    if(create && layout_ == ChunkLayout::chunk)
+        presence_->add(file_path, chunk_id);
+    auto fh = make_shared<FileHandle>(fd, chunk_path);
+    if(!fd_cache_)
+        return fh;
+    return fd_cache_->put(file_path, chunk_id, version, std::move(fh));
+}
+
+mutex&
+ChunkStorage::direct_io_mutex(const string& file_path,
+                              gkfs::rpc::chnk_id_t chunk_id) const {
+    auto h = hash<string>{}(file_path);
+    if(layout_ == ChunkLayout::chunk)
+        h ^= hash<gkfs::rpc::chnk_id_t>{}(chunk_id) + 0x9e3779b9 + (h << 6) +
+             (h >> 2);
+    return direct_io_mutexes_[h % direct_io_mutexes_.size()];
+}
+
+/**
+ * @internal
+ * An unaligned write is widened to the enclosing aligned range. The first and
+ * the last block of that range are read first if they exist in the file, the
+ * new data is copied in between, and the whole range is written. If this
+ * extends the file beyond the end of the new data, the file is truncated to
+ * its exact size again, because readers rely on the file size to determine the
+ * end of a chunk. The caller holds the chunk's direct I/O mutex so that
+ * concurrent read-modify-write cycles and truncations cannot lose data.
+ * @endinternal
+ */
+int
+ChunkStorage::write_direct(int fd, const char* buf, size_t size,
+                           off64_t offset) const {
+    using namespace gkfs::utils::arithmetic;
+    constexpr size_t align = gkfs::config::data::direct_io_alignment;
+    const char* src = buf;
+    uint64_t a_off = offset;
+    size_t len = size;
+    struct stat st {};
+    bool aligned = is_aligned(reinterpret_cast<uintptr_t>(buf), align) &&
+                   is_aligned(offset, align) && is_aligned(size, align);
+    if(!aligned) {
+        if(fstat(fd, &st) == -1)
+            return errno;
+        uint64_t end = offset + size;
+        a_off = align_left(offset, align);
+        auto a_end = is_aligned(end, align) ? end : align_right(end, align);
+        len = a_end - a_off;
+        auto* stage = staging_buffer(len);
+        // keep the existing data of the first and last block
+        memset(stage, 0, align);
+        memset(stage + len - align, 0, align);
+        if(a_off != static_cast<uint64_t>(offset) &&
+           a_off < static_cast<uint64_t>(st.st_size)) {
+            auto read = pread_direct(fd, stage, align, a_off);
+            if(read < 0)
+                return static_cast<int>(-read);
+        }
+        auto last = a_end - align;
+        if(a_end != end && last < static_cast<uint64_t>(st.st_size) &&
+           (last != a_off || a_off == static_cast<uint64_t>(offset))) {
+            auto read = pread_direct(fd, stage + len - align, align, last);
+            if(read < 0)
+                return static_cast<int>(-read);
+        }
+        memcpy(stage + (offset - a_off), buf, size);
+        src = stage;
+    }
+    size_t wrote_total = 0;
+    while(wrote_total != len) {
+        auto wrote = pwrite64(fd, src + wrote_total, len - wrote_total,
+                              a_off + wrote_total);
+        if(wrote < 0) {
+            if(errno == EINTR || errno == EAGAIN || errno == EWOULDBLOCK)
+                continue;
+            return errno;
+        }
+        wrote_total += wrote;
+    }
+    if(!aligned) {
+        auto new_size = max<off64_t>(st.st_size, offset + size);
+        if(static_cast<off64_t>(a_off + len) > new_size &&
+           ftruncate(fd, new_size) == -1)
+            return errno;
+    }
+    return 0;
+}
+
+ssize_t
+ChunkStorage::read_direct(int fd, char* buf, size_t size,
+                          off64_t offset) const {
+    using namespace gkfs::utils::arithmetic;
+    constexpr size_t align = gkfs::config::data::direct_io_alignment;
+    if(is_aligned(reinterpret_cast<uintptr_t>(buf), align) &&
+       is_aligned(offset, align) && is_aligned(size, align))
+        return pread_direct(fd, buf, size, offset);
+    uint64_t end = offset + size;
+    auto a_off = align_left(offset, align);
+    auto a_end = is_aligned(end, align) ? end : align_right(end, align);
+    auto* stage = staging_buffer(a_end - a_off);
+    auto read = pread_direct(fd, stage, a_end - a_off, a_off);
+    if(read < 0)
+        return read;
+    auto skip = static_cast<ssize_t>(offset - a_off);
+    if(read <= skip)
+        return 0;
+    auto n = min<size_t>(size, read - skip);
+    memcpy(buf, stage + skip, n);
+    return static_cast<ssize_t>(n);
+}
+
+ssize_t
+ChunkStorage::read_fd(int fd, char* buf, size_t size, off64_t offset) const {
+    if(direct_io_)
+        return read_direct(fd, buf, size, offset);
+    size_t read_total = 0;
+    while(read_total != size) {
+        auto read = pread64(fd, buf + read_total, size - read_total,
+                            offset + read_total);
+        // end-of-file
+        if(read == 0)
+            break;
+        if(read < 0) {
+            if(errno == EINTR || errno == EAGAIN || errno == EWOULDBLOCK)
+                continue;
+            return -errno;
+        }
+        read_total += read;
+    }
+    return static_cast<ssize_t>(read_total);
+}
+
+/**
+ * @internal
+ * A block's checksum covers the bytes of the block that exist in the chunk
+ * file. Fully overwritten blocks are checksummed from the write buffer, the
+ * partially overwritten first and last block are read back from the chunk file.
+ * @endinternal
+ */
+void
+ChunkStorage::update_checksums(int fd, const string& file_path,
+                               gkfs::rpc::chnk_id_t chunk_id, const char* buf,
+                               size_t size, off64_t offset) const {
+    if(size == 0)
+        return;
+    const uint64_t bs = checksums_->block_size();
+    const uint64_t off = offset;
+    auto first = off / bs;
+    auto last = (off + size - 1) / bs;
+    vector<ChecksumEntry> entries;
+    entries.reserve(last - first + 1);
+    vector<char> block;
+    for(auto b = first; b <= last; b++) {
+        auto b_off = b * bs;
+        if(buf && off <= b_off && off + size >= b_off + bs) {
+            entries.push_back({crc32c(0, buf + (b_off - off), bs),
+                               static_cast<uint32_t>(bs)});
+            continue;
+        }
+        block.resize(bs);
+        auto read = read_fd(fd, block.data(), bs,
+                            chunk_offset(chunk_id) + b_off);
+        if(read < 0) {
+            auto err_str = fmt::format(
+                    "{}() Failed to read block for its checksum. File: '{}', chunk: '{}', block: '{}', Error: '{}'",
+                    __func__, file_path, chunk_id, b, ::strerror(-read));
+            throw ChunkStorageException(static_cast<int>(-read), err_str);
+        }
+        entries.push_back({crc32c(0, block.data(), read),
+                           static_cast<uint32_t>(read)});
+    }
+    checksums_->put(file_path, chunk_id, first, entries);
+}
+
+/**
+ * @internal
+ * Only the checksummed bytes of a block are compared. Bytes beyond them read
+ * as zeros, e.g., if a hole was created by a later write behind the block.
+ * @endinternal
+ */
+bool
+ChunkStorage::verify_blocks(const string& file_path,
+                            gkfs::rpc::chnk_id_t chunk_id, const char* data,
+                            size_t size, uint64_t first_block,
+                            size_t count) const {
+    const size_t bs = checksums_->block_size();
+    auto entries = checksums_->get(file_path, chunk_id, first_block, count);
+    auto ok = true;
+    for(size_t i = 0; i < count; i++) {
+        const auto& entry = entries[i];
+        if(entry.len == 0)
+            continue;
+        auto off = i * bs;
+        auto avail = size > off ? min(bs, size - off) : 0;
+        verified_blocks_++;
+        if(avail >= entry.len && crc32c(0, data + off, entry.len) == entry.crc)
+            continue;
+        checksum_mismatches_++;
+        ok = false;
+        log_->error(
+                "{}() Checksum mismatch. File: '{}', chunk: '{}', block: '{}'",
+                __func__, file_path, chunk_id, first_block + i);
+    }
+    return ok;
+}
+
+mutex&
+ChunkStorage::compression_mutex(const string& file_path,
+                                gkfs::rpc::chnk_id_t chunk_id) const {
+    auto h = hash<string>{}(file_path);
+    h ^= hash<gkfs::rpc::chnk_id_t>{}(chunk_id) + 0x9e3779b9 + (h << 6) +
+         (h >> 2);
+    return compression_mutexes_[h % compression_mutexes_.size()];
+}
+
+bool
+ChunkStorage::read_chunk_header(int fd, const string& file_path,
+                                gkfs::rpc::chnk_id_t chunk_id,
+                                CompressedChunkHeader& header) const {
+    auto read = read_fd(fd, reinterpret_cast<char*>(&header), sizeof(header),
+                        0);
+    if(read < 0) {
+        auto err_str = fmt::format(
+                "Failed to read chunk header. File: '{}', chunk: '{}', Error: '{}'",
+                file_path, chunk_id, ::strerror(-read));
+        throw ChunkStorageException(static_cast<int>(-read), err_str);
+    }
+    // e.g., the chunk file was created but its first write failed
+    if(read == 0)
+        return false;
+    if(static_cast<size_t>(read) != sizeof(header) ||
+       header.magic != compressed_chunk_magic ||
+       header.raw_size > chunksize_ ||
+       (header.codec != ChunkCodec::raw && header.codec != ChunkCodec::lz4)) {
+        auto err_str = fmt::format(
+                "Chunk file is not a compressed chunk. File: '{}', chunk: '{}'",
+                file_path, chunk_id);
+        throw ChunkStorageException(EIO, err_str);
+    }
+    return true;
+}
+
+void
+ChunkStorage::load_compressed(int fd, const string& file_path,
+                              gkfs::rpc::chnk_id_t chunk_id,
+                              const CompressedChunkHeader& header, char* buf,
+                              size_t size) const {
+    assert(size <= header.raw_size);
+    if(header.codec == ChunkCodec::raw) {
+        auto read = read_fd(fd, buf, size, sizeof(header));
+        if(read < 0) {
+            auto err_str = fmt::format(
+                    "Failed to read chunk file. File: '{}', chunk: '{}', Error: '{}'",
+                    file_path, chunk_id, ::strerror(-read));
+            throw ChunkStorageException(static_cast<int>(-read), err_str);
+        }
+        // a hole at the end of the chunk
+        memset(buf + read, 0, size - read);
+        return;
+    }
+    thread_local vector<char> payload;
+    payload.resize(header.stored_size);
+    auto read = read_fd(fd, payload.data(), payload.size(), sizeof(header));
+    if(read < 0) {
+        auto err_str = fmt::format(
+                "Failed to read chunk file. File: '{}', chunk: '{}', Error: '{}'",
+                file_path, chunk_id, ::strerror(-read));
+        throw ChunkStorageException(static_cast<int>(-read), err_str);
+    }
+    if(static_cast<size_t>(read) != payload.size() ||
+       !decode_chunk(payload.data(), header, buf, size)) {
+        auto err_str = fmt::format(
+                "Failed to decode compressed chunk. File: '{}', chunk: '{}'",
+                file_path, chunk_id);
+        throw ChunkStorageException(EIO, err_str);
+    }
+}
+
+void
+ChunkStorage::store_compressed(int fd, const string& file_path,
+                               gkfs::rpc::chnk_id_t chunk_id, const char* data,
+                               size_t size) const {
+    thread_local vector<char> image;
+    auto codec = encode_chunk(data, size, image);
+    auto err = write_fd(fd, image.data(), image.size(), 0);
+    // a previous encoding may have been longer
+    if(err == 0 && ftruncate(fd, static_cast<off_t>(image.size())) == -1)
+        err = errno;
+    if(err != 0) {
+        auto err_str = fmt::format(
+                "Failed to write chunk file. File: '{}', chunk: '{}', size: '{}', Error: '{}'",
+                file_path, chunk_id, image.size(), ::strerror(err));
+        throw ChunkStorageException(err, err_str);
+    }
+    compression_raw_bytes_ += size;
+    compression_stored_bytes_ += image.size();
+    if(codec == ChunkCodec::raw)
+        compression_skipped_++;
+}
+
+/**
+ * @internal
+ * Chunks that were stored raw because they did not compress are updated in
+ * place. They are encoded again only when a write covers the whole chunk, so
+ * that small writes to incompressible data do not pay for compression.
+ * Compressed chunks are decoded, modified, and encoded again, unless the write
+ * replaces all of their data.
+ * @endinternal
+ */
+void
+ChunkStorage::write_compressed(int fd, const string& file_path,
+                               gkfs::rpc::chnk_id_t chunk_id, const char* buf,
+                               size_t size, off64_t offset) const {
+    lock_guard<mutex> lock(compression_mutex(file_path, chunk_id));
+    CompressedChunkHeader header{};
+    size_t old_size = 0;
+    if(read_chunk_header(fd, file_path, chunk_id, header))
+        old_size = header.raw_size;
+    const size_t end = offset + size;
+    if(offset == 0 && end >= old_size) {
+        store_compressed(fd, file_path, chunk_id, buf, size);
+        return;
+    }
+    if(old_size > 0 && header.codec == ChunkCodec::raw) {
+        auto err = write_fd(fd, buf, size, sizeof(header) + offset);
+        if(err == 0 && end > old_size) {
+            header.raw_size = header.stored_size = static_cast<uint32_t>(end);
+            err = write_fd(fd, reinterpret_cast<const char*>(&header),
+                           sizeof(header), 0);
+        }
+        if(err != 0) {
+            auto err_str = fmt::format(
+                    "Failed to write chunk file. File: '{}', chunk: '{}', size: '{}', offset: '{}', Error: '{}'",
+                    file_path, chunk_id, size, offset, ::strerror(err));
+            throw ChunkStorageException(err, err_str);
+        }
+        compression_raw_bytes_ += size;
+        compression_stored_bytes_ += size;
+        return;
+    }
+    thread_local vector<char> data;
+    data.resize(max(old_size, end));
+    if(old_size > 0)
+        load_compressed(fd, file_path, chunk_id, header, data.data(),
+                        old_size);
+    if(static_cast<size_t>(offset) > old_size)
+        memset(data.data() + old_size, 0, offset - old_size);
+    memcpy(data.data() + offset, buf, size);
+    store_compressed(fd, file_path, chunk_id, data.data(), data.size());
+}
+
+ssize_t
+ChunkStorage::read_compressed(int fd, const string& file_path,
+                              gkfs::rpc::chnk_id_t chunk_id, char* buf,
+                              size_t size, off64_t offset) const {
+    lock_guard<mutex> lock(compression_mutex(file_path, chunk_id));
+    CompressedChunkHeader header{};
+    if(!read_chunk_header(fd, file_path, chunk_id, header) ||
+       static_cast<size_t>(offset) >= header.raw_size)
+        return 0;
+    auto n = min<size_t>(size, header.raw_size - offset);
+    if(header.codec == ChunkCodec::raw) {
+        auto read = read_fd(fd, buf, n, sizeof(header) + offset);
+        if(read < 0) {
+            auto err_str = fmt::format(
+                    "Failed to read chunk file. File: '{}', chunk: '{}', size: '{}', offset: '{}', Error: '{}'",
+                    file_path, chunk_id, size, offset, ::strerror(-read));
+            throw ChunkStorageException(static_cast<int>(-read), err_str);
+        }
+        return read;
+    }
+    if(offset == 0) {
+        load_compressed(fd, file_path, chunk_id, header, buf, n);
+        return static_cast<ssize_t>(n);
+    }
+    // LZ4 blocks can only be decoded from their beginning
+    thread_local vector<char> data;
+    data.resize(offset + n);
+    load_compressed(fd, file_path, chunk_id, header, data.data(), data.size());
+    memcpy(buf, data.data() + offset, n);
+    return static_cast<ssize_t>(n);
 }
 
 // public functions
 
-ChunkStorage::ChunkStorage(string& path, const size_t chunksize)
-    : root_path_(path), chunksize_(chunksize) {
+/**
+ * @internal
+ * With the chunk layout, each chunk file of the file is synced with
+ * fdatasync(). If there are more than gkfs::config::data::sync_syncfs_threshold
+ * chunk files, a single syncfs() of the node-local file system is issued
+ * instead. The chunk directory and the root directory are synced as well so
+ * that newly created chunk files and backing files survive a crash. The
+ * file's checksum sidecar is synced as well, as it may be stored on another
+ * file system.
+ * @endinternal
+ */
+void
+ChunkStorage::sync_file(const string& file_path) const {
+    if(checksums_)
+        checksums_->sync(file_path);
+    auto chunk_dir = absolute(get_chunks_dir(file_path));
+    auto throw_err = [&](int err, const string& path) {
+        auto err_str = fmt::format(
+                "{}() Failed to sync chunk data. File: '{}', Error: '{}'",
+                __func__, path, ::strerror(err));
+        throw ChunkStorageException(err, err_str);
+    };
+    if(layout_ == ChunkLayout::extent) {
+        auto err = sync_path(chunk_dir, true);
+        // no chunk of this file was ever written to this daemon
+        if(err == ENOENT)
+            return;
+        if(err != 0)
+            throw_err(err, chunk_dir);
+    } else {
+        vector<string> chunk_files;
+        std::error_code ec;
+        fs::directory_iterator chunk_file(chunk_dir, ec);
+        if(ec && ec.value() == ENOENT)
+            return;
+        for(const fs::directory_iterator end; !ec && chunk_file != end;
+            chunk_file.increment(ec))
+            chunk_files.emplace_back(chunk_file->path().string());
+        if(ec)
+            throw_err(ec.value(), chunk_dir);
+        if(chunk_files.size() > gkfs::config::data::sync_syncfs_threshold) {
+            auto err = sync_file_system(root_path_);
+            if(err != 0)
+                throw_err(err, root_path_);
+            return;
+        }
+        for(const auto& chunk_path : chunk_files) {
+            auto err = sync_path(chunk_path, true);
+            // removed by a concurrent truncate
+            if(err != 0 && err != ENOENT)
+                throw_err(err, chunk_path);
+        }
+        auto err = sync_path(chunk_dir, false);
+        if(err != 0 && err != ENOENT)
+            throw_err(err, chunk_dir);
+    }
+    auto err = sync_path(root_path_, false);
+    if(err != 0)
+        throw_err(err, root_path_);
+}
+
+off64_t
+ChunkStorage::chunk_offset(gkfs::rpc::chnk_id_t chunk_id) const {
+    if(layout_ == ChunkLayout::chunk)
+        return 0;
+    return static_cast<off64_t>(chunk_id * chunksize_);
+}
+
+ChunkStorage::ChunkStorage(string& path, const size_t chunksize,
+                           const size_t fd_cache_size, ChunkLayout layout,
+                           bool direct_io, const size_t data_cache_size,
+                           bool write_through, const string& checksum_path,
+                           bool verify_reads, bool compression)
+    : root_path_(path), chunksize_(chunksize), layout_(layout),
+      direct_io_(direct_io),
+      direct_io_mutexes_(direct_io ? gkfs::config::data::direct_io_lock_stripes
+                                   : 0),
+      write_through_(write_through), verify_reads_(verify_reads),
+      compression_(compression),
+      compression_mutexes_(
+              compression ? gkfs::config::data::compression_lock_stripes
+                          : 0) {
     /* Get logger instance and set it for data module and chunk storage */
     GKFS_DATA_MOD->log(spdlog::get(GKFS_DATA_MOD->LOGGER_NAME));
     assert(GKFS_DATA_MOD->log());
@@ -113,19 +792,99 @@ ChunkStorage::ChunkStorage(string& path, const size_t chunksize)
                 __func__, root_path_);
         throw ChunkStorageException(EPERM, err_str);
     }
-    log_->debug("{}() Chunk storage initialized with path: '{}'", __func__,
-                root_path_);
+    if(compression_ &&
+       (!compression_available() || layout_ != ChunkLayout::chunk ||
+        direct_io_ || !checksum_path.empty())) {
+        auto err_str = fmt::format(
+                "{}() Compression requires LZ4 support and the chunk layout without direct I/O and checksums",
+                __func__);
+        throw ChunkStorageException(EINVAL, err_str);
+    }
+    if(direct_io_) {
+        // e.g., tmpfs rejects O_DIRECT with EINVAL
+        auto probe_path = fmt::format("{}/.direct_io_probe", root_path_);
+        auto fd = open(probe_path.c_str(), O_RDWR | O_CREAT | O_DIRECT, 0640);
+        if(fd == -1) {
+            auto err = errno;
+            auto err_str = fmt::format(
+                    "{}() Direct I/O is not supported in path '{}'. Error: '{}'",
+                    __func__, root_path_, ::strerror(err));
+            throw ChunkStorageException(err, err_str);
+        }
+        close(fd);
+        unlink(probe_path.c_str());
+    }
+    if(fd_cache_size > 0)
+        fd_cache_ = std::make_unique<ChunkFdCache>(
+                fd_cache_size, gkfs::config::data::fd_cache_shards);
+    if(layout_ == ChunkLayout::chunk)
+        presence_ = std::make_unique<ChunkPresenceIndex>(
+                gkfs::config::data::presence_files_max,
+                gkfs::config::data::fd_cache_shards);
+    if(data_cache_size > 0)
+        data_cache_ = std::make_unique<ChunkDataCache>(
+                data_cache_size, gkfs::config::data::chunk_cache_shards,
+                chunksize_);
+    if(!checksum_path.empty())
+        checksums_ = std::make_unique<ChunkChecksums>(
+                checksum_path, chunksize_,
+                gkfs::config::data::checksum_block_size, fd_cache_size,
+                gkfs::config::data::checksum_lock_stripes, write_through_);
+    log_->debug(
+            "{}() Chunk storage initialized with path: '{}' fd cache size: '{}' layout: '{}' direct I/O: '{}' data cache size: '{}' write-through: '{}' checksums: '{}' verify reads: '{}' compression: '{}'",
+            __func__, root_path_, fd_cache_size,
+            layout_ == ChunkLayout::chunk ? layout_chunk : layout_extent,
+            direct_io_, data_cache_size, write_through_,
+            checksums_ != nullptr, verify_reads_, compression_);
 }
 
+ChunkStorage::~ChunkStorage() = default;
+
 void
 ChunkStorage::destroy_chunk_space(const string& file_path) const {
     auto chunk_dir = absolute(get_chunks_dir(file_path));
+    if(checksums_)
+        checksums_->destroy(file_path);
+    if(layout_ == ChunkLayout::extent) {
+        // all chunks are removed with the backing file
+        auto failed = unlink(chunk_dir.c_str()) == -1 && errno != ENOENT;
+        auto err = errno;
+        // cached handles would otherwise keep writing to the unlinked file.
+        // Both caches must be invalidated after the unlink, so that a
+        // concurrent open or read cannot cache the old file again.
+        if(fd_cache_)
+            fd_cache_->invalidate_file(file_path);
+        if(data_cache_)
+            data_cache_->invalidate_file(file_path);
+        if(failed) {
+            auto err_str = fmt::format(
+                    "{}() Failed to remove backing file. Path: '{}', Error: '{}'",
+                    __func__, chunk_dir, ::strerror(err));
+            throw ChunkStorageException(err, err_str);
+        }
+        return;
+    }
+    {
+        lock_guard<mutex> lock(known_dirs_mutex_);
+        known_dirs_.erase(file_path);
+    }
+    presence_->erase(file_path);
     try {
         // Note: remove_all does not throw an error when path doesn't exist.
         auto n = fs::remove_all(chunk_dir);
+        // must follow the removal, see ChunkFdCache and ChunkDataCache
+        if(fd_cache_)
+            fd_cache_->invalidate_file(file_path);
+        if(data_cache_)
+            data_cache_->invalidate_file(file_path);
         log_->debug("{}() Removed '{}' files and directories from '{}'",
                     __func__, n, chunk_dir);
     } catch(const fs::filesystem_error& e) {
+        // some chunks may have been removed
+        if(fd_cache_)
+            fd_cache_->invalidate_file(file_path);
+        if(data_cache_)
+            data_cache_->invalidate_file(file_path);
         auto err_str = fmt::format(
                 "{}() Failed to remove chunk directory. Path: '{}', Error: '{}'",
                 __func__, chunk_dir, e.what());
@@ -147,24 +906,52 @@ ChunkStorage::write_chunk(const string& file_path,
 
     assert((offset + size) <= chunksize_);
     // may throw ChunkStorageException on failure
-    init_chunk_space(file_path);
-
-    auto chunk_path = absolute(get_chunk_path(file_path, chunk_id));
-
-    FileHandle fh(open(chunk_path.c_str(), O_WRONLY | O_CREAT, 0640),
-                  chunk_path);
-    if(!fh.valid()) {
-        auto err_str = fmt::format(
-                "{}() Failed to open chunk file for write. File: '{}', Error: '{}'",
-                __func__, chunk_path, ::strerror(errno));
-        throw ChunkStorageException(errno, err_str);
+    auto fh = open_chunk(file_path, chunk_id, true);
+    // data and checksums of a chunk are updated together
+    unique_lock<mutex> checksum_lock;
+    if(checksums_)
+        checksum_lock =
+                unique_lock<mutex>(checksums_->mutex(file_path, chunk_id));
+    const auto chunk_off = offset;
+    offset += chunk_offset(chunk_id);
+    if(compression_) {
+        try {
+            write_compressed(fh->native(), file_path, chunk_id, buf, size,
+                             chunk_off);
+        } catch(const ChunkStorageException&) {
+            // a failed write may have modified the chunk
+            if(data_cache_)
+                data_cache_->invalidate(file_path, chunk_id);
+            throw;
+        }
+        // must follow the write, see ChunkDataCache
+        if(data_cache_)
+            data_cache_->invalidate(file_path, chunk_id);
+        return size;
+    }
+    if(direct_io_) {
+        lock_guard<mutex> lock(direct_io_mutex(file_path, chunk_id));
+        auto err = write_direct(fh->native(), buf, size, offset);
+        if(data_cache_)
+            data_cache_->invalidate(file_path, chunk_id);
+        if(err != 0) {
+            auto err_str = fmt::format(
+                    "{}() Failed to write chunk file. File: '{}', chunk: '{}', size: '{}', offset: '{}', Error: '{}'",
+                    __func__, file_path, chunk_id, size, offset,
+                    ::strerror(err));
+            throw ChunkStorageException(err, err_str);
+        }
+        if(checksums_)
+            update_checksums(fh->native(), file_path, chunk_id, buf, size,
+                             chunk_off);
+        return size;
     }
 
     size_t wrote_total{};
     ssize_t wrote{};
 
     do {
-        wrote = pwrite(fh.native(), buf + wrote_total, size - wrote_total,
+        wrote = pwrite(fh->native(), buf + wrote_total, size - wrote_total,
                        offset + wrote_total);
 
         if(wrote < 0) {
@@ -172,15 +959,25 @@ ChunkStorage::write_chunk(const string& file_path,
             // system call
             if(errno == EINTR || errno == EAGAIN || errno == EWOULDBLOCK)
                 continue;
+            auto err = errno;
+            // a partial write may have modified the chunk
+            if(data_cache_)
+                data_cache_->invalidate(file_path, chunk_id);
             auto err_str = fmt::format(
-                    "{}() Failed to write chunk file. File: '{}', size: '{}', offset: '{}', Error: '{}'",
-                    __func__, chunk_path, size, offset, ::strerror(errno));
-            throw ChunkStorageException(errno, err_str);
+                    "{}() Failed to write chunk file. File: '{}', chunk: '{}', size: '{}', offset: '{}', Error: '{}'",
+                    __func__, file_path, chunk_id, size, offset, ::strerror(err));
+            throw ChunkStorageException(err, err_str);
         }
         wrote_total += wrote;
     } while(wrote_total != size);
+    // must follow the write, see ChunkDataCache
+    if(data_cache_)
+        data_cache_->invalidate(file_path, chunk_id);
+    if(checksums_)
+        update_checksums(fh->native(), file_path, chunk_id, buf, size,
+                         chunk_off);
 
-    // file is closed via the file handle's destructor.
+    // file is closed via the file handle's destructor if it is not cached.
     return wrote_total;
 }
 
@@ -192,23 +989,72 @@ ChunkStorage::write_chunk(const string& file_path,
  * @endinternal
  */
 ssize_t
-ChunkStorage::read_chunk(const string& file_path, gkfs::rpc::chnk_id_t chunk_id,
-                         char* buf, size_t size, off64_t offset) const {
+ChunkStorage::read_chunk_file(const string& file_path,
+                              gkfs::rpc::chnk_id_t chunk_id, char* buf,
+                              size_t size, off64_t offset) const {
     assert((offset + size) <= chunksize_);
-    auto chunk_path = absolute(get_chunk_path(file_path, chunk_id));
-
-    FileHandle fh(open(chunk_path.c_str(), O_RDONLY), chunk_path);
-    if(!fh.valid()) {
-        auto err_str = fmt::format(
-                "{}() Failed to open chunk file for read. File: '{}', Error: '{}'",
-                __func__, chunk_path, ::strerror(errno));
-        throw ChunkStorageException(errno, err_str);
+    shared_ptr<FileHandle> fh;
+    try {
+        fh = open_chunk(file_path, chunk_id, false);
+    } catch(const ChunkStorageException& e) {
+        if(e.code().value() != ENOENT)
+            throw;
+        // sparse chunk, index the file's chunks for subsequent reads
+        if(presence_)
+            presence_->load(file_path, [&](ChunkBitmap& bitmap) {
+                scan_chunk_space(file_path, bitmap);
+            });
+        return 0;
+    }
+    if(compression_)
+        return read_compressed(fh->native(), file_path, chunk_id, buf, size,
+                               offset);
+    if(checksums_ && verify_reads_ && size > 0) {
+        // verification needs the whole blocks that overlap the request
+        const uint64_t bs = checksums_->block_size();
+        auto first = offset / bs;
+        auto count = (offset + size + bs - 1) / bs - first;
+        thread_local vector<char> blocks;
+        blocks.resize(count * bs);
+        lock_guard<mutex> lock(checksums_->mutex(file_path, chunk_id));
+        auto read = read_fd(fh->native(), blocks.data(), blocks.size(),
+                            chunk_offset(chunk_id) + first * bs);
+        if(read < 0) {
+            auto err_str = fmt::format(
+                    "Failed to read chunk file. File: '{}', chunk: '{}', size: '{}', offset: '{}', Error: '{}'",
+                    file_path, chunk_id, size, offset, ::strerror(-read));
+            throw ChunkStorageException(static_cast<int>(-read), err_str);
+        }
+        if(!verify_blocks(file_path, chunk_id, blocks.data(), read, first,
+                          count)) {
+            auto err_str = fmt::format(
+                    "Chunk data does not match its checksum. File: '{}', chunk: '{}', size: '{}', offset: '{}'",
+                    file_path, chunk_id, size, offset);
+            throw ChunkStorageException(EIO, err_str);
+        }
+        auto skip = static_cast<ssize_t>(offset - first * bs);
+        if(read <= skip)
+            return 0;
+        auto n = min<size_t>(size, read - skip);
+        memcpy(buf, blocks.data() + skip, n);
+        return static_cast<ssize_t>(n);
+    }
+    offset += chunk_offset(chunk_id);
+    if(direct_io_) {
+        auto read = read_direct(fh->native(), buf, size, offset);
+        if(read < 0) {
+            auto err_str = fmt::format(
+                    "Failed to read chunk file. File: '{}', chunk: '{}', size: '{}', offset: '{}', Error: '{}'",
+                    file_path, chunk_id, size, offset, ::strerror(-read));
+            throw ChunkStorageException(static_cast<int>(-read), err_str);
+        }
+        return read;
     }
     size_t read_total = 0;
     ssize_t read = 0;
 
     do {
-        read = pread64(fh.native(), buf + read_total, size - read_total,
+        read = pread64(fh->native(), buf + read_total, size - read_total,
                        offset + read_total);
         if(read == 0) {
             /*
@@ -226,8 +1072,8 @@ ChunkStorage::read_chunk(const string& file_path, gkfs::rpc::chnk_id_t chunk_id,
             if(errno == EINTR || errno == EAGAIN || errno == EWOULDBLOCK)
                 continue;
             auto err_str = fmt::format(
-                    "Failed to read chunk file. File: '{}', size: '{}', offset: '{}', Error: '{}'",
-                    chunk_path, size, offset, ::strerror(errno));
+                    "Failed to read chunk file. File: '{}', chunk: '{}', size: '{}', offset: '{}', Error: '{}'",
+                    file_path, chunk_id, size, offset, ::strerror(errno));
             throw ChunkStorageException(errno, err_str);
         }
 
@@ -242,10 +1088,43 @@ ChunkStorage::read_chunk(const string& file_path, gkfs::rpc::chnk_id_t chunk_id,
         read_total += read;
     } while(read_total != size);
 
-    // file is closed via the file handle's destructor.
+    // file is closed via the file handle's destructor if it is not cached.
     return read_total;
 }
 
+/**
+ * @internal
+ * On a miss of an admitted chunk, the whole chunk is read and inserted into
+ * the chunk data cache. Other misses read only the requested range.
+ * @endinternal
+ */
+ssize_t
+ChunkStorage::read_chunk(const string& file_path, gkfs::rpc::chnk_id_t chunk_id,
+                         char* buf, size_t size, off64_t offset) const {
+    assert((offset + size) <= chunksize_);
+    // holes are answered without accessing the file system
+    if(presence_ && presence_->absent(file_path, chunk_id))
+        return 0;
+    if(!data_cache_)
+        return read_chunk_file(file_path, chunk_id, buf, size, offset);
+    ssize_t read = 0;
+    uint64_t version = 0;
+    if(data_cache_->get(file_path, chunk_id, buf, size, offset, read, version))
+        return read;
+    if(!data_cache_->admit(file_path, chunk_id))
+        return read_chunk_file(file_path, chunk_id, buf, size, offset);
+    auto data = data_cache_->acquire();
+    auto chunk_size = static_cast<size_t>(
+            read_chunk_file(file_path, chunk_id, data.get(), chunksize_, 0));
+    read = 0;
+    if(static_cast<size_t>(offset) < chunk_size) {
+        read = static_cast<ssize_t>(min(size, chunk_size - offset));
+        memcpy(buf, data.get() + offset, read);
+    }
+    data_cache_->put(file_path, chunk_id, version, std::move(data), chunk_size);
+    return read;
+}
+
 /**
  * @internal
  * Note eventual consistency here: While chunks are removed, there is no lock
@@ -253,9 +1132,15 @@ ChunkStorage::read_chunk(const string& file_path, gkfs::rpc::chnk_id_t chunk_id,
  * is the application's responsibility to stop modifying the file while truncate
  * is executed.
  *
+ * The chunks to remove are taken from the chunk presence index, so that the
+ * chunk directory is only listed if the file's chunks are not indexed yet.
  * If an error is encountered when removing a chunk file, the function will
  * still remove all files and report the error afterwards with
  * ChunkStorageException.
+ *
+ * With the extent layout, all chunks starting with chunk_start are located at
+ * the end of the backing file, which is therefore shrunk to the beginning of
+ * chunk_start if it is larger.
  * @endinternal
  */
 void
@@ -263,22 +1148,53 @@ ChunkStorage::trim_chunk_space(const string& file_path,
                                gkfs::rpc::chnk_id_t chunk_start) {
 
     auto chunk_dir = absolute(get_chunks_dir(file_path));
-    const fs::directory_iterator end;
+    if(checksums_)
+        checksums_->trim(file_path, chunk_start);
+    if(layout_ == ChunkLayout::extent) {
+        struct stat st {};
+        auto new_size = chunk_offset(chunk_start);
+        auto err = 0;
+        if(stat(chunk_dir.c_str(), &st) == -1) {
+            // no chunk of this file was ever written to this daemon
+            if(errno != ENOENT)
+                err = errno;
+        } else if(st.st_size > new_size &&
+                  truncate(chunk_dir.c_str(), new_size) == -1) {
+            err = errno;
+        }
+        // must follow the truncate, see ChunkDataCache
+        if(data_cache_)
+            data_cache_->invalidate_file(file_path, chunk_start);
+        if(err == 0)
+            return;
+        throw ChunkStorageException(
+                err,
+                fmt::format(
+                        "{}() Failed to trim backing file. File: '{}', Error: '{}'",
+                        __func__, chunk_dir, ::strerror(err)));
+    }
+    // the directory is only scanned if the file's chunks are not indexed yet
+    auto chunk_ids = presence_->trim(
+            file_path, chunk_start, [&](ChunkBitmap& bitmap) {
+                scan_chunk_space(file_path, bitmap);
+            });
     auto err_flag = false;
-    for(fs::directory_iterator chunk_file(chunk_dir); chunk_file != end;
-        ++chunk_file) {
-        auto chunk_path = chunk_file->path();
-        auto chunk_id = std::stoul(chunk_path.filename().c_str());
-        if(chunk_id >= chunk_start) {
-            auto err = unlink(chunk_path.c_str());
-            if(err == -1 && errno != ENOENT) {
-                err_flag = true;
-                log_->warn(
-                        "{}() Failed to remove chunk file. File: '{}', Error: '{}'",
-                        __func__, chunk_path.native(), ::strerror(errno));
-            }
+    for(auto chunk_id : chunk_ids) {
+        auto chunk_path = absolute(get_chunk_path(file_path, chunk_id));
+        auto err = unlink(chunk_path.c_str());
+        if(err == -1 && errno != ENOENT) {
+            err_flag = true;
+            log_->warn(
+                    "{}() Failed to remove chunk file. File: '{}', Error: '{}'",
+                    __func__, chunk_path, ::strerror(errno));
+            presence_->add(file_path, chunk_id);
         }
     }
+    // must follow the unlinks, see ChunkFdCache and ChunkDataCache
+    if(fd_cache_)
+        fd_cache_->invalidate_file(file_path, chunk_start);
+    if(data_cache_)
+        data_cache_->invalidate_file(file_path, chunk_start);
     if(err_flag)
         throw ChunkStorageException(
                 EIO,
@@ -287,19 +1203,140 @@ ChunkStorage::trim_chunk_space(const string& file_path,
                         __func__, file_path));
 }
 
+/**
+ * @internal
+ * With the extent layout, the remainder of the chunk within the backing file
+ * is deallocated with fallocate(FALLOC_FL_PUNCH_HOLE), so that it reads as
+ * zeros afterwards. The backing file size is not changed.
+ *
+ * Checksums of blocks beyond the new length are removed and the checksum of
+ * the block containing the new end is recomputed.
+ * @endinternal
+ */
 void
 ChunkStorage::truncate_chunk_file(const string& file_path,
                                   gkfs::rpc::chnk_id_t chunk_id, off_t length) {
-    auto chunk_path = absolute(get_chunk_path(file_path, chunk_id));
     assert(length > 0 &&
            static_cast<gkfs::rpc::chnk_id_t>(length) <= chunksize_);
-    auto ret = truncate(chunk_path.c_str(), length);
-    if(ret == -1) {
-        auto err_str = fmt::format(
-                "Failed to truncate chunk file. File: '{}', Error: '{}'",
-                chunk_path, ::strerror(errno));
-        throw ChunkStorageException(errno, err_str);
+    if(static_cast<size_t>(length) == chunksize_ &&
+       layout_ == ChunkLayout::extent)
+        return;
+    try {
+        truncate_chunk_data(file_path, chunk_id, length);
+    } catch(const ChunkStorageException&) {
+        // a failed truncate may have modified the chunk
+        if(data_cache_)
+            data_cache_->invalidate(file_path, chunk_id);
+        throw;
+    }
+    // must follow the truncate, see ChunkDataCache
+    if(data_cache_)
+        data_cache_->invalidate(file_path, chunk_id);
+}
+
+/**
+ * @internal
+ * The chunk's checksum mutex and direct I/O mutex are taken in the order of
+ * write_chunk(), so that an O_DIRECT read-modify-write of the chunk's last
+ * block cannot write back truncated data.
+ * @endinternal
+ */
+void
+ChunkStorage::truncate_chunk_data(const string& file_path,
+                                  gkfs::rpc::chnk_id_t chunk_id, off_t length) {
+    if(compression_) {
+        auto fh = open_chunk(file_path, chunk_id, false);
+        lock_guard<mutex> lock(compression_mutex(file_path, chunk_id));
+        CompressedChunkHeader header{};
+        if(!read_chunk_header(fh->native(), file_path, chunk_id, header) ||
+           header.raw_size <= static_cast<size_t>(length))
+            return;
+        vector<char> data(length);
+        load_compressed(fh->native(), file_path, chunk_id, header, data.data(),
+                        data.size());
+        store_compressed(fh->native(), file_path, chunk_id, data.data(),
+                         data.size());
+        return;
+    }
+    unique_lock<mutex> checksum_lock;
+    if(checksums_)
+        checksum_lock =
+                unique_lock<mutex>(checksums_->mutex(file_path, chunk_id));
+    unique_lock<mutex> direct_io_lock;
+    if(direct_io_)
+        direct_io_lock =
+                unique_lock<mutex>(direct_io_mutex(file_path, chunk_id));
+    if(layout_ == ChunkLayout::extent) {
+        auto backing_path = absolute(get_chunks_dir(file_path));
+        FileHandle fh(open(backing_path.c_str(), O_WRONLY), backing_path);
+        if(!fh.valid() ||
+           fallocate(fh.native(), FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE,
+                     chunk_offset(chunk_id) + length,
+                     static_cast<off_t>(chunksize_) - length) == -1) {
+            auto err = errno;
+            auto err_str = fmt::format(
+                    "Failed to truncate chunk in backing file. File: '{}', chunk: '{}', Error: '{}'",
+                    backing_path, chunk_id, ::strerror(err));
+            throw ChunkStorageException(err, err_str);
+        }
+    } else {
+        auto chunk_path = absolute(get_chunk_path(file_path, chunk_id));
+        if(fd_cache_)
+            fd_cache_->invalidate(file_path, chunk_id);
+        auto ret = truncate(chunk_path.c_str(), length);
+        if(ret == -1) {
+            auto err_str = fmt::format(
+                    "Failed to truncate chunk file. File: '{}', Error: '{}'",
+                    chunk_path, ::strerror(errno));
+            throw ChunkStorageException(errno, err_str);
+        }
+    }
+    if(!checksums_)
+        return;
+    const size_t bs = checksums_->block_size();
+    auto first_removed = (length + bs - 1) / bs;
+    checksums_->put(file_path, chunk_id, first_removed,
+                    vector<ChecksumEntry>(checksums_->blocks_per_chunk() -
+                                                  first_removed,
+                                          ChecksumEntry{0, 0}));
+    if(length % bs != 0)
+        update_checksums(open_chunk(file_path, chunk_id, false)->native(),
+                         file_path, chunk_id, nullptr, 1, length - 1);
+}
+
+/**
+ * @internal
+ * Group commit: every call takes a ticket of its file's sync group and then
+ * waits for the group's mutex. If a sync that started after the ticket was
+ * taken has completed in the meantime, the call returns right away. Otherwise,
+ * it syncs the file on behalf of all tickets taken so far. Sync groups are
+ * dropped once known_dirs_max files have one, which only costs batching.
+ * @endinternal
+ */
+void
+ChunkStorage::sync_chunk_space(const string& file_path) const {
+    sync_requests_++;
+    shared_ptr<sync_group> group;
+    {
+        lock_guard<mutex> lock(sync_groups_mutex_);
+        auto it = sync_groups_.find(file_path);
+        if(it == sync_groups_.end()) {
+            if(sync_groups_.size() >= gkfs::config::data::known_dirs_max)
+                sync_groups_.clear();
+            it = sync_groups_.emplace(file_path, make_shared<sync_group>())
+                         .first;
+        }
+        group = it->second;
     }
+    auto ticket = ++group->requested;
+    lock_guard<mutex> lock(group->mutex);
+    if(group->completed >= ticket)
+        return;
+    // all writes acknowledged before these tickets were taken are covered
+    auto covered = group->requested.load();
+    sync_ops_++;
+    sync_file(file_path);
+    group->completed = covered;
 }
 
 /**
@@ -330,4 +1367,82 @@ ChunkStorage::chunk_stat() const {
     return {chunksize_, bytes_total / chunksize_, bytes_free / chunksize_};
 }
 
-} // namespace gkfs::data
\ No newline at end of file
+ChunkFdCacheStats
+ChunkStorage::fd_cache_stats() const {
+    if(!fd_cache_)
+        return {};
+    return fd_cache_->stats();
+}
+
+ChunkDataCacheStats
+ChunkStorage::data_cache_stats() const {
+    if(!data_cache_)
+        return {};
+    return data_cache_->stats();
+}
+
+/**
+ * @internal
+ * The chunk is read as a whole under its checksum mutex, so that concurrent
+ * writes cannot cause false mismatches. Missing chunk files are skipped.
+ * @endinternal
+ */
+size_t
+ChunkStorage::scrub_chunk(const string& file_path,
+                          gkfs::rpc::chnk_id_t chunk_id) const {
+    if(!checksums_)
+        return 0;
+    shared_ptr<FileHandle> fh;
+    try {
+        fh = open_chunk(file_path, chunk_id, false);
+    } catch(const ChunkStorageException& e) {
+        if(e.code().value() != ENOENT)
+            throw;
+        return 0;
+    }
+    vector<char> data(chunksize_);
+    lock_guard<mutex> lock(checksums_->mutex(file_path, chunk_id));
+    auto read = read_fd(fh->native(), data.data(), chunksize_,
+                        chunk_offset(chunk_id));
+    if(read < 0) {
+        auto err_str = fmt::format(
+                "{}() Failed to read chunk file. File: '{}', chunk: '{}', Error: '{}'",
+                __func__, file_path, chunk_id, ::strerror(-read));
+        throw ChunkStorageException(static_cast<int>(-read), err_str);
+    }
+    verify_blocks(file_path, chunk_id, data.data(), read, 0,
+                  checksums_->blocks_per_chunk());
+    return read;
+}
+
+vector<string>
+ChunkStorage::checksum_files() const {
+    if(!checksums_)
+        return {};
+    return checksums_->files();
+}
+
+gkfs::rpc::chnk_id_t
+ChunkStorage::checksum_chunk_count(const string& file_path) const {
+    if(!checksums_)
+        return 0;
+    return checksums_->chunk_count(file_path);
+}
+
+ChunkSyncStats
+ChunkStorage::sync_stats() const {
+    return {sync_requests_.load(), sync_ops_.load()};
+}
+
+ChunkChecksumStats
+ChunkStorage::checksum_stats() const {
+    return {verified_blocks_.load(), checksum_mismatches_.load()};
+}
+
+ChunkCompressionStats
+ChunkStorage::compression_stats() const {
+    return {compression_raw_bytes_.load(), compression_stored_bytes_.load(),
+            compression_skipped_.load()};
+}
+
+} // namespace gkfs::data
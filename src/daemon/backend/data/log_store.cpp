@@ -0,0 +1,803 @@
+/*
+  Copyright 2018-2024, Barcelona Supercomputing Center (BSC), Spain
+  Copyright 2015-2024, Johannes Gutenberg Universitaet Mainz, Germany
+
+  This software was partially supported by the
+  EC H2020 funded project NEXTGenIO (Project ID: 671951, www.nextgenio.eu).
+
+  This software was partially supported by the
+  ADA-FS project under the SPPEXA project funded by the DFG.
+
+  This file is part of GekkoFS.
+
+  GekkoFS is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  GekkoFS is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with GekkoFS.  If not, see <https://www.gnu.org/licenses/>.
+
+  SPDX-License-Identifier: GPL-3.0-or-later
+*/
+/**
+ * @brief Log-structured write aggregation in front of the chunk storage.
+ */
+
+#include <daemon/backend/data/data_module.hpp>
+#include <daemon/backend/data/log_store.hpp>
+#include <daemon/backend/data/chunk_checksum.hpp>
+#include <daemon/backend/data/file_handle.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <limits>
+#include <vector>
+
+#include <spdlog/spdlog.h>
+
+extern "C" {
+#include <fcntl.h>
+#include <unistd.h>
+}
+
+namespace fs = std::filesystem;
+using namespace std;
+
+namespace gkfs::data {
+
+namespace {
+
+/**
+ * @brief pwrite() of a full buffer, retrying on interrupts and short writes.
+ * @return 0 on success or errno
+ */
+int
+pwrite_all(int fd, const char* buf, size_t size, off64_t offset) {
+    size_t wrote_total{};
+    while(wrote_total != size) {
+        auto wrote = pwrite64(fd, buf + wrote_total, size - wrote_total,
+                              offset + wrote_total);
+        if(wrote < 0) {
+            if(errno == EINTR || errno == EAGAIN || errno == EWOULDBLOCK)
+                continue;
+            return errno;
+        }
+        wrote_total += wrote;
+    }
+    return 0;
+}
+
+/**
+ * @brief pread() of a full buffer, retrying on interrupts and short reads.
+ * Segment data is never read beyond what was written.
+ * @return 0 on success or errno
+ */
+int
+pread_all(int fd, char* buf, size_t size, off64_t offset) {
+    size_t read_total{};
+    while(read_total != size) {
+        auto read = pread64(fd, buf + read_total, size - read_total,
+                            offset + read_total);
+        if(read < 0) {
+            if(errno == EINTR || errno == EAGAIN || errno == EWOULDBLOCK)
+                continue;
+            return errno;
+        }
+        if(read == 0)
+            return EIO;
+        read_total += read;
+    }
+    return 0;
+}
+
+constexpr uint32_t record_magic = 0x474b4c52; // "GKLR"
+constexpr auto watermark_file = "watermark";
+
+} // namespace
+
+enum class LogStore::record_type : uint32_t {
+    data = 1,  //!< Chunk data following the path
+    punch = 2, //!< Removes the range [offset, offset + len) of a chunk
+    trim = 3   //!< Removes all chunks starting with chunk_id
+};
+
+struct LogStore::record_header {
+    uint32_t magic;    //!< record_magic
+    record_type type;  //!< Type of the record
+    uint64_t seq;      //!< Sequence number, 0 if not committed
+    uint64_t chunk_id; //!< Chunk of the record
+    uint64_t offset;   //!< Chunk offset of the data or removed range
+    uint64_t len;      //!< Length of the data or removed range
+    uint32_t path_len; //!< Length of the path following the header
+    uint32_t crc;      //!< CRC32C of the path and the data
+};
+
+// private functions
+
+LogStore::stripe&
+LogStore::get_stripe(const string& file_path) {
+    return *stripes_[hash<string>{}(file_path) % stripes_.size()];
+}
+
+shared_ptr<LogStore::segment>
+LogStore::new_segment() {
+    auto seg = make_shared<segment>();
+    lock_guard<mutex> lock(segments_mutex_);
+    seg->id = next_segment_id_++;
+    auto seg_path = fmt::format("{}/{}", log_path_, seg->id);
+    auto fd = open(seg_path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0640);
+    if(fd == -1) {
+        auto err = errno;
+        auto err_str = fmt::format(
+                "{}() Failed to create log segment. Path: '{}', Error: '{}'",
+                __func__, seg_path, ::strerror(err));
+        throw ChunkStorageException(err, err_str);
+    }
+    seg->fh = make_shared<FileHandle>(fd, seg_path);
+    segments_.emplace(seg->id, seg);
+    return seg;
+}
+
+pair<shared_ptr<LogStore::segment>, uint64_t>
+LogStore::reserve(const record_header& header, const string& file_path) {
+    auto size = sizeof(header) + file_path.size();
+    auto record_size =
+            size + (header.type == record_type::data ? header.len : 0);
+    vector<char> buf(size);
+    memcpy(buf.data(), &header, sizeof(header));
+    memcpy(buf.data() + sizeof(header), file_path.data(), file_path.size());
+    auto& l = *lanes_[hash<thread::id>{}(this_thread::get_id()) %
+                      lanes_.size()];
+    lock_guard<mutex> lock(l.mutex);
+    if(!l.active || l.active->used + record_size > segment_size_) {
+        if(l.active)
+            l.active->sealed = true;
+        l.active = new_segment();
+    }
+    auto seg = l.active;
+    auto rec_off = seg->used;
+    auto err = pwrite_all(seg->fh->native(), buf.data(), buf.size(), rec_off);
+    if(err != 0) {
+        // records behind a broken header could not be replayed
+        seg->sealed = true;
+        l.active.reset();
+        auto err_str = fmt::format(
+                "{}() Failed to append to log segment '{}'. File: '{}', chunk: '{}', Error: '{}'",
+                __func__, seg->id, file_path, header.chunk_id,
+                ::strerror(err));
+        throw ChunkStorageException(err, err_str);
+    }
+    seg->used += record_size;
+    seg->pending++;
+    return {seg, rec_off};
+}
+
+void
+LogStore::append_tombstone(const string& file_path, record_type type,
+                           gkfs::rpc::chnk_id_t chunk_id, uint64_t offset,
+                           uint64_t len) {
+    record_header header{record_magic,
+                         type,
+                         ++seq_,
+                         chunk_id,
+                         offset,
+                         len,
+                         static_cast<uint32_t>(file_path.size()),
+                         crc32c(0, file_path.data(), file_path.size())};
+    auto [seg, rec_off] = reserve(header, file_path);
+    note_seq(*seg, header.seq);
+    seg->pending--;
+}
+
+void
+LogStore::note_seq(segment& seg, uint64_t seq) {
+    lock_guard<mutex> lock(seg.keys_mutex);
+    seg.max_seq = max(seg.max_seq, seq);
+}
+
+/**
+ * @internal
+ * Records are read per segment until the first incomplete header. Records
+ * without a sequence number were not committed, i.e., their write was not
+ * acknowledged, and are skipped. The remaining records are applied to the
+ * index in sequence order. Replayed segments are sealed and compacted by the
+ * compactor like any other segment.
+ * @endinternal
+ */
+void
+LogStore::recover() {
+    uint64_t watermark = 0;
+    ifstream(fmt::format("{}/{}", log_path_, watermark_file)) >> watermark;
+
+    struct record {
+        record_header header;
+        string path;
+        shared_ptr<segment> seg;
+        uint64_t data_off;
+    };
+    vector<record> records;
+    for(const auto& entry : fs::directory_iterator(log_path_)) {
+        auto name = entry.path().filename().string();
+        if(name.empty() || !all_of(name.begin(), name.end(), ::isdigit))
+            continue;
+        auto seg_path = entry.path().string();
+        auto fd = open(seg_path.c_str(), O_RDWR);
+        if(fd == -1) {
+            auto err = errno;
+            auto err_str = fmt::format(
+                    "{}() Failed to open log segment. Path: '{}', Error: '{}'",
+                    __func__, seg_path, ::strerror(err));
+            throw ChunkStorageException(err, err_str);
+        }
+        auto seg = make_shared<segment>();
+        seg->id = stoull(name);
+        seg->fh = make_shared<FileHandle>(fd, seg_path);
+        seg->used = fs::file_size(entry.path());
+        seg->sealed = true;
+        next_segment_id_ = max(next_segment_id_, seg->id + 1);
+        segments_.emplace(seg->id, seg);
+
+        uint64_t rec_off = 0;
+        vector<char> data;
+        while(rec_off + sizeof(record_header) <= seg->used) {
+            record r{{}, {}, seg, 0};
+            auto& h = r.header;
+            if(pread_all(fd, reinterpret_cast<char*>(&h), sizeof(h),
+                         rec_off) != 0 ||
+               h.magic != record_magic)
+                break;
+            auto data_len = h.type == record_type::data ? h.len : 0;
+            r.data_off = rec_off + sizeof(h) + h.path_len;
+            if(r.data_off + data_len > seg->used)
+                break;
+            rec_off = r.data_off + data_len;
+            if(h.seq == 0)
+                continue;
+            note_seq(*seg, h.seq);
+            if(h.seq <= watermark)
+                continue;
+            r.path.resize(h.path_len);
+            data.resize(data_len);
+            if(pread_all(fd, r.path.data(), h.path_len,
+                         r.data_off - h.path_len) != 0 ||
+               pread_all(fd, data.data(), data_len, r.data_off) != 0 ||
+               crc32c(crc32c(0, r.path.data(), r.path.size()), data.data(),
+                      data.size()) != h.crc) {
+                GKFS_DATA_MOD->log()->warn(
+                        "{}() Skipping corrupt record '{}' of log segment '{}'",
+                        __func__, h.seq, seg->id);
+                continue;
+            }
+            records.emplace_back(std::move(r));
+        }
+    }
+
+    sort(records.begin(), records.end(), [](const auto& a, const auto& b) {
+        return a.header.seq < b.header.seq;
+    });
+    uint64_t seq = watermark;
+    for(const auto& r : records) {
+        const auto& h = r.header;
+        seq = h.seq;
+        auto& files = get_stripe(r.path).files;
+        switch(h.type) {
+            case record_type::data: {
+                auto& extents = files[r.path][h.chunk_id];
+                punch(extents, h.offset, h.offset + h.len);
+                extents.emplace(h.offset,
+                                extent{h.len, r.seg.get(), r.data_off, h.seq});
+                r.seg->live += h.len;
+                live_bytes_ += h.len;
+                r.seg->keys.emplace(r.path, h.chunk_id);
+                break;
+            }
+            case record_type::punch: {
+                auto file_it = files.find(r.path);
+                if(file_it == files.end())
+                    break;
+                auto chunk_it = file_it->second.find(h.chunk_id);
+                if(chunk_it != file_it->second.end())
+                    punch(chunk_it->second, h.offset, h.offset + h.len);
+                break;
+            }
+            case record_type::trim: {
+                auto file_it = files.find(r.path);
+                if(file_it == files.end())
+                    break;
+                auto& chunks = file_it->second;
+                for(auto it = chunks.lower_bound(h.chunk_id);
+                    it != chunks.end();) {
+                    drop(it->second);
+                    it = chunks.erase(it);
+                }
+                break;
+            }
+        }
+    }
+    seq_ = max(seq, watermark);
+    watermark_ = watermark;
+    if(!segments_.empty())
+        GKFS_DATA_MOD->log()->info(
+                "{}() Replayed '{}' records with '{}' bytes from '{}' log segments",
+                __func__, records.size(), live_bytes_.load(),
+                segments_.size());
+}
+
+int
+LogStore::persist_watermark(uint64_t watermark) {
+    auto path = fmt::format("{}/{}", log_path_, watermark_file);
+    auto tmp_path = path + ".tmp";
+    auto fd = open(tmp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0640);
+    if(fd == -1)
+        return errno;
+    auto str = to_string(watermark);
+    auto err = pwrite_all(fd, str.data(), str.size(), 0);
+    close(fd);
+    if(err == 0 && rename(tmp_path.c_str(), path.c_str()) == -1)
+        err = errno;
+    return err;
+}
+
+void
+LogStore::punch(chunk_extents& extents, uint64_t off, uint64_t end) {
+    // start with the extent that may reach into the range from the left
+    auto it = extents.upper_bound(off);
+    if(it != extents.begin())
+        --it;
+    while(it != extents.end() && it->first < end) {
+        auto ext_off = it->first;
+        auto ext = it->second;
+        auto ext_end = ext_off + ext.len;
+        if(ext_end <= off) {
+            ++it;
+            continue;
+        }
+        it = extents.erase(it);
+        // keep the parts left and right of the range
+        if(ext_off < off)
+            extents.emplace(ext_off, extent{off - ext_off, ext.seg,
+                                            ext.seg_off, ext.seq});
+        if(ext_end > end) {
+            it = extents
+                         .emplace(end, extent{ext_end - end, ext.seg,
+                                              ext.seg_off + (end - ext_off),
+                                              ext.seq})
+                         .first;
+            ++it;
+        }
+        auto removed = min(ext_end, end) - max(ext_off, off);
+        ext.seg->live -= removed;
+        live_bytes_ -= removed;
+    }
+}
+
+void
+LogStore::drop(chunk_extents& extents) {
+    for(const auto& [off, ext] : extents) {
+        ext.seg->live -= ext.len;
+        live_bytes_ -= ext.len;
+    }
+    extents.clear();
+}
+
+void
+LogStore::compact_chunk(const string& file_path, gkfs::rpc::chnk_id_t chunk_id,
+                        chunk_extents& extents) {
+    vector<char> buf;
+    for(const auto& [off, ext] : extents) {
+        buf.resize(ext.len);
+        auto err = pread_all(ext.seg->fh->native(), buf.data(), ext.len,
+                             ext.seg_off);
+        if(err != 0) {
+            auto err_str = fmt::format(
+                    "{}() Failed to read log segment '{}'. File: '{}', chunk: '{}', Error: '{}'",
+                    __func__, ext.seg->id, file_path, chunk_id,
+                    ::strerror(err));
+            throw ChunkStorageException(err, err_str);
+        }
+        storage_->write_chunk(file_path, chunk_id, buf.data(), ext.len, off);
+        compacted_bytes_ += ext.len;
+    }
+    drop(extents);
+}
+
+/**
+ * @internal
+ * Chunks are compacted as a whole, including extents in other segments, so
+ * that older data in the log never overwrites newer data in the chunk file.
+ * A segment that fails to compact is kept and retried in the next round.
+ *
+ * The watermark is taken before the index is scanned for its oldest extent.
+ * Records committed later have a larger sequence number, and records committed
+ * before are in the index unless they were compacted or replaced.
+ * @endinternal
+ */
+void
+LogStore::compact() {
+    for(auto& l : lanes_) {
+        lock_guard<mutex> lock(l->mutex);
+        if(l->active && l->active->used > 0) {
+            l->active->sealed = true;
+            l->active.reset();
+        }
+    }
+    vector<shared_ptr<segment>> sealed;
+    {
+        lock_guard<mutex> lock(segments_mutex_);
+        for(const auto& [id, seg] : segments_) {
+            if(seg->sealed && seg->pending == 0)
+                sealed.emplace_back(seg);
+        }
+    }
+    for(auto& seg : sealed) {
+        set<pair<string, gkfs::rpc::chnk_id_t>> keys;
+        {
+            lock_guard<mutex> lock(seg->keys_mutex);
+            keys.swap(seg->keys);
+        }
+        for(const auto& key : keys) {
+            auto& s = get_stripe(key.first);
+            lock_guard<mutex> lock(s.mutex);
+            auto file_it = s.files.find(key.first);
+            if(file_it == s.files.end())
+                continue;
+            auto chunk_it = file_it->second.find(key.second);
+            if(chunk_it == file_it->second.end())
+                continue;
+            try {
+                compact_chunk(key.first, key.second, chunk_it->second);
+            } catch(const ChunkStorageException& e) {
+                GKFS_DATA_MOD->log()->error("{}() {}", __func__, e.what());
+                lock_guard<mutex> keys_lock(seg->keys_mutex);
+                seg->keys.emplace(key);
+                continue;
+            }
+            file_it->second.erase(chunk_it);
+            if(file_it->second.empty())
+                s.files.erase(file_it);
+        }
+    }
+
+    auto watermark = seq_.load();
+    for(auto& s : stripes_) {
+        lock_guard<mutex> lock(s->mutex);
+        for(const auto& [path, chunks] : s->files)
+            for(const auto& [chunk_id, extents] : chunks)
+                for(const auto& [off, ext] : extents)
+                    watermark = min(watermark, ext.seq - 1);
+    }
+    if(watermark > watermark_) {
+        auto err = persist_watermark(watermark);
+        if(err == 0)
+            watermark_ = watermark;
+        else
+            GKFS_DATA_MOD->log()->error(
+                    "{}() Failed to persist log watermark. Error: '{}'",
+                    __func__, ::strerror(err));
+    }
+
+    for(auto& seg : sealed) {
+        if(seg->live != 0)
+            continue;
+        {
+            lock_guard<mutex> lock(seg->keys_mutex);
+            // replay still needs its records
+            if(seg->max_seq > watermark_)
+                continue;
+        }
+        {
+            lock_guard<mutex> lock(segments_mutex_);
+            segments_.erase(seg->id);
+        }
+        auto seg_path = fmt::format("{}/{}", log_path_, seg->id);
+        if(unlink(seg_path.c_str()) == -1)
+            GKFS_DATA_MOD->log()->warn(
+                    "{}() Failed to remove log segment '{}'. Error: '{}'",
+                    __func__, seg_path, ::strerror(errno));
+    }
+}
+
+void
+LogStore::compactor_loop() {
+    unique_lock<mutex> lock(compactor_mutex_);
+    while(running_) {
+        compactor_cv_.wait_for(lock,
+                               chrono::milliseconds(compact_interval_ms_));
+        if(!running_)
+            break;
+        lock.unlock();
+        compact();
+        lock.lock();
+    }
+}
+
+// public functions
+
+LogStore::LogStore(shared_ptr<ChunkStorage> storage, const string& log_path,
+                   size_t segment_size, size_t max_write_size,
+                   unsigned int lanes, unsigned int compact_interval_ms)
+    : storage_(std::move(storage)), log_path_(log_path),
+      segment_size_(segment_size),
+      max_write_size_(min(max_write_size, segment_size)),
+      compact_interval_ms_(compact_interval_ms) {
+    assert(storage_);
+    lanes = max(lanes, 1u);
+    for(unsigned int i = 0; i < lanes; i++) {
+        lanes_.emplace_back(make_unique<lane>());
+        stripes_.emplace_back(make_unique<stripe>());
+    }
+    try {
+        fs::create_directories(log_path_);
+        recover();
+    } catch(const fs::filesystem_error& e) {
+        auto err_str = fmt::format(
+                "{}() Failed to recover log directory. Path: '{}', Error: '{}'",
+                __func__, log_path_, e.what());
+        throw ChunkStorageException(e.code().value(), err_str);
+    }
+    // move replayed data to the chunk files before serving requests
+    compact();
+    compactor_ = thread(&LogStore::compactor_loop, this);
+    GKFS_DATA_MOD->log()->debug(
+            "{}() Write log initialized with path: '{}' segment size: '{}' max write size: '{}' lanes: '{}'",
+            __func__, log_path_, segment_size_, max_write_size_, lanes);
+}
+
+LogStore::~LogStore() {
+    {
+        lock_guard<mutex> lock(compactor_mutex_);
+        running_ = false;
+    }
+    compactor_cv_.notify_all();
+    if(compactor_.joinable())
+        compactor_.join();
+    compact();
+    if(live_bytes_ != 0)
+        GKFS_DATA_MOD->log()->error(
+                "{}() '{}' bytes could not be moved from the write log to the chunk files",
+                __func__, live_bytes_.load());
+}
+
+/**
+ * @internal
+ * A log append reserves space in the lane's active segment and registers as
+ * pending writer under the lane's mutex. The data is written and committed
+ * without holding the lane's mutex. The compactor only takes sealed segments
+ * without pending writers, so it never misses an extent of a segment.
+ * @endinternal
+ */
+ssize_t
+LogStore::write_chunk(const string& file_path, gkfs::rpc::chnk_id_t chunk_id,
+                      const char* buf, size_t size, off64_t offset) {
+    if(size == 0)
+        return 0;
+    auto& s = get_stripe(file_path);
+    if(size > max_write_size_) {
+        lock_guard<mutex> lock(s.mutex);
+        auto ret = storage_->write_chunk(file_path, chunk_id, buf, size,
+                                         offset);
+        auto file_it = s.files.find(file_path);
+        if(file_it != s.files.end()) {
+            auto chunk_it = file_it->second.find(chunk_id);
+            if(chunk_it != file_it->second.end())
+                punch(chunk_it->second, offset, offset + size);
+        }
+        // older records of the range must not be replayed over the chunk file
+        append_tombstone(file_path, record_type::punch, chunk_id, offset,
+                         size);
+        return ret;
+    }
+
+    record_header header{record_magic,
+                         record_type::data,
+                         0,
+                         chunk_id,
+                         static_cast<uint64_t>(offset),
+                         size,
+                         static_cast<uint32_t>(file_path.size()),
+                         crc32c(crc32c(0, file_path.data(), file_path.size()),
+                                buf, size)};
+    auto [seg, rec_off] = reserve(header, file_path);
+    auto seg_off = rec_off + sizeof(header) + file_path.size();
+    auto err = pwrite_all(seg->fh->native(), buf, size, seg_off);
+    if(err != 0) {
+        seg->pending--;
+        auto err_str = fmt::format(
+                "{}() Failed to append to log segment '{}'. File: '{}', chunk: '{}', size: '{}', offset: '{}', Error: '{}'",
+                __func__, seg->id, file_path, chunk_id, size, offset,
+                ::strerror(err));
+        throw ChunkStorageException(err, err_str);
+    }
+    {
+        lock_guard<mutex> lock(s.mutex);
+        auto seq = ++seq_;
+        err = pwrite_all(seg->fh->native(), reinterpret_cast<char*>(&seq),
+                         sizeof(seq),
+                         rec_off + offsetof(record_header, seq));
+        if(err != 0) {
+            seg->pending--;
+            auto err_str = fmt::format(
+                    "{}() Failed to commit log record in segment '{}'. File: '{}', chunk: '{}', Error: '{}'",
+                    __func__, seg->id, file_path, chunk_id, ::strerror(err));
+            throw ChunkStorageException(err, err_str);
+        }
+        auto& extents = s.files[file_path][chunk_id];
+        punch(extents, offset, offset + size);
+        extents.emplace(offset, extent{size, seg.get(), seg_off, seq});
+        seg->live += size;
+        live_bytes_ += size;
+        lock_guard<mutex> keys_lock(seg->keys_mutex);
+        seg->keys.emplace(file_path, chunk_id);
+        seg->max_seq = max(seg->max_seq, seq);
+    }
+    appended_bytes_ += size;
+    seg->pending--;
+    return static_cast<ssize_t>(size);
+}
+
+/**
+ * @internal
+ * The returned size follows the chunk file semantics: data ends with the last
+ * byte of either the chunk file or the log. Holes in between read as zeros.
+ * @endinternal
+ */
+ssize_t
+LogStore::read_chunk(const string& file_path, gkfs::rpc::chnk_id_t chunk_id,
+                     char* buf, size_t size, off64_t offset) {
+    auto& s = get_stripe(file_path);
+    lock_guard<mutex> lock(s.mutex);
+    const chunk_extents* extents = nullptr;
+    auto file_it = s.files.find(file_path);
+    if(file_it != s.files.end()) {
+        auto chunk_it = file_it->second.find(chunk_id);
+        if(chunk_it != file_it->second.end() && !chunk_it->second.empty())
+            extents = &chunk_it->second;
+    }
+    if(!extents)
+        return storage_->read_chunk(file_path, chunk_id, buf, size, offset);
+
+    // 0 if the chunk only exists in the log
+    size_t read = storage_->read_chunk(file_path, chunk_id, buf, size, offset);
+    uint64_t off = offset;
+    uint64_t end = off + size;
+    auto last = prev(extents->end());
+    auto data_end = last->first + last->second.len;
+    if(data_end > off) {
+        auto log_read = min<uint64_t>(data_end, end) - off;
+        if(log_read > read) {
+            memset(buf + read, 0, log_read - read);
+            read = log_read;
+        }
+    }
+    // overlay all extents that intersect [off, end)
+    auto it = extents->upper_bound(off);
+    if(it != extents->begin())
+        --it;
+    for(; it != extents->end() && it->first < end; ++it) {
+        auto ext_off = it->first;
+        const auto& ext = it->second;
+        auto from = max(ext_off, off);
+        auto to = min(ext_off + ext.len, end);
+        if(from >= to)
+            continue;
+        auto err = pread_all(ext.seg->fh->native(), buf + (from - off),
+                             to - from, ext.seg_off + (from - ext_off));
+        if(err != 0) {
+            auto err_str = fmt::format(
+                    "{}() Failed to read log segment '{}'. File: '{}', chunk: '{}', Error: '{}'",
+                    __func__, ext.seg->id, file_path, chunk_id,
+                    ::strerror(err));
+            throw ChunkStorageException(err, err_str);
+        }
+    }
+    return static_cast<ssize_t>(read);
+}
+
+void
+LogStore::destroy_chunk_space(const string& file_path) {
+    auto& s = get_stripe(file_path);
+    lock_guard<mutex> lock(s.mutex);
+    auto file_it = s.files.find(file_path);
+    if(file_it != s.files.end()) {
+        for(auto& [chunk_id, extents] : file_it->second)
+            drop(extents);
+        s.files.erase(file_it);
+    }
+    append_tombstone(file_path, record_type::trim, 0, 0, 0);
+    storage_->destroy_chunk_space(file_path);
+}
+
+void
+LogStore::trim_chunk_space(const string& file_path,
+                           gkfs::rpc::chnk_id_t chunk_start) {
+    auto& s = get_stripe(file_path);
+    lock_guard<mutex> lock(s.mutex);
+    auto file_it = s.files.find(file_path);
+    if(file_it != s.files.end()) {
+        auto& chunks = file_it->second;
+        for(auto it = chunks.lower_bound(chunk_start); it != chunks.end();) {
+            drop(it->second);
+            it = chunks.erase(it);
+        }
+        if(chunks.empty())
+            s.files.erase(file_it);
+    }
+    append_tombstone(file_path, record_type::trim, chunk_start, 0, 0);
+    storage_->trim_chunk_space(file_path, chunk_start);
+}
+
+void
+LogStore::truncate_chunk_file(const string& file_path,
+                              gkfs::rpc::chnk_id_t chunk_id, off_t length) {
+    auto& s = get_stripe(file_path);
+    lock_guard<mutex> lock(s.mutex);
+    bool had_extents = false;
+    auto file_it = s.files.find(file_path);
+    if(file_it != s.files.end()) {
+        auto chunk_it = file_it->second.find(chunk_id);
+        if(chunk_it != file_it->second.end()) {
+            had_extents = !chunk_it->second.empty();
+            punch(chunk_it->second, length, numeric_limits<uint64_t>::max());
+        }
+    }
+    append_tombstone(file_path, record_type::punch, chunk_id, length,
+                     numeric_limits<uint64_t>::max() - length);
+    try {
+        storage_->truncate_chunk_file(file_path, chunk_id, length);
+    } catch(const ChunkStorageException& e) {
+        // the chunk may only exist in the log
+        if(!had_extents || e.code().value() != ENOENT)
+            throw;
+    }
+}
+
+/**
+ * @internal
+ * Segments are not synced. A flush therefore moves all extents of the file to
+ * its chunk files before syncing them.
+ * @endinternal
+ */
+void
+LogStore::sync_chunk_space(const string& file_path) {
+    {
+        auto& s = get_stripe(file_path);
+        lock_guard<mutex> lock(s.mutex);
+        auto file_it = s.files.find(file_path);
+        if(file_it != s.files.end()) {
+            auto& chunks = file_it->second;
+            for(auto it = chunks.begin(); it != chunks.end();) {
+                compact_chunk(file_path, it->first, it->second);
+                it = chunks.erase(it);
+            }
+            s.files.erase(file_it);
+        }
+    }
+    storage_->sync_chunk_space(file_path);
+}
+
+LogStoreStats
+LogStore::stats() {
+    size_t segments;
+    {
+        lock_guard<mutex> lock(segments_mutex_);
+        segments = segments_.size();
+    }
+    return {appended_bytes_.load(), compacted_bytes_.load(),
+            live_bytes_.load(), segments};
+}
+
+} // namespace gkfs::data
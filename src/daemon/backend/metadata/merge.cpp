@@ -211,6 +211,12 @@ MetadataMergeOperator::FullMergeV2(const MergeOperationInput& merge_in,
     }
 
     md.size(fsize);
+    // inline data always spans the whole file, e.g., it is cut by truncate
+    if(!md.inline_data().empty()) {
+        auto data = md.inline_data();
+        data.resize(fsize);
+        md.inline_data(data);
+    }
     merge_out->new_value = md.serialize();
     return true;
 }
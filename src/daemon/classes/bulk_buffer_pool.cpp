@@ -0,0 +1,215 @@
+/*
+  Copyright 2018-2024, Barcelona Supercomputing Center (BSC), Spain
+  Copyright 2015-2024, Johannes Gutenberg Universitaet Mainz, Germany
+
+  This software was partially supported by the
+  EC H2020 funded project NEXTGenIO (Project ID: 671951, www.nextgenio.eu).
+
+  This software was partially supported by the
+  ADA-FS project under the SPPEXA project funded by the DFG.
+
+  This file is part of GekkoFS.
+
+  GekkoFS is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  GekkoFS is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with GekkoFS.  If not, see <https://www.gnu.org/licenses/>.
+
+  SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include <daemon/classes/bulk_buffer_pool.hpp>
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <sstream>
+#include <stdexcept>
+
+extern "C" {
+#include <unistd.h>
+}
+
+using namespace std;
+
+namespace gkfs::daemon {
+
+BulkBufferPool::Lease::Lease(Lease&& rhs) noexcept
+    : pool_(std::move(rhs.pool_)), tier_(rhs.tier_), region_(rhs.region_),
+      buf_(rhs.buf_), handle_(rhs.handle_) {
+    rhs.pool_ = nullptr;
+}
+
+BulkBufferPool::Lease&
+BulkBufferPool::Lease::operator=(Lease&& rhs) noexcept {
+    if(this != &rhs) {
+        if(pool_)
+            pool_->release(tier_, region_);
+        pool_ = std::move(rhs.pool_);
+        rhs.pool_ = nullptr;
+        tier_ = rhs.tier_;
+        region_ = rhs.region_;
+        buf_ = rhs.buf_;
+        handle_ = rhs.handle_;
+    }
+    return *this;
+}
+
+BulkBufferPool::Lease::~Lease() {
+    if(pool_)
+        pool_->release(tier_, region_);
+}
+
+BulkBufferPool::BulkBufferPool(margo_instance_id mid,
+                               const vector<pair<size_t, size_t>>& tiers)
+    : mid_(mid) {
+    auto sorted = tiers;
+    sort(sorted.begin(), sorted.end());
+    const auto page_size = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+    try {
+        for(const auto& [size, count] : sorted) {
+            if(size == 0 || count == 0)
+                continue;
+            // added before it is filled so that the cleanup below also
+            // releases the buffers of a partially filled tier
+            auto& t = tiers_.emplace_back(tier{size, {}, {}});
+            t.regions.reserve(count);
+            t.free.reserve(count);
+            for(size_t i = 0; i < count; i++) {
+                // page-aligned for registration with the network
+                auto alloc_size = ((size + page_size - 1) / page_size) *
+                                  page_size;
+                auto* buf = ::aligned_alloc(page_size, alloc_size);
+                if(!buf) {
+                    throw runtime_error(fmt::format(
+                            "Failed to allocate bulk buffer of size {}", size));
+                }
+                hg_size_t buf_size = size;
+                hg_bulk_t handle = HG_BULK_NULL;
+                auto ret = margo_bulk_create(mid_, 1, &buf, &buf_size,
+                                             HG_BULK_READWRITE, &handle);
+                if(ret != HG_SUCCESS) {
+                    ::free(buf);
+                    throw runtime_error(fmt::format(
+                            "Failed to register bulk buffer of size {}", size));
+                }
+                t.free.push_back(t.regions.size());
+                t.regions.push_back({buf, handle});
+            }
+            capacity_ += count;
+        }
+    } catch(...) {
+        for(auto& t : tiers_) {
+            for(auto& r : t.regions) {
+                margo_bulk_free(r.handle);
+                ::free(r.buf);
+            }
+        }
+        throw;
+    }
+}
+
+BulkBufferPool::~BulkBufferPool() {
+    for(auto& t : tiers_) {
+        for(auto& r : t.regions) {
+            margo_bulk_free(r.handle);
+            ::free(r.buf);
+        }
+    }
+}
+
+void
+BulkBufferPool::release(size_t tier_idx, size_t region_idx) {
+    lock_guard<mutex> lock(mutex_);
+    tiers_[tier_idx].free.push_back(region_idx);
+    in_use_--;
+}
+
+BulkBufferPool::Lease
+BulkBufferPool::acquire(size_t size) {
+    Lease lease{};
+    {
+        lock_guard<mutex> lock(mutex_);
+        for(size_t i = 0; i < tiers_.size(); i++) {
+            auto& t = tiers_[i];
+            if(t.size < size || t.free.empty())
+                continue;
+            auto region_idx = t.free.back();
+            t.free.pop_back();
+            lease.tier_ = i;
+            lease.region_ = region_idx;
+            lease.buf_ = t.regions[region_idx].buf;
+            lease.handle_ = t.regions[region_idx].handle;
+            in_use_++;
+            break;
+        }
+    }
+    if(lease.buf_)
+        lease.pool_ = shared_from_this();
+    else
+        fallbacks_++;
+    return lease;
+}
+
+vector<pair<size_t, size_t>>
+BulkBufferPool::parse_tiers(const string& spec, size_t chunksize) {
+    vector<pair<size_t, size_t>> tiers{};
+    if(spec.empty() || spec == "0")
+        return tiers;
+    stringstream ss(spec);
+    string item;
+    while(getline(ss, item, ',')) {
+        auto sep = item.find(':');
+        if(sep == string::npos) {
+            throw invalid_argument(fmt::format(
+                    "Bulk pool tier '{}' must be of the form <chunks>:<count>",
+                    item));
+        }
+        auto chunks = stoul(item.substr(0, sep));
+        auto count = stoul(item.substr(sep + 1));
+        if(chunks == 0 || count == 0) {
+            throw invalid_argument(fmt::format(
+                    "Bulk pool tier '{}' must have a non-zero size and count",
+                    item));
+        }
+        tiers.emplace_back(chunks * chunksize, count);
+    }
+    return tiers;
+}
+
+vector<pair<void*, size_t>>
+BulkBufferPool::buffers() const {
+    vector<pair<void*, size_t>> buffers{};
+    buffers.reserve(capacity_);
+    for(const auto& t : tiers_) {
+        for(const auto& r : t.regions)
+            buffers.emplace_back(r.buf, t.size);
+    }
+    return buffers;
+}
+
+uint64_t
+BulkBufferPool::in_use() const {
+    return in_use_.load();
+}
+
+uint64_t
+BulkBufferPool::capacity() const {
+    return capacity_;
+}
+
+uint64_t
+BulkBufferPool::fallbacks() const {
+    return fallbacks_.load();
+}
+
+} // namespace gkfs::daemon
@@ -70,6 +70,166 @@ FsData::storage(const std::shared_ptr<gkfs::data::ChunkStorage>& storage) {
     storage_ = storage;
 }
 
+const std::shared_ptr<gkfs::data::LogStore>&
+FsData::log_store() const {
+    return log_store_;
+}
+
+void
+FsData::log_store(const std::shared_ptr<gkfs::data::LogStore>& log_store) {
+    log_store_ = log_store;
+}
+
+bool
+FsData::enable_write_log() const {
+    return enable_write_log_;
+}
+
+void
+FsData::enable_write_log(bool enable_write_log) {
+    FsData::enable_write_log_ = enable_write_log;
+}
+
+size_t
+FsData::fd_cache_size() const {
+    return fd_cache_size_;
+}
+
+void
+FsData::fd_cache_size(size_t fd_cache_size) {
+    FsData::fd_cache_size_ = fd_cache_size;
+}
+
+size_t
+FsData::chunk_cache_size() const {
+    return chunk_cache_size_;
+}
+
+void
+FsData::chunk_cache_size(size_t chunk_cache_size) {
+    FsData::chunk_cache_size_ = chunk_cache_size;
+}
+
+const std::string&
+FsData::data_layout() const {
+    return data_layout_;
+}
+
+void
+FsData::data_layout(const std::string& data_layout) {
+    FsData::data_layout_ = data_layout;
+}
+
+bool
+FsData::direct_io() const {
+    return direct_io_;
+}
+
+void
+FsData::direct_io(bool direct_io) {
+    FsData::direct_io_ = direct_io;
+}
+
+const std::string&
+FsData::durability() const {
+    return durability_;
+}
+
+void
+FsData::durability(const std::string& durability) {
+    FsData::durability_ = durability;
+}
+
+const std::string&
+FsData::compression() const {
+    return compression_;
+}
+
+void
+FsData::compression(const std::string& compression) {
+    FsData::compression_ = compression;
+}
+
+bool
+FsData::checksums() const {
+    return checksums_;
+}
+
+void
+FsData::checksums(bool checksums) {
+    FsData::checksums_ = checksums;
+}
+
+bool
+FsData::verify_reads() const {
+    return verify_reads_;
+}
+
+void
+FsData::verify_reads(bool verify_reads) {
+    FsData::verify_reads_ = verify_reads;
+}
+
+size_t
+FsData::scrub_rate() const {
+    return scrub_rate_;
+}
+
+void
+FsData::scrub_rate(size_t scrub_rate) {
+    FsData::scrub_rate_ = scrub_rate;
+}
+
+const std::shared_ptr<gkfs::data::ChunkScrubber>&
+FsData::scrubber() const {
+    return scrubber_;
+}
+
+void
+FsData::scrubber(const std::shared_ptr<gkfs::data::ChunkScrubber>& scrubber) {
+    scrubber_ = scrubber;
+}
+
+const std::string&
+FsData::io_engine() const {
+    return io_engine_;
+}
+
+void
+FsData::io_engine(const std::string& io_engine) {
+    FsData::io_engine_ = io_engine;
+}
+
+size_t
+FsData::pull_window() const {
+    return pull_window_;
+}
+
+void
+FsData::pull_window(size_t pull_window) {
+    FsData::pull_window_ = pull_window;
+}
+
+size_t
+FsData::push_window() const {
+    return push_window_;
+}
+
+void
+FsData::push_window(size_t push_window) {
+    FsData::push_window_ = push_window;
+}
+
+const std::string&
+FsData::bulk_pool_tiers() const {
+    return bulk_pool_tiers_;
+}
+
+void
+FsData::bulk_pool_tiers(const std::string& bulk_pool_tiers) {
+    FsData::bulk_pool_tiers_ = bulk_pool_tiers;
+}
+
 const std::string&
 FsData::rootdir() const {
     return rootdir_;
@@ -221,6 +381,46 @@ FsData::parallax_size_md(unsigned int size_md) {
             size_md * 1024ull * 1024ull * 1024ull);
 }
 
+size_t
+FsData::inline_data_size() const {
+    return inline_data_size_;
+}
+
+void
+FsData::inline_data_size(size_t inline_data_size) {
+    FsData::inline_data_size_ = inline_data_size;
+}
+
+size_t
+FsData::chunksize() const {
+    return chunksize_;
+}
+
+void
+FsData::chunksize(size_t chunksize) {
+    FsData::chunksize_ = chunksize;
+}
+
+unsigned int
+FsData::ec_data_shards() const {
+    return ec_data_shards_;
+}
+
+void
+FsData::ec_data_shards(unsigned int ec_data_shards) {
+    FsData::ec_data_shards_ = ec_data_shards;
+}
+
+unsigned int
+FsData::ec_parity_shards() const {
+    return ec_parity_shards_;
+}
+
+void
+FsData::ec_parity_shards(unsigned int ec_parity_shards) {
+    FsData::ec_parity_shards_ = ec_parity_shards;
+}
+
 const std::shared_ptr<gkfs::utils::Stats>&
 FsData::stats() const {
     return stats_;
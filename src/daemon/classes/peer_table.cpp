@@ -0,0 +1,112 @@
+/*
+  Copyright 2018-2024, Barcelona Supercomputing Center (BSC), Spain
+  Copyright 2015-2024, Johannes Gutenberg Universitaet Mainz, Germany
+
+  This software was partially supported by the
+  EC H2020 funded project NEXTGenIO (Project ID: 671951, www.nextgenio.eu).
+
+  This software was partially supported by the
+  ADA-FS project under the SPPEXA project funded by the DFG.
+
+  This file is part of GekkoFS.
+
+  GekkoFS is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  GekkoFS is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with GekkoFS.  If not, see <https://www.gnu.org/licenses/>.
+
+  SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include <daemon/classes/peer_table.hpp>
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <utility>
+
+using namespace std;
+
+namespace gkfs::daemon {
+
+PeerTable::PeerTable(margo_instance_id mid, std::string hosts_file)
+    : mid_(mid), hosts_file_(std::move(hosts_file)) {}
+
+PeerTable::~PeerTable() {
+    for(auto& [uri, addr] : addrs_)
+        margo_addr_free(mid_, addr);
+}
+
+void
+PeerTable::load() {
+    ifstream lf(hosts_file_);
+    if(!lf) {
+        throw runtime_error(fmt::format("Failed to open hosts file '{}'",
+                                        hosts_file_));
+    }
+    vector<pair<string, string>> hosts;
+    string line;
+    while(getline(lf, line)) {
+        istringstream ls(line);
+        string host;
+        string uri;
+        string rest;
+        if(!(ls >> host >> uri) || ls >> rest) {
+            throw runtime_error(fmt::format(
+                    "Unrecognized line format in hosts file: '{}'", line));
+        }
+        hosts.emplace_back(std::move(host), std::move(uri));
+    }
+    // same order as in the client (see load_hostfile()), which includes the
+    // rootdir suffix of the host name
+    std::sort(hosts.begin(), hosts.end());
+    uris_.clear();
+    for(auto& h : hosts)
+        uris_.emplace_back(std::move(h.second));
+}
+
+hg_addr_t
+PeerTable::addr(uint64_t host_id, uint64_t host_size) {
+    string uri;
+    {
+        lock_guard<mutex> lock(mutex_);
+        // the hosts file may have been read before all daemons registered
+        if(uris_.size() != host_size)
+            load();
+        if(uris_.size() != host_size || host_id >= host_size) {
+            throw runtime_error(fmt::format(
+                    "Daemon {} of {} not found in hosts file with {} daemons",
+                    host_id, host_size, uris_.size()));
+        }
+        uri = uris_[host_id];
+        auto it = addrs_.find(uri);
+        if(it != addrs_.end())
+            return it->second;
+    }
+    // the lookup may block and is done without holding the lock
+    hg_addr_t addr = HG_ADDR_NULL;
+    auto ret = margo_addr_lookup(mid_, uri.c_str(), &addr);
+    if(ret != HG_SUCCESS) {
+        throw runtime_error(fmt::format(
+                "Failed to look up daemon address '{}' err '{}'", uri, ret));
+    }
+    lock_guard<mutex> lock(mutex_);
+    auto [it, inserted] = addrs_.emplace(uri, addr);
+    // another request looked up the same daemon concurrently
+    if(!inserted)
+        margo_addr_free(mid_, addr);
+    return it->second;
+}
+
+} // namespace gkfs::daemon
@@ -66,6 +66,17 @@ RPCData::io_streams(const vector<ABT_xstream>& io_streams) {
     RPCData::io_streams_ = io_streams;
 }
 
+const std::shared_ptr<gkfs::data::UringEngine>&
+RPCData::uring_engine() const {
+    return uring_engine_;
+}
+
+void
+RPCData::uring_engine(
+        const std::shared_ptr<gkfs::data::UringEngine>& uring_engine) {
+    uring_engine_ = uring_engine;
+}
+
 const std::string&
 RPCData::self_addr_str() const {
     return self_addr_str_;
@@ -87,6 +98,26 @@ RPCData::distributor(
     distributor_ = distributor;
 }
 
+const std::shared_ptr<BulkBufferPool>&
+RPCData::bulk_pool() const {
+    return bulk_pool_;
+}
+
+void
+RPCData::bulk_pool(const std::shared_ptr<BulkBufferPool>& bulk_pool) {
+    bulk_pool_ = bulk_pool;
+}
+
+const std::shared_ptr<PeerTable>&
+RPCData::peers() const {
+    return peers_;
+}
+
+void
+RPCData::peers(const std::shared_ptr<PeerTable>& peers) {
+    peers_ = peers;
+}
+
 
 } // namespace daemon
 } // namespace gkfs
@@ -40,12 +40,18 @@
 #include <common/rpc/rpc_types.hpp>
 #include <common/rpc/rpc_util.hpp>
 #include <common/statistics/stats.hpp>
+#include <common/arithmetic/arithmetic.hpp>
 
 #include <daemon/env.hpp>
 #include <daemon/handler/rpc_defs.hpp>
 #include <daemon/ops/metadentry.hpp>
+#include <daemon/ops/data.hpp>
+#include <daemon/classes/bulk_buffer_pool.hpp>
+#include <daemon/classes/peer_table.hpp>
 #include <daemon/backend/metadata/db.hpp>
 #include <daemon/backend/data/chunk_storage.hpp>
+#include <daemon/backend/data/log_store.hpp>
+#include <daemon/backend/data/chunk_scrubber.hpp>
 #include <daemon/util.hpp>
 #include <CLI/CLI.hpp>
 
@@ -82,8 +88,21 @@ struct cli_options {
     string rpc_protocol;
     string dbbackend;
     string parallax_size;
+    string inline_data_size;
+    string chunksize;
+    string erasure_coding;
     string stats_file;
     string prometheus_gateway;
+    string fd_cache_size;
+    string chunk_cache_size;
+    string data_layout;
+    string durability;
+    string scrub_rate;
+    string compression;
+    string io_engine;
+    string pull_window;
+    string push_window;
+    string bulk_pool;
 };
 
 /**
@@ -156,6 +175,10 @@ register_server_rpcs(margo_instance_id mid) {
                    rpc_update_metadentry_size_in_t,
                    rpc_update_metadentry_size_out_t,
                    rpc_srv_update_metadentry_size);
+    MARGO_REGISTER(mid, gkfs::rpc::tag::write_inline, rpc_write_inline_in_t,
+                   rpc_update_metadentry_size_out_t, rpc_srv_write_inline);
+    MARGO_REGISTER(mid, gkfs::rpc::tag::read_inline, rpc_read_inline_in_t,
+                   rpc_data_out_t, rpc_srv_read_inline);
     MARGO_REGISTER(mid, gkfs::rpc::tag::get_dirents, rpc_get_dirents_in_t,
                    rpc_get_dirents_out_t, rpc_srv_get_dirents);
     MARGO_REGISTER(mid, gkfs::rpc::tag::get_dirents_extended,
@@ -173,6 +196,8 @@ register_server_rpcs(margo_instance_id mid) {
                    rpc_srv_truncate);
     MARGO_REGISTER(mid, gkfs::rpc::tag::get_chunk_stat, rpc_chunk_stat_in_t,
                    rpc_chunk_stat_out_t, rpc_srv_get_chunk_stat);
+    MARGO_REGISTER(mid, gkfs::rpc::tag::fsync_data, rpc_path_only_in_t,
+                   rpc_err_out_t, rpc_srv_fsync);
 }
 
 /**
@@ -228,6 +253,42 @@ init_rpc_server() {
     // Put context and class into RPC_data object
     RPC_DATA->server_rpc_mid(mid);
 
+    // Pre-register bulk buffers before the first data RPC can arrive
+    auto pool_tiers = gkfs::daemon::BulkBufferPool::parse_tiers(
+            GKFS_DATA->bulk_pool_tiers(), GKFS_DATA->chunksize());
+    if(!pool_tiers.empty()) {
+        try {
+            RPC_DATA->bulk_pool(make_shared<gkfs::daemon::BulkBufferPool>(
+                    mid, pool_tiers));
+            GKFS_DATA->spdlogger()->info(
+                    "{}() Bulk buffer pool with {} buffers ready", __func__,
+                    RPC_DATA->bulk_pool()->capacity());
+        } catch(const std::exception& e) {
+            GKFS_DATA->spdlogger()->warn(
+                    "{}() Failed to set up bulk buffer pool: {}. Buffers are allocated per RPC.",
+                    __func__, e.what());
+        }
+    }
+#ifdef GKFS_ENABLE_IO_URING
+    if(RPC_DATA->uring_engine() && RPC_DATA->bulk_pool()) {
+        try {
+            RPC_DATA->uring_engine()->register_buffers(
+                    RPC_DATA->bulk_pool()->buffers());
+            GKFS_DATA->spdlogger()->debug(
+                    "{}() Registered bulk buffer pool with io_uring",
+                    __func__);
+        } catch(const std::exception& e) {
+            GKFS_DATA->spdlogger()->warn(
+                    "{}() Failed to register bulk buffer pool with io_uring: {}. Chunk I/O uses unregistered buffers.",
+                    __func__, e.what());
+        }
+    }
+#endif
+
+    // other daemons are looked up when the first replica write is forwarded
+    RPC_DATA->peers(make_shared<gkfs::daemon::PeerTable>(
+            mid, GKFS_DATA->hosts_file()));
+
     // register RPCs
     register_server_rpcs(mid);
 }
@@ -307,14 +368,170 @@ init_environment() {
                                   __func__, chunk_storage_path);
     fs::create_directories(chunk_storage_path);
     try {
+        auto layout = GKFS_DATA->data_layout() == gkfs::data::layout_extent
+                              ? gkfs::data::ChunkLayout::extent
+                              : gkfs::data::ChunkLayout::chunk;
+        auto checksum_path =
+                GKFS_DATA->checksums()
+                        ? fmt::format("{}/{}", GKFS_DATA->rootdir(),
+                                      gkfs::config::data::checksum_dir)
+                        : ""s;
         GKFS_DATA->storage(std::make_shared<gkfs::data::ChunkStorage>(
-                chunk_storage_path, gkfs::config::rpc::chunksize));
+                chunk_storage_path, GKFS_DATA->chunksize(),
+                GKFS_DATA->fd_cache_size(), layout, GKFS_DATA->direct_io(),
+                GKFS_DATA->chunk_cache_size() * 1024 * 1024,
+                GKFS_DATA->durability() == gkfs::data::durability_write_through,
+                checksum_path, GKFS_DATA->verify_reads(),
+                GKFS_DATA->compression() == gkfs::data::compression_lz4));
     } catch(const std::exception& e) {
         GKFS_DATA->spdlogger()->error(
                 "{}() Failed to initialize storage backend: {}", __func__,
                 e.what());
         throw;
     }
+    if(GKFS_DATA->enable_stats() && GKFS_DATA->fd_cache_size() > 0) {
+        auto storage = GKFS_DATA->storage();
+        GKFS_DATA->stats()->register_counter("FD_CACHE_HITS", [storage] {
+            return storage->fd_cache_stats().hits;
+        });
+        GKFS_DATA->stats()->register_counter("FD_CACHE_MISSES", [storage] {
+            return storage->fd_cache_stats().misses;
+        });
+        GKFS_DATA->stats()->register_counter("FD_CACHE_EVICTIONS", [storage] {
+            return storage->fd_cache_stats().evictions;
+        });
+        GKFS_DATA->stats()->register_counter("FD_CACHE_SIZE", [storage] {
+            return storage->fd_cache_stats().size;
+        });
+    }
+    if(GKFS_DATA->enable_stats() && GKFS_DATA->chunk_cache_size() > 0) {
+        auto storage = GKFS_DATA->storage();
+        GKFS_DATA->stats()->register_counter("CHUNK_CACHE_HITS", [storage] {
+            return storage->data_cache_stats().hits;
+        });
+        GKFS_DATA->stats()->register_counter("CHUNK_CACHE_MISSES", [storage] {
+            return storage->data_cache_stats().misses;
+        });
+        // in percent of all chunk reads
+        GKFS_DATA->stats()->register_counter(
+                "CHUNK_CACHE_HIT_RATIO", [storage]() -> unsigned long long {
+                    auto stats = storage->data_cache_stats();
+                    auto total = stats.hits + stats.misses;
+                    return total == 0 ? 0 : stats.hits * 100 / total;
+                });
+        GKFS_DATA->stats()->register_counter(
+                "CHUNK_CACHE_EVICTIONS",
+                [storage] { return storage->data_cache_stats().evictions; });
+        GKFS_DATA->stats()->register_counter("CHUNK_CACHE_BYTES", [storage] {
+            return storage->data_cache_stats().bytes;
+        });
+    }
+    if(GKFS_DATA->enable_stats() &&
+       GKFS_DATA->durability() != gkfs::data::durability_none) {
+        auto storage = GKFS_DATA->storage();
+        GKFS_DATA->stats()->register_counter("SYNC_REQUESTS", [storage] {
+            return storage->sync_stats().requests;
+        });
+        // lower than SYNC_REQUESTS if concurrent flushes were batched
+        GKFS_DATA->stats()->register_counter("SYNC_OPS", [storage] {
+            return storage->sync_stats().syncs;
+        });
+    }
+    if(GKFS_DATA->enable_stats() && GKFS_DATA->checksums()) {
+        auto storage = GKFS_DATA->storage();
+        GKFS_DATA->stats()->register_counter(
+                "CHECKSUM_VERIFIED_BLOCKS",
+                [storage] { return storage->checksum_stats().verified_blocks; });
+        GKFS_DATA->stats()->register_counter(
+                "CHECKSUM_MISMATCHES",
+                [storage] { return storage->checksum_stats().mismatches; });
+    }
+    if(GKFS_DATA->enable_stats() &&
+       GKFS_DATA->compression() != gkfs::data::compression_none) {
+        auto storage = GKFS_DATA->storage();
+        // the ratio of both is the achieved compression ratio
+        GKFS_DATA->stats()->register_counter(
+                "COMPRESSION_RAW_BYTES",
+                [storage] { return storage->compression_stats().raw_bytes; });
+        GKFS_DATA->stats()->register_counter(
+                "COMPRESSION_STORED_BYTES", [storage] {
+                    return storage->compression_stats().stored_bytes;
+                });
+        GKFS_DATA->stats()->register_counter(
+                "COMPRESSION_SKIPPED",
+                [storage] { return storage->compression_stats().skipped; });
+    }
+    if(GKFS_DATA->checksums() && GKFS_DATA->scrub_rate() > 0) {
+        GKFS_DATA->scrubber(std::make_shared<gkfs::data::ChunkScrubber>(
+                GKFS_DATA->storage(), GKFS_DATA->scrub_rate() * 1024 * 1024,
+                gkfs::config::data::scrub_interval_s));
+        if(GKFS_DATA->enable_stats()) {
+            // the scrubber is stopped before the stats, do not keep it alive
+            weak_ptr<gkfs::data::ChunkScrubber> scrubber =
+                    GKFS_DATA->scrubber();
+            GKFS_DATA->stats()->register_counter("SCRUB_PASSES", [scrubber] {
+                auto s = scrubber.lock();
+                return s ? s->stats().passes : 0;
+            });
+            GKFS_DATA->stats()->register_counter("SCRUB_BYTES", [scrubber] {
+                auto s = scrubber.lock();
+                return s ? s->stats().bytes : 0;
+            });
+        }
+    }
+
+    if(GKFS_DATA->enable_write_log()) {
+        auto log_path = fmt::format("{}/{}", GKFS_DATA->rootdir(),
+                                    gkfs::config::data::log_dir);
+        GKFS_DATA->spdlogger()->debug("{}() Initializing write log: '{}'",
+                                      __func__, log_path);
+        try {
+            GKFS_DATA->log_store(std::make_shared<gkfs::data::LogStore>(
+                    GKFS_DATA->storage(), log_path,
+                    gkfs::config::data::log_segment_size,
+                    gkfs::config::data::log_max_write_size,
+                    gkfs::config::rpc::daemon_io_xstreams,
+                    gkfs::config::data::log_compact_interval_ms));
+        } catch(const std::exception& e) {
+            GKFS_DATA->spdlogger()->error(
+                    "{}() Failed to initialize write log: {}", __func__,
+                    e.what());
+            throw;
+        }
+        if(GKFS_DATA->enable_stats()) {
+            // the log is released before the stats, do not keep it alive
+            weak_ptr<gkfs::data::LogStore> log = GKFS_DATA->log_store();
+            GKFS_DATA->stats()->register_counter("LOG_SEGMENTS", [log] {
+                auto l = log.lock();
+                return l ? l->stats().segments : 0;
+            });
+            GKFS_DATA->stats()->register_counter("LOG_LIVE_BYTES", [log] {
+                auto l = log.lock();
+                return l ? l->stats().live_bytes : 0;
+            });
+            GKFS_DATA->stats()->register_counter("LOG_COMPACTED_BYTES", [log] {
+                auto l = log.lock();
+                return l ? l->stats().compacted_bytes : 0;
+            });
+        }
+    }
+
+#ifdef GKFS_ENABLE_IO_URING
+    // Must be set up before the first I/O RPC arrives
+    if(GKFS_DATA->io_engine() == gkfs::data::io_engine_uring) {
+        GKFS_DATA->spdlogger()->debug("{}() Initializing io_uring engine",
+                                      __func__);
+        try {
+            RPC_DATA->uring_engine(std::make_shared<gkfs::data::UringEngine>(
+                    gkfs::config::io::uring_queue_depth));
+        } catch(const std::exception& e) {
+            GKFS_DATA->spdlogger()->warn(
+                    "{}() Failed to initialize io_uring engine: {}. Falling back to the '{}' I/O engine",
+                    __func__, e.what(), gkfs::data::io_engine_tasklet);
+            GKFS_DATA->io_engine(gkfs::data::io_engine_tasklet);
+        }
+    }
+#endif
 
     // Init margo for RPC
     GKFS_DATA->spdlogger()->debug("{}() Initializing RPC server: '{}'",
@@ -327,6 +544,23 @@ init_environment() {
         throw;
     }
 
+    if(GKFS_DATA->enable_stats() && RPC_DATA->bulk_pool()) {
+        // the pool is released before margo shuts down, do not keep it alive
+        weak_ptr<gkfs::daemon::BulkBufferPool> pool = RPC_DATA->bulk_pool();
+        GKFS_DATA->stats()->register_counter("BULK_POOL_IN_USE", [pool] {
+            auto p = pool.lock();
+            return p ? p->in_use() : 0;
+        });
+        GKFS_DATA->stats()->register_counter("BULK_POOL_CAPACITY", [pool] {
+            auto p = pool.lock();
+            return p ? p->capacity() : 0;
+        });
+        GKFS_DATA->stats()->register_counter("BULK_POOL_FALLBACKS", [pool] {
+            auto p = pool.lock();
+            return p ? p->fallbacks() : 0;
+        });
+    }
+
     // Init Argobots ESs to drive IO
     try {
         GKFS_DATA->spdlogger()->debug("{}() Initializing I/O pool", __func__);
@@ -415,8 +649,24 @@ destroy_enviroment() {
     if(RPC_DATA->server_rpc_mid() != nullptr) {
         GKFS_DATA->spdlogger()->debug("{}() Finalizing margo RPC server",
                                       __func__);
+        // registered buffers and peer addresses must be released while margo
+        // is still running
+#ifdef GKFS_ENABLE_IO_URING
+        if(RPC_DATA->uring_engine())
+            RPC_DATA->uring_engine()->unregister_buffers();
+#endif
+        RPC_DATA->bulk_pool(nullptr);
+        RPC_DATA->peers(nullptr);
         margo_finalize(RPC_DATA->server_rpc_mid());
     }
+    // all chunk I/O has finished after the RPC server is shut down
+    RPC_DATA->uring_engine(nullptr);
+    GKFS_DATA->scrubber(nullptr);
+    if(GKFS_DATA->log_store()) {
+        GKFS_DATA->spdlogger()->info(
+                "{}() Moving write log to chunk files ...", __func__);
+        GKFS_DATA->log_store(nullptr);
+    }
 
     GKFS_DATA->spdlogger()->info("{}() Closing metadata DB", __func__);
     GKFS_DATA->close_mdb();
@@ -656,6 +906,244 @@ parse_input(const cli_options& opts, const CLI::App& desc) {
         GKFS_DATA->parallax_size_md(stoi(opts.parallax_size));
     }
 
+    if(desc.count("--chunksize")) {
+        auto chunksize = stoul(opts.chunksize);
+        if(!gkfs::utils::arithmetic::is_power_of_2(chunksize) ||
+           chunksize < gkfs::config::rpc::min_chunksize) {
+            throw runtime_error(fmt::format(
+                    "--chunksize '{}' must be a power of 2 and at least '{}'",
+                    chunksize, gkfs::config::rpc::min_chunksize));
+        }
+        GKFS_DATA->chunksize(chunksize);
+    }
+    GKFS_DATA->spdlogger()->debug("{}() Chunk size: '{}'", __func__,
+                                  GKFS_DATA->chunksize());
+
+    if(desc.count("--erasure-coding")) {
+        // <k>+<m>, e.g., 4+2
+        const auto& ec = opts.erasure_coding;
+        auto plus = ec.find('+');
+        unsigned long data_shards = 0;
+        unsigned long parity_shards = 0;
+        if(plus != string::npos) {
+            data_shards = stoul(ec.substr(0, plus));
+            parity_shards = stoul(ec.substr(plus + 1));
+        }
+        if(data_shards == 0 || parity_shards == 0 ||
+           data_shards + parity_shards > gkfs::config::ec::max_shards) {
+            throw runtime_error(fmt::format(
+                    "--erasure-coding '{}' must be <k>+<m> with k, m > 0 and k + m <= {}",
+                    ec, gkfs::config::ec::max_shards));
+        }
+        GKFS_DATA->ec_data_shards(data_shards);
+        GKFS_DATA->ec_parity_shards(parity_shards);
+    }
+    GKFS_DATA->spdlogger()->debug("{}() Erasure coding: '{}+{}'", __func__,
+                                  GKFS_DATA->ec_data_shards(),
+                                  GKFS_DATA->ec_parity_shards());
+
+    if(desc.count("--inline-data-size")) {
+        auto inline_size = stoul(opts.inline_data_size);
+        if(inline_size > GKFS_DATA->chunksize()) {
+            throw runtime_error(fmt::format(
+                    "--inline-data-size '{}' must not exceed the chunksize '{}'",
+                    inline_size, GKFS_DATA->chunksize()));
+        }
+        GKFS_DATA->inline_data_size(inline_size);
+    }
+    // parallax returns values up to their first null character
+    if(GKFS_DATA->inline_data_size() > 0 &&
+       GKFS_DATA->dbbackend() == gkfs::metadata::parallax_backend) {
+        GKFS_DATA->spdlogger()->warn(
+                "{}() Inline data is not supported with dbbackend '{}'. Disabling it",
+                __func__, GKFS_DATA->dbbackend());
+        GKFS_DATA->inline_data_size(0);
+    }
+    GKFS_DATA->spdlogger()->debug("{}() Inline data size: '{}'", __func__,
+                                  GKFS_DATA->inline_data_size());
+
+    if(desc.count("--fd-cache-size")) {
+        GKFS_DATA->fd_cache_size(stoul(opts.fd_cache_size));
+    }
+    GKFS_DATA->spdlogger()->debug("{}() Chunk file descriptor cache size: '{}'",
+                                  __func__, GKFS_DATA->fd_cache_size());
+
+    if(desc.count("--data-layout")) {
+        if(opts.data_layout != gkfs::data::layout_chunk &&
+           opts.data_layout != gkfs::data::layout_extent) {
+            throw runtime_error(fmt::format(
+                    "data layout '{}' is not valid. Consult `--help`",
+                    opts.data_layout));
+        }
+        GKFS_DATA->data_layout(opts.data_layout);
+    }
+    GKFS_DATA->spdlogger()->debug("{}() Chunk data layout: '{}'", __func__,
+                                  GKFS_DATA->data_layout());
+
+    if(desc.count("--io-engine")) {
+        if(opts.io_engine == gkfs::data::io_engine_tasklet ||
+           opts.io_engine == gkfs::data::io_engine_uring) {
+#ifndef GKFS_ENABLE_IO_URING
+            if(opts.io_engine == gkfs::data::io_engine_uring) {
+                throw runtime_error(fmt::format(
+                        "I/O engine '{}' was not compiled and is disabled. "
+                        "Pass -DGKFS_ENABLE_IO_URING:BOOL=ON to CMake to enable.",
+                        opts.io_engine));
+            }
+#endif
+            GKFS_DATA->io_engine(opts.io_engine);
+        } else {
+            throw runtime_error(
+                    fmt::format("I/O engine '{}' is not valid. Consult `--help`",
+                                opts.io_engine));
+        }
+    }
+    GKFS_DATA->spdlogger()->debug("{}() Chunk I/O engine: '{}'", __func__,
+                                  GKFS_DATA->io_engine());
+    if(desc.count("--enable-write-log")) {
+        GKFS_DATA->enable_write_log(true);
+        // appends must go through the log's index, not directly to the chunks
+        if(GKFS_DATA->io_engine() != gkfs::data::io_engine_tasklet) {
+            GKFS_DATA->spdlogger()->warn(
+                    "{}() I/O engine '{}' is not supported with the write log. Using '{}'",
+                    __func__, GKFS_DATA->io_engine(),
+                    gkfs::data::io_engine_tasklet);
+            GKFS_DATA->io_engine(gkfs::data::io_engine_tasklet);
+        }
+        GKFS_DATA->spdlogger()->info("{}() Write log enabled", __func__);
+    }
+    if(desc.count("--direct-io")) {
+        GKFS_DATA->direct_io(true);
+        // unaligned requests must be staged in aligned buffers
+        if(GKFS_DATA->io_engine() != gkfs::data::io_engine_tasklet) {
+            GKFS_DATA->spdlogger()->warn(
+                    "{}() I/O engine '{}' is not supported with direct I/O. Using '{}'",
+                    __func__, GKFS_DATA->io_engine(),
+                    gkfs::data::io_engine_tasklet);
+            GKFS_DATA->io_engine(gkfs::data::io_engine_tasklet);
+        }
+        GKFS_DATA->spdlogger()->info("{}() Direct chunk I/O enabled",
+                                     __func__);
+    }
+    if(desc.count("--durability")) {
+        if(opts.durability != gkfs::data::durability_none &&
+           opts.durability != gkfs::data::durability_flush &&
+           opts.durability != gkfs::data::durability_write_through) {
+            throw runtime_error(fmt::format(
+                    "durability '{}' is not valid. Consult `--help`",
+                    opts.durability));
+        }
+        GKFS_DATA->durability(opts.durability);
+    }
+    GKFS_DATA->spdlogger()->debug("{}() Chunk data durability: '{}'", __func__,
+                                  GKFS_DATA->durability());
+    // the write log's index is not persistent, writes would not be durable
+    if(GKFS_DATA->durability() == gkfs::data::durability_write_through &&
+       GKFS_DATA->enable_write_log()) {
+        GKFS_DATA->spdlogger()->warn(
+                "{}() The write log is not supported with durability '{}'. Disabling the write log",
+                __func__, GKFS_DATA->durability());
+        GKFS_DATA->enable_write_log(false);
+    }
+    if(desc.count("--checksums")) {
+        GKFS_DATA->checksums(true);
+        // checksums must be updated by every write
+        if(GKFS_DATA->io_engine() != gkfs::data::io_engine_tasklet) {
+            GKFS_DATA->spdlogger()->warn(
+                    "{}() I/O engine '{}' is not supported with checksums. Using '{}'",
+                    __func__, GKFS_DATA->io_engine(),
+                    gkfs::data::io_engine_tasklet);
+            GKFS_DATA->io_engine(gkfs::data::io_engine_tasklet);
+        }
+        GKFS_DATA->spdlogger()->info("{}() Chunk checksums enabled",
+                                     __func__);
+    }
+    if(desc.count("--verify-reads")) {
+        if(!GKFS_DATA->checksums())
+            throw runtime_error("--verify-reads requires --checksums");
+        GKFS_DATA->verify_reads(true);
+    }
+    if(desc.count("--scrub-rate")) {
+        GKFS_DATA->scrub_rate(stoul(opts.scrub_rate));
+        if(GKFS_DATA->scrub_rate() > 0 && !GKFS_DATA->checksums())
+            throw runtime_error("--scrub-rate requires --checksums");
+    }
+    GKFS_DATA->spdlogger()->debug(
+            "{}() Verify reads: '{}', scrub rate: '{}' MiB/s", __func__,
+            GKFS_DATA->verify_reads(), GKFS_DATA->scrub_rate());
+    if(desc.count("--compression")) {
+        if(opts.compression != gkfs::data::compression_none &&
+           opts.compression != gkfs::data::compression_lz4) {
+            throw runtime_error(fmt::format(
+                    "compression '{}' is not valid. Consult `--help`",
+                    opts.compression));
+        }
+#ifndef GKFS_ENABLE_LZ4
+        if(opts.compression == gkfs::data::compression_lz4) {
+            throw runtime_error(fmt::format(
+                    "compression '{}' was not compiled and is disabled. "
+                    "Pass -DGKFS_ENABLE_LZ4:BOOL=ON to CMake to enable.",
+                    opts.compression));
+        }
+#endif
+        GKFS_DATA->compression(opts.compression);
+    }
+    if(GKFS_DATA->compression() != gkfs::data::compression_none) {
+        // compressed chunks have no fixed on-disk offsets
+        if(GKFS_DATA->data_layout() != gkfs::data::layout_chunk ||
+           GKFS_DATA->direct_io() || GKFS_DATA->checksums())
+            throw runtime_error(
+                    "--compression requires the chunk data layout and is not supported with --direct-io and --checksums");
+        if(GKFS_DATA->io_engine() != gkfs::data::io_engine_tasklet) {
+            GKFS_DATA->spdlogger()->warn(
+                    "{}() I/O engine '{}' is not supported with compression. Using '{}'",
+                    __func__, GKFS_DATA->io_engine(),
+                    gkfs::data::io_engine_tasklet);
+            GKFS_DATA->io_engine(gkfs::data::io_engine_tasklet);
+        }
+    }
+    GKFS_DATA->spdlogger()->debug("{}() Chunk compression: '{}'", __func__,
+                                  GKFS_DATA->compression());
+    if(desc.count("--chunk-cache-size")) {
+        GKFS_DATA->chunk_cache_size(stoul(opts.chunk_cache_size));
+    }
+    GKFS_DATA->spdlogger()->debug("{}() Chunk data cache size: '{}' MiB",
+                                  __func__, GKFS_DATA->chunk_cache_size());
+    // cached chunks must be invalidated by every write
+    if(GKFS_DATA->chunk_cache_size() > 0 &&
+       GKFS_DATA->io_engine() != gkfs::data::io_engine_tasklet) {
+        GKFS_DATA->spdlogger()->warn(
+                "{}() I/O engine '{}' is not supported with the chunk data cache. Using '{}'",
+                __func__, GKFS_DATA->io_engine(),
+                gkfs::data::io_engine_tasklet);
+        GKFS_DATA->io_engine(gkfs::data::io_engine_tasklet);
+    }
+
+    if(desc.count("--pull-window")) {
+        auto pull_window = stoul(opts.pull_window);
+        if(pull_window == 0)
+            throw runtime_error("--pull-window must be at least 1");
+        GKFS_DATA->pull_window(pull_window);
+    }
+    GKFS_DATA->spdlogger()->debug("{}() Write bulk transfer window: '{}'",
+                                  __func__, GKFS_DATA->pull_window());
+    if(desc.count("--push-window")) {
+        auto push_window = stoul(opts.push_window);
+        if(push_window == 0)
+            throw runtime_error("--push-window must be at least 1");
+        GKFS_DATA->push_window(push_window);
+    }
+    GKFS_DATA->spdlogger()->debug("{}() Read bulk transfer window: '{}'",
+                                  __func__, GKFS_DATA->push_window());
+    if(desc.count("--bulk-pool")) {
+        // throws std::invalid_argument on malformed input
+        gkfs::daemon::BulkBufferPool::parse_tiers(opts.bulk_pool,
+                                                  GKFS_DATA->chunksize());
+        GKFS_DATA->bulk_pool_tiers(opts.bulk_pool);
+    }
+    GKFS_DATA->spdlogger()->debug("{}() Bulk buffer pool tiers: '{}'",
+                                  __func__, GKFS_DATA->bulk_pool_tiers());
+
     /*
      * Statistics collection arguments
      */
@@ -777,6 +1265,75 @@ main(int argc, const char* argv[]) {
     desc.add_option("--parallaxsize", opts.parallax_size,
                     "parallaxdb - metadata file size in GB (default 8GB), "
                     "used only with new files");
+    desc.add_option(
+                "--chunksize", opts.chunksize,
+                "Chunk size in bytes into which files are split. Must be a power of 2 and at least 4096. "
+                "Must be the same for all daemons and not change for an existing rootdir. (Default 524288)");
+    desc.add_option(
+                "--erasure-coding", opts.erasure_coding,
+                "Protect file data with <k>+<m> Reed-Solomon erasure coding, e.g., 4+2. Stripes of k chunks get m parity chunks "
+                "and survive the loss of m daemons. Replaces client replication. "
+                "Must be the same for all daemons and not change for an existing rootdir. (Default disabled)");
+    desc.add_option(
+                "--inline-data-size", opts.inline_data_size,
+                "Files up to this size in bytes store their data in their metadata entry instead of chunks. "
+                "Must not exceed the chunksize. 0 disables inline data. (Default 0)");
+    desc.add_option(
+                "--fd-cache-size", opts.fd_cache_size,
+                "Number of open chunk files cached by the data backend. "
+                "0 disables the cache. (Default 256)");
+    desc.add_option(
+                "--chunk-cache-size", opts.chunk_cache_size,
+                "Memory in MiB for caching frequently read chunks in the daemon. "
+                "0 disables the cache. Uses the tasklet I/O engine. (Default 0)");
+    desc.add_option(
+                "--data-layout", opts.data_layout,
+                "Placement of chunks on the node-local file system. Available: {chunk, extent}\n"
+                "chunk stores each chunk in its own file, extent stores all chunks of a file in one sparse file. (Default chunk)");
+    desc.add_option(
+                "--durability", opts.durability,
+                "Durability of chunk data. Available: {none, flush, write-through}\n"
+                "none ignores fsync(), flush syncs a file's chunks on fsync(), "
+                "write-through also syncs every write. (Default flush)");
+    desc.add_option(
+                "--io-engine", opts.io_engine,
+                "I/O engine for chunk reads and writes. Available: {tasklet, io_uring}\n"
+                "io_uring requires compiling with GKFS_ENABLE_IO_URING. (Default tasklet)");
+    desc.add_flag(
+                "--direct-io",
+                "Bypasses the page cache by accessing chunk files with O_DIRECT. "
+                "Unaligned requests are staged in aligned buffers. Uses the tasklet I/O engine. (Default off)");
+    desc.add_flag(
+                "--enable-write-log",
+                "Appends small writes to a log that is moved to the chunk files in the background. "
+                "Data in the log is lost if the daemon crashes. Uses the tasklet I/O engine. (Default off)");
+    desc.add_flag(
+                "--checksums",
+                "Stores a CRC32C checksum per 4 KiB block of every chunk, updated on each write. "
+                "Uses the tasklet I/O engine. (Default off)");
+    desc.add_flag(
+                "--verify-reads",
+                "Verifies chunk reads against their checksums and fails them with EIO on a mismatch. "
+                "Requires --checksums. (Default off)");
+    desc.add_option(
+                "--scrub-rate", opts.scrub_rate,
+                "MiB/s read by a background scrubber that verifies all chunk checksums. "
+                "0 disables the scrubber. Requires --checksums. (Default 0)");
+    desc.add_option(
+                "--compression", opts.compression,
+                "Compression of chunk data. Available: {none, lz4}\n"
+                "lz4 requires compiling with GKFS_ENABLE_LZ4 and the chunk data layout. "
+                "Uses the tasklet I/O engine. (Default none)");
+    desc.add_option(
+                "--pull-window", opts.pull_window,
+                "Number of chunk bulk transfers a write request keeps in flight. (Default 8)");
+    desc.add_option(
+                "--push-window", opts.push_window,
+                "Number of chunk bulk transfers a read request keeps in flight. (Default 8)");
+    desc.add_option(
+                "--bulk-pool", opts.bulk_pool,
+                "Pre-registered bulk buffers for data requests as <chunks>:<count>,... "
+                "where each tier has <count> buffers of <chunks> chunks. 0 disables the pool. (Default 1:64,4:16)");
     desc.add_flag(
                 "--enable-collection",
                 "Enables collection of general statistics. "
@@ -819,8 +1376,8 @@ main(int argc, const char* argv[]) {
 #else
         cout << "Create check parents: OFF" << endl;
 #endif
-        cout << "Chunk size: " << gkfs::config::rpc::chunksize << " bytes"
-             << endl;
+        cout << "Default chunk size: " << gkfs::config::rpc::chunksize
+             << " bytes" << endl;
         return EXIT_SUCCESS;
     }
     // intitialize logging framework
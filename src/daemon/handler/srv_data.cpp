@@ -37,14 +37,24 @@
 #include <daemon/handler/rpc_defs.hpp>
 #include <daemon/handler/rpc_util.hpp>
 #include <daemon/backend/data/chunk_storage.hpp>
+#include <daemon/backend/data/log_store.hpp>
 #include <daemon/ops/data.hpp>
+#include <daemon/classes/bulk_buffer_pool.hpp>
+#include <daemon/classes/peer_table.hpp>
 
 #include <common/rpc/rpc_types.hpp>
 #include <common/rpc/rpc_util.hpp>
+#include <common/rpc/chunk_set.hpp>
 #include <common/rpc/distributor.hpp>
 #include <common/arithmetic/arithmetic.hpp>
 #include <common/statistics/stats.hpp>
 
+#include <algorithm>
+#include <stdexcept>
+#include <deque>
+#include <map>
+#include <mutex>
+
 #ifdef GKFS_ENABLE_AGIOS
 #include <daemon/scheduler/agios.hpp>
 
@@ -57,6 +67,220 @@ using namespace std;
 
 namespace {
 
+/**
+ * @brief Provides the local buffer for the bulk transfers of a data RPC. A
+ * pre-registered buffer is borrowed from the daemon's bulk buffer pool if one is
+ * available. Otherwise, a bulk buffer is created for this RPC only.
+ * @param mid Margo instance id of the server
+ * @param size Required buffer size
+ * @param lease Set to the borrowed buffer. Must outlive all transfers
+ * @param bulk_handle Set to the created bulk handle which is freed with the RPC
+ * resources. Stays untouched if a pooled buffer is used
+ * @param local_bulk_handle Set to the bulk handle to use for transfers
+ * @param buf Set to the local buffer
+ * @return Mercury error code. HG_SUCCESS on success.
+ */
+hg_return_t
+get_local_bulk(margo_instance_id mid, hg_size_t size,
+               gkfs::daemon::BulkBufferPool::Lease& lease,
+               hg_bulk_t& bulk_handle, hg_bulk_t& local_bulk_handle,
+               void*& buf) {
+    if(RPC_DATA->bulk_pool()) {
+        lease = RPC_DATA->bulk_pool()->acquire(size);
+        if(lease) {
+            buf = lease.buffer();
+            local_bulk_handle = lease.handle();
+            return HG_SUCCESS;
+        }
+    }
+    // create bulk handle and allocated memory for buffer with buf_sizes
+    // information
+    auto ret = margo_bulk_create(mid, 1, nullptr, &size, HG_BULK_READWRITE,
+                                 &bulk_handle);
+    if(ret != HG_SUCCESS) {
+        GKFS_DATA->spdlogger()->error("{}() Failed to create bulk handle",
+                                      __func__);
+        return ret;
+    }
+    // access the internally allocated memory buffer and put it into buf_ptrs
+    uint32_t actual_count;
+    ret = margo_bulk_access(bulk_handle, 0, size, HG_BULK_READWRITE, 1, &buf,
+                            &size, &actual_count);
+    if(ret != HG_SUCCESS || actual_count != 1) {
+        GKFS_DATA->spdlogger()->error(
+                "{}() Failed to access allocated buffer from bulk handle",
+                __func__);
+        return ret != HG_SUCCESS ? ret : HG_OTHER_ERROR;
+    }
+    local_bulk_handle = bulk_handle;
+    return HG_SUCCESS;
+}
+
+/**
+ * @brief Write of replica chunks that is forwarded to another daemon.
+ */
+struct replica_write {
+    uint64_t host_id;                //!< Daemon storing the replicas
+    gkfs::rpc::ChunkSet chunks;      //!< Replica chunks relative to start
+    std::vector<uint8_t> chunk_set;  //!< Encoded chunks
+    std::vector<uint64_t> chnk_idxs; //!< Indices of the chunks in this RPC
+    uint64_t size{0};                //!< Total size of the chunks
+    hg_handle_t handle{HG_HANDLE_NULL};
+    margo_request req{MARGO_REQUEST_NULL};
+};
+
+// the daemon's distributor learns the number of daemons on first use
+std::mutex distributor_mutex;
+
+/**
+ * @brief Forwards the replicas of the chunks of a write request to the daemons
+ * storing them. The daemons pull the chunks from this daemon's bulk buffer.
+ * @internal
+ * Each replica daemon receives one write RPC with its chunks of all replicas.
+ * The RPC names the chunks that are in the local buffer as origin chunk set so
+ * that the daemon can compute the offsets of its chunks in the buffer. Replica
+ * daemons do not forward the chunks any further.
+ * @endinternal
+ * @param mid Margo instance id of the server
+ * @param in Input of the write request
+ * @param host_chunks Chunks in the local buffer relative to chunk_start
+ * @param chnk_ids Chunk ids in the local buffer
+ * @param chnk_sizes Chunk sizes in the local buffer
+ * @param chnk_n Number of chunks in the local buffer
+ * @param local_bulk_handle Bulk handle of the local buffer
+ * @param targets Set to the number of distinct daemons other than this one
+ * that each chunk is forwarded to. Copies that map to this daemon or to a
+ * daemon already storing the chunk are written only once
+ * @return All replica writes that were sent
+ */
+vector<replica_write>
+forward_replicas(margo_instance_id mid, const rpc_write_data_in_t& in,
+                 const gkfs::rpc::ChunkSet& host_chunks,
+                 const vector<uint64_t>& chnk_ids,
+                 const vector<uint64_t>& chnk_sizes, uint64_t chnk_n,
+                 hg_bulk_t local_bulk_handle, vector<uint32_t>& targets) {
+    map<uint64_t, replica_write> writes{};
+    targets.assign(chnk_n, 0);
+    {
+        lock_guard<mutex> lock(distributor_mutex);
+        for(uint64_t idx = 0; idx < chnk_n; idx++) {
+            for(uint32_t copy = 1; copy <= in.replicas; copy++) {
+                auto target = RPC_DATA->distributor()->locate_data(
+                        in.path, chnk_ids[idx], in.host_size, copy);
+                // more replicas than daemons
+                if(target == in.host_id)
+                    continue;
+                auto& write = writes[target];
+                if(!write.chnk_idxs.empty() && write.chnk_idxs.back() == idx)
+                    continue;
+                write.host_id = target;
+                write.chunks.add(chnk_ids[idx] - in.chunk_start);
+                write.chnk_idxs.push_back(idx);
+                write.size += chnk_sizes[idx];
+                targets[idx]++;
+            }
+        }
+    }
+    hg_id_t write_id = 0;
+    hg_bool_t registered = HG_FALSE;
+    margo_registered_name(mid, gkfs::rpc::tag::write, &write_id, &registered);
+    auto origin_set = host_chunks.encode();
+    vector<replica_write> sent{};
+    for(auto& [target, write] : writes) {
+        hg_addr_t addr = HG_ADDR_NULL;
+        try {
+            addr = RPC_DATA->peers()->addr(target, in.host_size);
+        } catch(const std::exception& e) {
+            GKFS_DATA->spdlogger()->error(
+                    "{}() Failed to forward replicas of file '{}' to daemon {}: '{}'",
+                    __func__, in.path, target, e.what());
+            continue;
+        }
+        write.chunk_set = write.chunks.encode();
+        rpc_write_data_in_t fwd_in{};
+        fwd_in.path = in.path;
+        fwd_in.offset = in.offset;
+        fwd_in.host_id = target;
+        fwd_in.host_size = in.host_size;
+        fwd_in.chunk_set = {write.chunk_set.size(), write.chunk_set.data()};
+        fwd_in.chunk_n = write.chnk_idxs.size();
+        fwd_in.chunk_start = in.chunk_start;
+        fwd_in.chunk_end = in.chunk_end;
+        fwd_in.total_chunk_size = write.size;
+        fwd_in.origin_chunk_set = {origin_set.size(), origin_set.data()};
+        fwd_in.replicas = 0;
+        fwd_in.write_quorum = 0;
+        fwd_in.bulk_handle = local_bulk_handle;
+        auto ret = margo_create(mid, addr, write_id, &write.handle);
+        if(ret == HG_SUCCESS)
+            ret = margo_iforward(write.handle, &fwd_in, &write.req);
+        if(ret != HG_SUCCESS) {
+            GKFS_DATA->spdlogger()->error(
+                    "{}() Failed to forward replicas of file '{}' to daemon {} err '{}'",
+                    __func__, in.path, target, ret);
+            if(write.handle != HG_HANDLE_NULL)
+                margo_destroy(write.handle);
+            continue;
+        }
+        sent.emplace_back(std::move(write));
+    }
+    return sent;
+}
+
+/**
+ * @brief Waits for forwarded replica writes and counts the written copies of
+ * each chunk.
+ * @param writes Forwarded replica writes. Finished writes are not waited for
+ * again
+ * @param copies Number of written copies per chunk index, updated
+ * @param quorums Returns as soon as each chunk has its number of copies in
+ * quorums. Empty waits for all writes
+ * @return true if each chunk has its quorum of copies
+ */
+bool
+wait_for_replicas(vector<replica_write>& writes, vector<uint32_t>& copies,
+                  const vector<uint32_t>& quorums) {
+    auto quorum_reached = [&]() {
+        if(quorums.empty())
+            return false;
+        for(size_t idx = 0; idx < copies.size(); idx++) {
+            if(copies[idx] < quorums[idx])
+                return false;
+        }
+        return true;
+    };
+    vector<margo_request> reqs(writes.size());
+    while(!quorum_reached()) {
+        std::transform(writes.begin(), writes.end(), reqs.begin(),
+                       [](const replica_write& w) { return w.req; });
+        if(std::all_of(reqs.begin(), reqs.end(), [](margo_request r) {
+               return r == MARGO_REQUEST_NULL;
+           }))
+            break;
+        size_t idx = 0;
+        auto ret = margo_wait_any(reqs.size(), reqs.data(), &idx);
+        auto& write = writes.at(idx);
+        write.req = MARGO_REQUEST_NULL;
+        int err = EIO;
+        rpc_data_out_t fwd_out{};
+        if(ret == HG_SUCCESS &&
+           margo_get_output(write.handle, &fwd_out) == HG_SUCCESS) {
+            err = fwd_out.err;
+            margo_free_output(write.handle, &fwd_out);
+        }
+        margo_destroy(write.handle);
+        if(err != 0) {
+            GKFS_DATA->spdlogger()->error(
+                    "{}() Replica write to daemon {} failed with err '{}'",
+                    __func__, write.host_id, err);
+            continue;
+        }
+        for(auto chnk_idx : write.chnk_idxs)
+            copies[chnk_idx]++;
+    }
+    return quorum_reached();
+}
+
 /**
  * @brief Serves a write request transferring the chunks associated with this
  * daemon and store them on the node-local FS.
@@ -71,16 +295,19 @@ namespace {
  * struct. Therefore, this information would need to be pulled with a bulk
  * transfer as well, adding unnecessary latency to the overall write operation.
  *
- * For each relevant chunk, a PULL bulk transfer is issued. Once finished, a
- * non-blocking Argobots tasklet is launched to write the data chunk to the
- * backend storage. Therefore, bulk transfer and the backend I/O operation are
- * overlapping for efficiency.
- * 4. Wait for all tasklets to complete adding up all the complete written data
+ * For each relevant chunk, a non-blocking PULL bulk transfer is issued. Up to
+ * the configured pull window of transfers are in flight at the same time. Once
+ * a chunk's transfer is finished, a non-blocking Argobots tasklet is launched
+ * to write the data chunk to the backend storage. Therefore, bulk transfers
+ * overlap with each other and with the backend I/O operations for efficiency.
+ * 4. If the client requests replicas, forward the chunks to the daemons of
+ * their replicas (see forward_replicas()).
+ * 5. Wait for all tasklets to complete adding up all the complete written data
  * size as reported by each task.
- * 5. Respond to client (when all backend write operations are finished) and
- * cleanup RPC resources. Any error is reported in the RPC output struct. Note,
- * that backend write operations are not canceled while in-flight when a task
- * encounters an error.
+ * 6. Respond to client (when all backend write operations are finished, or
+ * with replicas, when the write quorum is reached) and cleanup RPC resources.
+ * Any error is reported in the RPC output struct. Note, that backend write
+ * operations are not canceled while in-flight when a task encounters an error.
  *
  * Note, refer to the data backend documentation w.r.t. how Argobots tasklets
  * work and why they are used.
@@ -116,8 +343,27 @@ rpc_srv_write(hg_handle_t handle) {
             __func__, in.path, in.chunk_start, in.chunk_end, in.chunk_n,
             in.total_chunk_size, bulk_size, in.offset);
 
-    std::vector<uint8_t> write_ops_vect =
-            gkfs::rpc::decompress_bitset(in.wbitset);
+    gkfs::rpc::ChunkSet host_chunks;
+    // chunks in the remote bulk if sent by a daemon forwarding replicas.
+    // Otherwise, the remote bulk holds all chunks of the request
+    const bool origin_all = in.origin_chunk_set.size == 0;
+    gkfs::rpc::ChunkSet origin_chunks;
+    try {
+        host_chunks = gkfs::rpc::ChunkSet::decode(
+                static_cast<const uint8_t*>(in.chunk_set.data),
+                in.chunk_set.size);
+        if(!origin_all)
+            origin_chunks = gkfs::rpc::ChunkSet::decode(
+                    static_cast<const uint8_t*>(in.origin_chunk_set.data),
+                    in.origin_chunk_set.size);
+    } catch(const std::invalid_argument& e) {
+        GKFS_DATA->spdlogger()->error("{}() Invalid chunk set: '{}'", __func__,
+                                      e.what());
+        out.err = EINVAL;
+        return gkfs::rpc::cleanup_respond(&handle, &in, &out, &bulk_handle);
+    }
+    // the remote bulk starts with the first chunk of the request and its offset
+    const bool origin_first = origin_all || origin_chunks.contains(0);
 
 #ifdef GKFS_ENABLE_AGIOS
     int* data;
@@ -165,27 +411,13 @@ rpc_srv_write(hg_handle_t handle) {
      */
     void* bulk_buf;                          // buffer for bulk transfer
     vector<char*> bulk_buf_ptrs(in.chunk_n); // buffer-chunk offsets
-    // create bulk handle and allocated memory for buffer with buf_sizes
-    // information
-    ret = margo_bulk_create(mid, 1, nullptr, &in.total_chunk_size,
-                            HG_BULK_READWRITE, &bulk_handle);
-    if(ret != HG_SUCCESS) {
-        GKFS_DATA->spdlogger()->error("{}() Failed to create bulk handle",
-                                      __func__);
-        return gkfs::rpc::cleanup_respond(&handle, &in, &out,
-                                          static_cast<hg_bulk_t*>(nullptr));
-    }
-    // access the internally allocated memory buffer and put it into buf_ptrs
-    uint32_t actual_count;
-    ret = margo_bulk_access(bulk_handle, 0, in.total_chunk_size,
-                            HG_BULK_READWRITE, 1, &bulk_buf,
-                            &in.total_chunk_size, &actual_count);
-    if(ret != HG_SUCCESS || actual_count != 1) {
-        GKFS_DATA->spdlogger()->error(
-                "{}() Failed to access allocated buffer from bulk handle",
-                __func__);
+    // pooled buffer which is returned after the response has been sent
+    gkfs::daemon::BulkBufferPool::Lease bulk_lease{};
+    hg_bulk_t local_bulk_handle = nullptr; // pooled or created bulk handle
+    ret = get_local_bulk(mid, in.total_chunk_size, bulk_lease, bulk_handle,
+                         local_bulk_handle, bulk_buf);
+    if(ret != HG_SUCCESS)
         return gkfs::rpc::cleanup_respond(&handle, &in, &out, &bulk_handle);
-    }
     auto const host_id = in.host_id;
     [[maybe_unused]] auto const host_size = in.host_size;
 
@@ -211,15 +443,64 @@ rpc_srv_write(hg_handle_t handle) {
      * 5. Last chunk (if multiple chunks are written): Don't write CHUNKSIZE but
      * chnk_size_left for this destination Last chunk can also happen if only
      * one chunk is written. This is covered by 2 and 3.
+     * Sizes are derived from the request and not from bulk_size because the
+     * remote bulk of a forwarding daemon may be larger than its data.
      */
     // temporary variables
-    auto transfer_size = (bulk_size <= gkfs::config::rpc::chunksize)
-                                 ? bulk_size
-                                 : gkfs::config::rpc::chunksize;
+    const auto chunksize = GKFS_DATA->chunksize();
+    auto transfer_size = std::min(chunksize, in.total_chunk_size);
     uint64_t origin_offset;
     uint64_t local_offset;
+    // number of chunks in the remote bulk preceding the current chunk
+    uint64_t origin_idx = 0;
     // object for asynchronous disk IO
     gkfs::data::ChunkWriteOperation chunk_op{in.path, in.chunk_n};
+    // in-flight PULL transfers in issue order with their chunk index
+    deque<pair<uint64_t, margo_request>> pulls{};
+    const auto pull_window =
+            std::max(static_cast<size_t>(1), GKFS_DATA->pull_window());
+    // error of transfers or task setup. No more transfers are issued on error
+    int pull_err = 0;
+    /*
+     * Completes the oldest in-flight PULL and starts the write task of its
+     * chunk. If block is false, the transfer is only completed if it has
+     * already finished. Returns true if a transfer was completed.
+     */
+    auto complete_pull = [&](bool block) {
+        auto [idx, req] = pulls.front();
+        if(!block) {
+            int finished = 0;
+            if(margo_test(req, &finished) == HG_SUCCESS && !finished)
+                return false;
+        }
+        pulls.pop_front();
+        auto margo_err = margo_wait(req);
+        if(margo_err != HG_SUCCESS) {
+            GKFS_DATA->spdlogger()->error(
+                    "{}() Failed to pull data from client. file {} chunk {} (startchunk {}; endchunk {}) margo err '{}'",
+                    __func__, in.path, chnk_ids_host[idx], in.chunk_start,
+                    (in.chunk_end - 1), margo_err);
+            pull_err = EBUSY;
+            return true;
+        }
+        // data is not written anymore if any transfer has failed
+        if(pull_err != 0)
+            return true;
+        try {
+            // start tasklet for writing chunk
+            chunk_op.write_nonblock(
+                    idx, chnk_ids_host[idx], bulk_buf_ptrs[idx],
+                    chnk_sizes[idx],
+                    (chnk_ids_host[idx] == in.chunk_start) ? in.offset : 0);
+        } catch(const gkfs::data::ChunkWriteOpException& e) {
+            // This exception is caused by setup of Argobots variables. If this
+            // fails, something is really wrong
+            GKFS_DATA->spdlogger()->error("{}() while write_nonblock err '{}'",
+                                          __func__, e.what());
+            pull_err = EIO;
+        }
+        return true;
+    };
 
     /*
      * 3. Calculate chunk sizes that correspond to this host, transfer data, and
@@ -228,17 +509,29 @@ rpc_srv_write(hg_handle_t handle) {
     // Start to look for a chunk that hashes to this host with the first chunk
     // in the buffer
     for(auto chnk_id_file = in.chunk_start;
-        chnk_id_file <= in.chunk_end && chnk_id_curr < in.chunk_n;
+        chnk_id_file <= in.chunk_end && chnk_id_curr < in.chunk_n &&
+        pull_err == 0;
         chnk_id_file++) {
+        auto chnk_rel = chnk_id_file - in.chunk_start;
+        auto in_origin = origin_all || origin_chunks.contains(chnk_rel);
+        auto chnk_origin_idx = origin_idx;
+        if(in_origin)
+            origin_idx++;
         // Continue if chunk does not hash to this host
 
-        if(!(gkfs::rpc::get_bitset(write_ops_vect,
-                                   chnk_id_file - in.chunk_start))) {
+        if(!host_chunks.contains(chnk_rel)) {
             GKFS_DATA->spdlogger()->trace(
                     "{}() chunkid '{}' ignored as it does not match to this host with id '{}'. chnk_id_curr '{}'",
                     __func__, chnk_id_file, host_id, chnk_id_curr);
             continue;
         }
+        if(!in_origin) {
+            GKFS_DATA->spdlogger()->error(
+                    "{}() chunk {} of file {} is not in the remote bulk",
+                    __func__, chnk_id_file, in.path);
+            pull_err = EINVAL;
+            break;
+        }
 
         if(GKFS_DATA->enable_chunkstats()) {
             GKFS_DATA->stats()->add_write(in.path, chnk_id_file);
@@ -251,24 +544,10 @@ rpc_srv_write(hg_handle_t handle) {
         if(chnk_id_file == in.chunk_start && in.offset > 0) {
             // if only 1 destination and 1 chunk (small write) the transfer_size
             // == bulk_size
-            size_t offset_transfer_size = 0;
-            if(in.offset + bulk_size <= gkfs::config::rpc::chunksize)
-                offset_transfer_size = bulk_size;
-            else
-                offset_transfer_size = static_cast<size_t>(
-                        gkfs::config::rpc::chunksize - in.offset);
-            ret = margo_bulk_transfer(mid, HG_BULK_PULL, hgi->addr,
-                                      in.bulk_handle, 0, bulk_handle, 0,
-                                      offset_transfer_size);
-            if(ret != HG_SUCCESS) {
-                GKFS_DATA->spdlogger()->error(
-                        "{}() Failed to pull data from client for chunk {} (startchunk {}; endchunk {}",
-                        __func__, chnk_id_file, in.chunk_start,
-                        in.chunk_end - 1);
-                out.err = EBUSY;
-                return gkfs::rpc::cleanup_respond(&handle, &in, &out,
-                                                  &bulk_handle);
-            }
+            auto offset_transfer_size =
+                    std::min(chunksize - in.offset, chnk_size_left_host);
+            origin_offset = 0;
+            local_offset = 0;
             bulk_buf_ptrs[chnk_id_curr] = chnk_ptr;
             chnk_sizes[chnk_id_curr] = offset_transfer_size;
             chnk_ptr += offset_transfer_size;
@@ -277,54 +556,52 @@ rpc_srv_write(hg_handle_t handle) {
             local_offset = in.total_chunk_size - chnk_size_left_host;
             // origin offset of a chunk is dependent on a given offset in a
             // write operation
-            if(in.offset > 0)
-                origin_offset = (gkfs::config::rpc::chunksize - in.offset) +
-                                ((chnk_id_file - in.chunk_start) - 1) *
-                                        gkfs::config::rpc::chunksize;
-            else
-                origin_offset = (chnk_id_file - in.chunk_start) *
-                                gkfs::config::rpc::chunksize;
+            origin_offset = chnk_origin_idx * chunksize;
+            if(origin_first && chnk_origin_idx > 0)
+                origin_offset -= in.offset;
             // last chunk might have different transfer_size
             if(chnk_id_curr == in.chunk_n - 1)
                 transfer_size = chnk_size_left_host;
-            GKFS_DATA->spdlogger()->trace(
-                    "{}() BULK_TRANSFER_PULL hostid {} file {} chnkid {} total_Csize {} Csize_left {} origin offset {} local offset {} transfersize {}",
-                    __func__, host_id, in.path, chnk_id_file,
-                    in.total_chunk_size, chnk_size_left_host, origin_offset,
-                    local_offset, transfer_size);
-            // RDMA the data to here
-            ret = margo_bulk_transfer(mid, HG_BULK_PULL, hgi->addr,
-                                      in.bulk_handle, origin_offset,
-                                      bulk_handle, local_offset, transfer_size);
-            if(ret != HG_SUCCESS) {
-                GKFS_DATA->spdlogger()->error(
-                        "{}() Failed to pull data from client. file {} chunk {} (startchunk {}; endchunk {})",
-                        __func__, in.path, chnk_id_file, in.chunk_start,
-                        (in.chunk_end - 1));
-                out.err = EBUSY;
-                return gkfs::rpc::cleanup_respond(&handle, &in, &out,
-                                                  &bulk_handle);
-            }
             bulk_buf_ptrs[chnk_id_curr] = chnk_ptr;
             chnk_sizes[chnk_id_curr] = transfer_size;
             chnk_ptr += transfer_size;
             chnk_size_left_host -= transfer_size;
         }
-        try {
-            // start tasklet for writing chunk
-            chunk_op.write_nonblock(
-                    chnk_id_curr, chnk_ids_host[chnk_id_curr],
-                    bulk_buf_ptrs[chnk_id_curr], chnk_sizes[chnk_id_curr],
-                    (chnk_id_file == in.chunk_start) ? in.offset : 0);
-        } catch(const gkfs::data::ChunkWriteOpException& e) {
-            // This exception is caused by setup of Argobots variables. If this
-            // fails, something is really wrong
-            GKFS_DATA->spdlogger()->error("{}() while write_nonblock err '{}'",
-                                          __func__, e.what());
-            return gkfs::rpc::cleanup_respond(&handle, &in, &out, &bulk_handle);
+        GKFS_DATA->spdlogger()->trace(
+                "{}() BULK_TRANSFER_PULL hostid {} file {} chnkid {} total_Csize {} Csize_left {} origin offset {} local offset {} transfersize {}",
+                __func__, host_id, in.path, chnk_id_file, in.total_chunk_size,
+                chnk_size_left_host, origin_offset, local_offset,
+                chnk_sizes[chnk_id_curr]);
+        // RDMA the data to here without waiting for the transfer to finish
+        margo_request req = MARGO_REQUEST_NULL;
+        ret = margo_bulk_itransfer(mid, HG_BULK_PULL, hgi->addr, in.bulk_handle,
+                                   origin_offset, local_bulk_handle,
+                                   local_offset, chnk_sizes[chnk_id_curr],
+                                   &req);
+        if(ret != HG_SUCCESS) {
+            GKFS_DATA->spdlogger()->error(
+                    "{}() Failed to pull data from client. file {} chunk {} (startchunk {}; endchunk {})",
+                    __func__, in.path, chnk_id_file, in.chunk_start,
+                    (in.chunk_end - 1));
+            pull_err = EBUSY;
+            break;
         }
+        pulls.emplace_back(chnk_id_curr, req);
         // next chunk
         chnk_id_curr++;
+        // start writing chunks whose transfer has already finished and block
+        // on the oldest transfer if the window is full
+        while(!pulls.empty() && complete_pull(pulls.size() >= pull_window)) {
+        }
+    }
+    // all transfers must be finished before the bulk buffer can be released
+    while(!pulls.empty())
+        complete_pull(true);
+    if(pull_err != 0) {
+        out.err = pull_err;
+        // wait for chunks in flight before freeing their buffers
+        chunk_op.cancel_all_tasks();
+        return gkfs::rpc::cleanup_respond(&handle, &in, &out, &bulk_handle);
     }
     // Sanity check that all chunks where detected in previous loop
     // TODO don't proceed if that happens.
@@ -333,7 +610,17 @@ rpc_srv_write(hg_handle_t handle) {
                 "{}() Not all chunks were detected!!! Size left {}", __func__,
                 chnk_size_left_host);
     /*
-     * 4. Read task results and accumulate in out.io_size
+     * 4. Forward the replicas of the chunks to their daemons, which pull them
+     * from the local buffer while the chunks are written locally
+     */
+    vector<replica_write> replica_writes{};
+    vector<uint32_t> replica_targets{};
+    if(in.replicas > 0)
+        replica_writes = forward_replicas(mid, in, host_chunks, chnk_ids_host,
+                                          chnk_sizes, chnk_id_curr,
+                                          local_bulk_handle, replica_targets);
+    /*
+     * 5. Read task results and accumulate in out.io_size
      */
     auto write_result = chunk_op.wait_for_tasks();
     out.err = write_result.first;
@@ -347,12 +634,42 @@ rpc_srv_write(hg_handle_t handle) {
     }
 
     /*
-     * 5. Respond and cleanup
+     * 6. Respond and cleanup. With replicas, the response is sent once each
+     * chunk has been written write_quorum times, including the local copy.
+     * The local buffer is released after all replica writes have finished.
      */
-    GKFS_DATA->spdlogger()->debug("{}() Sending output response {}", __func__,
-                                  out.err);
-    auto handler_ret =
-            gkfs::rpc::cleanup_respond(&handle, &in, &out, &bulk_handle);
+    hg_return_t handler_ret;
+    if(in.replicas > 0) {
+        auto quorum = in.write_quorum;
+        if(quorum == 0 || quorum > in.replicas + 1)
+            quorum = in.replicas + 1;
+        // a chunk cannot have more copies than distinct daemons storing it,
+        // e.g., with more replicas than daemons
+        vector<uint32_t> quorums(chnk_id_curr);
+        for(uint64_t idx = 0; idx < chnk_id_curr; idx++)
+            quorums[idx] = std::min(quorum, 1 + replica_targets[idx]);
+        vector<uint32_t> copies(chnk_id_curr, 1);
+        // A failed local write is reported regardless of the replicas. Reads
+        // try the primary copy first and would otherwise return stale data.
+        // The client's replica fallback handles the error.
+        if(out.err == 0 && !wait_for_replicas(replica_writes, copies, quorums))
+            out.err = EIO;
+        GKFS_DATA->spdlogger()->debug(
+                "{}() Sending output response {} with write quorum {}",
+                __func__, out.err, quorum);
+        handler_ret = gkfs::rpc::respond(&handle, &out);
+        wait_for_replicas(replica_writes, copies, {});
+        auto cleanup_ret = gkfs::rpc::cleanup(
+                &handle, &in, static_cast<rpc_data_out_t*>(nullptr),
+                &bulk_handle);
+        if(handler_ret == HG_SUCCESS)
+            handler_ret = cleanup_ret;
+    } else {
+        GKFS_DATA->spdlogger()->debug("{}() Sending output response {}",
+                                      __func__, out.err);
+        handler_ret =
+                gkfs::rpc::cleanup_respond(&handle, &in, &out, &bulk_handle);
+    }
     if(GKFS_DATA->enable_stats()) {
         GKFS_DATA->stats()->add_value_size(
                 gkfs::utils::Stats::SizeOp::write_size, bulk_size);
@@ -419,8 +736,17 @@ rpc_srv_read(hg_handle_t handle) {
             "{}() path: '{}' chunk_start '{}' chunk_end '{}' chunk_n '{}' total_chunk_size '{}' bulk_size: '{}' offset: '{}'",
             __func__, in.path, in.chunk_start, in.chunk_end, in.chunk_n,
             in.total_chunk_size, bulk_size, in.offset);
-    std::vector<uint8_t> read_bitset_vect =
-            gkfs::rpc::decompress_bitset(in.wbitset);
+    gkfs::rpc::ChunkSet host_chunks;
+    try {
+        host_chunks = gkfs::rpc::ChunkSet::decode(
+                static_cast<const uint8_t*>(in.chunk_set.data),
+                in.chunk_set.size);
+    } catch(const std::invalid_argument& e) {
+        GKFS_DATA->spdlogger()->error("{}() Invalid chunk set: '{}'", __func__,
+                                      e.what());
+        out.err = EINVAL;
+        return gkfs::rpc::cleanup_respond(&handle, &in, &out, &bulk_handle);
+    }
 #ifdef GKFS_ENABLE_AGIOS
     int* data;
     ABT_eventual eventual = ABT_EVENTUAL_NULL;
@@ -467,27 +793,13 @@ rpc_srv_read(hg_handle_t handle) {
      */
     void* bulk_buf;                          // buffer for bulk transfer
     vector<char*> bulk_buf_ptrs(in.chunk_n); // buffer-chunk offsets
-    // create bulk handle and allocated memory for buffer with buf_sizes
-    // information
-    ret = margo_bulk_create(mid, 1, nullptr, &in.total_chunk_size,
-                            HG_BULK_READWRITE, &bulk_handle);
-    if(ret != HG_SUCCESS) {
-        GKFS_DATA->spdlogger()->error("{}() Failed to create bulk handle",
-                                      __func__);
-        return gkfs::rpc::cleanup_respond(&handle, &in, &out,
-                                          static_cast<hg_bulk_t*>(nullptr));
-    }
-    // access the internally allocated memory buffer and put it into buf_ptrs
-    uint32_t actual_count;
-    ret = margo_bulk_access(bulk_handle, 0, in.total_chunk_size,
-                            HG_BULK_READWRITE, 1, &bulk_buf,
-                            &in.total_chunk_size, &actual_count);
-    if(ret != HG_SUCCESS || actual_count != 1) {
-        GKFS_DATA->spdlogger()->error(
-                "{}() Failed to access allocated buffer from bulk handle",
-                __func__);
+    // pooled buffer which is returned after the response has been sent
+    gkfs::daemon::BulkBufferPool::Lease bulk_lease{};
+    hg_bulk_t local_bulk_handle = nullptr; // pooled or created bulk handle
+    ret = get_local_bulk(mid, in.total_chunk_size, bulk_lease, bulk_handle,
+                         local_bulk_handle, bulk_buf);
+    if(ret != HG_SUCCESS)
         return gkfs::rpc::cleanup_respond(&handle, &in, &out, &bulk_handle);
-    }
 
     auto const host_id = in.host_id;
 
@@ -506,9 +818,8 @@ rpc_srv_read(hg_handle_t handle) {
     // temporary traveling pointer
     auto chnk_ptr = static_cast<char*>(bulk_buf);
     // temporary variables
-    auto transfer_size = (bulk_size <= gkfs::config::rpc::chunksize)
-                                 ? bulk_size
-                                 : gkfs::config::rpc::chunksize;
+    const auto chunksize = GKFS_DATA->chunksize();
+    auto transfer_size = (bulk_size <= chunksize) ? bulk_size : chunksize;
     // object for asynchronous disk IO
     gkfs::data::ChunkReadOperation chunk_read_op{in.path, in.chunk_n};
     /*
@@ -524,8 +835,7 @@ rpc_srv_read(hg_handle_t handle) {
 
         // We only check if we are not using replicas
 
-        if(!(gkfs::rpc::get_bitset(read_bitset_vect,
-                                   chnk_id_file - in.chunk_start))) {
+        if(!host_chunks.contains(chnk_id_file - in.chunk_start)) {
             GKFS_DATA->spdlogger()->trace(
                     "{}() chunkid '{}' ignored as it does not match to this host with id '{}'. chnk_id_curr '{}'",
                     __func__, chnk_id_file, host_id, chnk_id_curr);
@@ -544,11 +854,11 @@ rpc_srv_read(hg_handle_t handle) {
             // if only 1 destination and 1 chunk (small read) the transfer_size
             // == bulk_size
             size_t offset_transfer_size = 0;
-            if(in.offset + bulk_size <= gkfs::config::rpc::chunksize)
+            if(in.offset + bulk_size <= chunksize)
                 offset_transfer_size = bulk_size;
             else
-                offset_transfer_size = static_cast<size_t>(
-                        gkfs::config::rpc::chunksize - in.offset);
+                offset_transfer_size =
+                        static_cast<size_t>(chunksize - in.offset);
             // Setting later transfer offsets
             local_offsets[chnk_id_curr] = 0;
             origin_offsets[chnk_id_curr] = 0;
@@ -564,12 +874,11 @@ rpc_srv_read(hg_handle_t handle) {
             // write operation
             if(in.offset > 0)
                 origin_offsets[chnk_id_curr] =
-                        (gkfs::config::rpc::chunksize - in.offset) +
-                        ((chnk_id_file - in.chunk_start) - 1) *
-                                gkfs::config::rpc::chunksize;
+                        (chunksize - in.offset) +
+                        ((chnk_id_file - in.chunk_start) - 1) * chunksize;
             else
-                origin_offsets[chnk_id_curr] = (chnk_id_file - in.chunk_start) *
-                                               gkfs::config::rpc::chunksize;
+                origin_offsets[chnk_id_curr] =
+                        (chnk_id_file - in.chunk_start) * chunksize;
             // last chunk might have different transfer_size
             if(chnk_id_curr == in.chunk_n - 1)
                 transfer_size = chnk_size_left_host;
@@ -590,6 +899,7 @@ rpc_srv_read(hg_handle_t handle) {
             // fails, something is really wrong
             GKFS_DATA->spdlogger()->error("{}() while read_nonblock err '{}'",
                                           __func__, e.what());
+            chunk_read_op.cancel_all_tasks();
             return gkfs::rpc::cleanup_respond(&handle, &in, &out, &bulk_handle);
         }
         chnk_id_curr++;
@@ -613,7 +923,7 @@ rpc_srv_read(hg_handle_t handle) {
     bulk_args.origin_addr = hgi->addr;
     bulk_args.origin_bulk_handle = in.bulk_handle;
     bulk_args.origin_offsets = &origin_offsets;
-    bulk_args.local_bulk_handle = bulk_handle;
+    bulk_args.local_bulk_handle = local_bulk_handle;
     bulk_args.local_offsets = &local_offsets;
     bulk_args.chunk_ids = &chnk_ids_host;
     // wait for all tasklets and push read data back to client
@@ -719,6 +1029,54 @@ rpc_srv_get_chunk_stat(hg_handle_t handle) {
     return gkfs::rpc::cleanup_respond(&handle, &out);
 }
 
+/**
+ * @brief Serves a flush request of a file, e.g., on fsync(), and flushes all
+ * corresponding chunks on this daemon to the storage device.
+ * @internal
+ * The sync depends on the daemon's durability mode. With "none", the request
+ * is acknowledged without syncing. Concurrent flushes of the same file are
+ * batched into one sync by the chunk storage.
+ *
+ * All exceptions must be caught here and dealt with accordingly.
+ * @endinteral
+ * @param handle Mercury RPC handle
+ * @return Mercury error code to Mercury
+ */
+hg_return_t
+rpc_srv_fsync(hg_handle_t handle) {
+    rpc_path_only_in_t in{};
+    rpc_err_out_t out{};
+    out.err = EIO;
+    auto ret = margo_get_input(handle, &in);
+    if(ret != HG_SUCCESS) {
+        GKFS_DATA->spdlogger()->error(
+                "{}() Could not get RPC input data with err {}", __func__, ret);
+        return gkfs::rpc::cleanup_respond(&handle, &in, &out);
+    }
+    GKFS_DATA->spdlogger()->debug("{}() path: '{}'", __func__, in.path);
+    try {
+        if(GKFS_DATA->durability() != gkfs::data::durability_none) {
+            if(auto log = GKFS_DATA->log_store())
+                log->sync_chunk_space(in.path);
+            else
+                GKFS_DATA->storage()->sync_chunk_space(in.path);
+        }
+        out.err = 0;
+    } catch(const gkfs::data::ChunkStorageException& err) {
+        GKFS_DATA->spdlogger()->error("{}() {}", __func__, err.what());
+        out.err = err.code().value();
+    } catch(const ::exception& err) {
+        GKFS_DATA->spdlogger()->error(
+                "{}() Unexpected error when syncing '{}'", __func__,
+                err.what());
+        out.err = EIO;
+    }
+
+    GKFS_DATA->spdlogger()->debug("{}() Sending output response '{}'", __func__,
+                                  out.err);
+    return gkfs::rpc::cleanup_respond(&handle, &in, &out);
+}
+
 } // namespace
 
 DEFINE_MARGO_RPC_HANDLER(rpc_srv_write)
@@ -729,6 +1087,8 @@ DEFINE_MARGO_RPC_HANDLER(rpc_srv_truncate)
 
 DEFINE_MARGO_RPC_HANDLER(rpc_srv_get_chunk_stat)
 
+DEFINE_MARGO_RPC_HANDLER(rpc_srv_fsync)
+
 #ifdef GKFS_ENABLE_AGIOS
 void*
 agios_eventual_callback(int64_t request_id, void* info) {
@@ -72,6 +72,10 @@ rpc_srv_get_fs_config(hg_handle_t handle) {
     out.blocks_state = static_cast<hg_bool_t>(GKFS_DATA->blocks_state());
     out.uid = getuid();
     out.gid = getgid();
+    out.inline_data_size = GKFS_DATA->inline_data_size();
+    out.chunksize = GKFS_DATA->chunksize();
+    out.ec_data_shards = GKFS_DATA->ec_data_shards();
+    out.ec_parity_shards = GKFS_DATA->ec_parity_shards();
     GKFS_DATA->spdlogger()->debug("{}() Sending output configs back to library",
                                   __func__);
     auto hret = margo_respond(handle, &out);
@@ -38,6 +38,7 @@
 #include <daemon/handler/rpc_util.hpp>
 #include <daemon/backend/metadata/db.hpp>
 #include <daemon/backend/data/chunk_storage.hpp>
+#include <daemon/backend/data/log_store.hpp>
 #include <daemon/ops/metadentry.hpp>
 
 #include <common/rpc/rpc_types.hpp>
@@ -188,7 +189,7 @@ rpc_srv_decr_size(hg_handle_t handle) {
                                   in.path, in.length);
 
     try {
-        GKFS_DATA->mdb()->decrease_size(in.path, in.length);
+        gkfs::metadata::decrease_size(in.path, in.length);
         out.err = 0;
     } catch(const std::exception& e) {
         GKFS_DATA->spdlogger()->error("{}() Failed to decrease size: '{}'",
@@ -249,8 +250,12 @@ rpc_srv_remove_metadata(hg_handle_t handle) {
         out.mode = md.mode();
         out.size = md.size();
         if constexpr(gkfs::config::metadata::implicit_data_removal) {
-            if(S_ISREG(md.mode()) && (md.size() != 0))
-                GKFS_DATA->storage()->destroy_chunk_space(in.path);
+            if(S_ISREG(md.mode()) && (md.size() != 0)) {
+                if(auto log = GKFS_DATA->log_store())
+                    log->destroy_chunk_space(in.path);
+                else
+                    GKFS_DATA->storage()->destroy_chunk_space(in.path);
+            }
         }
 
     } catch(const gkfs::metadata::DBException& e) {
@@ -311,7 +316,10 @@ rpc_srv_remove_data(hg_handle_t handle) {
 
     // Remove all chunks for that file
     try {
-        GKFS_DATA->storage()->destroy_chunk_space(in.path);
+        if(auto log = GKFS_DATA->log_store())
+            log->destroy_chunk_space(in.path);
+        else
+            GKFS_DATA->storage()->destroy_chunk_space(in.path);
         out.err = 0;
     } catch(const gkfs::data::ChunkStorageException& e) {
         GKFS_DATA->spdlogger()->error(
@@ -428,6 +436,9 @@ rpc_srv_update_metadentry_size(hg_handle_t handle) {
         GKFS_DATA->spdlogger()->debug("{}() Entry not found: '{}'", __func__,
                                       in.path);
         out.err = ENOENT;
+    } catch(const gkfs::metadata::InlineDataException& e) {
+        GKFS_DATA->spdlogger()->debug("{}() {}", __func__, e.what());
+        out.err = gkfs::rpc::inline_data_err;
     } catch(const std::exception& e) {
         GKFS_DATA->spdlogger()->error(
                 "{}() Failed to update metadentry size on DB: '{}'", __func__,
@@ -448,6 +459,207 @@ rpc_srv_update_metadentry_size(hg_handle_t handle) {
     return HG_SUCCESS;
 }
 
+/**
+ * @brief Serves a request to write data inline into a file's metadentry.
+ * @internal
+ * The data is pulled from the client before the metadentry is checked. If the
+ * file's data is not stored inline (or cannot be after this write), the
+ * inline data error is returned and the client writes to the file's chunks
+ * instead. Otherwise, the returned offset is that of the write, which differs
+ * from the input offset for appends.
+ *
+ * All exceptions must be caught here and dealt with accordingly. Any errors are
+ * placed in the response.
+ * @endinteral
+ * @param handle Mercury RPC handle
+ * @return Mercury error code to Mercury
+ */
+hg_return_t
+rpc_srv_write_inline(hg_handle_t handle) {
+    rpc_write_inline_in_t in{};
+    rpc_update_metadentry_size_out_t out{};
+    out.err = EIO;
+    hg_bulk_t bulk_handle = nullptr;
+
+    auto ret = margo_get_input(handle, &in);
+    if(ret != HG_SUCCESS) {
+        GKFS_DATA->spdlogger()->error(
+                "{}() Could not get RPC input data with err '{}'", __func__,
+                ret);
+        out.err = EBUSY;
+        return gkfs::rpc::cleanup_respond(&handle, &in, &out);
+    }
+    GKFS_DATA->spdlogger()->debug(
+            "{}() path: '{}', count: '{}', offset: '{}', append: '{}'",
+            __func__, in.path, in.count, in.offset, in.append);
+
+    if(in.count > GKFS_DATA->inline_data_size()) {
+        out.err = gkfs::rpc::inline_data_err;
+        return gkfs::rpc::cleanup_respond(&handle, &in, &out);
+    }
+    vector<char> buf(in.count);
+    if(in.count > 0) {
+        auto hgi = margo_get_info(handle);
+        auto mid = margo_hg_info_get_instance(hgi);
+        void* buf_ptr = buf.data();
+        hg_size_t buf_size = in.count;
+        ret = margo_bulk_create(mid, 1, &buf_ptr, &buf_size,
+                                HG_BULK_WRITE_ONLY, &bulk_handle);
+        if(ret != HG_SUCCESS) {
+            GKFS_DATA->spdlogger()->error("{}() Failed to create bulk handle",
+                                          __func__);
+            return gkfs::rpc::cleanup_respond(&handle, &in, &out,
+                                              &bulk_handle);
+        }
+        ret = margo_bulk_transfer(mid, HG_BULK_PULL, hgi->addr, in.bulk_handle,
+                                  0, bulk_handle, 0, buf_size);
+        if(ret != HG_SUCCESS) {
+            GKFS_DATA->spdlogger()->error(
+                    "{}() Failed to pull '{}' bytes of path '{}' from client",
+                    __func__, buf_size, in.path);
+            out.err = EBUSY;
+            return gkfs::rpc::cleanup_respond(&handle, &in, &out,
+                                              &bulk_handle);
+        }
+    }
+
+    try {
+        off64_t offset = in.offset;
+        if(gkfs::metadata::write_inline(in.path, buf.data(), in.count, offset,
+                                        in.append == HG_TRUE)) {
+            out.ret_offset = offset;
+            out.err = 0;
+        } else {
+            out.err = gkfs::rpc::inline_data_err;
+        }
+    } catch(const gkfs::metadata::NotFoundException& e) {
+        GKFS_DATA->spdlogger()->debug("{}() Entry not found: '{}'", __func__,
+                                      in.path);
+        out.err = ENOENT;
+    } catch(const std::exception& e) {
+        GKFS_DATA->spdlogger()->error("{}() Failed to write inline data: '{}'",
+                                      __func__, e.what());
+        out.err = EIO;
+    }
+
+    GKFS_DATA->spdlogger()->debug("{}() Sending output err '{}'", __func__,
+                                  out.err);
+    return gkfs::rpc::cleanup_respond(&handle, &in, &out, &bulk_handle);
+}
+
+/**
+ * @brief Serves a request to read data stored inline in a file's metadentry.
+ * @internal
+ * Returns the inline data error if the file's data is not stored inline.
+ *
+ * With spill set, the client has written the inline data to the file's chunks
+ * and the request commits the move instead: The daemon pulls the client's copy
+ * of the data and removes the inline data from the metadentry if it is
+ * unchanged. Otherwise, EAGAIN is returned and the client repeats the move.
+ * The inline data is thus kept until it is stored in the chunks.
+ *
+ * All exceptions must be caught here and dealt with accordingly. Any errors are
+ * placed in the response.
+ * @endinteral
+ * @param handle Mercury RPC handle
+ * @return Mercury error code to Mercury
+ */
+hg_return_t
+rpc_srv_read_inline(hg_handle_t handle) {
+    rpc_read_inline_in_t in{};
+    rpc_data_out_t out{};
+    out.err = EIO;
+    out.io_size = 0;
+    hg_bulk_t bulk_handle = nullptr;
+
+    auto ret = margo_get_input(handle, &in);
+    if(ret != HG_SUCCESS) {
+        GKFS_DATA->spdlogger()->error(
+                "{}() Could not get RPC input data with err '{}'", __func__,
+                ret);
+        out.err = EBUSY;
+        return gkfs::rpc::cleanup_respond(&handle, &in, &out);
+    }
+    GKFS_DATA->spdlogger()->debug(
+            "{}() path: '{}', count: '{}', offset: '{}', spill: '{}'", __func__,
+            in.path, in.count, in.offset, in.spill);
+
+    string data{};
+    auto hgi = margo_get_info(handle);
+    auto mid = margo_hg_info_get_instance(hgi);
+    if(in.spill == HG_TRUE) {
+        if(in.count == 0 || in.count > GKFS_DATA->inline_data_size()) {
+            out.err = EINVAL;
+            return gkfs::rpc::cleanup_respond(&handle, &in, &out);
+        }
+        data.resize(in.count);
+        void* buf_ptr = data.data();
+        hg_size_t buf_size = data.size();
+        ret = margo_bulk_create(mid, 1, &buf_ptr, &buf_size,
+                                HG_BULK_WRITE_ONLY, &bulk_handle);
+        if(ret == HG_SUCCESS)
+            ret = margo_bulk_transfer(mid, HG_BULK_PULL, hgi->addr,
+                                      in.bulk_handle, 0, bulk_handle, 0,
+                                      buf_size);
+        if(ret != HG_SUCCESS) {
+            GKFS_DATA->spdlogger()->error(
+                    "{}() Failed to pull '{}' bytes of path '{}' from client",
+                    __func__, buf_size, in.path);
+            out.err = EBUSY;
+            return gkfs::rpc::cleanup_respond(&handle, &in, &out,
+                                              &bulk_handle);
+        }
+    }
+
+    try {
+        if(in.spill == HG_TRUE) {
+            out.err = gkfs::metadata::spill_inline(in.path, data) ? 0 : EAGAIN;
+            GKFS_DATA->spdlogger()->debug("{}() Sending output err '{}'",
+                                          __func__, out.err);
+            return gkfs::rpc::cleanup_respond(&handle, &in, &out,
+                                              &bulk_handle);
+        }
+        if(!gkfs::metadata::read_inline(in.path, in.offset, in.count, data)) {
+            out.err = gkfs::rpc::inline_data_err;
+            return gkfs::rpc::cleanup_respond(&handle, &in, &out);
+        }
+    } catch(const gkfs::metadata::NotFoundException& e) {
+        GKFS_DATA->spdlogger()->debug("{}() Entry not found: '{}'", __func__,
+                                      in.path);
+        out.err = ENOENT;
+        return gkfs::rpc::cleanup_respond(&handle, &in, &out, &bulk_handle);
+    } catch(const std::exception& e) {
+        GKFS_DATA->spdlogger()->error("{}() Failed to access inline data: '{}'",
+                                      __func__, e.what());
+        return gkfs::rpc::cleanup_respond(&handle, &in, &out, &bulk_handle);
+    }
+
+    if(!data.empty()) {
+        void* buf_ptr = data.data();
+        hg_size_t buf_size = data.size();
+        ret = margo_bulk_create(mid, 1, &buf_ptr, &buf_size, HG_BULK_READ_ONLY,
+                                &bulk_handle);
+        if(ret == HG_SUCCESS)
+            ret = margo_bulk_transfer(mid, HG_BULK_PUSH, hgi->addr,
+                                      in.bulk_handle, 0, bulk_handle, 0,
+                                      buf_size);
+        if(ret != HG_SUCCESS) {
+            GKFS_DATA->spdlogger()->error(
+                    "{}() Failed to push '{}' bytes of path '{}' to client",
+                    __func__, buf_size, in.path);
+            out.err = EBUSY;
+            return gkfs::rpc::cleanup_respond(&handle, &in, &out,
+                                              &bulk_handle);
+        }
+    }
+
+    out.io_size = data.size();
+    out.err = 0;
+    GKFS_DATA->spdlogger()->debug("{}() Sending output err '{}' io_size '{}'",
+                                  __func__, out.err, out.io_size);
+    return gkfs::rpc::cleanup_respond(&handle, &in, &out, &bulk_handle);
+}
+
 /**
  * @brief Serves a request to return the current file size.
  * @internal
@@ -906,6 +1118,10 @@ DEFINE_MARGO_RPC_HANDLER(rpc_srv_update_metadentry_size)
 
 DEFINE_MARGO_RPC_HANDLER(rpc_srv_get_metadentry_size)
 
+DEFINE_MARGO_RPC_HANDLER(rpc_srv_write_inline)
+
+DEFINE_MARGO_RPC_HANDLER(rpc_srv_read_inline)
+
 DEFINE_MARGO_RPC_HANDLER(rpc_srv_get_dirents)
 
 DEFINE_MARGO_RPC_HANDLER(rpc_srv_get_dirents_extended)
@@ -31,7 +31,9 @@
 
 #include <daemon/ops/data.hpp>
 #include <daemon/backend/data/chunk_storage.hpp>
+#include <daemon/backend/data/log_store.hpp>
 #include <common/arithmetic/arithmetic.hpp>
+#include <algorithm>
 #include <utility>
 
 extern "C" {
@@ -72,15 +74,22 @@ ChunkTruncateOperation::truncate_abt(void* _arg) {
     int err_response = 0;
     try {
         // get chunk from where to cut off
-        auto chunk_id_start = block_index(size, gkfs::config::rpc::chunksize);
+        auto chunk_id_start = block_index(size, GKFS_DATA->chunksize());
         // do not last delete chunk if it is in the middle of a chunk
-        auto left_pad = block_overrun(size, gkfs::config::rpc::chunksize);
+        auto left_pad = block_overrun(size, GKFS_DATA->chunksize());
+        auto log = GKFS_DATA->log_store();
         if(left_pad != 0) {
-            GKFS_DATA->storage()->truncate_chunk_file(path, chunk_id_start,
-                                                      left_pad);
+            if(log)
+                log->truncate_chunk_file(path, chunk_id_start, left_pad);
+            else
+                GKFS_DATA->storage()->truncate_chunk_file(path, chunk_id_start,
+                                                          left_pad);
             chunk_id_start++;
         }
-        GKFS_DATA->storage()->trim_chunk_space(path, chunk_id_start);
+        if(log)
+            log->trim_chunk_space(path, chunk_id_start);
+        else
+            GKFS_DATA->storage()->trim_chunk_space(path, chunk_id_start);
     } catch(const ChunkStorageException& err) {
         GKFS_DATA->spdlogger()->error("{}() {}", __func__, err.what());
         err_response = err.code().value();
@@ -189,8 +198,12 @@ ChunkWriteOperation::write_file_abt(void* _arg) {
     const string& path = *(arg->path);
     ssize_t wrote{0};
     try {
-        wrote = GKFS_DATA->storage()->write_chunk(path, arg->chnk_id, arg->buf,
-                                                  arg->size, arg->off);
+        if(auto log = GKFS_DATA->log_store())
+            wrote = log->write_chunk(path, arg->chnk_id, arg->buf, arg->size,
+                                     arg->off);
+        else
+            wrote = GKFS_DATA->storage()->write_chunk(
+                    path, arg->chnk_id, arg->buf, arg->size, arg->off);
     } catch(const ChunkStorageException& err) {
         GKFS_DATA->spdlogger()->error("{}() {}", __func__, err.what());
         wrote = -(err.code().value());
@@ -211,6 +224,7 @@ ChunkWriteOperation::clear_task_args() {
 ChunkWriteOperation::ChunkWriteOperation(const string& path, size_t n)
     : ChunkOperation{path, n} {
     task_args_.resize(n);
+    use_uring_ = RPC_DATA->uring_engine() != nullptr;
 }
 
 /**
@@ -247,6 +261,17 @@ ChunkWriteOperation::write_nonblock(size_t idx, const uint64_t chunk_id,
     task_arg.off = offset;
     task_arg.eventual = task_eventuals_[idx];
 
+#ifdef GKFS_ENABLE_IO_URING
+    if(use_uring_) {
+        // submitted right away, as the write handler queues each chunk once
+        // its transfer has finished while later chunks are still pulled
+        RPC_DATA->uring_engine()->write_nonblock(path_, chunk_id, bulk_buf_ptr,
+                                                 size, offset,
+                                                 task_eventuals_[idx]);
+        RPC_DATA->uring_engine()->submit();
+        return;
+    }
+#endif
     abt_err = ABT_task_create(RPC_DATA->io_pool(), write_file_abt,
                               &task_args_[idx], &abt_tasks_[idx]);
     if(abt_err != ABT_SUCCESS) {
@@ -263,6 +288,10 @@ ChunkWriteOperation::wait_for_tasks() {
                                   __func__, path_);
     size_t total_written = 0;
     int io_err = 0;
+#ifdef GKFS_ENABLE_IO_URING
+    if(use_uring_)
+        RPC_DATA->uring_engine()->submit();
+#endif
     /*
      * gather all Eventual's information. do not throw here to properly cleanup
      * all eventuals On error, cleanup eventuals and set written data to 0 as
@@ -326,8 +355,13 @@ ChunkReadOperation::read_file_abt(void* _arg) {
     try {
         // Under expected circumstances (error or no error) read_chunk will
         // signal the eventual
-        read = GKFS_DATA->storage()->read_chunk(path, arg->chnk_id, arg->buf,
-                                                arg->size, arg->off);
+        if(auto log = GKFS_DATA->log_store())
+            read = log->read_chunk(path, arg->chnk_id, arg->buf, arg->size,
+                                   arg->off);
+        else
+            read = GKFS_DATA->storage()->read_chunk(path, arg->chnk_id,
+                                                    arg->buf, arg->size,
+                                                    arg->off);
     } catch(const ChunkStorageException& err) {
         GKFS_DATA->spdlogger()->error("{}() {}", __func__, err.what());
         read = -(err.code().value());
@@ -348,6 +382,7 @@ ChunkReadOperation::clear_task_args() {
 ChunkReadOperation::ChunkReadOperation(const string& path, size_t n)
     : ChunkOperation{path, n} {
     task_args_.resize(n);
+    use_uring_ = RPC_DATA->uring_engine() != nullptr;
 }
 
 /**
@@ -383,6 +418,15 @@ ChunkReadOperation::read_nonblock(size_t idx, const uint64_t chunk_id,
     task_arg.off = offset;
     task_arg.eventual = task_eventuals_[idx];
 
+#ifdef GKFS_ENABLE_IO_URING
+    if(use_uring_) {
+        // submitted in wait_for_tasks_and_push_back() with all other chunks
+        RPC_DATA->uring_engine()->read_nonblock(path_, chunk_id, bulk_buf_ptr,
+                                                size, offset,
+                                                task_eventuals_[idx]);
+        return;
+    }
+#endif
     abt_err = ABT_task_create(RPC_DATA->io_pool(), read_file_abt,
                               &task_args_[idx], &abt_tasks_[idx]);
     if(abt_err != ABT_SUCCESS) {
@@ -393,6 +437,20 @@ ChunkReadOperation::read_nonblock(size_t idx, const uint64_t chunk_id,
     }
 }
 
+/**
+ * @internal
+ * Chunks are pushed back in the order their read tasks complete rather than in
+ * index order, so that a slow chunk does not stall all chunks behind it. Up to
+ * the configured push window of non-blocking PUSH transfers are in flight at
+ * the same time.
+ *
+ * Ready tasks are found by testing all pending eventuals. If nothing has
+ * finished, the handler blocks on the first pending eventual if no PUSH is in
+ * flight, and on the PUSH transfers if no task is pending. As eventuals and
+ * transfers cannot be waited for together, it otherwise sleeps for the push
+ * poll interval so that it does not occupy its execution stream.
+ * @endinternal
+ */
 pair<int, size_t>
 ChunkReadOperation::wait_for_tasks_and_push_back(const bulk_args& args) {
     GKFS_DATA->spdlogger()->trace("ChunkReadOperation::{}() enter: path '{}'",
@@ -400,6 +458,50 @@ ChunkReadOperation::wait_for_tasks_and_push_back(const bulk_args& args) {
     assert(args.chunk_ids->size() == task_args_.size());
     size_t total_read = 0;
     int io_err = 0;
+#ifdef GKFS_ENABLE_IO_URING
+    if(use_uring_)
+        RPC_DATA->uring_engine()->submit();
+#endif
+    const auto push_window =
+            std::max(static_cast<size_t>(1), GKFS_DATA->push_window());
+    // indices of tasks that have not been processed yet
+    vector<uint64_t> pending(task_args_.size());
+    for(uint64_t idx = 0; idx < pending.size(); idx++)
+        pending[idx] = idx;
+    // in-flight PUSH transfers and the size they transfer
+    vector<margo_request> pushes{};
+    vector<size_t> push_sizes{};
+
+    // completes the in-flight PUSH at position pos that was waited for
+    auto complete_push = [&](size_t pos, hg_return_t margo_err) {
+        if(margo_err != HG_SUCCESS) {
+            GKFS_DATA->spdlogger()->error(
+                    "ChunkReadOperation::{}() Failed to margo_bulk_transfer with margo err: '{}'",
+                    __func__, margo_err);
+            io_err = EBUSY;
+        } else {
+            total_read += push_sizes[pos];
+        }
+        pushes.erase(pushes.begin() + pos);
+        push_sizes.erase(push_sizes.begin() + pos);
+    };
+    // waits for any in-flight PUSH to finish and completes it
+    auto wait_any_push = [&]() {
+        size_t pos = 0;
+        auto margo_err = margo_wait_any(pushes.size(), pushes.data(), &pos);
+        if(pos >= pushes.size()) {
+            GKFS_DATA->spdlogger()->error(
+                    "ChunkReadOperation::{}() Failed to wait for any PUSH with margo err: '{}'",
+                    __func__, margo_err);
+            // the oldest transfer must still be waited for
+            pos = 0;
+            margo_err = margo_wait(pushes[pos]);
+            if(margo_err == HG_SUCCESS)
+                margo_err = HG_OTHER_ERROR;
+        }
+        // margo_wait_any() has waited for the request at pos
+        complete_push(pos, margo_err);
+    };
 
     /*
      * gather all Eventual's information. do not throw here to properly cleanup
@@ -407,49 +509,60 @@ ChunkReadOperation::wait_for_tasks_and_push_back(const bulk_args& args) {
      * longer be executed as the data would be corrupted The loop continues
      * until all eventuals have been cleaned and freed.
      */
-    for(uint64_t idx = 0; idx < task_args_.size(); idx++) {
-        ssize_t* task_size = nullptr;
-        auto abt_err =
-                ABT_eventual_wait(task_eventuals_[idx], (void**) &task_size);
-        if(abt_err != ABT_SUCCESS) {
-            GKFS_DATA->spdlogger()->error(
-                    "ChunkReadOperation::{}() Error when waiting on ABT eventual",
-                    __func__);
-            io_err = EIO;
-            ABT_eventual_free(&task_eventuals_[idx]);
-            continue;
-        }
-        // error occured. stop processing but clean up
-        if(io_err != 0) {
-            ABT_eventual_free(&task_eventuals_[idx]);
-            continue;
-        }
-        assert(task_size != nullptr);
-        if(*task_size < 0) {
-            // sparse regions do not have chunk files and are therefore skipped
-            if(-(*task_size) == ENOENT) {
+    while(!pending.empty() || !pushes.empty()) {
+        bool progress = false;
+        for(auto it = pending.begin(); it != pending.end();) {
+            auto idx = *it;
+            ssize_t* task_size = nullptr;
+            ABT_bool ready = ABT_FALSE;
+            auto abt_err = ABT_eventual_test(task_eventuals_[idx],
+                                             (void**) &task_size, &ready);
+            if(abt_err == ABT_SUCCESS && ready == ABT_FALSE) {
+                ++it;
+                continue;
+            }
+            progress = true;
+            it = pending.erase(it);
+            if(abt_err != ABT_SUCCESS) {
+                GKFS_DATA->spdlogger()->error(
+                        "ChunkReadOperation::{}() Error when waiting on ABT eventual",
+                        __func__);
+                io_err = EIO;
                 ABT_eventual_free(&task_eventuals_[idx]);
                 continue;
             }
-            io_err = -(*task_size); // make error code > 0
-        } else if(*task_size == 0) {
-            // read size of 0 is not an error and can happen because reading the
-            // end-of-file
+            assert(task_size != nullptr);
+            auto size = *task_size;
             ABT_eventual_free(&task_eventuals_[idx]);
-            continue;
-        } else {
+            // error occured. stop processing but clean up
+            if(io_err != 0)
+                continue;
+            if(size < 0) {
+                // sparse regions do not have chunk files and are therefore
+                // skipped
+                if(-size != ENOENT)
+                    io_err = -size; // make error code > 0
+                continue;
+            }
+            // read size of 0 is not an error and can happen because reading
+            // the end-of-file
+            if(size == 0)
+                continue;
             // successful case, push read data back to client
             GKFS_DATA->spdlogger()->trace(
                     "ChunkReadOperation::{}() BULK_TRANSFER_PUSH file '{}' chnkid '{}' origin offset '{}' local offset '{}' transfersize '{}'",
                     __func__, path_, args.chunk_ids->at(idx),
                     args.origin_offsets->at(idx), args.local_offsets->at(idx),
-                    *task_size);
+                    size);
             assert(task_args_[idx].chnk_id == args.chunk_ids->at(idx));
-            auto margo_err = margo_bulk_transfer(
+            if(pushes.size() >= push_window)
+                wait_any_push();
+            margo_request req = MARGO_REQUEST_NULL;
+            auto margo_err = margo_bulk_itransfer(
                     args.mid, HG_BULK_PUSH, args.origin_addr,
                     args.origin_bulk_handle, args.origin_offsets->at(idx),
-                    args.local_bulk_handle, args.local_offsets->at(idx),
-                    *task_size);
+                    args.local_bulk_handle, args.local_offsets->at(idx), size,
+                    &req);
             if(margo_err != HG_SUCCESS) {
                 GKFS_DATA->spdlogger()->error(
                         "ChunkReadOperation::{}() Failed to margo_bulk_transfer with margo err: '{}'",
@@ -457,9 +570,31 @@ ChunkReadOperation::wait_for_tasks_and_push_back(const bulk_args& args) {
                 io_err = EBUSY;
                 continue;
             }
-            total_read += *task_size;
+            pushes.push_back(req);
+            push_sizes.push_back(static_cast<size_t>(size));
+        }
+        // collect finished PUSH transfers
+        for(size_t pos = 0; pos < pushes.size();) {
+            int finished = 0;
+            if(margo_test(pushes[pos], &finished) == HG_SUCCESS && !finished) {
+                pos++;
+                continue;
+            }
+            progress = true;
+            complete_push(pos, margo_wait(pushes[pos]));
+        }
+        if(progress)
+            continue;
+        if(pushes.empty()) {
+            // nothing else to do than waiting for the next task
+            ABT_eventual_wait(task_eventuals_[pending.front()], nullptr);
+        } else if(pending.empty()) {
+            wait_any_push();
+        } else {
+            margo_thread_sleep(
+                    args.mid,
+                    gkfs::config::rpc::daemon_push_poll_interval_ms);
         }
-        ABT_eventual_free(&task_eventuals_[idx]);
     }
     // in case of error set read size to zero as data would be corrupted
     if(io_err != 0)
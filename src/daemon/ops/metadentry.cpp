@@ -31,10 +31,27 @@
 #include <daemon/backend/data/chunk_storage.hpp>
 #include <daemon/backend/metadata/metadata_module.hpp>
 
+#include <array>
+#include <mutex>
+
 using namespace std;
 
 namespace gkfs::metadata {
 
+namespace {
+
+/**
+ * @brief Returns the mutex serializing the size and inline data updates of a
+ * file. Only used if inline data is enabled.
+ */
+mutex&
+inline_mutex(const string& path) {
+    static array<mutex, gkfs::config::metadata::inline_lock_stripes> mutexes;
+    return mutexes[hash<string>{}(path) % mutexes.size()];
+}
+
+} // namespace
+
 Metadata
 get(const std::string& path) {
     return Metadata(get_str(path));
@@ -100,9 +117,94 @@ update(const string& path, Metadata& md) {
  */
 off_t
 update_size(const string& path, size_t io_size, off64_t offset, bool append) {
+    if(GKFS_DATA->inline_data_size() == 0)
+        return GKFS_DATA->mdb()->increase_size(path, io_size, offset, append);
+    // data written to chunks would be hidden by the inline data
+    lock_guard<mutex> lock(inline_mutex(path));
+    if(!get(path).inline_data().empty())
+        throw InlineDataException(
+                fmt::format("Data of '{}' is stored inline", path));
     return GKFS_DATA->mdb()->increase_size(path, io_size, offset, append);
 }
 
+void
+decrease_size(const string& path, size_t size) {
+    if(GKFS_DATA->inline_data_size() == 0) {
+        GKFS_DATA->mdb()->decrease_size(path, size);
+        return;
+    }
+    lock_guard<mutex> lock(inline_mutex(path));
+    GKFS_DATA->mdb()->decrease_size(path, size);
+}
+
+/**
+ * @internal
+ * The data of a file is stored inline if its inline data spans the whole file.
+ * This is also true for empty files, which become inline files with their
+ * first inline write. Files whose data is stored in chunks have a size larger
+ * than their (empty) inline data. Truncating such a file to 0 makes it
+ * eligible again, as truncate removes all of its chunks.
+ * @endinternal
+ */
+bool
+write_inline(const string& path, const char* buf, size_t count,
+             off64_t& offset, bool append) {
+    lock_guard<mutex> lock(inline_mutex(path));
+    auto md = get(path);
+    auto data = md.inline_data();
+    if(data.size() != md.size())
+        return false;
+    if(append)
+        offset = static_cast<off64_t>(md.size());
+    auto end = offset + count;
+    if(end > GKFS_DATA->inline_data_size())
+        return false;
+    if(end > data.size())
+        data.resize(end);
+    data.replace(offset, count, buf, count);
+    md.size(data.size());
+    md.inline_data(data);
+    if constexpr(gkfs::config::metadata::use_mtime) {
+        md.update_mtime_now();
+    }
+    update(path, md);
+    return true;
+}
+
+bool
+read_inline(const string& path, off64_t offset, size_t count,
+            string& data) {
+    lock_guard<mutex> lock(inline_mutex(path));
+    auto md = get(path);
+    const auto& inline_data = md.inline_data();
+    if(inline_data.empty() || inline_data.size() != md.size())
+        return false;
+    data.clear();
+    if(static_cast<size_t>(offset) < inline_data.size())
+        data = inline_data.substr(offset, count);
+    return true;
+}
+
+/**
+ * @internal
+ * A file whose data is no longer stored inline was spilled by another client
+ * in the meantime, which wrote the same data to the chunks.
+ * @endinternal
+ */
+bool
+spill_inline(const string& path, const string& data) {
+    lock_guard<mutex> lock(inline_mutex(path));
+    auto md = get(path);
+    const auto& inline_data = md.inline_data();
+    if(inline_data.empty() || inline_data.size() != md.size())
+        return true;
+    if(inline_data != data)
+        return false;
+    md.inline_data({});
+    update(path, md);
+    return true;
+}
+
 void
 remove(const string& path) {
     /*
@@ -0,0 +1,357 @@
+/*
+  Copyright 2018-2024, Barcelona Supercomputing Center (BSC), Spain
+  Copyright 2015-2024, Johannes Gutenberg Universitaet Mainz, Germany
+
+  This software was partially supported by the
+  EC H2020 funded project NEXTGenIO (Project ID: 671951, www.nextgenio.eu).
+
+  This software was partially supported by the
+  ADA-FS project under the SPPEXA project funded by the DFG.
+
+  This file is part of GekkoFS.
+
+  GekkoFS is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  GekkoFS is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with GekkoFS.  If not, see <https://www.gnu.org/licenses/>.
+
+  SPDX-License-Identifier: GPL-3.0-or-later
+*/
+/**
+ * @brief Member definitions for the io_uring chunk I/O engine.
+ */
+
+#include <daemon/ops/uring_engine.hpp>
+#include <daemon/daemon.hpp>
+#include <daemon/backend/data/chunk_storage.hpp>
+#include <daemon/backend/data/file_handle.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+using namespace std;
+
+namespace gkfs::data {
+
+void
+UringEngine::queue(request* req) {
+    auto* sqe = io_uring_get_sqe(&ring_);
+    if(!sqe) {
+        // submission queue is full. Hand it to the kernel and try again
+        submit_queued();
+        sqe = io_uring_get_sqe(&ring_);
+        if(!sqe)
+            throw UringEngineException("No io_uring submission entry left");
+    }
+    auto* buf = req->buf + req->done;
+    auto size = req->size - req->done;
+    auto off = req->off + req->done;
+    auto index = fixed_index(buf, size);
+    if(index >= 0) {
+        if(req->write)
+            io_uring_prep_write_fixed(sqe, req->fh->native(), buf, size, off,
+                                      index);
+        else
+            io_uring_prep_read_fixed(sqe, req->fh->native(), buf, size, off,
+                                     index);
+    } else if(req->write) {
+        io_uring_prep_write(sqe, req->fh->native(), buf, size, off);
+    } else {
+        io_uring_prep_read(sqe, req->fh->native(), buf, size, off);
+    }
+    io_uring_sqe_set_data(sqe, req);
+    unsubmitted_.emplace_back(sqe, req);
+}
+
+/**
+ * @internal
+ * The kernel takes queued entries in order and does not take any if
+ * io_uring_enter() fails. After a hard error, the entries are therefore still
+ * in the submission queue and are turned into NOPs without user data, which
+ * the reaper ignores, before their requests are completed. Otherwise, the
+ * kernel would access the freed requests and their buffers on the next
+ * successful submit.
+ * @endinternal
+ */
+int
+UringEngine::submit_queued() {
+    auto ret = io_uring_submit(&ring_);
+    if(ret >= 0) {
+        auto taken = min(static_cast<size_t>(ret), unsubmitted_.size());
+        unsubmitted_.erase(unsubmitted_.begin(), unsubmitted_.begin() + taken);
+        return ret;
+    }
+    if(ret == -EINTR || ret == -EAGAIN || ret == -EBUSY)
+        return ret;
+    for(auto& [sqe, req] : unsubmitted_) {
+        io_uring_prep_nop(sqe);
+        io_uring_sqe_set_data(sqe, nullptr);
+        complete(req, ret);
+    }
+    unsubmitted_.clear();
+    return ret;
+}
+
+int
+UringEngine::fixed_index(const char* buf, size_t size) const {
+    // last buffer starting at or before buf
+    auto it = upper_bound(
+            fixed_buffers_.begin(), fixed_buffers_.end(), buf,
+            [](const char* b, const fixed_buffer& f) { return b < f.base; });
+    if(it == fixed_buffers_.begin())
+        return -1;
+    --it;
+    if(static_cast<size_t>(buf - it->base) + size > it->size)
+        return -1;
+    return it->index;
+}
+
+void
+UringEngine::prepare(const string& path, gkfs::rpc::chnk_id_t chunk_id,
+                     char* buf, size_t size, off64_t offset, bool write,
+                     ABT_eventual eventual) {
+    auto* req = new request{nullptr, buf, size, offset, 0, write, eventual};
+    try {
+        // may throw ChunkStorageException, e.g., ENOENT for sparse reads
+        req->fh = GKFS_DATA->storage()->open_chunk(path, chunk_id, write);
+        req->off += GKFS_DATA->storage()->chunk_offset(chunk_id);
+    } catch(const ChunkStorageException& err) {
+        GKFS_DATA->spdlogger()->error("{}() {}", __func__, err.what());
+        complete(req, -(err.code().value()));
+        return;
+    } catch(const ::exception& err) {
+        GKFS_DATA->spdlogger()->error(
+                "{}() Unexpected error opening chunk {} of file {}", __func__,
+                chunk_id, path);
+        complete(req, -EIO);
+        return;
+    }
+    if(size == 0) {
+        complete(req, 0);
+        return;
+    }
+    try {
+        lock_guard<mutex> lock(sq_mutex_);
+        queue(req);
+    } catch(const ::exception& err) {
+        GKFS_DATA->spdlogger()->error(
+                "{}() Failed to queue chunk {} of file {}: {}", __func__,
+                chunk_id, path, err.what());
+        complete(req, -EBUSY);
+    }
+}
+
+void
+UringEngine::complete(request* req, ssize_t result) {
+    ABT_eventual_set(req->eventual, &result, sizeof(result));
+    delete req;
+}
+
+void
+UringEngine::reap_abt(void* _arg) {
+    assert(_arg);
+    static_cast<UringEngine*>(_arg)->reap();
+}
+
+/**
+ * @internal
+ * The reaper only accesses the submission queue, protected by sq_mutex_, to
+ * requeue unfinished requests. Waiting on the completion queue is safe without
+ * the lock as long as only a single thread is consuming it.
+ * A request without user data is the NOP submitted by the destructor to wake
+ * up the reaper for shutdown.
+ * @endinternal
+ */
+void
+UringEngine::reap() {
+    while(true) {
+        struct io_uring_cqe* cqe = nullptr;
+        auto ret = io_uring_wait_cqe(&ring_, &cqe);
+        if(ret < 0) {
+            if(ret == -EINTR || ret == -EAGAIN)
+                continue;
+            GKFS_DATA->spdlogger()->critical(
+                    "{}() Failed to wait for io_uring completions: '{}'",
+                    __func__, ::strerror(-ret));
+            return;
+        }
+        auto* req = static_cast<request*>(io_uring_cqe_get_data(cqe));
+        auto res = cqe->res;
+        io_uring_cqe_seen(&ring_, cqe);
+        if(!req) {
+            if(!running_)
+                return;
+            continue;
+        }
+        if(res < 0 && res != -EINTR && res != -EAGAIN) {
+            GKFS_DATA->spdlogger()->error(
+                    "{}() Failed to {} chunk file. size: '{}', offset: '{}', Error: '{}'",
+                    __func__, req->write ? "write" : "read", req->size,
+                    req->off, ::strerror(-res));
+            complete(req, res);
+            continue;
+        }
+        if(res > 0)
+            req->done += res;
+        // A value of zero indicates end-of-file for reads which is not an
+        // error. Otherwise continue with the remaining bytes
+        if(res != 0 && req->done < req->size) {
+            try {
+                lock_guard<mutex> lock(sq_mutex_);
+                queue(req);
+                submit_queued();
+            } catch(const ::exception& err) {
+                GKFS_DATA->spdlogger()->error("{}() {}", __func__, err.what());
+                complete(req, -EBUSY);
+            }
+            continue;
+        }
+        complete(req, static_cast<ssize_t>(req->done));
+    }
+}
+
+UringEngine::UringEngine(unsigned int queue_depth) {
+    auto ret = io_uring_queue_init(queue_depth, &ring_, 0);
+    if(ret < 0) {
+        throw UringEngineException(
+                fmt::format("Failed to set up io_uring with depth {}: '{}'",
+                            queue_depth, ::strerror(-ret)));
+    }
+    ret = ABT_pool_create_basic(ABT_POOL_FIFO_WAIT, ABT_POOL_ACCESS_MPSC,
+                                ABT_TRUE, &pool_);
+    if(ret == ABT_SUCCESS)
+        ret = ABT_xstream_create_basic(ABT_SCHED_BASIC_WAIT, 1, &pool_,
+                                       ABT_SCHED_CONFIG_NULL, &xstream_);
+    if(ret == ABT_SUCCESS)
+        ret = ABT_thread_create(pool_, reap_abt, this, ABT_THREAD_ATTR_NULL,
+                                &reaper_);
+    if(ret != ABT_SUCCESS) {
+        if(xstream_ != ABT_XSTREAM_NULL) {
+            ABT_xstream_join(xstream_);
+            ABT_xstream_free(&xstream_);
+        }
+        io_uring_queue_exit(&ring_);
+        throw UringEngineException(
+                "Failed to create execution stream for io_uring completions");
+    }
+}
+
+UringEngine::~UringEngine() {
+    running_ = false;
+    {
+        lock_guard<mutex> lock(sq_mutex_);
+        auto* sqe = io_uring_get_sqe(&ring_);
+        if(!sqe) {
+            io_uring_submit(&ring_);
+            sqe = io_uring_get_sqe(&ring_);
+        }
+        if(sqe) {
+            io_uring_prep_nop(sqe);
+            io_uring_sqe_set_data(sqe, nullptr);
+        }
+        io_uring_submit(&ring_);
+    }
+    ABT_thread_join(reaper_);
+    ABT_thread_free(&reaper_);
+    ABT_xstream_join(xstream_);
+    ABT_xstream_free(&xstream_);
+    io_uring_queue_exit(&ring_);
+}
+
+void
+UringEngine::write_nonblock(const string& path, gkfs::rpc::chnk_id_t chunk_id,
+                            const char* buf, size_t size, off64_t offset,
+                            ABT_eventual eventual) noexcept {
+    // the buffer is only read by the kernel for writes
+    prepare(path, chunk_id, const_cast<char*>(buf), size, offset, true,
+            eventual);
+}
+
+void
+UringEngine::read_nonblock(const string& path, gkfs::rpc::chnk_id_t chunk_id,
+                           char* buf, size_t size, off64_t offset,
+                           ABT_eventual eventual) noexcept {
+    prepare(path, chunk_id, buf, size, offset, false, eventual);
+}
+
+/**
+ * @internal
+ * Registering pins the buffers' pages and may fail, e.g., because of the
+ * locked memory limit or the kernel's limit of 16384 (1024 before Linux 5.13)
+ * buffers, each of at most 1 GiB.
+ * @endinternal
+ */
+void
+UringEngine::register_buffers(const vector<pair<void*, size_t>>& buffers) {
+    vector<struct iovec> iovs{};
+    vector<fixed_buffer> fixed{};
+    iovs.reserve(buffers.size());
+    fixed.reserve(buffers.size());
+    for(const auto& [buf, size] : buffers) {
+        fixed.push_back({static_cast<char*>(buf), size,
+                         static_cast<int>(iovs.size())});
+        iovs.push_back({buf, size});
+    }
+    sort(fixed.begin(), fixed.end(),
+         [](const fixed_buffer& a, const fixed_buffer& b) {
+             return a.base < b.base;
+         });
+    lock_guard<mutex> lock(sq_mutex_);
+    if(!fixed_buffers_.empty())
+        throw UringEngineException("io_uring buffers are registered already");
+    auto ret = io_uring_register_buffers(&ring_, iovs.data(), iovs.size());
+    if(ret < 0) {
+        throw UringEngineException(
+                fmt::format("Failed to register {} io_uring buffers: '{}'",
+                            iovs.size(), ::strerror(-ret)));
+    }
+    fixed_buffers_ = std::move(fixed);
+}
+
+void
+UringEngine::unregister_buffers() {
+    lock_guard<mutex> lock(sq_mutex_);
+    if(fixed_buffers_.empty())
+        return;
+    fixed_buffers_.clear();
+    io_uring_unregister_buffers(&ring_);
+}
+
+/**
+ * @internal
+ * Queued requests are not lost if submitting fails temporarily, e.g., with
+ * EBUSY if the completion queue is overflowing. In this case, the caller yields
+ * to let the reaper make progress and tries again. On any other error, the
+ * queued requests have been completed with the error by submit_queued().
+ * @endinternal
+ */
+void
+UringEngine::submit() {
+    while(true) {
+        int ret;
+        {
+            lock_guard<mutex> lock(sq_mutex_);
+            ret = submit_queued();
+        }
+        if(ret >= 0)
+            return;
+        if(ret != -EINTR && ret != -EAGAIN && ret != -EBUSY) {
+            GKFS_DATA->spdlogger()->error(
+                    "{}() Failed to submit to io_uring, queued requests failed: '{}'",
+                    __func__, ::strerror(-ret));
+            return;
+        }
+        ABT_thread_yield();
+    }
+}
+
+} // namespace gkfs::data
@@ -0,0 +1,127 @@
+/*
+  Copyright 2018-2024, Barcelona Supercomputing Center (BSC), Spain
+  Copyright 2015-2024, Johannes Gutenberg Universitaet Mainz, Germany
+
+  This software was partially supported by the
+  EC H2020 funded project NEXTGenIO (Project ID: 671951, www.nextgenio.eu).
+
+  This software was partially supported by the
+  ADA-FS project under the SPPEXA project funded by the DFG.
+
+  This file is part of GekkoFS.
+
+  GekkoFS is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  GekkoFS is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with GekkoFS.  If not, see <https://www.gnu.org/licenses/>.
+
+  SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include <catch2/catch.hpp>
+#include <common/attr_cache.hpp>
+
+#include <cerrno>
+
+using gkfs::metadata::AttributeCache;
+using std::chrono::milliseconds;
+
+SCENARIO(" stat results are cached until they expire ",
+         "[metadata][attr_cache]") {
+
+    GIVEN(" a cache of 4 entries in 1 shard with a TTL of 100 ms ") {
+
+        AttributeCache cache{4, 1, milliseconds(100)};
+        const auto now = AttributeCache::clock::now();
+
+        WHEN(" the attributes of a path are cached ") {
+
+            cache.put("/foo", {0, "attr"}, now);
+
+            THEN(" they are returned until the TTL expires ") {
+                auto hit = cache.get("/foo", now + milliseconds(99));
+                REQUIRE(hit.has_value());
+                REQUIRE(hit->err == 0);
+                REQUIRE(hit->attr == "attr");
+                REQUIRE(!cache.get("/foo", now + milliseconds(100)));
+                REQUIRE(cache.stats().hits == 1);
+                REQUIRE(cache.stats().misses == 1);
+                REQUIRE(cache.stats().size == 0);
+            }
+
+            AND_WHEN(" they are replaced ") {
+
+                cache.put("/foo", {0, "new"}, now + milliseconds(50));
+
+                THEN(" the new attributes get a new TTL ") {
+                    auto hit = cache.get("/foo", now + milliseconds(120));
+                    REQUIRE(hit.has_value());
+                    REQUIRE(hit->attr == "new");
+                }
+            }
+
+            AND_WHEN(" the path is invalidated ") {
+
+                cache.invalidate("/foo");
+
+                THEN(" they are no longer returned ") {
+                    REQUIRE(!cache.get("/foo", now));
+                    REQUIRE(cache.stats().size == 0);
+                }
+            }
+        }
+
+        WHEN(" a path does not exist ") {
+
+            cache.put("/missing", {ENOENT, ""}, now);
+
+            THEN(" the error is cached ") {
+                auto hit = cache.get("/missing", now);
+                REQUIRE(hit.has_value());
+                REQUIRE(hit->err == ENOENT);
+            }
+        }
+
+        WHEN(" more paths than the capacity are cached ") {
+
+            cache.put("/a", {0, "a"}, now);
+            cache.put("/b", {0, "b"}, now);
+            cache.put("/c", {0, "c"}, now);
+            cache.put("/d", {0, "d"}, now);
+            // "/a" becomes the most recently used entry
+            REQUIRE(cache.get("/a", now));
+            cache.put("/e", {0, "e"}, now);
+
+            THEN(" the least recently used entry is evicted ") {
+                REQUIRE(!cache.get("/b", now));
+                REQUIRE(cache.get("/a", now));
+                REQUIRE(cache.get("/e", now));
+                REQUIRE(cache.stats().evictions == 1);
+                REQUIRE(cache.stats().size == 4);
+            }
+        }
+    }
+
+    GIVEN(" a cache without capacity ") {
+
+        AttributeCache cache{0, 16, milliseconds(100)};
+
+        WHEN(" attributes are cached ") {
+
+            cache.put("/foo", {0, "attr"});
+
+            THEN(" nothing is stored ") {
+                REQUIRE(!cache.get("/foo"));
+                REQUIRE(cache.stats().size == 0);
+            }
+        }
+    }
+}
@@ -0,0 +1,272 @@
+/*
+  Copyright 2018-2024, Barcelona Supercomputing Center (BSC), Spain
+  Copyright 2015-2024, Johannes Gutenberg Universitaet Mainz, Germany
+
+  This software was partially supported by the
+  EC H2020 funded project NEXTGenIO (Project ID: 671951, www.nextgenio.eu).
+
+  This software was partially supported by the
+  ADA-FS project under the SPPEXA project funded by the DFG.
+
+  This file is part of GekkoFS.
+
+  GekkoFS is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  GekkoFS is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with GekkoFS.  If not, see <https://www.gnu.org/licenses/>.
+
+  SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include <catch2/catch.hpp>
+#include <daemon/backend/data/chunk_presence.hpp>
+
+#include <vector>
+
+using gkfs::data::ChunkBitmap;
+using gkfs::data::ChunkPresenceIndex;
+using gkfs::rpc::chnk_id_t;
+
+SCENARIO(" a chunk bitmap holds chunk ids exactly ",
+         "[chunk_presence][chunk_bitmap]") {
+
+    GIVEN(" an empty bitmap ") {
+
+        ChunkBitmap bitmap{};
+
+        WHEN(" chunks are added and removed ") {
+
+            bitmap.add(3);
+            bitmap.add(1);
+            bitmap.add(3);
+            bitmap.add(7);
+            bitmap.remove(7);
+            bitmap.remove(8);
+
+            THEN(" only the remaining chunks are set ") {
+                REQUIRE(bitmap.size() == 2);
+                REQUIRE(bitmap.contains(1));
+                REQUIRE(bitmap.contains(3));
+                REQUIRE_FALSE(bitmap.contains(0));
+                REQUIRE_FALSE(bitmap.contains(7));
+            }
+        }
+
+        WHEN(" a container exceeds 4096 chunks ") {
+
+            // every other id keeps the array from covering a range
+            for(chnk_id_t id = 0; id <= 2 * 4096; id += 2)
+                bitmap.add(id);
+
+            THEN(" it is converted to a bitmap holding the same chunks ") {
+                REQUIRE(bitmap.size() == 4097);
+                for(chnk_id_t id = 0; id <= 2 * 4096 + 1; id++)
+                    REQUIRE(bitmap.contains(id) == (id % 2 == 0));
+                REQUIRE_FALSE(bitmap.contains(65535));
+            }
+
+            AND_WHEN(" chunks are removed below 4097 again ") {
+
+                bitmap.remove(2);
+                bitmap.remove(3);
+                bitmap.add(1);
+
+                THEN(" it is converted back to an array ") {
+                    REQUIRE(bitmap.size() == 4097);
+                    REQUIRE(bitmap.contains(0));
+                    REQUIRE(bitmap.contains(1));
+                    REQUIRE_FALSE(bitmap.contains(2));
+                    REQUIRE(bitmap.contains(4));
+                    REQUIRE(bitmap.contains(2 * 4096));
+                }
+            }
+        }
+
+        WHEN(" chunks lie at the boundaries of 2^16 ids ") {
+
+            const std::vector<chnk_id_t> ids{0, 65535, 65536, 131071, 131072,
+                                             (chnk_id_t{1} << 40) + 65535};
+            for(auto id : ids)
+                bitmap.add(id);
+
+            THEN(" each is kept in its own container ") {
+                REQUIRE(bitmap.size() == ids.size());
+                for(auto id : ids)
+                    REQUIRE(bitmap.contains(id));
+                REQUIRE_FALSE(bitmap.contains(1));
+                REQUIRE_FALSE(bitmap.contains(65534));
+                REQUIRE_FALSE(bitmap.contains(65537));
+                REQUIRE_FALSE(bitmap.contains(131073));
+                REQUIRE_FALSE(bitmap.contains(chnk_id_t{1} << 40));
+            }
+
+            AND_WHEN(" chunks are removed from a container start ") {
+
+                auto removed = bitmap.remove_from(65536);
+
+                THEN(" all chunks at or beyond the cut are removed ") {
+                    REQUIRE(removed ==
+                            std::vector<chnk_id_t>{
+                                    65536, 131071, 131072,
+                                    (chnk_id_t{1} << 40) + 65535});
+                    REQUIRE(bitmap.size() == 2);
+                    REQUIRE(bitmap.contains(0));
+                    REQUIRE(bitmap.contains(65535));
+                    REQUIRE_FALSE(bitmap.contains(65536));
+                }
+            }
+
+            AND_WHEN(" chunks are removed from the last id of a container ") {
+
+                auto removed = bitmap.remove_from(65535);
+
+                THEN(" the cut chunk is removed as well ") {
+                    REQUIRE(removed.size() == 5);
+                    REQUIRE(removed.front() == 65535);
+                    REQUIRE(bitmap.size() == 1);
+                    REQUIRE(bitmap.contains(0));
+                }
+            }
+
+            AND_WHEN(" chunks are removed beyond all chunks ") {
+
+                auto removed = bitmap.remove_from((chnk_id_t{1} << 40) + 65536);
+
+                THEN(" nothing is removed ") {
+                    REQUIRE(removed.empty());
+                    REQUIRE(bitmap.size() == ids.size());
+                }
+            }
+        }
+
+        WHEN(" chunks are removed within a bitmap container ") {
+
+            for(chnk_id_t id = 65536; id < 65536 + 10000; id++)
+                bitmap.add(id);
+            bitmap.add(5);
+            auto removed = bitmap.remove_from(65536 + 5000);
+
+            THEN(" the chunks before the cut remain ") {
+                REQUIRE(removed.size() == 5000);
+                REQUIRE(removed.front() == 65536 + 5000);
+                REQUIRE(removed.back() == 65536 + 9999);
+                REQUIRE(bitmap.size() == 5001);
+                REQUIRE(bitmap.contains(5));
+                REQUIRE(bitmap.contains(65536 + 4999));
+                REQUIRE_FALSE(bitmap.contains(65536 + 5000));
+            }
+
+            AND_WHEN(" the container shrinks to an array ") {
+
+                auto more = bitmap.remove_from(65536 + 100);
+
+                THEN(" the chunks before the cut remain ") {
+                    REQUIRE(more.size() == 4900);
+                    REQUIRE(bitmap.size() == 101);
+                    REQUIRE(bitmap.contains(65536 + 99));
+                    REQUIRE_FALSE(bitmap.contains(65536 + 100));
+                }
+            }
+        }
+
+        WHEN(" chunks are removed within an array container ") {
+
+            for(chnk_id_t id = 10; id < 20; id++)
+                bitmap.add(id);
+            auto removed = bitmap.remove_from(15);
+
+            THEN(" the chunks before the cut remain ") {
+                REQUIRE(removed ==
+                        std::vector<chnk_id_t>{15, 16, 17, 18, 19});
+                REQUIRE(bitmap.size() == 5);
+                REQUIRE(bitmap.contains(14));
+                REQUIRE_FALSE(bitmap.contains(15));
+            }
+        }
+    }
+}
+
+SCENARIO(" a presence index knows the local chunks of files ",
+         "[chunk_presence][chunk_presence_index]") {
+
+    GIVEN(" an index ") {
+
+        ChunkPresenceIndex index{16, 4};
+        auto scans = 0;
+        auto scan = [&scans](ChunkBitmap& bitmap) {
+            scans++;
+            bitmap.add(1);
+            bitmap.add(70000);
+        };
+
+        WHEN(" a file is unknown ") {
+
+            THEN(" no chunk is reported absent ") {
+                REQUIRE_FALSE(index.absent("/f", 0));
+                index.add("/f", 0);
+                REQUIRE_FALSE(index.absent("/f", 1));
+            }
+        }
+
+        WHEN(" a file's chunk space is created ") {
+
+            index.init("/f", [] { return true; });
+            index.add("/f", 2);
+
+            THEN(" only added chunks are present ") {
+                REQUIRE(index.absent("/f", 1));
+                REQUIRE_FALSE(index.absent("/f", 2));
+            }
+        }
+
+        WHEN(" a file's chunk space existed before ") {
+
+            index.init("/f", [] { return false; });
+
+            THEN(" its chunks are not known ") {
+                REQUIRE_FALSE(index.absent("/f", 1));
+            }
+        }
+
+        WHEN(" a file is loaded ") {
+
+            index.load("/f", scan);
+            index.load("/f", scan);
+
+            THEN(" it is scanned once ") {
+                REQUIRE(scans == 1);
+                REQUIRE_FALSE(index.absent("/f", 70000));
+                REQUIRE(index.absent("/f", 2));
+            }
+
+            AND_WHEN(" it is erased ") {
+
+                index.erase("/f");
+
+                THEN(" its chunks are not known anymore ") {
+                    REQUIRE_FALSE(index.absent("/f", 2));
+                }
+            }
+        }
+
+        WHEN(" an unknown file is trimmed ") {
+
+            auto removed = index.trim("/f", 2, scan);
+
+            THEN(" it is scanned and the chunks beyond the cut are removed ") {
+                REQUIRE(scans == 1);
+                REQUIRE(removed == std::vector<chnk_id_t>{70000});
+                REQUIRE_FALSE(index.absent("/f", 1));
+                REQUIRE(index.absent("/f", 70000));
+            }
+        }
+    }
+}
@@ -0,0 +1,199 @@
+/*
+  Copyright 2018-2024, Barcelona Supercomputing Center (BSC), Spain
+  Copyright 2015-2024, Johannes Gutenberg Universitaet Mainz, Germany
+
+  This software was partially supported by the
+  EC H2020 funded project NEXTGenIO (Project ID: 671951, www.nextgenio.eu).
+
+  This software was partially supported by the
+  ADA-FS project under the SPPEXA project funded by the DFG.
+
+  This file is part of GekkoFS.
+
+  GekkoFS is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  GekkoFS is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with GekkoFS.  If not, see <https://www.gnu.org/licenses/>.
+
+  SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include <catch2/catch.hpp>
+#include <common/rpc/chunk_set.hpp>
+
+#include <stdexcept>
+#include <vector>
+
+using gkfs::rpc::ChunkSet;
+
+namespace {
+
+/**
+ * Build the chunk set of one daemon out of @daemons for a request of
+ * @n chunks, mimicking the scattered placement of the hash distributor.
+ *
+ * @param n number of chunks of the request
+ * @param daemons number of daemons (1 yields a contiguous set)
+ * @returns the chunk set of daemon 0
+ */
+ChunkSet
+make_chunk_set(uint64_t n, uint64_t daemons) {
+    ChunkSet set{};
+    for(uint64_t chunk = 0; chunk < n; chunk++) {
+        if(((chunk * 2654435761u) >> 7) % daemons == 0) {
+            set.add(chunk);
+        }
+    }
+    return set;
+}
+
+/**
+ * Check that @set survives an encode/decode round trip.
+ *
+ * @param set the set to check
+ * @param n number of chunks of the request
+ */
+void
+check_round_trip(const ChunkSet& set, uint64_t n) {
+    const auto encoded = set.encode();
+    const auto decoded = ChunkSet::decode(encoded.data(), encoded.size());
+
+    REQUIRE(decoded.size() == set.size());
+    for(uint64_t chunk = 0; chunk < n + 8; chunk++) {
+        REQUIRE(decoded.contains(chunk) == set.contains(chunk));
+    }
+    REQUIRE(decoded.encode() == encoded);
+}
+
+} // namespace
+
+SCENARIO(" chunk sets survive an encode/decode round trip ",
+         "[rpc][chunk_set]") {
+
+    GIVEN(" an empty chunk set ") {
+
+        ChunkSet set{};
+
+        THEN(" it round trips and contains no chunk ") {
+            REQUIRE(set.size() == 0);
+            REQUIRE(!set.contains(0));
+            check_round_trip(set, 0);
+        }
+    }
+
+    GIVEN(" a contiguous chunk set ") {
+
+        const uint64_t n = 100000;
+        const auto set = make_chunk_set(n, 1);
+
+        THEN(" it is encoded in a few bytes ") {
+            REQUIRE(set.size() == n);
+            REQUIRE(set.encode().size() < 8);
+            check_round_trip(set, n);
+        }
+    }
+
+    GIVEN(" scattered chunk sets ") {
+
+        const uint64_t n = 100000;
+
+        THEN(" they round trip and are not larger than a bitmap ") {
+            for(const uint64_t daemons : {2u, 16u, 512u}) {
+                const auto set = make_chunk_set(n, daemons);
+                REQUIRE(set.encode().size() <= n / 8 + 16);
+                check_round_trip(set, n);
+            }
+        }
+    }
+
+    GIVEN(" a chunk set with chunks beyond 16 bits ") {
+
+        ChunkSet set{};
+        set.add(3);
+        set.add(70000);
+        set.add(1ull << 40);
+
+        THEN(" it round trips ") {
+            REQUIRE(set.size() == 3);
+            REQUIRE(set.contains(1ull << 40));
+            check_round_trip(set, 70000);
+        }
+    }
+}
+
+SCENARIO(" chunk sets reject invalid input ", "[rpc][chunk_set]") {
+
+    GIVEN(" a chunk set ") {
+
+        ChunkSet set{};
+        set.add(10);
+
+        WHEN(" the last chunk is added again ") {
+
+            set.add(10);
+
+            THEN(" the set is unchanged ") {
+                REQUIRE(set.size() == 1);
+            }
+        }
+
+        WHEN(" a preceding chunk is added ") {
+
+            THEN(" std::invalid_argument is thrown ") {
+                REQUIRE_THROWS_AS(set.add(9), std::invalid_argument);
+            }
+        }
+    }
+
+    GIVEN(" malformed encodings ") {
+
+        const std::vector<std::vector<uint8_t>> malformed = {
+                {},              // empty
+                {2, 0},          // unknown format
+                {0, 1, 0x80},    // truncated varint
+                {0, 5, 0, 0},    // too many runs
+                {0, 1, 0, 0, 0}, // trailing bytes
+                {1, 9, 0xff},    // bitmap too short
+        };
+
+        THEN(" decoding throws std::invalid_argument ") {
+            for(const auto& data : malformed) {
+                REQUIRE_THROWS_AS(ChunkSet::decode(data.data(), data.size()),
+                                  std::invalid_argument);
+            }
+        }
+    }
+}
+
+// benchmarks are hidden, run them with `tests "[benchmark]"`
+TEST_CASE(" chunk set encoding performance ", "[.][benchmark][chunk_set]") {
+
+    for(const uint64_t n : {1u << 10, 1u << 16, 1u << 20}) {
+        for(const uint64_t daemons : {1u, 4u, 64u}) {
+            const auto set = make_chunk_set(n, daemons);
+            const auto encoded = set.encode();
+            const auto name = std::to_string(n) + " chunks, " +
+                              std::to_string(daemons) + " daemons";
+
+            BENCHMARK("encode " + name) {
+                return set.encode();
+            };
+
+            BENCHMARK("decode " + name) {
+                return ChunkSet::decode(encoded.data(), encoded.size());
+            };
+
+            BENCHMARK("contains " + name) {
+                return set.contains(n / 2);
+            };
+        }
+    }
+}
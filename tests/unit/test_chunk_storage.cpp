@@ -0,0 +1,87 @@
+/*
+  Copyright 2018-2024, Barcelona Supercomputing Center (BSC), Spain
+  Copyright 2015-2024, Johannes Gutenberg Universitaet Mainz, Germany
+
+  This software was partially supported by the
+  EC H2020 funded project NEXTGenIO (Project ID: 671951, www.nextgenio.eu).
+
+  This software was partially supported by the
+  ADA-FS project under the SPPEXA project funded by the DFG.
+
+  This file is part of GekkoFS.
+
+  GekkoFS is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  GekkoFS is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with GekkoFS.  If not, see <https://www.gnu.org/licenses/>.
+
+  SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include <catch2/catch.hpp>
+#include <daemon/backend/data/chunk_storage.hpp>
+#include <daemon/backend/data/data_module.hpp>
+#include <spdlog/sinks/null_sink.h>
+#include <helpers.hpp>
+
+#include <string>
+
+using gkfs::data::ChunkLayout;
+using gkfs::data::ChunkStorage;
+
+SCENARIO(" compressed chunks are stored without the file handle cache ",
+         "[chunk_storage][compression]") {
+
+    GIVEN(" a chunk storage with compression and no file handle cache ") {
+
+        if(!spdlog::get(gkfs::data::DataModule::LOGGER_NAME))
+            spdlog::null_logger_mt(gkfs::data::DataModule::LOGGER_NAME);
+
+        helpers::temporary_directory tmpdir{};
+        std::string root = tmpdir.dirname().string();
+        constexpr size_t chunksize = 4096;
+        ChunkStorage storage(root, chunksize, 0, ChunkLayout::chunk, false,
+                             0, false, {}, false, true);
+
+        std::string data(chunksize, 'a');
+        data.replace(100, 5, "hello");
+        REQUIRE(storage.write_chunk("/foo", 1, data.data(), data.size(), 0) ==
+                static_cast<ssize_t>(data.size()));
+
+        WHEN(" the chunk is partially overwritten ") {
+
+            REQUIRE(storage.write_chunk("/foo", 1, "XYZ", 3, 2000) == 3);
+
+            THEN(" the whole chunk is read back with the new data ") {
+                data.replace(2000, 3, "XYZ");
+                std::string buf(chunksize, '\0');
+                REQUIRE(storage.read_chunk("/foo", 1, buf.data(), buf.size(),
+                                           0) ==
+                        static_cast<ssize_t>(chunksize));
+                REQUIRE(buf == data);
+                REQUIRE(storage.compression_stats().stored_bytes <
+                        storage.compression_stats().raw_bytes);
+            }
+        }
+
+        WHEN(" the chunk is truncated ") {
+
+            storage.truncate_chunk_file("/foo", 1, 103);
+
+            THEN(" only the remaining data is read back ") {
+                std::string buf(chunksize, '\0');
+                REQUIRE(storage.read_chunk("/foo", 1, buf.data(), buf.size(),
+                                           0) == 103);
+                REQUIRE(buf.substr(0, 103) == data.substr(0, 103));
+            }
+        }
+    }
+}
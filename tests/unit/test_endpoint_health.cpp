@@ -0,0 +1,114 @@
+/*
+  Copyright 2018-2024, Barcelona Supercomputing Center (BSC), Spain
+  Copyright 2015-2024, Johannes Gutenberg Universitaet Mainz, Germany
+
+  This software was partially supported by the
+  EC H2020 funded project NEXTGenIO (Project ID: 671951, www.nextgenio.eu).
+
+  This software was partially supported by the
+  ADA-FS project under the SPPEXA project funded by the DFG.
+
+  This file is part of GekkoFS.
+
+  GekkoFS is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  GekkoFS is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with GekkoFS.  If not, see <https://www.gnu.org/licenses/>.
+
+  SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include <catch2/catch.hpp>
+#include <common/rpc/endpoint_health.hpp>
+
+#include <stdexcept>
+
+using gkfs::rpc::EndpointHealth;
+using std::chrono::milliseconds;
+
+SCENARIO(" endpoints failing RPCs in a row are suspected for a period ",
+         "[rpc][endpoint_health]") {
+
+    GIVEN(" a tracker suspecting endpoints after 3 failures for 100 ms ") {
+
+        EndpointHealth health{3, milliseconds(100)};
+        const auto now = EndpointHealth::clock::now();
+
+        WHEN(" an endpoint failed fewer than 3 RPCs in a row ") {
+
+            health.failed(1, now);
+            health.failed(1, now);
+
+            THEN(" it is not suspected ") {
+                REQUIRE(!health.suspect(1, now));
+                REQUIRE(health.suspects(now).empty());
+            }
+        }
+
+        WHEN(" an endpoint failed 3 RPCs in a row ") {
+
+            for(int i = 0; i < 3; i++) {
+                health.failed(1, now);
+            }
+
+            THEN(" it is suspected during the period ") {
+                REQUIRE(health.suspect(1, now));
+                REQUIRE(health.suspect(1, now + milliseconds(99)));
+                REQUIRE(!health.suspect(2, now));
+                REQUIRE(health.suspects(now) == std::vector<uint64_t>{1});
+            }
+
+            THEN(" it is no longer suspected after the period ") {
+                REQUIRE(!health.suspect(1, now + milliseconds(100)));
+            }
+
+            AND_WHEN(" it fails again after the period ") {
+
+                health.failed(1, now + milliseconds(150));
+
+                THEN(" it is suspected again ") {
+                    REQUIRE(health.suspect(1, now + milliseconds(200)));
+                    REQUIRE(!health.suspect(1, now + milliseconds(250)));
+                }
+            }
+
+            AND_WHEN(" it answers an RPC ") {
+
+                health.answered(1);
+
+                THEN(" it is no longer suspected ") {
+                    REQUIRE(!health.suspect(1, now));
+                    REQUIRE(health.suspects(now).empty());
+                }
+            }
+        }
+
+        WHEN(" an endpoint answers between failures ") {
+
+            health.failed(1, now);
+            health.failed(1, now);
+            health.answered(1);
+            health.failed(1, now);
+
+            THEN(" it is not suspected ") {
+                REQUIRE(!health.suspect(1, now));
+            }
+        }
+    }
+
+    GIVEN(" a threshold of 0 ") {
+
+        THEN(" std::invalid_argument is thrown ") {
+            REQUIRE_THROWS_AS(EndpointHealth(0, milliseconds(100)),
+                              std::invalid_argument);
+        }
+    }
+}
@@ -0,0 +1,92 @@
+/*
+  Copyright 2018-2024, Barcelona Supercomputing Center (BSC), Spain
+  Copyright 2015-2024, Johannes Gutenberg Universitaet Mainz, Germany
+
+  This software was partially supported by the
+  EC H2020 funded project NEXTGenIO (Project ID: 671951, www.nextgenio.eu).
+
+  This software was partially supported by the
+  ADA-FS project under the SPPEXA project funded by the DFG.
+
+  This file is part of GekkoFS.
+
+  GekkoFS is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  GekkoFS is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with GekkoFS.  If not, see <https://www.gnu.org/licenses/>.
+
+  SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include <catch2/catch.hpp>
+#include <common/rpc/latency_tracker.hpp>
+
+#include <stdexcept>
+
+using gkfs::rpc::LatencyTracker;
+using std::chrono::microseconds;
+
+SCENARIO(" latency trackers report a percentile of recent latencies ",
+         "[rpc][latency_tracker]") {
+
+    GIVEN(" a tracker of the 90th percentile ") {
+
+        LatencyTracker tracker{90, 100, 10};
+
+        WHEN(" fewer than min_samples latencies were added ") {
+
+            for(int i = 0; i < 9; i++) {
+                tracker.add(microseconds(100));
+            }
+
+            THEN(" no percentile is reported ") {
+                REQUIRE(tracker.value() == microseconds(0));
+            }
+        }
+
+        WHEN(" latencies 1 to 100 were added ") {
+
+            for(int i = 1; i <= 100; i++) {
+                tracker.add(microseconds(i));
+            }
+
+            THEN(" their 90th percentile is reported ") {
+                REQUIRE(tracker.value() == microseconds(90));
+            }
+        }
+
+        WHEN(" the latencies become slower ") {
+
+            for(int i = 1; i <= 100; i++) {
+                tracker.add(microseconds(i));
+            }
+            for(int i = 0; i < 100; i++) {
+                tracker.add(microseconds(1000));
+            }
+
+            THEN(" only the recent latencies are considered ") {
+                REQUIRE(tracker.value() == microseconds(1000));
+            }
+        }
+    }
+
+    GIVEN(" invalid parameters ") {
+
+        THEN(" std::invalid_argument is thrown ") {
+            REQUIRE_THROWS_AS(LatencyTracker(0, 100, 10),
+                              std::invalid_argument);
+            REQUIRE_THROWS_AS(LatencyTracker(101, 100, 10),
+                              std::invalid_argument);
+            REQUIRE_THROWS_AS(LatencyTracker(50, 0, 10),
+                              std::invalid_argument);
+        }
+    }
+}
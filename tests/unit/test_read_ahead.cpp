@@ -0,0 +1,169 @@
+/*
+  Copyright 2018-2024, Barcelona Supercomputing Center (BSC), Spain
+  Copyright 2015-2024, Johannes Gutenberg Universitaet Mainz, Germany
+
+  This software was partially supported by the
+  EC H2020 funded project NEXTGenIO (Project ID: 671951, www.nextgenio.eu).
+
+  This software was partially supported by the
+  ADA-FS project under the SPPEXA project funded by the DFG.
+
+  This file is part of GekkoFS.
+
+  GekkoFS is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  GekkoFS is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with GekkoFS.  If not, see <https://www.gnu.org/licenses/>.
+
+  SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include <catch2/catch.hpp>
+#include <common/read_ahead/read_ahead.hpp>
+
+#include <utility>
+
+using gkfs::read_ahead::AccessPattern;
+using gkfs::read_ahead::MemoryBudget;
+
+SCENARIO(" sequential and strided reads are predicted ",
+         "[read_ahead][access_pattern]") {
+
+    GIVEN(" a detector predicting after 2 reads continuing a pattern ") {
+
+        AccessPattern pattern{2};
+
+        WHEN(" a file is read sequentially ") {
+
+            auto first = pattern.record(0, 100);
+            auto second = pattern.record(100, 100);
+            auto third = pattern.record(200, 50);
+
+            THEN(" the read after the third is predicted to follow it ") {
+                REQUIRE(first == -1);
+                REQUIRE(second == -1);
+                REQUIRE(third == 250);
+                REQUIRE(pattern.record(250, 10) == 260);
+            }
+        }
+
+        WHEN(" a file is read with a stride ") {
+
+            pattern.record(0, 10);
+            pattern.record(1000, 10);
+            auto third = pattern.record(2000, 10);
+
+            THEN(" the next read is predicted one stride ahead ") {
+                REQUIRE(third == -1);
+                REQUIRE(pattern.record(3000, 10) == 4000);
+            }
+        }
+
+        WHEN(" the pattern is broken ") {
+
+            pattern.record(0, 100);
+            pattern.record(100, 100);
+            pattern.record(200, 100);
+            auto jump = pattern.record(10000, 100);
+
+            THEN(" no read is predicted until the new pattern is detected ") {
+                REQUIRE(jump == -1);
+                REQUIRE(pattern.record(10100, 100) == -1);
+                REQUIRE(pattern.record(10200, 100) == 10300);
+            }
+        }
+
+        WHEN(" a file is read backwards ") {
+
+            pattern.record(3000, 10);
+            pattern.record(2000, 10);
+
+            THEN(" no read is predicted ") {
+                REQUIRE(pattern.record(1000, 10) == -1);
+            }
+        }
+
+        WHEN(" the detector is reset ") {
+
+            pattern.record(0, 100);
+            pattern.record(100, 100);
+            pattern.reset();
+
+            THEN(" previous reads are forgotten ") {
+                REQUIRE(pattern.record(200, 100) == -1);
+                REQUIRE(pattern.record(300, 100) == -1);
+                REQUIRE(pattern.record(400, 100) == 500);
+            }
+        }
+    }
+}
+
+SCENARIO(" read-ahead memory is bounded by a budget ",
+         "[read_ahead][memory_budget]") {
+
+    GIVEN(" a budget of 100 bytes ") {
+
+        MemoryBudget budget{100};
+
+        WHEN(" memory within the limit is reserved ") {
+
+            auto a = budget.reserve(60);
+            auto b = budget.reserve(40);
+
+            THEN(" the reservations are granted ") {
+                REQUIRE(a);
+                REQUIRE(b);
+                REQUIRE(budget.used() == 100);
+            }
+
+            AND_THEN(" further memory is refused ") {
+                auto c = budget.reserve(1);
+                REQUIRE(!c);
+                REQUIRE(budget.used() == 100);
+            }
+        }
+
+        WHEN(" a reservation is destroyed ") {
+
+            {
+                auto a = budget.reserve(100);
+                REQUIRE(a);
+            }
+
+            THEN(" its memory is returned to the budget ") {
+                REQUIRE(budget.used() == 0);
+                REQUIRE(budget.reserve(100));
+            }
+        }
+
+        WHEN(" a reservation is moved ") {
+
+            auto a = budget.reserve(50);
+            auto b = std::move(a);
+
+            THEN(" its memory is returned only once ") {
+                REQUIRE(b.size() == 50);
+                b = MemoryBudget::Reservation{};
+                REQUIRE(budget.used() == 0);
+            }
+        }
+
+        WHEN(" more memory than the limit is requested ") {
+
+            auto a = budget.reserve(101);
+
+            THEN(" the reservation is refused ") {
+                REQUIRE(!a);
+                REQUIRE(budget.used() == 0);
+            }
+        }
+    }
+}
@@ -0,0 +1,158 @@
+/*
+  Copyright 2018-2024, Barcelona Supercomputing Center (BSC), Spain
+  Copyright 2015-2024, Johannes Gutenberg Universitaet Mainz, Germany
+
+  This software was partially supported by the
+  EC H2020 funded project NEXTGenIO (Project ID: 671951, www.nextgenio.eu).
+
+  This software was partially supported by the
+  ADA-FS project under the SPPEXA project funded by the DFG.
+
+  This file is part of GekkoFS.
+
+  GekkoFS is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  GekkoFS is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with GekkoFS.  If not, see <https://www.gnu.org/licenses/>.
+
+  SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include <catch2/catch.hpp>
+#include <common/erasure/reed_solomon.hpp>
+
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+using gkfs::ec::ReedSolomon;
+
+namespace {
+
+/**
+ * Encode random data with @rs and return the k + m shards.
+ *
+ * @param rs the code
+ * @param size size of each shard
+ * @returns data shards followed by parity shards
+ */
+std::vector<std::vector<uint8_t>>
+make_shards(const ReedSolomon& rs, size_t size) {
+    const auto k = rs.data_shards();
+    const auto m = rs.parity_shards();
+    std::mt19937 rng(k * 1000 + m);
+    std::vector<std::vector<uint8_t>> shards(k + m,
+                                             std::vector<uint8_t>(size));
+    for(unsigned i = 0; i < k; i++) {
+        for(auto& byte : shards[i]) {
+            byte = static_cast<uint8_t>(rng());
+        }
+    }
+    std::vector<const uint8_t*> data;
+    std::vector<uint8_t*> parity;
+    for(unsigned i = 0; i < k; i++) {
+        data.push_back(shards[i].data());
+    }
+    for(unsigned i = 0; i < m; i++) {
+        parity.push_back(shards[k + i].data());
+    }
+    rs.encode(data.data(), parity.data(), size);
+    return shards;
+}
+
+/**
+ * Erase the shards not in @present, reconstruct them with @rs, and check
+ * that they equal the originals.
+ *
+ * @param rs the code
+ * @param original the shards returned by make_shards()
+ * @param present which shards survive
+ */
+void
+check_reconstruct(const ReedSolomon& rs,
+                  const std::vector<std::vector<uint8_t>>& original,
+                  const std::vector<bool>& present) {
+    auto shards = original;
+    std::vector<uint8_t*> ptrs;
+    for(size_t i = 0; i < shards.size(); i++) {
+        if(!present[i]) {
+            std::fill(shards[i].begin(), shards[i].end(), 0xa5);
+        }
+        ptrs.push_back(shards[i].data());
+    }
+    rs.reconstruct(ptrs.data(), present, original[0].size());
+    REQUIRE(shards == original);
+}
+
+} // namespace
+
+SCENARIO(" Reed-Solomon restores erased shards ", "[erasure][reed_solomon]") {
+
+    GIVEN(" codes of different sizes ") {
+
+        THEN(" any m erased shards are restored ") {
+            std::mt19937 rng(42);
+            // sizes not a multiple of the vector width test the scalar tail
+            for(const auto& [k, m, size] :
+                {std::tuple{1u, 1u, 1u}, std::tuple{4u, 2u, 4099u},
+                 std::tuple{6u, 3u, 70000u}, std::tuple{10u, 4u, 333u},
+                 std::tuple{200u, 56u, 64u}}) {
+                const ReedSolomon rs{k, m};
+                const auto shards = make_shards(rs, size);
+                for(int round = 0; round < 20; round++) {
+                    std::vector<bool> present(k + m, true);
+                    for(unsigned e = 0; e < m; e++) {
+                        present[rng() % (k + m)] = false;
+                    }
+                    check_reconstruct(rs, shards, present);
+                }
+            }
+        }
+    }
+
+    GIVEN(" a 4+2 code ") {
+
+        const ReedSolomon rs{4, 2};
+        const auto shards = make_shards(rs, 1000);
+
+        THEN(" losing all parity shards restores them ") {
+            check_reconstruct(rs, shards,
+                              {true, true, true, true, false, false});
+        }
+
+        THEN(" losing the first data shards restores them ") {
+            check_reconstruct(rs, shards,
+                              {false, false, true, true, true, true});
+        }
+
+        THEN(" losing more than m shards throws std::invalid_argument ") {
+            auto copy = shards;
+            std::vector<uint8_t*> ptrs;
+            for(auto& shard : copy) {
+                ptrs.push_back(shard.data());
+            }
+            REQUIRE_THROWS_AS(rs.reconstruct(ptrs.data(),
+                                             {false, true, false, true, false,
+                                              true},
+                                             1000),
+                              std::invalid_argument);
+        }
+    }
+
+    GIVEN(" invalid code sizes ") {
+
+        THEN(" std::invalid_argument is thrown ") {
+            REQUIRE_THROWS_AS(ReedSolomon(0, 2), std::invalid_argument);
+            REQUIRE_THROWS_AS(ReedSolomon(4, 0), std::invalid_argument);
+            REQUIRE_THROWS_AS(ReedSolomon(200, 57), std::invalid_argument);
+        }
+    }
+}